@@ -161,6 +161,7 @@ def xls_ir_verilog_impl(ctx, src):
         "clock_period_ps",
         "additional_input_delay_ps",
         "pipeline_stages",
+        "initiation_interval",
         "delay_model",
         "top",
         "generator",
@@ -173,6 +174,8 @@ def xls_ir_verilog_impl(ctx, src):
         "flop_outputs_kind",
         "flop_single_value_channels",
         "add_idle_output",
+        "data_load_enable",
+        "retime_pipeline",
         "module_name",
         "clock_margin_percent",
         "period_relaxation_percent",
@@ -180,6 +180,7 @@ def _optimize_ir(ctx, src):
         "skip_passes",
         "opt_level",
         "convert_array_index_to_select",
+        "resource_sharing_max_delay_increase_ps",
         "inline_procs",
     )
 
@@ -236,6 +237,9 @@ def get_ir_equivalence_test_cmd(
     ir_equivalence_tool = get_xls_toolchain_info(ctx).ir_equivalence_tool
     IR_EQUIVALENCE_FLAGS = (
         "timeout",
+        "sat_sweeping",
+        "candidate_timeout",
+        "backend",
     )
 
     ir_equivalence_args = dict(ctx.attr.ir_equivalence_args)
@@ -353,6 +357,7 @@ def get_benchmark_ir_cmd(ctx, src, append_cmd_line_args = True):
         "show_known_bits",
         "delay_model",
         "convert_array_index_to_select",
+        "resource_sharing_max_delay_increase_ps",
     )
 
     benchmark_ir_args = append_default_to_args(
@@ -459,7 +459,7 @@ static absl::StatusOr<Node*> UpdateSingleStagePipelineWithFlowControl(
 // (4) Use the (pipelined) valid signal as the load enable signal for other
 //     pipeline registers in each stage. This is a power optimization
 //     which reduces switching in the data path when the valid signal is
-//     deasserted.
+//     deasserted. Skipped if CodegenOptions::data_load_enable() is false.
 // TODO(meheff): 2021/08/21 This might be better performed as a codegen pass.
 struct ValidPorts {
   InputPort* input;
@@ -490,7 +490,9 @@ static absl::StatusOr<ValidPorts> AddValidSignal(
 
   // Use the pipelined valid signal as load enable each datapath  pipeline
   // register in each stage as a power optimization.
-  for (int64_t stage = 0; stage < pipeline_registers.size(); ++stage) {
+  for (int64_t stage = 0;
+       options.data_load_enable() && stage < pipeline_registers.size();
+       ++stage) {
     // For each (non-valid-signal) pipeline register add `valid` or `valid ||
     // reset` (if reset exists) as a load enable. The `reset` term ensures the
     // pipeline flushes when reset is enabled.
@@ -448,6 +448,50 @@ TEST_F(BlockConversionTest, TrivialPipelinedFunction) {
   }
 }
 
+TEST_F(BlockConversionTest, PipelinedFunctionDataLoadEnable) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Negate(fb.Not(fb.Add(x, y)))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(f, TestDelayEstimator(),
+                            SchedulingOptions().pipeline_stages(3)));
+
+  // Returns the names of the registers which have a load enable.
+  auto load_enabled_registers = [](Block* block) {
+    std::vector<std::string> names;
+    for (Register* reg : block->GetRegisters()) {
+      if (block->GetRegisterWrite(reg).value()->load_enable().has_value()) {
+        names.push_back(reg->name());
+      }
+    }
+    return names;
+  };
+
+  CodegenOptions options;
+  options.flop_inputs(false).flop_outputs(false).clock_name("clk");
+  options.valid_control("input_valid", "output_valid");
+  {
+    // By default the data registers are loaded only when valid.
+    XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                             FunctionToPipelinedBlock(schedule, options, f));
+    EXPECT_EQ(block->GetRegisters().size(), 4);
+    EXPECT_EQ(load_enabled_registers(block).size(), 2);
+    XLS_ASSERT_OK(p->RemoveBlock(block));
+  }
+  {
+    options.data_load_enable(false);
+    XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                             FunctionToPipelinedBlock(schedule, options, f));
+    EXPECT_EQ(block->GetRegisters().size(), 4);
+    EXPECT_TRUE(load_enabled_registers(block).empty());
+  }
+}
+
 TEST_F(BlockConversionTest, ZeroWidthPipeline) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
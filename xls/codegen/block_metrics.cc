@@ -14,6 +14,11 @@
 
 #include "xls/codegen/block_metrics.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
@@ -33,6 +38,70 @@ int64_t GenerateFlopCount(Block* block) {
   return count;
 }
 
+// Returns the number of flops in registers with a load enable.
+absl::StatusOr<int64_t> GenerateGatedFlopCount(Block* block) {
+  int64_t count = 0;
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    if (reg_write->load_enable().has_value()) {
+      count += reg->type()->GetFlatBitCount();
+    }
+  }
+  return count;
+}
+
+// Returns the number of flops which may toggle in each cycle while the block
+// is idle. Input ports are assumed to change arbitrarily and registers with a
+// load enable are assumed to hold their value. A register without a load
+// enable toggles if its data input depends on a toggling value.
+absl::StatusOr<int64_t> GenerateIdleToggleFlopCount(Block* block) {
+  // Map from each register to the write which drives it.
+  absl::flat_hash_map<Register*, RegisterWrite*> reg_writes;
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(reg_writes[reg], block->GetRegisterWrite(reg));
+  }
+
+  // Nodes whose value may change while the block is idle. Registers form
+  // cycles through the register read/write pairs so iterate to a fixed point.
+  absl::flat_hash_set<Node*> toggling;
+  std::vector<Node*> topo_sort = TopoSort(block).AsVector();
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (Node* node : topo_sort) {
+      if (toggling.contains(node) || node->GetType()->GetFlatBitCount() == 0) {
+        continue;
+      }
+      bool toggles = false;
+      if (node->Is<InputPort>()) {
+        toggles = true;
+      } else if (node->Is<RegisterRead>()) {
+        RegisterWrite* reg_write =
+            reg_writes.at(node->As<RegisterRead>()->GetRegister());
+        toggles = !reg_write->load_enable().has_value() &&
+                  toggling.contains(reg_write->data());
+      } else {
+        toggles = std::any_of(
+            node->operands().begin(), node->operands().end(),
+            [&](Node* operand) { return toggling.contains(operand); });
+      }
+      if (toggles) {
+        toggling.insert(node);
+        changed = true;
+      }
+    }
+  }
+
+  int64_t count = 0;
+  for (Node* node : block->nodes()) {
+    if (node->Is<RegisterRead>() && toggling.contains(node)) {
+      count += node->GetType()->GetFlatBitCount();
+    }
+  }
+  return count;
+}
+
 // Returns true if there is a combinational feedthrough path from an input port
 // to an output port.
 bool HasFeedthroughPass(Block* block) {
@@ -170,6 +239,12 @@ absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
     Block* block, std::optional<const DelayEstimator*> delay_estimator) {
   BlockMetricsProto proto;
   proto.set_flop_count(GenerateFlopCount(block));
+  XLS_ASSIGN_OR_RETURN(int64_t gated_flop_count,
+                       GenerateGatedFlopCount(block));
+  proto.set_gated_flop_count(gated_flop_count);
+  XLS_ASSIGN_OR_RETURN(int64_t idle_toggle_flop_count,
+                       GenerateIdleToggleFlopCount(block));
+  proto.set_idle_toggle_flop_count(idle_toggle_flop_count);
   proto.set_feedthrough_path_exists(HasFeedthroughPass(block));
 
   if (delay_estimator.has_value()) {
@@ -16,8 +16,10 @@
 
 #include "absl/strings/str_format.h"
 #include "xls/codegen/block_metrics.h"
+#include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_util.h"
+#include "xls/ir/op.h"
 
 namespace xls::verilog {
 
@@ -30,8 +32,30 @@ absl::StatusOr<bool> BlockMetricsGenerationPass::RunInternal(
         "signature generation.");
   }
 
+  std::optional<const DelayEstimator*> delay_estimator;
+  if (options.delay_estimator != nullptr) {
+    delay_estimator = options.delay_estimator;
+  }
   XLS_ASSIGN_OR_RETURN(BlockMetricsProto block_metrics,
-                       GenerateBlockMetrics(unit->block));
+                       GenerateBlockMetrics(unit->block, delay_estimator));
+  if (unit->max_reg_to_reg_delay_before_retiming_ps.has_value()) {
+    block_metrics.set_max_reg_to_reg_delay_before_retiming_ps(
+        unit->max_reg_to_reg_delay_before_retiming_ps.value());
+  }
+  if (options.schedule.has_value()) {
+    block_metrics.set_initiation_interval(
+        options.schedule->initiation_interval());
+  }
+  for (const ResourceUsage& usage : unit->resource_usage) {
+    ResourceUsageProto* usage_proto = block_metrics.add_resource_usage();
+    usage_proto->set_op(OpToString(usage.resource_class.op));
+    for (int64_t bit_count : usage.resource_class.operand_bit_counts) {
+      usage_proto->add_operand_bit_counts(bit_count);
+    }
+    usage_proto->set_bit_count(usage.resource_class.bit_count);
+    usage_proto->set_operation_count(usage.operation_count);
+    usage_proto->set_unit_count(usage.unit_count);
+  }
   XLS_RETURN_IF_ERROR(unit->signature->ReplaceBlockMetrics(block_metrics));
 
   return true;
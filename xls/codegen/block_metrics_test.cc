@@ -112,6 +112,74 @@ TEST(BlockMetricsGeneratorTest, PipelineRegistersCount) {
   EXPECT_EQ(proto.flop_count(), schedule.CountFinalInteriorPipelineRegisters());
 }
 
+TEST(BlockMetricsGeneratorTest, GatedAndIdleToggleFlops) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb("test_block", &package);
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue in = bb.InputPort("in", u32);
+  BValue en = bb.InputPort("en", package.GetBitsType(1));
+  // Toggles with the input.
+  BValue reg0 = bb.InsertRegister("reg0", in);
+  // Holds its value while idle.
+  BValue reg1 = bb.InsertRegister("reg1", bb.Not(reg0), /*load_enable=*/en);
+  // Fed only by a register which holds its value.
+  BValue reg2 = bb.InsertRegister("reg2", reg1);
+  // Fed by a constant.
+  BValue reg3 = bb.InsertRegister("reg3", bb.Literal(UBits(42, 8)));
+  bb.OutputPort("out", bb.Concat({reg2, reg3}));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto,
+                           GenerateBlockMetrics(block));
+  EXPECT_EQ(proto.flop_count(), 104);
+  EXPECT_EQ(proto.gated_flop_count(), 32);
+  EXPECT_EQ(proto.idle_toggle_flop_count(), 32);
+}
+
+TEST(BlockMetricsGeneratorTest, ValidGatedPipelineRegisters) {
+  Package package("test");
+
+  FunctionBuilder fb("test_func", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Negate(fb.Not(fb.Add(x, y)))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(const DelayEstimator* delay_estimator,
+                           GetDelayEstimator("unit"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(f, *delay_estimator,
+                            SchedulingOptions().pipeline_stages(3)));
+
+  auto metrics =
+      [&](bool data_load_enable) -> absl::StatusOr<BlockMetricsProto> {
+    CodegenOptions options;
+    options.flop_inputs(false).flop_outputs(false).clock_name("clk");
+    options.valid_control("in_vld", "out_vld");
+    options.data_load_enable(data_load_enable);
+    options.module_name(data_load_enable ? "gated" : "ungated");
+    XLS_ASSIGN_OR_RETURN(Block * block,
+                         FunctionToPipelinedBlock(schedule, options, f));
+    return GenerateBlockMetrics(block);
+  };
+
+  int64_t data_flops = schedule.CountFinalInteriorPipelineRegisters();
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto gated, metrics(true));
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto ungated, metrics(false));
+
+  // One valid flop per stage boundary in addition to the data flops.
+  EXPECT_EQ(gated.flop_count(), data_flops + 2);
+  EXPECT_EQ(ungated.flop_count(), data_flops + 2);
+
+  EXPECT_EQ(gated.gated_flop_count(), data_flops);
+  EXPECT_EQ(gated.idle_toggle_flop_count(), 2);
+  EXPECT_EQ(ungated.gated_flop_count(), 0);
+  EXPECT_EQ(ungated.idle_toggle_flop_count(), data_flops + 2);
+}
+
 TEST(BlockMetricsGeneratorTest, DelayModel) {
   Package package("test");
   BlockBuilder bb("pass_thru", &package);
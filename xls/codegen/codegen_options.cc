@@ -120,6 +120,16 @@ CodegenOptions& CodegenOptions::add_idle_output(bool value) {
   return *this;
 }
 
+CodegenOptions& CodegenOptions::data_load_enable(bool value) {
+  data_load_enable_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::retime_pipeline(bool value) {
+  retime_pipeline_ = value;
+  return *this;
+}
+
 CodegenOptions& CodegenOptions::assert_format(absl::string_view value) {
   assert_format_ = std::string{value};
   return *this;
@@ -143,6 +143,20 @@ class CodegenOptions {
   CodegenOptions& add_idle_output(bool value);
   bool add_idle_output() const { return add_idle_output_; }
 
+  // Whether the load enable of each pipeline data register is driven by the
+  // valid signal of its stage, so that the register holds its value (and
+  // synthesis may gate its clock) while the stage holds no valid data. Only
+  // affects function pipelines with valid control; the data registers of proc
+  // pipelines always have load enables as these are required for flow
+  // control.
+  CodegenOptions& data_load_enable(bool value);
+  bool data_load_enable() const { return data_load_enable_; }
+
+  // Whether to retime the pipeline registers of the generated block to
+  // minimize the critical path. Requires a delay estimator.
+  CodegenOptions& retime_pipeline(bool value);
+  bool retime_pipeline() const { return retime_pipeline_; }
+
   // Format string to use when emitting assert operations in Verilog. Supports
   // the following placeholders:
   //
@@ -250,6 +264,8 @@ class CodegenOptions {
   IOKind flop_outputs_kind_ = IOKind::kFlop;
   bool split_outputs_ = false;
   bool add_idle_output_ = false;
+  bool data_load_enable_ = true;
+  bool retime_pipeline_ = false;
   bool flop_single_value_channels_ = false;
   absl::optional<std::string> assert_format_;
   absl::optional<std::string> gate_format_;
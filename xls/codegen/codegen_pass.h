@@ -18,10 +18,12 @@
 #include "absl/types/optional.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/resource_sharing.h"
 
 namespace xls::verilog {
 
@@ -36,6 +38,10 @@ struct CodegenPassOptions : public PassOptions {
   // Optional schedule. If given, a feedforward pipeline is generated based on
   // the schedule.
   absl::optional<PipelineSchedule> schedule;
+
+  // Optional delay estimator. If given, delay metrics are generated for the
+  // block. Required for retiming.
+  const DelayEstimator* delay_estimator = nullptr;
 };
 
 // Data structure operated on by codegen passes. Contains the IR and associated
@@ -57,6 +63,15 @@ struct CodegenPassUnit {
   // out-of-sync with the IR.
   absl::optional<ModuleSignature> signature;
 
+  // The maximum register-to-register delay of the block before its pipeline
+  // registers were retimed. Set by the retiming pass if it changed the block.
+  absl::optional<int64_t> max_reg_to_reg_delay_before_retiming_ps;
+
+  // The number of operations and functional units of each shareable resource
+  // class. Set by the resource sharing pass for pipelines with an initiation
+  // interval greater than one.
+  std::vector<ResourceUsage> resource_usage;
+
   // These methods are required by CompoundPassBase.
   std::string DumpIr() const;
   const std::string& name() const { return block->name(); }
@@ -20,8 +20,10 @@
 #include "xls/codegen/block_metrics_generation_pass.h"
 #include "xls/codegen/codegen_checker.h"
 #include "xls/codegen/codegen_wrapper_pass.h"
+#include "xls/codegen/modulo_resource_sharing_pass.h"
 #include "xls/codegen/port_legalization_pass.h"
 #include "xls/codegen/register_legalization_pass.h"
+#include "xls/codegen/retiming_pass.h"
 #include "xls/codegen/signature_generation_pass.h"
 #include "xls/passes/dce_pass.h"
 
@@ -46,6 +48,14 @@ std::unique_ptr<CodegenCompoundPass> CreateCodegenPassPipeline() {
   // TODO(meheff): 2021/04/29 Also flatten ports with types here.
   top->Add<PortLegalizationPass>();
 
+  // Optionally move pipeline registers across combinational logic to reduce
+  // the critical path.
+  top->Add<RetimingPass>();
+
+  // Share functional units between pipeline stages which are active in
+  // different cycles if the initiation interval is greater than one.
+  top->Add<ModuloResourceSharingPass>();
+
   // Remove zero-width registers.
   top->Add<RegisterLegalizationPass>();
 
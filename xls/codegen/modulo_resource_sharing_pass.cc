@@ -0,0 +1,298 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/modulo_resource_sharing_pass.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/optional.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+#include "xls/scheduling/resource_sharing.h"
+
+namespace xls::verilog {
+namespace {
+
+// The number of registers between the input ports of a block and each node.
+struct RegisterDepths {
+  // Nodes which do not depend on an input port (e.g., literals) have no entry.
+  absl::flat_hash_map<Node*, int64_t> depth;
+
+  // Nodes which depend on values at different depths. These hold a
+  // combination of data from different pipeline stages (for example, the
+  // load enable of a pipeline register which includes the reset signal).
+  absl::flat_hash_set<Node*> ambiguous;
+};
+
+// Computes the register depth of each node in the block. Returns absl::nullopt
+// if the depths do not converge, which happens if there is a feedback path
+// through a register.
+absl::StatusOr<absl::optional<RegisterDepths>> ComputeRegisterDepths(
+    Block* block) {
+  absl::flat_hash_map<Register*, RegisterWrite*> reg_writes;
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(reg_writes[reg], block->GetRegisterWrite(reg));
+  }
+
+  // A register read precedes the write of its register in a topological sort
+  // so sweep until nothing changes. Each sweep propagates depths through at
+  // least one more level of registers.
+  std::vector<Node*> topo_sort = TopoSort(block).AsVector();
+  RegisterDepths result;
+  int64_t max_sweeps = block->GetRegisters().size() + 2;
+  bool changed = true;
+  for (int64_t sweep = 0; changed; ++sweep) {
+    if (sweep == max_sweeps) {
+      return absl::nullopt;
+    }
+    changed = false;
+    for (Node* node : topo_sort) {
+      absl::optional<int64_t> depth;
+      bool ambiguous = false;
+      if (node->Is<InputPort>()) {
+        depth = 0;
+      } else if (node->Is<RegisterRead>()) {
+        Node* data =
+            reg_writes.at(node->As<RegisterRead>()->GetRegister())->data();
+        if (result.depth.contains(data)) {
+          depth = result.depth.at(data) + 1;
+        }
+        ambiguous = result.ambiguous.contains(data);
+      } else {
+        for (Node* operand : node->operands()) {
+          if (!result.depth.contains(operand)) {
+            continue;
+          }
+          int64_t operand_depth = result.depth.at(operand);
+          if (depth.has_value() && depth.value() != operand_depth) {
+            ambiguous = true;
+          }
+          depth = std::max(depth.value_or(operand_depth), operand_depth);
+          ambiguous = ambiguous || result.ambiguous.contains(operand);
+        }
+      }
+      if (depth.has_value() && (!result.depth.contains(node) ||
+                                result.depth.at(node) != depth.value())) {
+        result.depth[node] = depth.value();
+        changed = true;
+      }
+      if (ambiguous && result.ambiguous.insert(node).second) {
+        changed = true;
+      }
+    }
+  }
+  return result;
+}
+
+// Adds a register which counts cycles modulo the initiation interval,
+// starting from zero after reset, and returns its value.
+absl::StatusOr<Node*> MakePhaseCounter(Block* block,
+                                       int64_t initiation_interval,
+                                       const CodegenOptions& options) {
+  if (!options.reset().has_value()) {
+    return absl::InvalidArgumentError(
+        "Sharing functional units in a pipeline with an initiation interval "
+        "greater than one requires a reset signal.");
+  }
+  XLS_ASSIGN_OR_RETURN(InputPort * reset_port,
+                       block->GetInputPort(options.reset()->name()));
+
+  int64_t width = Bits::MinBitCountUnsigned(initiation_interval - 1);
+  std::string name = "ii_phase";
+  for (int64_t i = 1; block->GetRegister(name).ok(); ++i) {
+    name = absl::StrCat("ii_phase__", i);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Register * reg,
+      block->AddRegister(name, block->package()->GetBitsType(width),
+                         xls::Reset{
+                             .reset_value = Value(UBits(0, width)),
+                             .asynchronous = options.reset()->asynchronous(),
+                             .active_low = options.reset()->active_low()}));
+  XLS_ASSIGN_OR_RETURN(RegisterRead * phase,
+                       block->MakeNodeWithName<RegisterRead>(
+                           /*loc=*/absl::nullopt, reg, /*name=*/reg->name()));
+
+  XLS_ASSIGN_OR_RETURN(
+      Node * last_phase,
+      block->MakeNode<xls::Literal>(
+          /*loc=*/absl::nullopt, Value(UBits(initiation_interval - 1, width))));
+  XLS_ASSIGN_OR_RETURN(Node * is_last_phase,
+                       block->MakeNode<CompareOp>(/*loc=*/absl::nullopt, phase,
+                                                  last_phase, Op::kEq));
+  XLS_ASSIGN_OR_RETURN(Node * one,
+                       block->MakeNode<xls::Literal>(/*loc=*/absl::nullopt,
+                                                     Value(UBits(1, width))));
+  XLS_ASSIGN_OR_RETURN(Node * incremented,
+                       block->MakeNode<BinOp>(/*loc=*/absl::nullopt, phase,
+                                              one, Op::kAdd));
+  XLS_ASSIGN_OR_RETURN(Node * zero,
+                       block->MakeNode<xls::Literal>(/*loc=*/absl::nullopt,
+                                                     Value(UBits(0, width))));
+  XLS_ASSIGN_OR_RETURN(
+      Node * next_phase,
+      block->MakeNode<Select>(/*loc=*/absl::nullopt, is_last_phase,
+                              std::vector<Node*>{incremented, zero},
+                              /*default_value=*/absl::nullopt));
+  XLS_RETURN_IF_ERROR(block
+                          ->MakeNode<RegisterWrite>(
+                              /*loc=*/absl::nullopt, next_phase,
+                              /*load_enable=*/absl::nullopt,
+                              /*reset=*/reset_port, reg)
+                          .status());
+  return phase;
+}
+
+// Replaces the given nodes, which perform the same operation, with a single
+// node whose operands are selected by `phase`. `nodes_by_slot` holds the node
+// which is active in each phase, or nullptr if there is none.
+absl::Status ShareUnit(Block* block, Node* phase,
+                       absl::Span<Node* const> nodes_by_slot) {
+  Node* first = *std::find_if(nodes_by_slot.begin(), nodes_by_slot.end(),
+                              [](Node* node) { return node != nullptr; });
+  bool needs_default =
+      (int64_t{1} << phase->BitCountOrDie()) > nodes_by_slot.size();
+
+  std::vector<Node*> operands;
+  for (int64_t i = 0; i < first->operand_count(); ++i) {
+    // Phases in which no node is active reuse the operands of the first node
+    // to simplify the mux.
+    std::vector<Node*> cases;
+    for (Node* node : nodes_by_slot) {
+      cases.push_back(node == nullptr ? first->operand(i) : node->operand(i));
+    }
+    if (std::all_of(cases.begin(), cases.end(),
+                    [&](Node* n) { return n == cases.front(); })) {
+      operands.push_back(cases.front());
+      continue;
+    }
+    absl::optional<Node*> default_value;
+    if (needs_default) {
+      default_value = first->operand(i);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * mux,
+                         block->MakeNode<Select>(first->loc(), phase, cases,
+                                                 default_value));
+    operands.push_back(mux);
+  }
+
+  XLS_ASSIGN_OR_RETURN(Node * shared, first->Clone(operands));
+  shared->SetName(absl::StrCat(OpToString(first->op()), "_shared"));
+  for (Node* node : nodes_by_slot) {
+    if (node != nullptr) {
+      XLS_VLOG(3) << absl::StreamFormat("Replacing %s with %s",
+                                        node->GetName(), shared->GetName());
+      XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(shared));
+      XLS_RETURN_IF_ERROR(block->RemoveNode(node));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ModuloResourceSharingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  if (!options.schedule.has_value() ||
+      options.schedule->initiation_interval() == 1) {
+    return false;
+  }
+  int64_t initiation_interval = options.schedule->initiation_interval();
+  Block* block = unit->block;
+
+  XLS_ASSIGN_OR_RETURN(absl::optional<RegisterDepths> depths,
+                       ComputeRegisterDepths(block));
+  if (!depths.has_value()) {
+    XLS_VLOG(2) << "Block is not a feed-forward pipeline; not sharing units.";
+    return false;
+  }
+
+  // The shareable nodes of each resource class in each modulo slot, along with
+  // the number of nodes which cannot be shared. Classes are kept in order of
+  // first appearance so the result is deterministic.
+  struct ClassNodes {
+    std::vector<std::vector<Node*>> slots;
+    int64_t unshared_count = 0;
+  };
+  std::vector<ResourceClass> resource_classes;
+  absl::flat_hash_map<ResourceClass, ClassNodes> class_nodes;
+  for (Node* node : TopoSort(block)) {
+    absl::optional<ResourceClass> resource_class = GetResourceClass(node);
+    if (!resource_class.has_value()) {
+      continue;
+    }
+    if (!class_nodes.contains(*resource_class)) {
+      resource_classes.push_back(*resource_class);
+      class_nodes[*resource_class].slots.resize(initiation_interval);
+    }
+    ClassNodes& nodes = class_nodes.at(*resource_class);
+    if (!depths->depth.contains(node) || depths->ambiguous.contains(node)) {
+      ++nodes.unshared_count;
+      continue;
+    }
+    nodes.slots[depths->depth.at(node) % initiation_interval].push_back(node);
+  }
+
+  absl::optional<Node*> phase;
+  bool changed = false;
+  for (const ResourceClass& resource_class : resource_classes) {
+    const ClassNodes& nodes = class_nodes.at(resource_class);
+    int64_t shared_unit_count = 0;
+    int64_t operation_count = nodes.unshared_count;
+    for (const std::vector<Node*>& slot : nodes.slots) {
+      shared_unit_count =
+          std::max(shared_unit_count, static_cast<int64_t>(slot.size()));
+      operation_count += slot.size();
+    }
+    unit->resource_usage.push_back(
+        ResourceUsage{.resource_class = resource_class,
+                      .operation_count = operation_count,
+                      .unit_count = shared_unit_count + nodes.unshared_count});
+
+    // The i-th node of each slot are assigned to the i-th unit.
+    for (int64_t i = 0; i < shared_unit_count; ++i) {
+      std::vector<Node*> nodes_by_slot;
+      int64_t node_count = 0;
+      for (const std::vector<Node*>& slot : nodes.slots) {
+        nodes_by_slot.push_back(i < slot.size() ? slot[i] : nullptr);
+        node_count += i < slot.size() ? 1 : 0;
+      }
+      if (node_count < 2) {
+        continue;
+      }
+      if (!phase.has_value()) {
+        XLS_ASSIGN_OR_RETURN(phase,
+                             MakePhaseCounter(block, initiation_interval,
+                                              options.codegen_options));
+      }
+      XLS_RETURN_IF_ERROR(ShareUnit(block, phase.value(), nodes_by_slot));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
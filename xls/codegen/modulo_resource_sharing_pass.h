@@ -0,0 +1,50 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_MODULO_RESOURCE_SHARING_PASS_H_
+#define XLS_CODEGEN_MODULO_RESOURCE_SHARING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Shares functional units (multipliers, dividers, etc; see
+// xls/scheduling/resource_sharing.h) between the stages of a feed-forward
+// pipeline whose schedule has an initiation interval (II) greater than one.
+//
+// Inputs of such a pipeline are presented once every II cycles, so a node
+// which is N registers from the inputs holds valid data only in cycles in
+// which N modulo II equals the cycle count (since reset) modulo II. A register
+// counting cycles modulo II is added and drives muxes which select the
+// operands of each shared unit. The block must have a reset, which defines the
+// cycle in which the first input is presented.
+//
+// Records the operation and unit counts for each resource class in the pass
+// unit. Does nothing if there is no schedule or its initiation interval is one.
+class ModuloResourceSharingPass : public CodegenPass {
+ public:
+  ModuloResourceSharingPass()
+      : CodegenPass("modulo_resource_sharing",
+                    "Share functional units between pipeline stages") {}
+  ~ModuloResourceSharingPass() override {}
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_MODULO_RESOURCE_SHARING_PASS_H_
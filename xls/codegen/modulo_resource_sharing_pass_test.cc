@@ -0,0 +1,210 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/modulo_resource_sharing_pass.h"
+
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Unit delay delay estimator.
+class TestDelayEstimator : public DelayEstimator {
+ public:
+  TestDelayEstimator() : DelayEstimator("test") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    switch (node->op()) {
+      case Op::kParam:
+      case Op::kLiteral:
+        return 0;
+      default:
+        return 1;
+    }
+  }
+};
+
+class ModuloResourceSharingPassTest : public IrTestBase {
+ protected:
+  // Builds a function computing x * y * z with the multiplies in different
+  // pipeline stages.
+  absl::StatusOr<Function*> BuildFunction(Package* p) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(16));
+    BValue y = fb.Param("y", p->GetBitsType(16));
+    BValue z = fb.Param("z", p->GetBitsType(16));
+    return fb.BuildWithReturnValue(fb.UMul(fb.UMul(x, y), z));
+  }
+
+  absl::StatusOr<PipelineSchedule> Schedule(Function* f,
+                                            int64_t initiation_interval) {
+    return PipelineSchedule::Run(f, TestDelayEstimator(),
+                                 SchedulingOptions()
+                                     .pipeline_stages(2)
+                                     .initiation_interval(initiation_interval));
+  }
+
+  CodegenOptions Options(bool with_reset = true) {
+    CodegenOptions options;
+    options.flop_inputs(false).flop_outputs(false).clock_name("clk");
+    if (with_reset) {
+      options.reset("rst", /*asynchronous=*/false, /*active_low=*/false,
+                    /*reset_data_path=*/false);
+    }
+    return options;
+  }
+
+  absl::StatusOr<bool> Run(CodegenPassUnit* unit,
+                           const CodegenPassOptions& options) {
+    PassResults results;
+    return ModuloResourceSharingPass().Run(unit, options, &results);
+  }
+
+  int64_t CountMultiplies(Block* block) {
+    int64_t count = 0;
+    for (Node* node : block->nodes()) {
+      count += node->op() == Op::kUMul ? 1 : 0;
+    }
+    return count;
+  }
+};
+
+TEST_F(ModuloResourceSharingPassTest, SharesMultiplier) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule schedule,
+                           Schedule(f, /*initiation_interval=*/2));
+
+  CodegenPassOptions options;
+  options.codegen_options = Options();
+  options.schedule = schedule;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      FunctionToPipelinedBlock(schedule, options.codegen_options, f));
+  EXPECT_EQ(CountMultiplies(block), 2);
+
+  CodegenPassUnit unit(block->package(), block);
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(true));
+  EXPECT_EQ(CountMultiplies(block), 1);
+  XLS_EXPECT_OK(block->GetRegister("ii_phase").status());
+
+  ASSERT_EQ(unit.resource_usage.size(), 1);
+  EXPECT_EQ(unit.resource_usage[0].resource_class.op, Op::kUMul);
+  EXPECT_EQ(unit.resource_usage[0].operation_count, 2);
+  EXPECT_EQ(unit.resource_usage[0].unit_count, 1);
+
+  // Reset for one cycle then present an input every other cycle. Inputs in
+  // the intervening cycles are ignored.
+  std::minstd_rand engine;
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs;
+  inputs.push_back({{"rst", 1}, {"x", 0}, {"y", 0}, {"z", 0}});
+  for (int64_t i = 0; i < 32; ++i) {
+    inputs.push_back({{"rst", 0},
+                      {"x", engine() & 0xffff},
+                      {"y", engine() & 0xffff},
+                      {"z", engine() & 0xffff}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(auto outputs,
+                           InterpretSequentialBlock(block, inputs));
+  for (int64_t cycle = 1; cycle + 1 < inputs.size(); cycle += 2) {
+    const auto& input = inputs[cycle];
+    uint64_t expected =
+        (input.at("x") * input.at("y") * input.at("z")) & 0xffff;
+    EXPECT_EQ(outputs[cycle + 1].at("out"), expected) << "cycle " << cycle;
+  }
+}
+
+TEST_F(ModuloResourceSharingPassTest, InitiationIntervalOfOne) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule schedule,
+                           Schedule(f, /*initiation_interval=*/1));
+
+  CodegenPassOptions options;
+  options.codegen_options = Options();
+  options.schedule = schedule;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      FunctionToPipelinedBlock(schedule, options.codegen_options, f));
+  CodegenPassUnit unit(block->package(), block);
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(false));
+  EXPECT_EQ(CountMultiplies(block), 2);
+  EXPECT_TRUE(unit.resource_usage.empty());
+}
+
+TEST_F(ModuloResourceSharingPassTest, SameSlotIsNotShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(
+                        fb.Not(fb.Add(fb.UMul(x, y), fb.UMul(y, x)))));
+  // Both multiplies must be in the first stage to meet timing.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(
+          f, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(2).initiation_interval(4)));
+
+  CodegenPassOptions options;
+  options.codegen_options = Options();
+  options.schedule = schedule;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      FunctionToPipelinedBlock(schedule, options.codegen_options, f));
+  CodegenPassUnit unit(block->package(), block);
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(false));
+  EXPECT_EQ(CountMultiplies(block), 2);
+  ASSERT_EQ(unit.resource_usage.size(), 1);
+  EXPECT_EQ(unit.resource_usage[0].operation_count, 2);
+  EXPECT_EQ(unit.resource_usage[0].unit_count, 2);
+}
+
+TEST_F(ModuloResourceSharingPassTest, RequiresReset) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, BuildFunction(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule schedule,
+                           Schedule(f, /*initiation_interval=*/2));
+
+  CodegenPassOptions options;
+  options.codegen_options = Options(/*with_reset=*/false);
+  options.schedule = schedule;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      FunctionToPipelinedBlock(schedule, options.codegen_options, f));
+  CodegenPassUnit unit(block->package(), block);
+  EXPECT_THAT(Run(&unit, options),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("requires a reset signal")));
+}
+
+}  // namespace
+}  // namespace xls::verilog
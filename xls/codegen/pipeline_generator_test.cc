@@ -18,6 +18,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/flattening.h"
+#include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function_builder.h"
@@ -932,6 +933,83 @@ TEST_P(PipelineGeneratorTest, AddNegateFlopNeitherInputsNorOutputs) {
               IsOkAndHolds(UBits(91, 8)));
 }
 
+TEST_P(PipelineGeneratorTest, RetimedPipeline) {
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(8));
+  BValue chain = x;
+  for (int64_t i = 0; i < 5; ++i) {
+    chain = i % 2 == 0 ? fb.Not(chain) : fb.Negate(chain);
+  }
+  BValue result_value = fb.Negate(chain);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // Schedule all but the last operation in the first stage.
+  ScheduleCycleMap cycle_map;
+  for (Node* node : func->nodes()) {
+    cycle_map[node] = node == result_value.node() ? 1 : 0;
+  }
+  PipelineSchedule schedule(func, cycle_map);
+
+  TestDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPipelineModuleText(schedule, func,
+                           BuildPipelineOptions()
+                               .retime_pipeline(true)
+                               .use_system_verilog(UseSystemVerilog()),
+                           &delay_estimator));
+
+  // The six operations are split evenly between the two stages. Delays
+  // include the clock-to-q delay of the register.
+  const BlockMetricsProto& metrics =
+      result.signature.proto().metrics().block_metrics();
+  EXPECT_EQ(metrics.delay_model(), "test");
+  EXPECT_EQ(metrics.max_reg_to_reg_delay_before_retiming_ps(), 6);
+  EXPECT_EQ(metrics.max_reg_to_reg_delay_ps(), 4);
+  EXPECT_EQ(result.signature.proto().pipeline().latency(), 3);
+
+  ModuleSimulator simulator(result.signature, result.verilog_text,
+                            GetSimulator());
+  EXPECT_THAT(simulator.RunAndReturnSingleOutput({{"x", UBits(42, 8)}}),
+              IsOkAndHolds(UBits(45, 8)));
+}
+
+TEST_P(PipelineGeneratorTest, SharedMultiplierPipeline) {
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(8));
+  BValue y = fb.Param("y", package.GetBitsType(8));
+  BValue z = fb.Param("z", package.GetBitsType(8));
+  fb.UMul(fb.UMul(x, y), z);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(
+          func, TestDelayEstimator(),
+          SchedulingOptions().pipeline_stages(2).initiation_interval(2)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPipelineModuleText(schedule, func,
+                           BuildPipelineOptions()
+                               .reset("rst", /*asynchronous=*/false,
+                                      /*active_low=*/false,
+                                      /*reset_data_path=*/false)
+                               .use_system_verilog(UseSystemVerilog())));
+
+  EXPECT_EQ(result.signature.proto().pipeline().initiation_interval(), 2);
+  const BlockMetricsProto& metrics =
+      result.signature.proto().metrics().block_metrics();
+  EXPECT_EQ(metrics.initiation_interval(), 2);
+  ASSERT_EQ(metrics.resource_usage_size(), 1);
+  EXPECT_EQ(metrics.resource_usage(0).op(), "umul");
+  EXPECT_EQ(metrics.resource_usage(0).operation_count(), 2);
+  EXPECT_EQ(metrics.resource_usage(0).unit_count(), 1);
+  EXPECT_THAT(result.verilog_text, HasSubstr("ii_phase"));
+}
+
 TEST_P(PipelineGeneratorTest, EmitsCoverpoints) {
   Package package(TestBaseName());
   FunctionBuilder fb(TestBaseName(), &package);
@@ -0,0 +1,634 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/retiming_pass.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_metrics.h"
+#include "xls/codegen/xls_metrics.pb.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/binary_search.h"
+#include "xls/data_structures/min_cut.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+
+namespace xls::verilog {
+namespace {
+
+// The combinational logic of a feed-forward pipelined block with the pipeline
+// registers abstracted away. Edges connect each node to the nodes which use its
+// value, either directly or through a chain of pipeline registers. Nodes which
+// only depend on literals ("constant" nodes) are not included: they may be used
+// in any stage without registers.
+struct RetimingGraph {
+  Block* block;
+
+  // The index of the last pipeline stage. Stage zero contains the input ports.
+  int64_t last_stage = 0;
+
+  // The nodes of the graph in topological order.
+  std::vector<Node*> nodes;
+
+  absl::flat_hash_map<Node*, std::vector<Node*>> predecessors;
+  absl::flat_hash_map<Node*, std::vector<Node*>> successors;
+
+  // The pipeline stage of every node in the block; nullopt for constant nodes.
+  absl::flat_hash_map<Node*, absl::optional<int64_t>> stage;
+
+  // The node whose value is carried by each register read.
+  absl::flat_hash_map<RegisterRead*, Node*> register_source;
+
+  absl::flat_hash_map<Node*, int64_t> delay;
+};
+
+// Lower and upper bounds on the stage of each node in a RetimingGraph.
+using StageBounds = absl::flat_hash_map<Node*, std::pair<int64_t, int64_t>>;
+
+// Returns the node whose value is carried by `node`, looking through any
+// register reads.
+Node* ResolveValue(const RetimingGraph& graph, Node* node) {
+  if (node->Is<RegisterRead>()) {
+    return graph.register_source.at(node->As<RegisterRead>());
+  }
+  return node;
+}
+
+// Builds the retiming graph of the given block. Returns nullopt if the block is
+// not a feed-forward pipeline whose registers may be freely moved.
+absl::StatusOr<absl::optional<RetimingGraph>> BuildRetimingGraph(
+    Block* block, const DelayEstimator& delay_estimator) {
+  if (!block->GetInstantiations().empty()) {
+    XLS_VLOG(3) << "Not retiming block with instantiations";
+    return absl::nullopt;
+  }
+  RetimingGraph graph;
+  graph.block = block;
+
+  absl::flat_hash_map<Register*, RegisterWrite*> register_writes;
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    if (reg->reset().has_value() || reg_write->load_enable().has_value() ||
+        reg_write->reset().has_value()) {
+      XLS_VLOG(3) << "Not retiming block with reset or load enable on register "
+                  << reg->name();
+      return absl::nullopt;
+    }
+    register_writes[reg] = reg_write;
+  }
+
+  // The stage of a register read is one more than the stage of the data written
+  // to the register, so the stages of all nodes are determined by repeatedly
+  // sweeping through the nodes in topological order. The number of sweeps is
+  // bounded by the number of pipeline stages.
+  std::vector<Node*> topo_sort;
+  for (Node* node : TopoSort(block)) {
+    topo_sort.push_back(node);
+  }
+  bool progress = true;
+  while (graph.stage.size() < topo_sort.size() && progress) {
+    progress = false;
+    for (Node* node : topo_sort) {
+      if (graph.stage.contains(node)) {
+        continue;
+      }
+      absl::optional<int64_t> stage;
+      if (node->Is<InputPort>()) {
+        stage = 0;
+      } else if (node->Is<RegisterRead>()) {
+        Node* data =
+            register_writes.at(node->As<RegisterRead>()->GetRegister())->data();
+        if (!graph.stage.contains(data)) {
+          continue;
+        }
+        if (graph.stage.at(data).has_value()) {
+          stage = graph.stage.at(data).value() + 1;
+        }
+      } else {
+        bool ready = true;
+        for (Node* operand : node->operands()) {
+          if (!graph.stage.contains(operand)) {
+            ready = false;
+            break;
+          }
+          const absl::optional<int64_t>& operand_stage =
+              graph.stage.at(operand);
+          if (!operand_stage.has_value()) {
+            continue;
+          }
+          if (stage.has_value() && stage.value() != operand_stage.value()) {
+            XLS_VLOG(3) << "Not retiming block: operands of " << node->GetName()
+                        << " are in different stages";
+            return absl::nullopt;
+          }
+          stage = operand_stage;
+        }
+        if (!ready) {
+          continue;
+        }
+      }
+      graph.stage[node] = stage;
+      progress = true;
+    }
+  }
+  if (graph.stage.size() < topo_sort.size()) {
+    XLS_VLOG(3) << "Not retiming block: registers form a cycle";
+    return absl::nullopt;
+  }
+
+  for (Node* node : topo_sort) {
+    if (node->Is<RegisterRead>()) {
+      Node* source = node;
+      while (source->Is<RegisterRead>()) {
+        source =
+            register_writes.at(source->As<RegisterRead>()->GetRegister())
+                ->data();
+      }
+      graph.register_source[node->As<RegisterRead>()] = source;
+      continue;
+    }
+    if (node->Is<RegisterWrite>() || !graph.stage.at(node).has_value()) {
+      continue;
+    }
+    graph.nodes.push_back(node);
+    graph.last_stage =
+        std::max(graph.last_stage, graph.stage.at(node).value());
+    XLS_ASSIGN_OR_RETURN(graph.delay[node],
+                         delay_estimator.GetOperationDelayInPs(node));
+  }
+  // Within a stage, edges are between direct operands so ordering by stage
+  // preserves a topological order.
+  std::stable_sort(graph.nodes.begin(), graph.nodes.end(),
+                   [&](Node* a, Node* b) {
+                     return graph.stage.at(a).value() <
+                            graph.stage.at(b).value();
+                   });
+  for (Node* node : graph.nodes) {
+    std::vector<Node*>& predecessors = graph.predecessors[node];
+    graph.successors[node];
+    for (Node* operand : node->operands()) {
+      Node* source = ResolveValue(graph, operand);
+      if (graph.stage.at(source).has_value() &&
+          std::find(predecessors.begin(), predecessors.end(), source) ==
+              predecessors.end()) {
+        predecessors.push_back(source);
+        graph.successors[source].push_back(node);
+      }
+    }
+  }
+  return graph;
+}
+
+// Returns the maximum combinational delay of any stage of the pipeline if each
+// node is placed in the stage given by `stage_of`.
+template <typename StageFn>
+int64_t MaxStageDelay(const RetimingGraph& graph, StageFn stage_of) {
+  // The delay from the beginning of the stage to the end of each node.
+  absl::flat_hash_map<Node*, int64_t> finish;
+  int64_t max_delay = 0;
+  for (Node* node : graph.nodes) {
+    int64_t start = 0;
+    for (Node* predecessor : graph.predecessors.at(node)) {
+      if (stage_of(predecessor) == stage_of(node)) {
+        start = std::max(start, finish.at(predecessor));
+      }
+    }
+    finish[node] = start + graph.delay.at(node);
+    max_delay = std::max(max_delay, finish.at(node));
+  }
+  return max_delay;
+}
+
+// Returns the initial stage bounds of each node. Ports and side-effecting
+// operations stay in their stage. If inputs (outputs) are flopped no logic may
+// be placed in the first (last) stage.
+StageBounds InitialBounds(const RetimingGraph& graph,
+                          const CodegenOptions& options) {
+  int64_t first = options.flop_inputs() ? 1 : 0;
+  int64_t last =
+      options.flop_outputs() ? graph.last_stage - 1 : graph.last_stage;
+  StageBounds bounds;
+  for (Node* node : graph.nodes) {
+    int64_t stage = graph.stage.at(node).value();
+    if (OpIsSideEffecting(node->op())) {
+      bounds[node] = {stage, stage};
+    } else {
+      bounds[node] = {std::min(first, stage), std::max(last, stage)};
+    }
+  }
+  return bounds;
+}
+
+// Tightens the lower bound of each node such that dependency and clock period
+// constraints are met. Mirrors sched::ScheduleBounds::PropagateLowerBounds.
+// Returns false if the bounds become infeasible.
+bool PropagateLowerBounds(const RetimingGraph& graph, int64_t clock_period_ps,
+                          StageBounds* bounds) {
+  // The delay from the beginning of the stage to the start of each node.
+  absl::flat_hash_map<Node*, int64_t> in_stage_delay;
+  for (Node* node : graph.nodes) {
+    auto& [lb, ub] = bounds->at(node);
+    int64_t& node_in_stage_delay = in_stage_delay[node];
+    for (Node* predecessor : graph.predecessors.at(node)) {
+      int64_t predecessor_lb = bounds->at(predecessor).first;
+      if (predecessor_lb < lb) {
+        continue;
+      }
+      int64_t predecessor_finish =
+          in_stage_delay.at(predecessor) + graph.delay.at(predecessor);
+      if (predecessor_lb > lb) {
+        lb = predecessor_lb;
+        node_in_stage_delay = predecessor_finish;
+        continue;
+      }
+      node_in_stage_delay = std::max(node_in_stage_delay, predecessor_finish);
+    }
+    int64_t node_delay = graph.delay.at(node);
+    if (node_delay > clock_period_ps) {
+      return false;
+    }
+    if (node_in_stage_delay + node_delay > clock_period_ps) {
+      ++lb;
+      node_in_stage_delay = 0;
+    }
+    if (lb > ub) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tightens the upper bound of each node such that dependency and clock period
+// constraints are met. Mirrors sched::ScheduleBounds::PropagateUpperBounds.
+// Returns false if the bounds become infeasible.
+bool PropagateUpperBounds(const RetimingGraph& graph, int64_t clock_period_ps,
+                          StageBounds* bounds) {
+  // The delay from the end of each node to the end of the stage.
+  absl::flat_hash_map<Node*, int64_t> in_stage_delay;
+  for (auto it = graph.nodes.rbegin(); it != graph.nodes.rend(); ++it) {
+    Node* node = *it;
+    auto& [lb, ub] = bounds->at(node);
+    int64_t& node_in_stage_delay = in_stage_delay[node];
+    for (Node* successor : graph.successors.at(node)) {
+      int64_t successor_ub = bounds->at(successor).second;
+      if (successor_ub > ub) {
+        continue;
+      }
+      int64_t successor_delay =
+          in_stage_delay.at(successor) + graph.delay.at(successor);
+      if (successor_ub < ub) {
+        ub = successor_ub;
+        node_in_stage_delay = successor_delay;
+        continue;
+      }
+      node_in_stage_delay = std::max(node_in_stage_delay, successor_delay);
+    }
+    int64_t node_delay = graph.delay.at(node);
+    if (node_delay > clock_period_ps) {
+      return false;
+    }
+    if (node_in_stage_delay + node_delay > clock_period_ps) {
+      --ub;
+      node_in_stage_delay = 0;
+    }
+    if (lb > ub) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PropagateBounds(const RetimingGraph& graph, int64_t clock_period_ps,
+                     StageBounds* bounds) {
+  return PropagateLowerBounds(graph, clock_period_ps, bounds) &&
+         PropagateUpperBounds(graph, clock_period_ps, bounds);
+}
+
+// Splits the nodes which may be placed in either stage `stage` or `stage + 1`
+// by a minimum cost cut, where the cost is the number of register bits at the
+// boundary, and tightens the bounds accordingly. Mirrors
+// sched::MinCostFunctionPartition over the edges of the retiming graph.
+void SplitAfterStage(const RetimingGraph& graph, int64_t stage,
+                     StageBounds* bounds) {
+  std::vector<Node*> partitionable_nodes;
+  absl::flat_hash_set<Node*> partitionable_nodes_set;
+  for (Node* node : graph.nodes) {
+    if (bounds->at(node).first <= stage && bounds->at(node).second > stage) {
+      partitionable_nodes.push_back(node);
+      partitionable_nodes_set.insert(node);
+    }
+  }
+  if (partitionable_nodes.empty()) {
+    return;
+  }
+
+  min_cut::Graph cut_graph;
+  min_cut::NodeId source = cut_graph.AddNode("source");
+  min_cut::NodeId sink = cut_graph.AddNode("sink");
+  std::vector<Node*> nodes_in_cut_graph;
+  absl::flat_hash_map<Node*, min_cut::NodeId> node_to_cut_node;
+  absl::flat_hash_map<min_cut::NodeId, Node*> cut_node_to_node;
+
+  const int64_t kMaxWeight = std::numeric_limits<int64_t>::max();
+  auto add_edge = [&](min_cut::NodeId src, min_cut::NodeId tgt,
+                      int64_t weight) {
+    cut_graph.AddEdge(src, tgt, weight);
+    cut_graph.AddEdge(tgt, src, kMaxWeight);
+  };
+  auto add_node = [&](Node* node) {
+    min_cut::NodeId id = cut_graph.AddNode(node->GetName());
+    node_to_cut_node[node] = id;
+    cut_node_to_node[id] = node;
+    nodes_in_cut_graph.push_back(node);
+    return id;
+  };
+
+  // Values flowing into the partitionable set are computed at or before
+  // `stage`, and values flowing out are used after it.
+  for (Node* node : partitionable_nodes) {
+    add_node(node);
+  }
+  for (Node* node : partitionable_nodes) {
+    for (Node* predecessor : graph.predecessors.at(node)) {
+      if (!node_to_cut_node.contains(predecessor)) {
+        add_edge(source, add_node(predecessor), kMaxWeight);
+      }
+    }
+    for (Node* successor : graph.successors.at(node)) {
+      if (!node_to_cut_node.contains(successor)) {
+        add_edge(add_node(successor), sink, kMaxWeight);
+      }
+    }
+  }
+
+  // Edge weights are divided by the fan-out (with a fan-in node joining the
+  // successors) so that a value crossing the boundary is counted once.
+  auto edge_weight = [&](Node* node, int64_t fan_out) {
+    const int64_t kWeightFactor = 1024 * 1024;
+    return (node->GetType()->GetFlatBitCount() * kWeightFactor + fan_out / 2) /
+           fan_out;
+  };
+  for (Node* node : nodes_in_cut_graph) {
+    std::vector<min_cut::NodeId> successors;
+    for (Node* successor : graph.successors.at(node)) {
+      if (node_to_cut_node.contains(successor)) {
+        successors.push_back(node_to_cut_node.at(successor));
+      }
+    }
+    if (successors.empty()) {
+      continue;
+    }
+    if (successors.size() == 1) {
+      add_edge(node_to_cut_node.at(node), successors.front(),
+               edge_weight(node, /*fan_out=*/1));
+      continue;
+    }
+    min_cut::NodeId fan_in = cut_graph.AddNode(node->GetName() + "_fanin");
+    int64_t weight = edge_weight(node, /*fan_out=*/successors.size());
+    for (min_cut::NodeId successor : successors) {
+      add_edge(node_to_cut_node.at(node), successor, weight);
+      add_edge(successor, fan_in, weight);
+    }
+  }
+
+  min_cut::GraphCut cut = min_cut::MinCutBetweenNodes(cut_graph, source, sink);
+  for (min_cut::NodeId id : cut.source_partition) {
+    auto it = cut_node_to_node.find(id);
+    if (it != cut_node_to_node.end() &&
+        partitionable_nodes_set.contains(it->second)) {
+      bounds->at(it->second).second = stage;
+    }
+  }
+  for (min_cut::NodeId id : cut.sink_partition) {
+    auto it = cut_node_to_node.find(id);
+    if (it != cut_node_to_node.end() &&
+        partitionable_nodes_set.contains(it->second)) {
+      bounds->at(it->second).first = stage + 1;
+    }
+  }
+}
+
+// Returns a name for a new register derived from `name` which does not collide
+// with an existing register.
+std::string UniqueRegisterName(Block* block, absl::string_view name) {
+  std::string result(name);
+  for (int64_t i = 1; block->GetRegister(result).ok(); ++i) {
+    result = absl::StrCat(name, "__", i);
+  }
+  return result;
+}
+
+// Replaces the pipeline registers of the block with registers placing each node
+// of the graph in the given stage. Existing registers which carry the same
+// value across the same stage boundary are reused.
+absl::Status RewritePipelineRegisters(
+    const RetimingGraph& graph,
+    const absl::flat_hash_map<Node*, int64_t>& new_stage) {
+  Block* block = graph.block;
+
+  // Existing register reads keyed by the value they carry and the stage
+  // boundary after which it is written.
+  absl::flat_hash_map<std::pair<Node*, int64_t>, RegisterRead*> reusable_reads;
+  std::vector<Register*> registers(block->GetRegisters().begin(),
+                                   block->GetRegisters().end());
+  for (Register* reg : registers) {
+    XLS_ASSIGN_OR_RETURN(RegisterRead * reg_read, block->GetRegisterRead(reg));
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    XLS_RETURN_IF_ERROR(block->RemoveNode(reg_write));
+    const absl::optional<int64_t>& stage = graph.stage.at(reg_read);
+    if (stage.has_value()) {
+      reusable_reads.insert(
+          {{graph.register_source.at(reg_read), stage.value() - 1}, reg_read});
+    }
+  }
+
+  // Detach every node from the register reads by using the carried values
+  // directly, then remove the registers which can't be reused.
+  std::vector<Node*> nodes(block->nodes().begin(), block->nodes().end());
+  for (Node* node : nodes) {
+    if (node->Is<RegisterRead>()) {
+      continue;
+    }
+    for (int64_t i = 0; i < node->operand_count(); ++i) {
+      if (node->operand(i)->Is<RegisterRead>()) {
+        XLS_RETURN_IF_ERROR(node->ReplaceOperandNumber(
+            i, ResolveValue(graph, node->operand(i))));
+      }
+    }
+  }
+  absl::flat_hash_set<RegisterRead*> reusable_set;
+  for (const auto& [key, reg_read] : reusable_reads) {
+    reusable_set.insert(reg_read);
+  }
+  for (Register* reg : registers) {
+    XLS_ASSIGN_OR_RETURN(RegisterRead * reg_read, block->GetRegisterRead(reg));
+    if (!reusable_set.contains(reg_read)) {
+      XLS_RETURN_IF_ERROR(block->RemoveNode(reg_read));
+      XLS_RETURN_IF_ERROR(block->RemoveRegister(reg));
+    }
+  }
+
+  // The nodes carrying each value in successive stages, starting with the
+  // value itself in the stage in which it is computed.
+  absl::flat_hash_map<Node*, std::vector<Node*>> pipelined_values;
+  auto value_in_stage = [&](Node* value,
+                            int64_t stage) -> absl::StatusOr<Node*> {
+    int64_t value_stage = new_stage.at(value);
+    std::vector<Node*>& pipelined = pipelined_values[value];
+    if (pipelined.empty()) {
+      pipelined.push_back(value);
+    }
+    while (value_stage + static_cast<int64_t>(pipelined.size()) <= stage) {
+      int64_t boundary = value_stage + pipelined.size() - 1;
+      Register* reg;
+      RegisterRead* reg_read;
+      auto it = reusable_reads.find({value, boundary});
+      if (it != reusable_reads.end()) {
+        reg_read = it->second;
+        reg = reg_read->GetRegister();
+      } else {
+        XLS_ASSIGN_OR_RETURN(
+            reg, block->AddRegister(
+                     UniqueRegisterName(
+                         block, PipelineSignalName(value->GetName(), boundary)),
+                     value->GetType()));
+        XLS_ASSIGN_OR_RETURN(reg_read, block->MakeNodeWithName<RegisterRead>(
+                                           value->loc(), reg,
+                                           /*name=*/reg->name()));
+      }
+      XLS_RETURN_IF_ERROR(block
+                              ->MakeNode<RegisterWrite>(
+                                  value->loc(), pipelined.back(),
+                                  /*load_enable=*/absl::nullopt,
+                                  /*reset=*/absl::nullopt, reg)
+                              .status());
+      pipelined.push_back(reg_read);
+    }
+    return pipelined.at(stage - value_stage);
+  };
+
+  for (Node* node : graph.nodes) {
+    int64_t stage = new_stage.at(node);
+    for (int64_t i = 0; i < node->operand_count(); ++i) {
+      Node* operand = node->operand(i);
+      if (!new_stage.contains(operand) || new_stage.at(operand) == stage) {
+        continue;
+      }
+      XLS_RET_CHECK_LT(new_stage.at(operand), stage);
+      XLS_ASSIGN_OR_RETURN(Node * staged_operand,
+                           value_in_stage(operand, stage));
+      XLS_RETURN_IF_ERROR(node->ReplaceOperandNumber(i, staged_operand));
+    }
+  }
+
+  for (RegisterRead* reg_read : reusable_set) {
+    if (reg_read->users().empty()) {
+      Register* reg = reg_read->GetRegister();
+      XLS_RETURN_IF_ERROR(block->RemoveNode(reg_read));
+      XLS_RETURN_IF_ERROR(block->RemoveRegister(reg));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> RetimingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  if (!options.codegen_options.retime_pipeline()) {
+    return false;
+  }
+  if (options.delay_estimator == nullptr) {
+    return absl::InvalidArgumentError(
+        "Retiming requires a delay estimator.");
+  }
+  Block* block = unit->block;
+  XLS_ASSIGN_OR_RETURN(absl::optional<RetimingGraph> graph,
+                       BuildRetimingGraph(block, *options.delay_estimator));
+  if (!graph.has_value() || graph->last_stage == 0) {
+    return false;
+  }
+
+  int64_t original_delay = MaxStageDelay(
+      *graph, [&](Node* node) { return graph->stage.at(node).value(); });
+  int64_t max_node_delay = 0;
+  for (Node* node : graph->nodes) {
+    max_node_delay = std::max(max_node_delay, graph->delay.at(node));
+  }
+  const StageBounds initial_bounds =
+      InitialBounds(*graph, options.codegen_options);
+  // The original placement is feasible for its own delay, so the search range
+  // contains at least one feasible clock period.
+  int64_t clock_period_ps = BinarySearchMinTrue(
+      max_node_delay, original_delay, [&](int64_t clock_period_ps) {
+        StageBounds bounds = initial_bounds;
+        return PropagateBounds(*graph, clock_period_ps, &bounds);
+      });
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Retiming %s: maximum stage delay %dps, achievable %dps", block->name(),
+      original_delay, clock_period_ps);
+  if (clock_period_ps >= original_delay) {
+    return false;
+  }
+
+  // Choose a placement achieving the clock period which minimizes registers by
+  // splitting the nodes at each stage boundary in turn.
+  StageBounds bounds = initial_bounds;
+  XLS_RET_CHECK(PropagateBounds(*graph, clock_period_ps, &bounds));
+  for (int64_t stage = 0; stage < graph->last_stage; ++stage) {
+    SplitAfterStage(*graph, stage, &bounds);
+    if (!PropagateBounds(*graph, clock_period_ps, &bounds)) {
+      XLS_VLOG(2) << "Retiming " << block->name()
+                  << " failed: infeasible bounds after splitting stage "
+                  << stage;
+      return false;
+    }
+  }
+  absl::flat_hash_map<Node*, int64_t> new_stage;
+  for (Node* node : graph->nodes) {
+    XLS_RET_CHECK_EQ(bounds.at(node).first, bounds.at(node).second)
+        << node->GetName();
+    new_stage[node] = bounds.at(node).first;
+  }
+  XLS_RET_CHECK_LE(
+      MaxStageDelay(*graph, [&](Node* node) { return new_stage.at(node); }),
+      clock_period_ps);
+
+  XLS_ASSIGN_OR_RETURN(BlockMetricsProto metrics,
+                       GenerateBlockMetrics(block, options.delay_estimator));
+  if (metrics.has_max_reg_to_reg_delay_ps()) {
+    unit->max_reg_to_reg_delay_before_retiming_ps =
+        metrics.max_reg_to_reg_delay_ps();
+  }
+
+  XLS_RETURN_IF_ERROR(RewritePipelineRegisters(*graph, new_stage));
+  return true;
+}
+
+}  // namespace xls::verilog
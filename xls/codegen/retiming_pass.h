@@ -0,0 +1,45 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_RETIMING_PASS_H_
+#define XLS_CODEGEN_RETIMING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Moves the pipeline registers of a feed-forward pipelined block across
+// combinational logic to minimize the maximum delay of any pipeline stage, as
+// measured by the delay estimator in the pass options. Among the placements
+// which achieve the minimum delay, one which (heuristically) minimizes the
+// number of register bits is chosen using a min-cut at each stage boundary.
+//
+// Only runs if CodegenOptions::retime_pipeline() is set. The latency of the
+// block is unchanged. Blocks which are not a plain feed-forward pipeline (for
+// example, those with registers which have a reset or load enable, or with
+// instantiations) are left unchanged.
+class RetimingPass : public CodegenPass {
+ public:
+  RetimingPass() : CodegenPass("retiming", "Retime pipeline registers") {}
+  ~RetimingPass() override {}
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_RETIMING_PASS_H_
@@ -0,0 +1,241 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/retiming_pass.h"
+
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/block_metrics.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/codegen/xls_metrics.pb.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Unit delay delay estimator.
+class TestDelayEstimator : public DelayEstimator {
+ public:
+  TestDelayEstimator() : DelayEstimator("test") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    switch (node->op()) {
+      case Op::kInputPort:
+      case Op::kOutputPort:
+      case Op::kLiteral:
+      case Op::kRegisterRead:
+      case Op::kRegisterWrite:
+        return 0;
+      default:
+        return 1;
+    }
+  }
+};
+
+// Delay estimator which has no model for negate.
+class NoNegateDelayEstimator : public TestDelayEstimator {
+ public:
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    if (node->op() == Op::kNeg) {
+      return absl::UnimplementedError("No delay model for neg");
+    }
+    return TestDelayEstimator::GetOperationDelayInPs(node);
+  }
+};
+
+class RetimingPassTest : public IrTestBase {
+ protected:
+  CodegenPassOptions Options(bool retime = true) {
+    CodegenPassOptions options;
+    options.codegen_options.flop_inputs(true)
+        .flop_outputs(true)
+        .retime_pipeline(retime);
+    options.delay_estimator = &delay_estimator_;
+    return options;
+  }
+
+  absl::StatusOr<bool> Run(CodegenPassUnit* unit,
+                           const CodegenPassOptions& options) {
+    PassResults results;
+    return RetimingPass().Run(unit, options, &results);
+  }
+
+  // Builds a pipeline with flopped inputs and outputs whose first interior
+  // stage computes six operations and whose second computes one.
+  absl::StatusOr<Block*> BuildUnbalancedPipeline(Package* p) {
+    BlockBuilder bb(TestName(), p);
+    XLS_RETURN_IF_ERROR(bb.block()->AddClockPort("clk"));
+    BValue a = bb.InputPort("a", p->GetBitsType(32));
+    BValue a_flop = bb.InsertRegister("p0_a", a);
+    BValue x = bb.Not(a_flop);
+    x = bb.Negate(x);
+    x = bb.Not(x);
+    x = bb.Negate(x);
+    x = bb.Add(x, a_flop);
+    x = bb.Not(x, /*loc=*/absl::nullopt, "x");
+    BValue x_flop = bb.InsertRegister("p1_x", x);
+    BValue y = bb.Negate(x_flop, /*loc=*/absl::nullopt, "y");
+    BValue y_flop = bb.InsertRegister("p2_y", y);
+    bb.OutputPort("out", y_flop);
+    return bb.Build();
+  }
+
+  // Returns the outputs of the block for the given input sequence, skipping
+  // the first `latency` cycles.
+  absl::StatusOr<std::vector<uint64_t>> Simulate(
+      Block* block, absl::Span<const uint64_t> inputs, int64_t latency) {
+    std::vector<absl::flat_hash_map<std::string, uint64_t>> input_maps;
+    for (uint64_t input : inputs) {
+      input_maps.push_back({{"a", input}});
+    }
+    XLS_ASSIGN_OR_RETURN(auto output_maps,
+                         InterpretSequentialBlock(block, input_maps));
+    std::vector<uint64_t> outputs;
+    for (int64_t i = latency; i < output_maps.size(); ++i) {
+      outputs.push_back(output_maps[i].at("out"));
+    }
+    return outputs;
+  }
+
+  TestDelayEstimator delay_estimator_;
+};
+
+TEST_F(RetimingPassTest, UnbalancedPipeline) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildUnbalancedPipeline(p.get()));
+  auto reference_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * reference,
+                           BuildUnbalancedPipeline(reference_package.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto before,
+                           GenerateBlockMetrics(block, &delay_estimator_));
+  EXPECT_EQ(before.max_reg_to_reg_delay_ps(), 6);
+
+  CodegenPassUnit unit(block->package(), block);
+  EXPECT_THAT(Run(&unit, Options()), IsOkAndHolds(true));
+  EXPECT_EQ(unit.max_reg_to_reg_delay_before_retiming_ps, 6);
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto after,
+                           GenerateBlockMetrics(block, &delay_estimator_));
+  EXPECT_EQ(after.max_reg_to_reg_delay_ps(), 4);
+  // Inputs and outputs remain flopped.
+  EXPECT_EQ(after.max_input_to_reg_delay_ps(), 0);
+  EXPECT_EQ(after.max_reg_to_output_delay_ps(), 0);
+  // The input register is reused.
+  XLS_EXPECT_OK(block->GetRegister("p0_a").status());
+
+  std::minstd_rand engine;
+  std::vector<uint64_t> inputs;
+  for (int64_t i = 0; i < 32; ++i) {
+    inputs.push_back(engine());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> expected,
+                           Simulate(reference, inputs, /*latency=*/3));
+  EXPECT_THAT(Simulate(block, inputs, /*latency=*/3), IsOkAndHolds(expected));
+
+  // The pipeline is now balanced.
+  EXPECT_THAT(Run(&unit, Options()), IsOkAndHolds(false));
+}
+
+TEST_F(RetimingPassTest, DisabledByDefault) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildUnbalancedPipeline(p.get()));
+  CodegenPassUnit unit(block->package(), block);
+  EXPECT_THAT(Run(&unit, Options(/*retime=*/false)), IsOkAndHolds(false));
+  EXPECT_FALSE(unit.max_reg_to_reg_delay_before_retiming_ps.has_value());
+}
+
+TEST_F(RetimingPassTest, RequiresDelayEstimator) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildUnbalancedPipeline(p.get()));
+  CodegenPassUnit unit(block->package(), block);
+  CodegenPassOptions options = Options();
+  options.delay_estimator = nullptr;
+  EXPECT_THAT(Run(&unit, options),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("delay estimator")));
+}
+
+TEST_F(RetimingPassTest, DelayEstimationErrorIsReturned) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, BuildUnbalancedPipeline(p.get()));
+  CodegenPassUnit unit(block->package(), block);
+  CodegenPassOptions options = Options();
+  NoNegateDelayEstimator delay_estimator;
+  options.delay_estimator = &delay_estimator;
+  EXPECT_THAT(Run(&unit, options),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("No delay model for neg")));
+}
+
+TEST_F(RetimingPassTest, RegistersWithLoadEnableAreNotRetimed) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue en = bb.InputPort("en", p->GetBitsType(1));
+  BValue x = bb.Not(bb.Negate(bb.Not(a)));
+  BValue x_flop = bb.InsertRegister("x_reg", x, /*load_enable=*/en);
+  bb.OutputPort("out", bb.Negate(x_flop));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  CodegenPassUnit unit(block->package(), block);
+  CodegenPassOptions options = Options();
+  options.codegen_options.flop_inputs(false).flop_outputs(false);
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(false));
+}
+
+TEST_F(RetimingPassTest, LogicMovesAcrossInteriorRegisters) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue b = bb.InputPort("b", p->GetBitsType(8));
+  BValue sum = bb.Add(a, b);
+  BValue sum_flop = bb.InsertRegister("p0_sum", sum);
+  BValue x = bb.Not(bb.Negate(bb.Not(bb.Negate(sum_flop))));
+  bb.OutputPort("out", x);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  CodegenPassUnit unit(block->package(), block);
+  CodegenPassOptions options = Options();
+  options.codegen_options.flop_inputs(false).flop_outputs(false);
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(true));
+
+  // Five operations are split three and two; there is no register-to-register
+  // path so the "before" value is not set.
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto after,
+                           GenerateBlockMetrics(block, &delay_estimator_));
+  EXPECT_EQ(after.max_input_to_reg_delay_ps() +
+                after.max_reg_to_output_delay_ps(),
+            5);
+  EXPECT_LE(after.max_input_to_reg_delay_ps(), 3);
+  EXPECT_LE(after.max_reg_to_output_delay_ps(), 3);
+  EXPECT_FALSE(unit.max_reg_to_reg_delay_before_retiming_ps.has_value());
+  EXPECT_EQ(block->GetRegisters().size(), 1);
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -116,9 +116,9 @@ absl::StatusOr<ModuleSignature> GenerateSignature(
       pipeline_control = PipelineControl();
       *(pipeline_control->mutable_valid()) = options.valid_control().value();
     }
-    // We assume initiation-interval of one because that is all we generate at
-    // the moment.
-    b.WithPipelineInterface(register_levels, /*initiation_interval=*/1,
+    int64_t initiation_interval =
+        schedule.has_value() ? schedule->initiation_interval() : 1;
+    b.WithPipelineInterface(register_levels, initiation_interval,
                             pipeline_control);
   }
 
@@ -0,0 +1,64 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "xls/common/thread.h"
+
+namespace xls {
+
+int64_t DefaultThreadCount() {
+  return std::max(int64_t{1},
+                  static_cast<int64_t>(std::thread::hardware_concurrency()));
+}
+
+void ParallelFor(int64_t count, int64_t num_threads,
+                 const std::function<void(int64_t)>& fn) {
+  if (num_threads == 0) {
+    num_threads = DefaultThreadCount();
+  }
+  num_threads = std::min(num_threads, count);
+  if (num_threads <= 1) {
+    for (int64_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  std::atomic<int64_t> next_index(0);
+  auto worker = [&]() {
+    for (int64_t i = next_index.fetch_add(1); i < count;
+         i = next_index.fetch_add(1)) {
+      fn(i);
+    }
+  };
+  // The calling thread also does work so only spawn num_threads - 1 threads.
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(num_threads - 1);
+  for (int64_t t = 0; t < num_threads - 1; ++t) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  worker();
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,37 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_PARALLEL_FOR_H_
+#define XLS_COMMON_PARALLEL_FOR_H_
+
+#include <cstdint>
+#include <functional>
+
+namespace xls {
+
+// Returns the number of threads to use when the caller has no preference: the
+// number of hardware threads, or one if that cannot be determined.
+int64_t DefaultThreadCount();
+
+// Invokes fn(i) for every i in [0, count) using up to `num_threads` threads
+// (DefaultThreadCount() if `num_threads` is zero). Indices are claimed in
+// increasing order but may complete in any order. Blocks until every
+// invocation has returned. With a single thread (or count <= 1) all
+// invocations happen on the calling thread.
+void ParallelFor(int64_t count, int64_t num_threads,
+                 const std::function<void(int64_t)>& fn);
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_PARALLEL_FOR_H_
@@ -0,0 +1,54 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/parallel_for.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(ParallelForTest, EveryIndexVisitedOnce) {
+  for (int64_t num_threads : {0, 1, 2, 7, 100}) {
+    std::vector<std::atomic<int64_t>> visits(1000);
+    ParallelFor(visits.size(), num_threads,
+                [&](int64_t i) { visits[i].fetch_add(1); });
+    for (const std::atomic<int64_t>& v : visits) {
+      EXPECT_EQ(v.load(), 1) << "num_threads: " << num_threads;
+    }
+  }
+}
+
+TEST(ParallelForTest, ZeroCount) {
+  bool called = false;
+  ParallelFor(0, 4, [&](int64_t i) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(ParallelForTest, SingleThreadRunsInOrder) {
+  std::vector<int64_t> order;
+  ParallelFor(5, 1, [&](int64_t i) { order.push_back(i); });
+  EXPECT_THAT(order, ::testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST(ParallelForTest, DefaultThreadCountIsPositive) {
+  EXPECT_GE(DefaultThreadCount(), 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -2692,6 +2692,11 @@ class Module : public AstNode {
 
   const std::string& name() const { return name_; }
 
+  // Returns all AST nodes owned by this module in order of creation. Parsing is
+  // deterministic, so re-parsing the same text yields the same order; this
+  // allows serialized artifacts to refer to nodes by index.
+  absl::Span<const std::unique_ptr<AstNode>> nodes() const { return nodes_; }
+
   const AstNode* FindNode(AstNodeKind kind, const Span& span) const {
     for (const auto& node : nodes_) {
       if (node->kind() == kind && node->GetSpan().has_value() &&
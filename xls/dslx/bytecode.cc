@@ -105,6 +105,14 @@ absl::StatusOr<Bytecode::Op> OpFromString(std::string_view s) {
       absl::StrCat("String was not a bytecode op: `", s, "`"));
 }
 
+std::string RegisterOperandToString(const Bytecode::RegisterOperand& operand) {
+  if (absl::holds_alternative<Bytecode::SlotIndex>(operand)) {
+    return absl::StrCat("slot:",
+                        absl::get<Bytecode::SlotIndex>(operand).value());
+  }
+  return absl::get<InterpValue>(operand).ToString();
+}
+
 }  // namespace
 
 std::string OpToString(Bytecode::Op op) {
@@ -193,6 +201,12 @@ std::string OpToString(Bytecode::Op op) {
       return "width_slice";
     case Bytecode::Op::kXor:
       return "xor";
+    case Bytecode::Op::kRegBinop:
+      return "reg_binop";
+    case Bytecode::Op::kRegBinopStore:
+      return "reg_binop_store";
+    case Bytecode::Op::kRegCompareJumpRelIf:
+      return "reg_cmp_jump_rel_if";
   }
   return absl::StrCat("<invalid: ", static_cast<int>(op), ">");
 }
@@ -383,6 +397,17 @@ absl::StatusOr<const Bytecode::TraceData*> Bytecode::trace_data() const {
   return &absl::get<TraceData>(data_.value());
 }
 
+absl::StatusOr<const Bytecode::RegisterOpData*> Bytecode::register_op_data()
+    const {
+  if (!data_.has_value()) {
+    return absl::InvalidArgumentError("Bytecode does not hold data.");
+  }
+  if (!absl::holds_alternative<RegisterOpData>(data_.value())) {
+    return absl::InvalidArgumentError("Bytecode data is not RegisterOpData.");
+  }
+  return &absl::get<RegisterOpData>(data_.value());
+}
+
 absl::StatusOr<Bytecode::SlotIndex> Bytecode::slot_index() const {
   if (!data_.has_value()) {
     return absl::InvalidArgumentError("Bytecode does not hold data.");
@@ -482,6 +507,17 @@ std::string Bytecode::ToString(bool source_locs) const {
         }
       }
       data_string = absl::StrCat("trace data: ", absl::StrJoin(pieces, ", "));
+    } else if (absl::holds_alternative<RegisterOpData>(data_.value())) {
+      const RegisterOpData& reg_data = absl::get<RegisterOpData>(data_.value());
+      data_string = absl::StrCat(OpToString(reg_data.op), " ",
+                                 RegisterOperandToString(reg_data.lhs), ", ",
+                                 RegisterOperandToString(reg_data.rhs));
+      if (reg_data.dest.has_value()) {
+        absl::StrAppend(&data_string, " -> slot:", reg_data.dest->value());
+      }
+      if (reg_data.target.has_value()) {
+        absl::StrAppendFormat(&data_string, " %+d", reg_data.target->value());
+      }
     } else if (absl::holds_alternative<JumpTarget>(data_.value())) {
       JumpTarget target = absl::get<JumpTarget>(data_.value());
       if (target == kPlaceholderJumpAmount) {
@@ -564,6 +600,145 @@ absl::StatusOr<std::vector<Bytecode>> BytecodesFromString(
   return result;
 }
 
+// Returns true if the given stack-form binary op may be folded into a
+// register-form instruction.
+static bool IsFusableBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kAdd:
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kConcat:
+    case Bytecode::Op::kDiv:
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kMul:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kShl:
+    case Bytecode::Op::kShr:
+    case Bytecode::Op::kSub:
+    case Bytecode::Op::kXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool IsComparison(Bytecode::Op op) {
+  return op == Bytecode::Op::kEq || op == Bytecode::Op::kNe ||
+         op == Bytecode::Op::kLt || op == Bytecode::Op::kLe ||
+         op == Bytecode::Op::kGt || op == Bytecode::Op::kGe;
+}
+
+// Returns the register operand equivalent to the given bytecode if it is a
+// load or a literal.
+static absl::optional<Bytecode::RegisterOperand> AsRegisterOperand(
+    const Bytecode& bytecode) {
+  if (!bytecode.has_data()) {
+    return absl::nullopt;
+  }
+  const Bytecode::Data& data = bytecode.data().value();
+  if (bytecode.op() == Bytecode::Op::kLoad &&
+      absl::holds_alternative<Bytecode::SlotIndex>(data)) {
+    return absl::get<Bytecode::SlotIndex>(data);
+  }
+  if (bytecode.op() == Bytecode::Op::kLiteral &&
+      absl::holds_alternative<InterpValue>(data)) {
+    return absl::get<InterpValue>(data);
+  }
+  return absl::nullopt;
+}
+
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes) {
+  std::vector<Bytecode> result;
+  // The PC in `result` of the bytecode replacing each original bytecode, plus
+  // an entry for the end of the function.
+  std::vector<int64_t> new_pcs(bytecodes.size() + 1);
+  // The (new PC, original PC) pairs of every jump; the targets of these are
+  // adjusted once all bytecodes have been placed.
+  std::vector<std::pair<int64_t, int64_t>> jumps;
+  int64_t pc = 0;
+  while (pc < bytecodes.size()) {
+    int64_t new_pc = result.size();
+    absl::optional<Bytecode::RegisterOperand> lhs;
+    absl::optional<Bytecode::RegisterOperand> rhs;
+    if (pc + 2 < bytecodes.size() && IsFusableBinop(bytecodes[pc + 2].op())) {
+      lhs = AsRegisterOperand(bytecodes[pc]);
+      rhs = AsRegisterOperand(bytecodes[pc + 1]);
+    }
+    if (lhs.has_value() && rhs.has_value()) {
+      const Bytecode& binop = bytecodes[pc + 2];
+      Bytecode::RegisterOpData data{binop.op(), std::move(lhs.value()),
+                                    std::move(rhs.value()), absl::nullopt,
+                                    absl::nullopt};
+      Bytecode::Op op = Bytecode::Op::kRegBinop;
+      int64_t fused_count = 3;
+      if (pc + 3 < bytecodes.size()) {
+        const Bytecode& next = bytecodes[pc + 3];
+        if (next.op() == Bytecode::Op::kStore) {
+          XLS_ASSIGN_OR_RETURN(data.dest, next.slot_index());
+          op = Bytecode::Op::kRegBinopStore;
+          fused_count = 4;
+        } else if (next.op() == Bytecode::Op::kJumpRelIf &&
+                   IsComparison(data.op)) {
+          XLS_ASSIGN_OR_RETURN(data.target, next.jump_target());
+          op = Bytecode::Op::kRegCompareJumpRelIf;
+          fused_count = 4;
+          jumps.push_back({new_pc, pc + 3});
+        }
+      }
+      for (int64_t i = 0; i < fused_count; ++i) {
+        new_pcs[pc + i] = new_pc;
+      }
+      result.push_back(Bytecode(binop.source_span(), op, std::move(data)));
+      pc += fused_count;
+      continue;
+    }
+
+    new_pcs[pc] = new_pc;
+    if (bytecodes[pc].op() == Bytecode::Op::kJumpRel ||
+        bytecodes[pc].op() == Bytecode::Op::kJumpRelIf) {
+      jumps.push_back({new_pc, pc});
+    }
+    result.push_back(std::move(bytecodes[pc]));
+    ++pc;
+  }
+  new_pcs[bytecodes.size()] = result.size();
+
+  for (const auto& [new_pc, old_pc] : jumps) {
+    Bytecode& jump = result[new_pc];
+    bool is_fused = jump.op() == Bytecode::Op::kRegCompareJumpRelIf;
+    Bytecode::JumpTarget old_target;
+    if (is_fused) {
+      XLS_ASSIGN_OR_RETURN(const Bytecode::RegisterOpData* data,
+                           jump.register_op_data());
+      old_target = data->target.value();
+    } else {
+      XLS_ASSIGN_OR_RETURN(old_target, jump.jump_target());
+    }
+    int64_t old_dest = old_pc + old_target.value();
+    XLS_RET_CHECK(old_dest >= 0 && old_dest < bytecodes.size())
+        << "Jump at PC " << old_pc << " is out of range.";
+    int64_t new_dest = new_pcs[old_dest];
+    XLS_RET_CHECK(result[new_dest].op() == Bytecode::Op::kJumpDest)
+        << "Jump at PC " << old_pc << " does not land on a jump_dest.";
+    Bytecode::JumpTarget new_target(new_dest - new_pc);
+    if (is_fused) {
+      Bytecode::RegisterOpData data =
+          absl::get<Bytecode::RegisterOpData>(jump.data().value());
+      data.target = new_target;
+      jump = Bytecode(jump.source_span(), jump.op(), std::move(data));
+    } else {
+      jump = Bytecode(jump.source_span(), jump.op(), new_target);
+    }
+  }
+
+  return result;
+}
+
 absl::StatusOr<std::unique_ptr<BytecodeFunction>> BytecodeFunction::Create(
     Module* owner, const TypeInfo* type_info, std::vector<Bytecode> bytecodes) {
   auto bf = absl::WrapUnique(
@@ -578,10 +753,27 @@ BytecodeFunction::BytecodeFunction(Module* owner, const TypeInfo* type_info,
 
 absl::Status BytecodeFunction::Init() {
   num_slots_ = 0;
+  auto note_slot = [this](Bytecode::SlotIndex slot) {
+    num_slots_ = std::max(num_slots_, slot.value() + 1);
+  };
   for (const auto& bc : bytecodes_) {
     if (bc.op() == Bytecode::Op::kLoad || bc.op() == Bytecode::Op::kStore) {
       XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bc.slot_index());
-      num_slots_ = std::max(num_slots_, slot.value() + 1);
+      note_slot(slot);
+    } else if (bc.op() == Bytecode::Op::kRegBinop ||
+               bc.op() == Bytecode::Op::kRegBinopStore ||
+               bc.op() == Bytecode::Op::kRegCompareJumpRelIf) {
+      XLS_ASSIGN_OR_RETURN(const Bytecode::RegisterOpData* data,
+                           bc.register_op_data());
+      for (const Bytecode::RegisterOperand* operand :
+           {&data->lhs, &data->rhs}) {
+        if (absl::holds_alternative<Bytecode::SlotIndex>(*operand)) {
+          note_slot(absl::get<Bytecode::SlotIndex>(*operand));
+        }
+      }
+      if (data->dest.has_value()) {
+        note_slot(data->dest.value());
+      }
     }
   }
   return absl::OkStatus();
@@ -600,6 +792,11 @@ std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
         bytecodes.emplace_back(
             Bytecode(bc.source_span(), bc.op(),
                      absl::get<InterpValue>(bc.data().value())));
+      } else if (absl::holds_alternative<Bytecode::RegisterOpData>(
+                     bc.data().value())) {
+        bytecodes.emplace_back(Bytecode(
+            bc.source_span(), bc.op(),
+            absl::get<Bytecode::RegisterOpData>(bc.data().value())));
       } else {
         const std::unique_ptr<ConcreteType>& type =
             absl::get<std::unique_ptr<ConcreteType>>(bc.data().value());
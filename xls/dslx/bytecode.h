@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "xls/common/strong_int.h"
 #include "xls/dslx/ast.h"
@@ -145,6 +146,21 @@ class Bytecode {
     kDup,
     // Pops the value at TOS0.
     kPop,
+
+    // Register-form "superinstructions". These are not emitted directly, but
+    // are formed by FuseSuperinstructions() from common stack-form sequences.
+    // They read their operands from slots or immediates (see RegisterOpData)
+    // instead of the stack.
+    //
+    // Applies the data argument's binary op and pushes the result onto the
+    // stack.
+    kRegBinop,
+    // Applies the data argument's binary op and stores the result into its
+    // destination slot.
+    kRegBinopStore,
+    // Applies the data argument's comparison op and jumps (relative) by its
+    // target if the result is true.
+    kRegCompareJumpRelIf,
   };
 
   // Indicates the amount by which the PC should be adjusted.
@@ -209,9 +225,26 @@ class Bytecode {
   };
 
   using TraceData = std::vector<FormatStep>;
+
+  // An operand of a register-form instruction: either the value held in a slot
+  // or an immediate value.
+  using RegisterOperand = absl::variant<SlotIndex, InterpValue>;
+
+  // Data for the register-form instructions (kRegBinop, etc.).
+  struct RegisterOpData {
+    // The (stack-form) binary op being applied, e.g., kAdd or kLt.
+    Op op;
+    RegisterOperand lhs;
+    RegisterOperand rhs;
+    // The slot receiving the result; only used by kRegBinopStore.
+    absl::optional<SlotIndex> dest;
+    // The relative jump amount; only used by kRegCompareJumpRelIf.
+    absl::optional<JumpTarget> target;
+  };
+
   using Data = absl::variant<InterpValue, JumpTarget, NumElements, SlotIndex,
                              std::unique_ptr<ConcreteType>, InvocationData,
-                             MatchArmItem, TraceData>;
+                             MatchArmItem, TraceData, RegisterOpData>;
 
   static Bytecode MakeDup(Span span);
   static Bytecode MakeFail(Span span, std::string);
@@ -250,6 +283,7 @@ class Bytecode {
   absl::StatusOr<JumpTarget> jump_target() const;
   absl::StatusOr<const MatchArmItem*> match_arm_item() const;
   absl::StatusOr<NumElements> num_elements() const;
+  absl::StatusOr<const RegisterOpData*> register_op_data() const;
   absl::StatusOr<SlotIndex> slot_index() const;
   absl::StatusOr<const TraceData*> trace_data() const;
   absl::StatusOr<const ConcreteType*> type_data() const;
@@ -324,6 +358,18 @@ std::string BytecodesToString(absl::Span<const Bytecode> bytecodes,
 absl::StatusOr<std::vector<Bytecode>> BytecodesFromString(
     absl::string_view text);
 
+// Replaces common stack-form instruction sequences with single register-form
+// instructions which read their operands directly from slots or immediates:
+//
+//   load/literal x; load/literal y; <binop>             -> reg_binop
+//   load/literal x; load/literal y; <binop>; store z    -> reg_binop_store
+//   load/literal x; load/literal y; <cmp>; jump_rel_if  -> reg_cmp_jump_rel_if
+//
+// Relative jump amounts are adjusted to account for the removed instructions.
+// All jumps must land on a jump_dest, which is never fused.
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_BYTECODE_H_
@@ -24,10 +24,12 @@ absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
     const Function* f, const TypeInfo* type_info,
     const absl::optional<SymbolicBindings>& caller_bindings) {
   Key key = std::make_tuple(f, type_info, caller_bindings);
+  absl::MutexLock lock(&mutex_);
   if (!cache_.contains(key)) {
     XLS_ASSIGN_OR_RETURN(
         std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings));
+        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings,
+                              /*fuse_superinstructions=*/true));
     cache_.emplace(key, std::move(bf));
   }
 
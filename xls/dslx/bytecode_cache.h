@@ -16,7 +16,9 @@
 
 #include <memory>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/bytecode.h"
 #include "xls/dslx/bytecode_cache_interface.h"
@@ -25,19 +27,25 @@
 
 namespace xls::dslx {
 
+// Thread-safe cache of emitted bytecode functions. Emission happens with the
+// cache lock held, so concurrent interpreters never emit the same function
+// twice.
 class BytecodeCache : public BytecodeCacheInterface {
  public:
   BytecodeCache(ImportData* import_data);
   absl::StatusOr<BytecodeFunction*> GetOrCreateBytecodeFunction(
       const Function* f, const TypeInfo* type_info,
-      const absl::optional<SymbolicBindings>& caller_bindings) override;
+      const absl::optional<SymbolicBindings>& caller_bindings) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
   using Key = std::tuple<const Function*, const TypeInfo*,
                          absl::optional<SymbolicBindings>>;
 
   ImportData* import_data_;
-  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls::dslx
@@ -52,16 +52,17 @@ absl::Status BytecodeEmitter::Init(const Function* f) {
 /* static */ absl::StatusOr<std::unique_ptr<BytecodeFunction>>
 BytecodeEmitter::Emit(ImportData* import_data, const TypeInfo* type_info,
                       const Function* f,
-                      const absl::optional<SymbolicBindings>& caller_bindings) {
+                      const absl::optional<SymbolicBindings>& caller_bindings,
+                      bool fuse_superinstructions) {
   return EmitProcNext(import_data, type_info, f, caller_bindings,
-                      /*proc_members=*/{});
+                      /*proc_members=*/{}, fuse_superinstructions);
 }
 
 /* static */ absl::StatusOr<std::unique_ptr<BytecodeFunction>>
 BytecodeEmitter::EmitProcNext(
     ImportData* import_data, const TypeInfo* type_info, const Function* f,
     const absl::optional<SymbolicBindings>& caller_bindings,
-    const std::vector<NameDef*>& proc_members) {
+    const std::vector<NameDef*>& proc_members, bool fuse_superinstructions) {
   BytecodeEmitter emitter(import_data, type_info, caller_bindings);
   for (const NameDef* name_def : proc_members) {
     emitter.namedef_to_slot_[name_def] = emitter.namedef_to_slot_.size();
@@ -73,6 +74,10 @@ BytecodeEmitter::EmitProcNext(
     return emitter.status_;
   }
 
+  if (fuse_superinstructions) {
+    XLS_ASSIGN_OR_RETURN(emitter.bytecode_,
+                         FuseSuperinstructions(std::move(emitter.bytecode_)));
+  }
   return BytecodeFunction::Create(f->owner(), type_info,
                                   std::move(emitter.bytecode_));
 }
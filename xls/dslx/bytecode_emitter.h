@@ -35,9 +35,12 @@ class BytecodeEmitter : public ExprVisitor {
   // `caller_bindings` contains the symbolic bindings associated with the
   // _caller_ of `f`, if any, and is used to determine the symbolic bindings for
   // `f` itself. It will be nullopt for non-parametric functions.
+  // If `fuse_superinstructions` is true, the emitted bytecode is post-processed
+  // by FuseSuperinstructions() into the faster register form.
   static absl::StatusOr<std::unique_ptr<BytecodeFunction>> Emit(
       ImportData* import_data, const TypeInfo* type_info, const Function* f,
-      const absl::optional<SymbolicBindings>& caller_bindings);
+      const absl::optional<SymbolicBindings>& caller_bindings,
+      bool fuse_superinstructions = false);
 
   static absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitExpression(
       ImportData* import_data, const TypeInfo* type_info, Expr* expr,
@@ -49,7 +52,8 @@ class BytecodeEmitter : public ExprVisitor {
   static absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitProcNext(
       ImportData* import_data, const TypeInfo* type_info, const Function* f,
       const absl::optional<SymbolicBindings>& caller_bindings,
-      const std::vector<NameDef*>& proc_members);
+      const std::vector<NameDef*>& proc_members,
+      bool fuse_superinstructions = false);
 
  private:
   BytecodeEmitter(ImportData* import_data, const TypeInfo* type_info,
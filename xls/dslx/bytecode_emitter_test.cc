@@ -30,7 +30,7 @@ using status_testing::IsOkAndHolds;
 
 absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitBytecodes(
     ImportData* import_data, absl::string_view program,
-    absl::string_view fn_name) {
+    absl::string_view fn_name, bool fuse_superinstructions = false) {
   XLS_ASSIGN_OR_RETURN(
       TypecheckedModule tm,
       ParseAndTypecheck(program, "test.x", "test", import_data));
@@ -38,7 +38,7 @@ absl::StatusOr<std::unique_ptr<BytecodeFunction>> EmitBytecodes(
   XLS_ASSIGN_OR_RETURN(TestFunction * tf, tm.module->GetTest(fn_name));
 
   return BytecodeEmitter::Emit(import_data, tm.type_info, tf->fn(),
-                               absl::nullopt);
+                               absl::nullopt, fuse_superinstructions);
 }
 
 // Verifies that a baseline translation - of a nearly-minimal test case -
@@ -1118,6 +1118,55 @@ fn main() -> u32 {
   }
 }
 
+TEST(BytecodeEmitterTest, SimpleForWithSuperinstructions) {
+  constexpr absl::string_view kProgram = R"(#![test]
+fn main() -> u32 {
+  for (i, accum) : (u32, u32) in range(u32:0, u32:8) {
+    accum + i
+  }(u32:1)
+})";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> bf,
+      EmitBytecodes(&import_data, kProgram, "main",
+                    /*fuse_superinstructions=*/true));
+
+  // Same as SimpleFor, but with the loop header, body, and index increment
+  // each collapsed into a single instruction, and the jumps adjusted to match.
+  const std::vector<std::string> kExpected = {
+      "literal u32:0 @ test.x:3:44-3:45",
+      "literal u32:8 @ test.x:3:51-3:52",
+      "literal builtin:range @ test.x:3:34-3:39",
+      "call range(u32:0, u32:8) : {} @ test.x:3:39-3:53",
+      "store 0 @ test.x:3:6-5:11",
+      "literal u32:0 @ test.x:3:6-5:11",
+      "store 1 @ test.x:3:6-5:11",
+      "literal u32:1 @ test.x:5:9-5:10",
+      "jump_dest @ test.x:3:6-5:11",
+      "reg_cmp_jump_rel_if eq slot:1, u32:8 +12 @ test.x:3:6-5:11",
+      "load 0 @ test.x:3:6-5:11",
+      "load 1 @ test.x:3:6-5:11",
+      "index @ test.x:3:6-5:11",
+      "swap @ test.x:3:6-5:11",
+      "create_tuple 2 @ test.x:3:6-5:11",
+      "expand_tuple @ test.x:3:7-3:17",
+      "store 2 @ test.x:3:8-3:9",
+      "store 3 @ test.x:3:11-3:16",
+      "reg_binop add slot:3, slot:2 @ test.x:4:11-4:12",
+      "reg_binop_store add slot:1, u32:1 -> slot:1 @ test.x:3:6-5:11",
+      "jump_rel -12 @ test.x:3:6-5:11",
+      "jump_dest @ test.x:3:6-5:11",
+  };
+
+  const std::vector<Bytecode>& bytecodes = bf->bytecodes();
+  ASSERT_EQ(bytecodes.size(), kExpected.size());
+  for (int i = 0; i < bytecodes.size(); i++) {
+    ASSERT_EQ(bytecodes[i].ToString(), kExpected[i]);
+  }
+  EXPECT_EQ(bf->num_slots(), 4);
+}
+
 TEST(BytecodeEmitterTest, ShlAndShr) {
   constexpr absl::string_view kProgram = R"(#![test]
 fn main() -> u32 {
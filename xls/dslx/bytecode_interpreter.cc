@@ -80,6 +80,9 @@ absl::Status BytecodeInterpreter::Run() {
       if (!stack_.empty()) {
         XLS_VLOG(2) << " - TOS: " << stack_.back().ToString();
       }
+      if (EvalFastPath(frame, bytecode)) {
+        continue;
+      }
       int64_t old_pc = frame->pc();
       XLS_RETURN_IF_ERROR(EvalNextInstruction());
       if (!stack_.empty()) {
@@ -248,6 +251,23 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       XLS_RETURN_IF_ERROR(EvalRecv(bytecode));
       break;
     }
+    case Bytecode::Op::kRegBinop: {
+      XLS_RETURN_IF_ERROR(EvalRegBinop(bytecode));
+      break;
+    }
+    case Bytecode::Op::kRegBinopStore: {
+      XLS_RETURN_IF_ERROR(EvalRegBinopStore(bytecode));
+      break;
+    }
+    case Bytecode::Op::kRegCompareJumpRelIf: {
+      XLS_ASSIGN_OR_RETURN(std::optional<int64_t> new_pc,
+                           EvalRegCompareJumpRelIf(frame->pc(), bytecode));
+      if (new_pc.has_value()) {
+        frame->set_pc(new_pc.value());
+        return absl::OkStatus();
+      }
+      break;
+    }
     case Bytecode::Op::kSend: {
       XLS_RETURN_IF_ERROR(EvalSend(bytecode));
       break;
@@ -293,6 +313,124 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Returns the value referenced by the given register operand, or nullptr if it
+// refers to a slot which has not been assigned.
+const InterpValue* GetRegisterOperand(
+    const std::vector<InterpValue>& slots,
+    const Bytecode::RegisterOperand& operand) {
+  if (const auto* slot = absl::get_if<Bytecode::SlotIndex>(&operand)) {
+    if (slot->value() >= slots.size()) {
+      return nullptr;
+    }
+    return &slots[slot->value()];
+  }
+  return &absl::get<InterpValue>(operand);
+}
+
+// Applies the binary op `op` to two bits values of the same signedness and
+// width. Returns nullopt for any other ops or operands, which must go through
+// the (error-checking) InterpValue implementations instead.
+absl::optional<InterpValue> EvalBitsBinop(Bytecode::Op op,
+                                          const InterpValue& lhs,
+                                          const InterpValue& rhs) {
+  if (!lhs.IsBits() || lhs.tag() != rhs.tag()) {
+    return absl::nullopt;
+  }
+  const Bits& a = lhs.GetBitsOrDie();
+  const Bits& b = rhs.GetBitsOrDie();
+  if (a.bit_count() != b.bit_count()) {
+    return absl::nullopt;
+  }
+  bool is_signed = lhs.IsSBits();
+  switch (op) {
+    case Bytecode::Op::kAdd:
+      return InterpValue::MakeBits(is_signed, bits_ops::Add(a, b));
+    case Bytecode::Op::kSub:
+      return InterpValue::MakeBits(is_signed, bits_ops::Sub(a, b));
+    case Bytecode::Op::kMul:
+      return InterpValue::MakeBits(
+          is_signed, bits_ops::UMul(a, b).Slice(0, a.bit_count()));
+    case Bytecode::Op::kAnd:
+      return InterpValue::MakeBits(is_signed, bits_ops::And(a, b));
+    case Bytecode::Op::kOr:
+      return InterpValue::MakeBits(is_signed, bits_ops::Or(a, b));
+    case Bytecode::Op::kXor:
+      return InterpValue::MakeBits(is_signed, bits_ops::Xor(a, b));
+    case Bytecode::Op::kEq:
+      return InterpValue::MakeBool(a == b);
+    case Bytecode::Op::kNe:
+      return InterpValue::MakeBool(!(a == b));
+    case Bytecode::Op::kLt:
+      return InterpValue::MakeBool(is_signed ? bits_ops::SLessThan(a, b)
+                                             : bits_ops::ULessThan(a, b));
+    case Bytecode::Op::kLe:
+      return InterpValue::MakeBool(is_signed
+                                       ? bits_ops::SLessThanOrEqual(a, b)
+                                       : bits_ops::ULessThanOrEqual(a, b));
+    case Bytecode::Op::kGt:
+      return InterpValue::MakeBool(is_signed ? bits_ops::SGreaterThan(a, b)
+                                             : bits_ops::UGreaterThan(a, b));
+    case Bytecode::Op::kGe:
+      return InterpValue::MakeBool(is_signed
+                                       ? bits_ops::SGreaterThanOrEqual(a, b)
+                                       : bits_ops::UGreaterThanOrEqual(a, b));
+    default:
+      return absl::nullopt;
+  }
+}
+
+}  // namespace
+
+bool BytecodeInterpreter::EvalFastPath(Frame* frame,
+                                       const Bytecode& bytecode) {
+  switch (bytecode.op()) {
+    case Bytecode::Op::kJumpDest:
+      frame->IncrementPc();
+      return true;
+    case Bytecode::Op::kRegBinop:
+    case Bytecode::Op::kRegBinopStore:
+    case Bytecode::Op::kRegCompareJumpRelIf:
+      break;
+    default:
+      return false;
+  }
+
+  if (!bytecode.has_data()) {
+    return false;
+  }
+  const auto* data =
+      absl::get_if<Bytecode::RegisterOpData>(&bytecode.data().value());
+  if (data == nullptr ||
+      (bytecode.op() == Bytecode::Op::kRegBinopStore &&
+       !data->dest.has_value()) ||
+      (bytecode.op() == Bytecode::Op::kRegCompareJumpRelIf &&
+       !data->target.has_value())) {
+    return false;
+  }
+  const InterpValue* lhs = GetRegisterOperand(frame->slots(), data->lhs);
+  const InterpValue* rhs = GetRegisterOperand(frame->slots(), data->rhs);
+  if (lhs == nullptr || rhs == nullptr) {
+    return false;
+  }
+  absl::optional<InterpValue> result = EvalBitsBinop(data->op, *lhs, *rhs);
+  if (!result.has_value()) {
+    return false;
+  }
+
+  if (bytecode.op() == Bytecode::Op::kRegBinop) {
+    stack_.push_back(std::move(result.value()));
+  } else if (bytecode.op() == Bytecode::Op::kRegBinopStore) {
+    frame->StoreSlot(data->dest.value(), std::move(result.value()));
+  } else if (result->IsTrue()) {
+    frame->set_pc(frame->pc() + data->target->value());
+    return true;
+  }
+  frame->IncrementPc();
+  return true;
+}
+
 absl::StatusOr<InterpValue> BytecodeInterpreter::Pop() {
   if (stack_.empty()) {
     return absl::InternalError("Tried to pop off an empty stack.");
@@ -802,6 +940,95 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
   return absl::OkStatus();
 }
 
+absl::StatusOr<InterpValue> BytecodeInterpreter::LoadRegisterOperand(
+    const Bytecode::RegisterOperand& operand) {
+  if (absl::holds_alternative<InterpValue>(operand)) {
+    return absl::get<InterpValue>(operand);
+  }
+  Bytecode::SlotIndex slot = absl::get<Bytecode::SlotIndex>(operand);
+  if (frames_.back().slots().size() <= slot.value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Attempted to access local data in slot %d, which is out of range.",
+        slot.value()));
+  }
+  return frames_.back().slots().at(slot.value());
+}
+
+absl::Status BytecodeInterpreter::EvalRegBinop(const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::RegisterOpData* data,
+                       bytecode.register_op_data());
+  XLS_ASSIGN_OR_RETURN(InterpValue lhs, LoadRegisterOperand(data->lhs));
+  XLS_ASSIGN_OR_RETURN(InterpValue rhs, LoadRegisterOperand(data->rhs));
+  stack_.push_back(std::move(lhs));
+  stack_.push_back(std::move(rhs));
+  return EvalBinaryOp(data->op, bytecode);
+}
+
+absl::Status BytecodeInterpreter::EvalRegBinopStore(const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::RegisterOpData* data,
+                       bytecode.register_op_data());
+  XLS_RET_CHECK(data->dest.has_value());
+  XLS_RETURN_IF_ERROR(EvalRegBinop(bytecode));
+  XLS_ASSIGN_OR_RETURN(InterpValue result, Pop());
+  frames_.back().StoreSlot(data->dest.value(), std::move(result));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::optional<int64_t>>
+BytecodeInterpreter::EvalRegCompareJumpRelIf(int64_t pc,
+                                             const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::RegisterOpData* data,
+                       bytecode.register_op_data());
+  XLS_RET_CHECK(data->target.has_value());
+  XLS_RETURN_IF_ERROR(EvalRegBinop(bytecode));
+  XLS_ASSIGN_OR_RETURN(InterpValue result, Pop());
+  if (result.IsTrue()) {
+    return pc + data->target->value();
+  }
+  return std::nullopt;
+}
+
+absl::Status BytecodeInterpreter::EvalBinaryOp(Bytecode::Op op,
+                                               const Bytecode& bytecode) {
+  switch (op) {
+    case Bytecode::Op::kAdd:
+      return EvalAdd(bytecode);
+    case Bytecode::Op::kAnd:
+      return EvalAnd(bytecode);
+    case Bytecode::Op::kConcat:
+      return EvalConcat(bytecode);
+    case Bytecode::Op::kDiv:
+      return EvalDiv(bytecode);
+    case Bytecode::Op::kEq:
+      return EvalEq(bytecode);
+    case Bytecode::Op::kGe:
+      return EvalGe(bytecode);
+    case Bytecode::Op::kGt:
+      return EvalGt(bytecode);
+    case Bytecode::Op::kLe:
+      return EvalLe(bytecode);
+    case Bytecode::Op::kLt:
+      return EvalLt(bytecode);
+    case Bytecode::Op::kMul:
+      return EvalMul(bytecode);
+    case Bytecode::Op::kNe:
+      return EvalNe(bytecode);
+    case Bytecode::Op::kOr:
+      return EvalOr(bytecode);
+    case Bytecode::Op::kShl:
+      return EvalShl(bytecode);
+    case Bytecode::Op::kShr:
+      return EvalShr(bytecode);
+    case Bytecode::Op::kSub:
+      return EvalSub(bytecode);
+    case Bytecode::Op::kXor:
+      return EvalXor(bytecode);
+    default:
+      return absl::InternalError(absl::StrCat(
+          "Not a register-form binary op: ", OpToString(op)));
+  }
+}
+
 absl::Status BytecodeInterpreter::EvalShl(const Bytecode& bytecode) {
   return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
     return lhs.Shl(rhs);
@@ -1282,6 +1509,7 @@ absl::Status BytecodeInterpreter::RunBuiltinMap(const Bytecode& bytecode) {
 
   // Now take the collected bytecodes and cram them into a BytecodeFunction,
   // then start executing it.
+  XLS_ASSIGN_OR_RETURN(bytecodes, FuseSuperinstructions(std::move(bytecodes)));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeFunction::Create(/*source=*/nullptr, frames_.back().type_info(),
@@ -82,6 +82,13 @@ class BytecodeInterpreter {
   // when the PC is already pointing to the end of the bytecode.
   absl::Status EvalNextInstruction();
 
+  // Attempts to run the given instruction of the current frame without any
+  // error handling; this covers register-form instructions over bits values,
+  // which make up the bulk of loop bodies and headers. Returns false (without
+  // side effects) if the instruction needs the general path, i.e.,
+  // EvalNextInstruction(), which also reports any errors.
+  bool EvalFastPath(Frame* frame, const Bytecode& bytecode);
+
   absl::Status EvalAdd(const Bytecode& bytecode);
   absl::Status EvalAnd(const Bytecode& bytecode);
   absl::Status EvalCall(const Bytecode& bytecode);
@@ -111,6 +118,8 @@ class BytecodeInterpreter {
   absl::Status EvalOr(const Bytecode& bytecode);
   absl::Status EvalPop(const Bytecode& bytecode);
   absl::Status EvalRecv(const Bytecode& bytecode);
+  absl::Status EvalRegBinop(const Bytecode& bytecode);
+  absl::Status EvalRegBinopStore(const Bytecode& bytecode);
   absl::Status EvalSend(const Bytecode& bytecode);
   absl::Status EvalShl(const Bytecode& bytecode);
   absl::Status EvalShr(const Bytecode& bytecode);
@@ -133,6 +142,14 @@ class BytecodeInterpreter {
       const absl::optional<SymbolicBindings>& caller_bindings);
   absl::StatusOr<std::optional<int64_t>> EvalJumpRelIf(
       int64_t pc, const Bytecode& bytecode);
+  absl::StatusOr<std::optional<int64_t>> EvalRegCompareJumpRelIf(
+      int64_t pc, const Bytecode& bytecode);
+
+  // Applies the stack-form binary op `op` to the top two values on the stack,
+  // as the corresponding standalone instruction would.
+  absl::Status EvalBinaryOp(Bytecode::Op op, const Bytecode& bytecode);
+  absl::StatusOr<InterpValue> LoadRegisterOperand(
+      const Bytecode::RegisterOperand& operand);
 
   // TODO(rspringer): 2022-02-14: Builtins should probably go in their own file,
   // likely after removing the old interpreter.
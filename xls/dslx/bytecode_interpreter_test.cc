@@ -1187,5 +1187,64 @@ fn main(p: bool, x: u32) -> u32 {
   EXPECT_EQ(int_value, 0x0);
 }
 
+// Verifies that register-form superinstructions compute the same results as
+// the stack-form bytecode they replace, including for ops and operands that
+// aren't handled by the interpreter's fast path.
+TEST(BytecodeInterpreterTest, SuperinstructionsMatchStackForm) {
+  constexpr absl::string_view kProgram = R"(
+fn helper(x: s8, y: s8) -> s8 {
+  if x < y { y - x } else { x - y }
+}
+
+fn main() -> (u32, s8, u64, u32) {
+  let a = u32:7;
+  let total = for (i, accum) : (u32, u32) in range(u32:0, u32:10) {
+    let doubled = i * u32:2;
+    let masked = doubled & a;
+    accum + masked ^ (i << u32:1)
+  }(u32:0);
+  let diff = helper(s8:-3, s8:4);
+  let wide = a ++ total;
+  let sel = if total >= a { total / a } else { u32:0 };
+  (total, diff, wide as u64, sel)
+})";
+
+  std::vector<InterpValue> results;
+  for (bool fuse_superinstructions : {false, true}) {
+    auto import_data = CreateImportDataForTest();
+    XLS_ASSERT_OK_AND_ASSIGN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                             tm.module->GetFunctionOrError("main"));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<BytecodeFunction> bf,
+        BytecodeEmitter::Emit(&import_data, tm.type_info, f,
+                              SymbolicBindings(), fuse_superinstructions));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpValue result,
+        BytecodeInterpreter::Interpret(&import_data, bf.get(), {}));
+    results.push_back(result);
+  }
+  EXPECT_EQ(results[0], results[1]) << results[0].ToString() << " vs "
+                                    << results[1].ToString();
+}
+
+TEST(BytecodeInterpreterTest, RegBinopOutOfRangeSlot) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.emplace_back(
+      kFakeSpan, Bytecode::Op::kRegBinop,
+      Bytecode::RegisterOpData{Bytecode::Op::kAdd, Bytecode::SlotIndex(5),
+                               InterpValue::MakeU32(1), absl::nullopt,
+                               absl::nullopt});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto bfunc,
+      BytecodeFunction::Create(/*source=*/nullptr, /*type_info=*/nullptr,
+                               std::move(bytecodes)));
+  EXPECT_THAT(
+      BytecodeInterpreter::Interpret(/*import_data=*/nullptr, bfunc.get(), {}),
+      StatusIs(absl::StatusCode::kInternal, HasSubstr("out of range")));
+}
+
 }  // namespace
 }  // namespace xls::dslx
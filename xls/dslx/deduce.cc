@@ -14,6 +14,8 @@
 
 #include "xls/dslx/deduce.h"
 
+#include <algorithm>
+
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/btree_set.h"
 #include "absl/status/status.h"
@@ -2325,11 +2327,51 @@ absl::StatusOr<TypeAndBindings> DeduceParametricCall(
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(
-      TypeAndBindings tab,
-      InstantiateFunction(invocation->span(), *callee_type, args, ctx,
-                          /*parametric_constraints=*/parametric_constraints,
-                          /*explicit_constraints=*/&explicit_bindings));
+  // The instantiation is memoized when it is fully determined by the callee,
+  // the explicit bindings and the argument types; i.e. when every parametric
+  // given in the invocation was mapped to a caller binding above.
+  bool memoizable = std::all_of(
+      parametric_constraints.begin(),
+      parametric_constraints.begin() + invocation->parametrics().size(),
+      [&](const ParametricConstraint& constraint) {
+        return explicit_bindings.contains(constraint.identifier());
+      });
+  SymbolicBindings explicit_symbolic_bindings(explicit_bindings);
+  std::vector<const ConcreteType*> arg_types;
+  arg_types.reserve(args.size());
+  for (const InstantiateArg& arg : args) {
+    arg_types.push_back(arg.type.get());
+  }
+  absl::optional<TypeAndBindings> memoized;
+  if (memoizable) {
+    memoized = ctx->instantiation_cache().Get(f, explicit_symbolic_bindings,
+                                              arg_types);
+  }
+  TypeAndBindings tab;
+  if (memoized.has_value()) {
+    XLS_VLOG(5) << "Using memoized instantiation of " << f->identifier()
+                << ": " << memoized->symbolic_bindings;
+    tab = std::move(memoized).value();
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        tab, InstantiateFunction(
+                 invocation->span(), *callee_type, args, ctx,
+                 /*parametric_constraints=*/parametric_constraints,
+                 /*explicit_constraints=*/&explicit_bindings));
+    // Constraints which could not be evaluated yet are left unbound, in which
+    // case the instantiation may differ once more is known.
+    absl::flat_hash_map<std::string, InterpValue> callee_bindings =
+        tab.symbolic_bindings.ToMap();
+    bool all_bound = std::all_of(
+        parametric_constraints.begin(), parametric_constraints.end(),
+        [&](const ParametricConstraint& constraint) {
+          return callee_bindings.contains(constraint.identifier());
+        });
+    if (memoizable && all_bound) {
+      ctx->instantiation_cache().Add(f, explicit_symbolic_bindings, arg_types,
+                                     tab);
+    }
+  }
   const SymbolicBindings& callee_symbolic_bindings = tab.symbolic_bindings;
 
   if (f->IsParametric()) {
@@ -14,6 +14,8 @@
 
 #include "xls/dslx/deduce_ctx.h"
 
+#include <algorithm>
+
 #include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
@@ -36,7 +38,46 @@ DeduceCtx::DeduceCtx(TypeInfo* type_info, Module* module,
       deduce_function_(std::move(XLS_DIE_IF_NULL(deduce_function))),
       typecheck_function_(std::move(typecheck_function)),
       typecheck_module_(std::move(typecheck_module)),
-      import_data_(import_data) {}
+      import_data_(import_data),
+      instantiation_cache_(std::make_shared<InstantiationCache>()) {}
+
+absl::optional<TypeAndBindings> InstantiationCache::Get(
+    const Function* callee, const SymbolicBindings& explicit_bindings,
+    absl::Span<const ConcreteType* const> arg_types) const {
+  auto it = entries_.find(std::make_pair(callee, explicit_bindings));
+  if (it == entries_.end()) {
+    return absl::nullopt;
+  }
+  for (const Entry& entry : it->second) {
+    if (entry.arg_types.size() != arg_types.size() ||
+        !std::equal(arg_types.begin(), arg_types.end(),
+                    entry.arg_types.begin(),
+                    [](const ConcreteType* lhs,
+                       const std::unique_ptr<ConcreteType>& rhs) {
+                      return *lhs == *rhs;
+                    })) {
+      continue;
+    }
+    return TypeAndBindings{entry.type_and_bindings.type->CloneToUnique(),
+                           entry.type_and_bindings.symbolic_bindings};
+  }
+  return absl::nullopt;
+}
+
+void InstantiationCache::Add(const Function* callee,
+                             const SymbolicBindings& explicit_bindings,
+                             absl::Span<const ConcreteType* const> arg_types,
+                             const TypeAndBindings& type_and_bindings) {
+  Entry entry;
+  for (const ConcreteType* arg_type : arg_types) {
+    entry.arg_types.push_back(arg_type->CloneToUnique());
+  }
+  entry.type_and_bindings =
+      TypeAndBindings{type_and_bindings.type->CloneToUnique(),
+                      type_and_bindings.symbolic_bindings};
+  entries_[std::make_pair(callee, explicit_bindings)].push_back(
+      std::move(entry));
+}
 
 // Helper that converts the symbolic bindings to a parametric expression
 // environment (for parametric evaluation).
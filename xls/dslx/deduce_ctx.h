@@ -16,12 +16,20 @@
 #define XLS_DSLX_DEDUCE_CTX_H_
 
 #include <filesystem>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/dslx/concrete_type.h"
 #include "xls/dslx/import_routines.h"
 #include "xls/dslx/interp_bindings.h"
+#include "xls/dslx/symbolic_bindings.h"
+#include "xls/dslx/type_and_bindings.h"
 
 namespace xls::dslx {
 
@@ -78,6 +86,38 @@ using DeduceFn = std::function<absl::StatusOr<std::unique_ptr<ConcreteType>>(
 // generally used for typechecking parametric instantiations).
 using TypecheckFunctionFn = std::function<absl::Status(Function*, DeduceCtx*)>;
 
+// Memoizes parametric function instantiations (see InstantiateFunction())
+// within a typechecking session.
+//
+// An instantiation is fully determined by the callee, the bindings given by the
+// caller and the argument types. Memoizing it avoids re-evaluating the callee's
+// parametric expressions every time an invocation with the same instantiation
+// is deduced (including the re-deduction of an invocation after the body of the
+// callee has been typechecked).
+class InstantiationCache {
+ public:
+  // Returns the memoized instantiation of `callee`, if any.
+  absl::optional<TypeAndBindings> Get(
+      const Function* callee, const SymbolicBindings& explicit_bindings,
+      absl::Span<const ConcreteType* const> arg_types) const;
+
+  // Notes `type_and_bindings` as the instantiation of `callee`.
+  void Add(const Function* callee, const SymbolicBindings& explicit_bindings,
+           absl::Span<const ConcreteType* const> arg_types,
+           const TypeAndBindings& type_and_bindings);
+
+ private:
+  struct Entry {
+    std::vector<std::unique_ptr<ConcreteType>> arg_types;
+    TypeAndBindings type_and_bindings;
+  };
+
+  // Entries with the same key are distinguished by their argument types.
+  absl::flat_hash_map<std::pair<const Function*, SymbolicBindings>,
+                      std::vector<Entry>>
+      entries_;
+};
+
 // A single object that contains all the state/callbacks used in the
 // typechecking process.
 class DeduceCtx {
@@ -89,12 +129,15 @@ class DeduceCtx {
   // Creates a new DeduceCtx reflecting the given type info and module.
   // Uses the same callbacks as this current context.
   //
-  // Note that the resulting DeduceCtx has an empty fn_stack.
+  // Note that the resulting DeduceCtx has an empty fn_stack but shares the
+  // instantiation cache of this context.
   std::unique_ptr<DeduceCtx> MakeCtx(TypeInfo* new_type_info,
                                      Module* new_module) const {
-    return std::make_unique<DeduceCtx>(new_type_info, new_module,
-                                       deduce_function_, typecheck_function_,
-                                       typecheck_module_, import_data_);
+    auto ctx = std::make_unique<DeduceCtx>(
+        new_type_info, new_module, deduce_function_, typecheck_function_,
+        typecheck_module_, import_data_);
+    ctx->instantiation_cache_ = instantiation_cache_;
+    return ctx;
   }
 
   // Helper that calls back to the top-level deduce procedure for the given
@@ -152,6 +195,10 @@ class DeduceCtx {
   bool inside_for() const { return inside_for_; }
   void set_inside_for(bool inside_for) { inside_for_ = inside_for; }
 
+  InstantiationCache& instantiation_cache() const {
+    return *instantiation_cache_;
+  }
+
  private:
   // Maps AST nodes to their deduced types.
   TypeInfo* type_info_ = nullptr;
@@ -181,6 +228,10 @@ class DeduceCtx {
   // member.
   bool inside_for_ = false;
 
+  // Memoized parametric instantiations, shared with the contexts created via
+  // MakeCtx().
+  std::shared_ptr<InstantiationCache> instantiation_cache_;
+
   // -- Metadata
 
   // Keeps track of the function we're currently typechecking and the symbolic
@@ -26,6 +26,8 @@
 
 namespace xls::dslx {
 
+class ModuleCache;
+
 // An entry that goes into the ImportData.
 struct ModuleInfo {
   std::unique_ptr<Module> module;
@@ -146,6 +148,14 @@ class ImportData {
   void SetBytecodeCache(std::unique_ptr<BytecodeCacheInterface> bytecode_cache);
   BytecodeCacheInterface* bytecode_cache();
 
+  // Sets the on-disk cache from which imported modules are restored instead of
+  // being typechecked, see module_cache.h. Not owned; may be nullptr to
+  // disable the cache.
+  void SetModuleCache(ModuleCache* module_cache) {
+    module_cache_ = module_cache;
+  }
+  ModuleCache* module_cache() const { return module_cache_; }
+
  private:
   friend ImportData CreateImportData(std::string,
                                      absl::Span<const std::filesystem::path>);
@@ -167,6 +177,7 @@ class ImportData {
   std::string stdlib_path_;
   absl::Span<const std::filesystem::path> additional_search_paths_;
   std::unique_ptr<BytecodeCacheInterface> bytecode_cache_;
+  ModuleCache* module_cache_ = nullptr;
 };
 
 }  // namespace xls::dslx
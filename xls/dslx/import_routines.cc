@@ -20,6 +20,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/dslx/module_cache.h"
 #include "xls/dslx/parser.h"
 #include "xls/dslx/scanner.h"
 
@@ -120,6 +121,42 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
+// Typechecks "module" (just parsed from "contents"), restoring its type
+// information from the module cache if possible.
+static absl::StatusOr<TypeInfo*> TypecheckViaModuleCache(
+    const TypecheckFn& ftypecheck, Module* module, absl::string_view contents,
+    ModuleCache* module_cache, ImportData* import_data) {
+  // The cache key covers the modules imported by "module", so these have to be
+  // imported up front (type checking would import them anyway).
+  for (const ModuleMember& member : module->top()) {
+    if (absl::holds_alternative<Import*>(member)) {
+      Import* import = absl::get<Import*>(member);
+      XLS_RETURN_IF_ERROR(DoImport(ftypecheck, ImportTokens(import->subject()),
+                                   import_data, import->span())
+                              .status());
+    }
+  }
+  XLS_RETURN_IF_ERROR(
+      module_cache->AddModule(*module, contents, import_data).status());
+
+  absl::StatusOr<TypeInfo*> restored =
+      module_cache->Restore(module, import_data);
+  if (restored.ok()) {
+    return restored.value();
+  }
+  if (!absl::IsNotFound(restored.status())) {
+    XLS_LOG(WARNING) << "Ignoring module cache entry for " << module->name()
+                     << ": " << restored.status();
+  }
+
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module));
+  if (absl::Status saved = module_cache->Save(*module, *type_info);
+      !saved.ok()) {
+    XLS_VLOG(1) << "Not caching module " << module->name() << ": " << saved;
+  }
+  return type_info;
+}
+
 absl::StatusOr<const ModuleInfo*> DoImport(
     const TypecheckFn& ftypecheck, const ImportTokens& subject,
     ImportData* import_data, const Span& import_span) {
@@ -144,7 +181,15 @@ absl::StatusOr<const ModuleInfo*> DoImport(
   Scanner scanner(found_path, contents);
   Parser parser(/*module_name=*/fully_qualified_name, &scanner);
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
-  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
+  TypeInfo* type_info;
+  if (ModuleCache* module_cache = import_data->module_cache()) {
+    XLS_ASSIGN_OR_RETURN(type_info,
+                         TypecheckViaModuleCache(ftypecheck, module.get(),
+                                                 contents, module_cache,
+                                                 import_data));
+  } else {
+    XLS_ASSIGN_OR_RETURN(type_info, ftypecheck(module.get()));
+  }
   return import_data->Put(subject, ModuleInfo{std::move(module), type_info});
 }
 
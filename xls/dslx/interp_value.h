@@ -333,6 +333,35 @@ class InterpValue {
   bool operator==(const InterpValue& rhs) const;
   bool operator!=(const InterpValue& rhs) const { return !(*this == rhs); }
 
+  // Hashes the value structurally, consistent with operator==; e.g. bits-like
+  // values hash only their bit pattern as they compare equal regardless of
+  // signedness.
+  template <typename H>
+  friend H AbslHashValue(H h, const InterpValue& v) {
+    switch (v.tag_) {
+      case InterpValueTag::kUBits:
+      case InterpValueTag::kSBits:
+      case InterpValueTag::kEnum:
+        return H::combine(std::move(h), absl::get<Bits>(v.payload_));
+      case InterpValueTag::kTuple:
+      case InterpValueTag::kArray:
+        return H::combine(std::move(h), v.tag_,
+                          absl::get<std::vector<InterpValue>>(v.payload_));
+      case InterpValueTag::kFunction:
+        return H::combine(std::move(h), v.tag_,
+                          absl::get<FnData>(v.payload_));
+      case InterpValueTag::kToken:
+        return H::combine(
+            std::move(h), v.tag_,
+            absl::get<std::shared_ptr<TokenData>>(v.payload_).get());
+      case InterpValueTag::kChannel:
+        return H::combine(
+            std::move(h), v.tag_,
+            absl::get<std::shared_ptr<Channel>>(v.payload_).get());
+    }
+    return h;
+  }
+
   // Lt() only performs comparisons on bits-valued InterpValues, whereas this
   // compares across Bits-, array-, and tuple-valued objects. For this set, the
   // ordering Bits < arrays < tuples has been arbitrarily defined.
@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/hash/hash_testing.h"
 #include "xls/common/status/matchers.h"
 
 namespace xls::dslx {
@@ -49,6 +50,31 @@ TEST(InterpValueTest, BitsEquivalence) {
   EXPECT_NE(a, b);
 }
 
+TEST(InterpValueTest, Hash) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue array_a,
+      InterpValue::MakeArray({InterpValue::MakeUBits(8, 1),
+                              InterpValue::MakeUBits(8, 2)}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue array_b,
+      InterpValue::MakeArray({InterpValue::MakeUBits(8, 1),
+                              InterpValue::MakeUBits(8, 3)}));
+  // Signed and unsigned values with the same bit pattern compare equal.
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      InterpValue::MakeToken(),
+      InterpValue::MakeUBits(/*bit_count=*/0, /*value=*/0),
+      InterpValue::MakeUBits(/*bit_count=*/8, /*value=*/0),
+      InterpValue::MakeUBits(/*bit_count=*/8, /*value=*/42),
+      InterpValue::MakeSBits(/*bit_count=*/8, /*value=*/42),
+      InterpValue::MakeUBits(/*bit_count=*/32, /*value=*/42),
+      InterpValue::MakeUnit(),
+      InterpValue::MakeTuple({InterpValue::MakeUBits(8, 1),
+                              InterpValue::MakeUBits(8, 2)}),
+      array_a,
+      array_b,
+  }));
+}
+
 TEST(InterpValueTest, FlattenArrayOfBits) {
   auto a = InterpValue::MakeUBits(/*bit_count=*/12, /*value=*/0xf00);
   auto b = InterpValue::MakeUBits(/*bit_count=*/12, /*value=*/0xba5);
@@ -45,6 +45,26 @@ ABSL_FLAG(std::string, test_filter, "",
 ABSL_FLAG(bool, bytecode, true,
           "If true, use the in-development bytecode interpreter to execute.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
+ABSL_FLAG(int64_t, num_threads, 1,
+          "Number of threads used to run tests and quickcheck samples; 0 for "
+          "one per hardware thread. Trace output of tests which run "
+          "concurrently may be interleaved.");
+ABSL_FLAG(std::string, module_cache_dir, "",
+          "Directory in which typechecked imported modules are cached across "
+          "invocations (see xls/dslx/module_cache.h); no caching if empty.");
+ABSL_FLAG(bool, jit_tests, false,
+          "If true, converts test functions to IR and runs them in the JIT; "
+          "tests which use procs or produce trace output still run in the "
+          "interpreter selected by --bytecode.");
+ABSL_FLAG(bool, compare_jit_tests, false,
+          "With --jit_tests, also runs each JIT-executed test in the bytecode "
+          "interpreter and fails the test if the outcomes differ.");
+ABSL_FLAG(bool, quickcheck_corner_cases, false,
+          "If true, biases quickcheck samples towards corner cases (zero, "
+          "one, all ones, min/max signed values per bit field).");
+ABSL_FLAG(int64_t, max_exhaustive_quickcheck_bits, -1,
+          "Quickchecks whose arguments have at most this many bits in total "
+          "are checked on every possible input; -1 to disable.");
 
 namespace xls::dslx {
 namespace {
@@ -88,7 +108,18 @@ absl::Status RealMain(absl::string_view entry_module_path,
       .execute = execute,
       .seed = seed,
       .bytecode = absl::GetFlag(FLAGS_bytecode),
+      .num_threads = absl::GetFlag(FLAGS_num_threads),
+      .jit_tests = absl::GetFlag(FLAGS_jit_tests),
+      .compare_jit_tests = absl::GetFlag(FLAGS_compare_jit_tests),
+      .quickcheck_corner_cases = absl::GetFlag(FLAGS_quickcheck_corner_cases),
   };
+  if (int64_t bits = absl::GetFlag(FLAGS_max_exhaustive_quickcheck_bits);
+      bits >= 0) {
+    options.max_exhaustive_quickcheck_bits = bits;
+  }
+  if (!absl::GetFlag(FLAGS_module_cache_dir).empty()) {
+    options.module_cache_dir = absl::GetFlag(FLAGS_module_cache_dir);
+  }
   XLS_ASSIGN_OR_RETURN(
       TestResult test_result,
       ParseAndTest(program, module_name, entry_module_path, options));
@@ -24,11 +24,15 @@
 
 #include "xls/dslx/ir_converter.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "absl/status/status.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
+#include "xls/common/parallel_for.h"
 #include "xls/dslx/ast.h"
 #include "xls/dslx/builtins_metadata.h"
 #include "xls/dslx/deduce_ctx.h"
@@ -42,6 +46,8 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value_helpers.h"
 
 namespace xls::dslx {
 namespace {
@@ -52,8 +58,18 @@ struct PackageData {
   Package* package;
   absl::flat_hash_map<xls::FunctionBase*, dslx::Function*> ir_to_dslx;
   absl::flat_hash_set<xls::Function*> wrappers;
+
+  // When converting into a scratch package (see ConvertCallGraphInParallel())
+  // this is the data of the package the scratch package is merged into.
+  // Functions already converted into that package are referenced via stubs:
+  // declarations with the same signature which are replaced on merge.
+  const PackageData* parent = nullptr;
+  absl::flat_hash_set<xls::Function*> stubs;
 };
 
+// TODO(leary): 2019-07-19 Create a way to get the file path from the module.
+constexpr absl::string_view kFakeFilename = "fake_file.x";
+
 // Returns a status that indicates an error in the IR conversion process.
 absl::Status ConversionErrorStatus(const absl::optional<Span>& span,
                                    absl::string_view message) {
@@ -354,6 +370,10 @@ class FunctionConverter {
   // Handles the cover!() builtin invocation.
   absl::Status HandleCoverBuiltin(Invocation* node, BValue condition);
 
+  // Handles the assert_eq() and assert_lt() builtin invocations.
+  absl::Status HandleAssertBuiltin(Invocation* node, absl::string_view name,
+                                   BValue lhs, BValue rhs);
+
   // Handles an arm of a match expression.
   absl::StatusOr<BValue> HandleMatcher(NameDefTree* matcher,
                                        absl::Span<const int64_t> index,
@@ -486,6 +506,15 @@ class FunctionConverter {
 
   Package* package() const { return package_data_.package; }
 
+  // Returns whether a function with the given name has been converted, see
+  // GetConvertedFunction().
+  bool HasConvertedFunction(absl::string_view name) const;
+
+  // Returns the converted function with the given name. When converting into a
+  // scratch package, functions converted into the parent package are declared
+  // in the scratch package via stubs.
+  absl::StatusOr<xls::Function*> GetConvertedFunction(absl::string_view name);
+
   // Package that IR is being generated into.
   PackageData& package_data_;
 
@@ -780,9 +809,7 @@ FunctionConverter::FunctionConverter(
       module_(module),
       import_data_(import_data),
       options_(std::move(options)),
-      // TODO(leary): 2019-07-19 Create a way to get the file path from the
-      // module.
-      fileno_(package_data.package->GetOrCreateFileno("fake_file.x")),
+      fileno_(package_data.package->GetOrCreateFileno(kFakeFilename)),
       proc_id_to_members_(proc_id_to_members),
       is_top_(is_top) {
   XLS_VLOG(5) << "Constructed IR converter: " << this;
@@ -799,6 +826,63 @@ void FunctionConverter::AddConstantDep(ConstantDef* constant_def) {
   constant_deps_.push_back(constant_def);
 }
 
+// Builds an arbitrary value of the given type (used as the result of stubs).
+static BValue StubValue(xls::Type* type, FunctionBuilder* fb) {
+  if (!TypeHasToken(type)) {
+    return fb->Literal(ZeroOfType(type));
+  }
+  if (type->IsToken()) {
+    return fb->AfterAll({});
+  }
+  if (type->IsTuple()) {
+    std::vector<BValue> elements;
+    for (xls::Type* element_type : type->AsTupleOrDie()->element_types()) {
+      elements.push_back(StubValue(element_type, fb));
+    }
+    return fb->Tuple(elements);
+  }
+  xls::ArrayType* array_type = type->AsArrayOrDie();
+  std::vector<BValue> elements(
+      array_type->size(), StubValue(array_type->element_type(), fb));
+  return fb->Array(elements, array_type->element_type());
+}
+
+bool FunctionConverter::HasConvertedFunction(absl::string_view name) const {
+  return package()->HasFunctionWithName(name) ||
+         (package_data_.parent != nullptr &&
+          package_data_.parent->package->HasFunctionWithName(name));
+}
+
+absl::StatusOr<xls::Function*> FunctionConverter::GetConvertedFunction(
+    absl::string_view name) {
+  if (package()->HasFunctionWithName(name) ||
+      package_data_.parent == nullptr ||
+      !package_data_.parent->package->HasFunctionWithName(name)) {
+    return package()->GetFunction(name);
+  }
+
+  XLS_ASSIGN_OR_RETURN(xls::Function * f,
+                       package_data_.parent->package->GetFunction(name));
+  XLS_VLOG(5) << "Declaring stub for converted function: " << f->name();
+  FunctionBuilder fb(f->name(), package());
+  for (xls::Param* param : f->params()) {
+    XLS_ASSIGN_OR_RETURN(xls::Type * type,
+                         package()->MapTypeFromOtherPackage(param->GetType()));
+    fb.Param(param->name(), type);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      xls::Type * return_type,
+      package()->MapTypeFromOtherPackage(f->GetType()->return_type()));
+  XLS_ASSIGN_OR_RETURN(xls::Function * stub,
+                       fb.BuildWithReturnValue(StubValue(return_type, &fb)));
+  package_data_.stubs.insert(stub);
+  if (auto it = package_data_.parent->ir_to_dslx.find(f);
+      it != package_data_.parent->ir_to_dslx.end()) {
+    package_data_.ir_to_dslx[stub] = it->second;
+  }
+  return stub;
+}
+
 absl::Status FunctionConverter::DefAlias(AstNode* from, AstNode* to) {
   XLS_RET_CHECK_NE(from, to);
   auto it = node_to_ir_.find(from);
@@ -1751,7 +1835,7 @@ absl::StatusOr<BValue> FunctionConverter::HandleMap(Invocation* node) {
                      free_set, node_sym_bindings.value()));
   XLS_VLOG(5) << "Getting function with mangled name: " << mangled_name
               << " from package: " << package()->name();
-  XLS_ASSIGN_OR_RETURN(xls::Function * f, package()->GetFunction(mangled_name));
+  XLS_ASSIGN_OR_RETURN(xls::Function * f, GetConvertedFunction(mangled_name));
   return Def(node, [&](absl::optional<SourceLocation> loc) -> BValue {
     return function_builder_->Map(arg, f, loc);
   });
@@ -1901,6 +1985,42 @@ absl::Status FunctionConverter::HandleFailBuiltin(Invocation* node,
   return absl::OkStatus();
 }
 
+absl::Status FunctionConverter::HandleAssertBuiltin(Invocation* node,
+                                                    absl::string_view name,
+                                                    BValue lhs, BValue rhs) {
+  if (options_.emit_fail_as_assert) {
+    XLS_RET_CHECK(implicit_token_data_.has_value())
+        << "Invoking " << name
+        << "(), but no implicit token is present for caller @ "
+        << node->span();
+    XLS_RET_CHECK(implicit_token_data_->create_control_predicate != nullptr);
+    BValue holds;
+    if (name == "assert_eq") {
+      holds = function_builder_->Eq(lhs, rhs);
+    } else {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> lhs_type,
+                           ResolveType(node->args()[0]));
+      XLS_ASSIGN_OR_RETURN(bool is_signed, IsSigned(*lhs_type));
+      holds = is_signed ? function_builder_->SLt(lhs, rhs)
+                        : function_builder_->ULt(lhs, rhs);
+    }
+    // The assertion only fires if control reaches this program point.
+    BValue control_predicate = implicit_token_data_->create_control_predicate();
+    std::string message = absl::StrFormat("Assertion failure via %s @ %s",
+                                          name, node->span().ToString());
+    BValue assert_result_token = function_builder_->Assert(
+        implicit_token_data_->entry_token,
+        function_builder_->Or(function_builder_->Not(control_predicate),
+                              holds),
+        message);
+    implicit_token_data_->control_tokens.push_back(assert_result_token);
+  }
+  Def(node, [&](absl::optional<SourceLocation> loc) {
+    return function_builder_->Tuple({}, loc);
+  });
+  return absl::OkStatus();
+}
+
 absl::Status FunctionConverter::HandleFormatMacro(FormatMacro* node) {
   XLS_RET_CHECK(implicit_token_data_.has_value())
       << "Invoking trace_fmt!(), but no implicit token is present for caller @ "
@@ -1968,9 +2088,8 @@ absl::Status FunctionConverter::HandleInvocation(Invocation* node) {
     return values;
   };
 
-  if (package()->HasFunctionWithName(called_name)) {
-    XLS_ASSIGN_OR_RETURN(xls::Function * f,
-                         package()->GetFunction(called_name));
+  if (HasConvertedFunction(called_name)) {
+    XLS_ASSIGN_OR_RETURN(xls::Function * f, GetConvertedFunction(called_name));
     XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
     return HandleUdfInvocation(node, f, std::move(args));
   }
@@ -1987,6 +2106,11 @@ absl::Status FunctionConverter::HandleInvocation(Invocation* node) {
     XLS_RET_CHECK_EQ(args.size(), 2)
         << called_name << " builtin requires two arguments";
     return HandleCoverBuiltin(node, std::move(args[1]));
+  } else if (called_name == "assert_eq" || called_name == "assert_lt") {
+    XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
+    XLS_RET_CHECK_EQ(args.size(), 2)
+        << called_name << " builtin requires two arguments";
+    return HandleAssertBuiltin(node, called_name, args[0], args[1]);
   } else if (called_name == "trace!") {
     XLS_ASSIGN_OR_RETURN(std::vector<BValue> args, accept_args());
     XLS_RET_CHECK_EQ(args.size(), 1)
@@ -3206,8 +3330,123 @@ absl::Status ConvertOneFunctionInternal(
       .status();
 }
 
+// Merges the functions converted into the scratch package of `scratch_data`
+// into the package of `package_data`, replacing references to stubs with
+// references to the functions they declare.
+absl::Status MergeScratchPackage(const PackageData& scratch_data,
+                                 PackageData& package_data) {
+  Package* package = package_data.package;
+  absl::flat_hash_map<const xls::Function*, xls::Function*> remapping;
+  // Functions are added to a package after their callees, so each function is
+  // cloned after the functions it refers to.
+  for (const std::unique_ptr<xls::Function>& f :
+       scratch_data.package->functions()) {
+    // Besides stubs, functions built on demand (e.g. to map builtins) may
+    // already be present in the package.
+    if (scratch_data.stubs.contains(f.get()) ||
+        package->HasFunctionWithName(f->name())) {
+      XLS_ASSIGN_OR_RETURN(remapping[f.get()], package->GetFunction(f->name()));
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(xls::Function * clone,
+                         f->Clone(f->name(), package, remapping));
+    remapping[f.get()] = clone;
+    if (auto it = scratch_data.ir_to_dslx.find(f.get());
+        it != scratch_data.ir_to_dslx.end()) {
+      package_data.ir_to_dslx[clone] = it->second;
+    }
+    if (scratch_data.wrappers.contains(f.get())) {
+      package_data.wrappers.insert(clone);
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
+// Converts the functions in the call graph using up to `options.num_threads`
+// threads.
+//
+// Function instances whose callees have all been converted are independent of
+// each other. They are converted concurrently, each into a scratch package
+// which refers to already-converted callees via stubs, and then merged into
+// the package in conversion order. Procs (which share channel and member
+// state) and the top function (which is marked as the package top) are
+// converted directly into the package; procs are converted last.
+//
+// Note that the functions of the resulting package may be ordered differently
+// than with serial conversion.
+static absl::Status ConvertCallGraphInParallel(
+    absl::Span<const ConversionRecord> order, ImportData* import_data,
+    const ConvertOptions& options, PackageData& package_data,
+    absl::flat_hash_map<ProcId, std::vector<ProcConfigValue>>* proc_id_to_args,
+    absl::flat_hash_map<ProcId, MemberNameToValue>* proc_id_to_members) {
+  // Group the function records into waves such that the callees of each
+  // record are in earlier waves.
+  absl::flat_hash_map<std::pair<Function*, SymbolicBindings>, int64_t> wave_of;
+  std::vector<std::vector<const ConversionRecord*>> waves;
+  std::vector<const ConversionRecord*> proc_records;
+  for (const ConversionRecord& record : order) {
+    if (record.HasProcId()) {
+      proc_records.push_back(&record);
+      continue;
+    }
+    int64_t wave = 0;
+    for (const Callee& callee : record.callees()) {
+      auto it = wave_of.find(std::make_pair(callee.f(), callee.sym_bindings()));
+      if (it != wave_of.end()) {
+        wave = std::max(wave, it->second + 1);
+      }
+    }
+    wave_of[std::make_pair(record.f(), record.symbolic_bindings())] = wave;
+    if (wave >= waves.size()) {
+      waves.resize(wave + 1);
+    }
+    waves[wave].push_back(&record);
+  }
+  XLS_VLOG(3) << "Converting " << wave_of.size() << " functions in "
+              << waves.size() << " waves";
+
+  Fileno fileno = package_data.package->GetOrCreateFileno(kFakeFilename);
+  for (const std::vector<const ConversionRecord*>& wave : waves) {
+    std::vector<std::unique_ptr<Package>> scratch_packages(wave.size());
+    std::vector<PackageData> scratch_data(wave.size());
+    std::vector<absl::Status> statuses(wave.size());
+    ParallelFor(wave.size(), options.num_threads, [&](int64_t i) {
+      if (wave[i]->IsTop()) {
+        return;
+      }
+      scratch_packages[i] =
+          std::make_unique<Package>(package_data.package->name());
+      scratch_packages[i]->SetFileno(fileno, kFakeFilename);
+      scratch_data[i].package = scratch_packages[i].get();
+      scratch_data[i].parent = &package_data;
+      statuses[i] = ConvertOneFunctionInternal(
+          scratch_data[i], *wave[i], import_data, proc_id_to_args,
+          proc_id_to_members, options);
+    });
+    for (int64_t i = 0; i < wave.size(); ++i) {
+      XLS_VLOG(3) << "Converting to IR: " << wave[i]->ToString();
+      if (wave[i]->IsTop()) {
+        XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
+            package_data, *wave[i], import_data, proc_id_to_args,
+            proc_id_to_members, options));
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(statuses[i]);
+      XLS_RETURN_IF_ERROR(MergeScratchPackage(scratch_data[i], package_data));
+    }
+  }
+
+  for (const ConversionRecord* record : proc_records) {
+    XLS_VLOG(3) << "Converting to IR: " << record->ToString();
+    XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
+        package_data, *record, import_data, proc_id_to_args,
+        proc_id_to_members, options));
+  }
+  return absl::OkStatus();
+}
+
 // Converts the functions in the call graph in a specified order.
 //
 // Args:
@@ -3236,11 +3475,17 @@ static absl::Status ConvertCallGraph(
   // ConvertOneFunctionInternal().
   absl::flat_hash_map<ProcId, std::vector<ProcConfigValue>> proc_id_to_args;
   absl::flat_hash_map<ProcId, MemberNameToValue> proc_id_to_members;
-  for (const ConversionRecord& record : order) {
-    XLS_VLOG(3) << "Converting to IR: " << record.ToString();
-    XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
-        package_data, record, import_data, &proc_id_to_args,
-        &proc_id_to_members, options));
+  if (options.num_threads != 1) {
+    XLS_RETURN_IF_ERROR(ConvertCallGraphInParallel(
+        order, import_data, options, package_data, &proc_id_to_args,
+        &proc_id_to_members));
+  } else {
+    for (const ConversionRecord& record : order) {
+      XLS_VLOG(3) << "Converting to IR: " << record.ToString();
+      XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(
+          package_data, record, import_data, &proc_id_to_args,
+          &proc_id_to_members, options));
+    }
   }
 
   XLS_VLOG(3) << "Verifying converted package";
@@ -3334,6 +3579,68 @@ absl::StatusOr<std::string> ConvertOneFunction(
   return package.DumpIr();
 }
 
+absl::StatusOr<xls::Function*> ConvertTestFunctionIntoPackage(
+    TestFunction* test, ImportData* import_data, const ConvertOptions& options,
+    Package* package) {
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
+                       import_data->GetRootTypeInfo(test->owner()));
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> entry_order,
+                       GetOrderForEntry(test->fn(), type_info));
+
+  // Functions converted for previous tests are reused. The test itself is the
+  // last record; it is not converted as the package top.
+  auto mangled_name =
+      [&](const ConversionRecord& record) -> absl::StatusOr<std::string> {
+    return MangleDslxName(
+        record.module()->name(), record.f()->identifier(),
+        GetRequiresImplicitToken(record.f(), import_data, options)
+            ? CallingConvention::kImplicitToken
+            : CallingConvention::kTypical,
+        record.f()->GetFreeParametricKeySet(), &record.symbolic_bindings());
+  };
+  std::vector<ConversionRecord> order;
+  for (const ConversionRecord& record : entry_order) {
+    if (record.HasProcId()) {
+      return absl::UnimplementedError(
+          absl::StrFormat("Test %s requires conversion of proc functions.",
+                          test->identifier()));
+    }
+    XLS_ASSIGN_OR_RETURN(std::string name, mangled_name(record));
+    if (package->HasFunctionWithName(name)) {
+      continue;
+    }
+    if (record.f() != test->fn()) {
+      order.push_back(record);
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        ConversionRecord test_record,
+        ConversionRecord::Make(record.f(), record.invocation(),
+                               record.module(), record.type_info(),
+                               record.symbolic_bindings(), record.callees(),
+                               /*proc_id=*/absl::nullopt, /*is_top=*/false));
+    order.push_back(std::move(test_record));
+  }
+  PackageData package_data{package};
+  XLS_RETURN_IF_ERROR(
+      ConvertCallGraph(order, import_data, options, package_data));
+
+  XLS_ASSIGN_OR_RETURN(std::string test_name, mangled_name(entry_order.back()));
+  XLS_ASSIGN_OR_RETURN(xls::Function * f, package->GetFunction(test_name));
+  if (!GetRequiresImplicitToken(test->fn(), import_data, options)) {
+    return f;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::string wrapper_name,
+      MangleDslxName(test->owner()->name(), test->identifier(),
+                     CallingConvention::kTypical, /*free_keys=*/{},
+                     /*symbolic_bindings=*/nullptr));
+  if (package->HasFunctionWithName(wrapper_name)) {
+    return package->GetFunction(wrapper_name);
+  }
+  return EmitImplicitTokenEntryWrapper(f, test->fn(), /*is_top=*/false);
+}
+
 absl::StatusOr<Value> InterpValueToValue(const InterpValue& iv) {
   switch (iv.tag()) {
     case InterpValueTag::kSBits:
@@ -42,6 +42,12 @@ struct ConvertOptions {
 
   // Should the generated IR be verified?
   bool verify_ir = true;
+
+  // Number of threads used to convert functions which do not depend on each
+  // other concurrently; zero means one per hardware thread. With more than one
+  // thread the functions of the resulting package may be ordered differently
+  // than with serial conversion.
+  int64_t num_threads = 1;
 };
 
 // Converts the contents of a module to IR form.
@@ -106,6 +112,18 @@ absl::Status ConvertOneFunctionIntoPackage(
     ImportData* import_data, const SymbolicBindings* symbolic_bindings,
     const ConvertOptions& options, Package* package);
 
+// Converts the body of a test function (and the functions it calls that are not
+// yet present in "package") to IR, e.g. so that the test can be run in the JIT.
+//
+// Returns the IR function that runs the test; it takes no arguments. If the
+// test requires an implicit token (e.g. because it contains assertions) this is
+// a wrapper which supplies the implicit token arguments; assertion failures
+// are reported as interpreter events. Tests which spawn procs are not
+// supported.
+absl::StatusOr<xls::Function*> ConvertTestFunctionIntoPackage(
+    TestFunction* test, ImportData* import_data, const ConvertOptions& options,
+    Package* package);
+
 // Converts an interpreter value to an IR value.
 absl::StatusOr<Value> InterpValueToValue(const InterpValue& v);
 
@@ -25,6 +25,7 @@
 #include "xls/dslx/error_printer.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/ir_converter.h"
+#include "xls/dslx/module_cache.h"
 #include "xls/dslx/parser.h"
 #include "xls/dslx/scanner.h"
 #include "xls/dslx/typecheck.h"
@@ -48,6 +49,12 @@ ABSL_FLAG(bool, emit_fail_as_assert, true,
 ABSL_FLAG(bool, verify, true,
           "If true, verifies the generated IR for correctness.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, module_cache_dir, "",
+          "Directory in which typechecked imported modules are cached across "
+          "invocations (see xls/dslx/module_cache.h); no caching if empty.");
+ABSL_FLAG(int64_t, num_threads, 1,
+          "Number of threads used to convert independent functions to IR; "
+          "zero means one per hardware thread.");
 
 namespace xls::dslx {
 namespace {
@@ -84,8 +91,9 @@ absl::StatusOr<std::unique_ptr<Module>> ParseText(absl::string_view text,
 static absl::Status AddPathToPackage(
     absl::string_view path, absl::optional<absl::string_view> entry,
     const ConvertOptions& convert_options, std::string stdlib_path,
-    absl::Span<const std::filesystem::path> dslx_paths, Package* package,
-    bool* printed_error) {
+    absl::Span<const std::filesystem::path> dslx_paths,
+    const absl::optional<std::filesystem::path>& module_cache_dir,
+    Package* package, bool* printed_error) {
   // Read the `.x` contents.
   XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(path));
   // Figure out what we name this module.
@@ -101,6 +109,11 @@ static absl::Status AddPathToPackage(
   // make the modules outlive any given AddPathToPackage() if we want to
   // appropriately reuse things in ImportData).
   ImportData import_data(CreateImportData(std::move(stdlib_path), dslx_paths));
+  absl::optional<ModuleCache> module_cache;
+  if (module_cache_dir.has_value()) {
+    module_cache.emplace(*module_cache_dir);
+    import_data.SetModuleCache(&module_cache.value());
+  }
   absl::StatusOr<TypeInfo*> type_info_or =
       CheckModule(module.get(), &import_data);
   if (!type_info_or.ok()) {
@@ -126,8 +139,9 @@ absl::Status RealMain(absl::Span<const absl::string_view> paths,
                       absl::optional<absl::string_view> package_name,
                       const std::string& stdlib_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
+                      absl::optional<std::filesystem::path> module_cache_dir,
                       bool emit_fail_as_assert, bool verify_ir,
-                      bool* printed_error) {
+                      int64_t num_threads, bool* printed_error) {
   absl::optional<xls::Package> package;
   if (package_name.has_value()) {
     package.emplace(package_name.value());
@@ -151,11 +165,13 @@ absl::Status RealMain(absl::Span<const absl::string_view> paths,
       .emit_positions = true,
       .emit_fail_as_assert = emit_fail_as_assert,
       .verify_ir = verify_ir,
+      .num_threads = num_threads,
   };
   for (absl::string_view path : paths) {
     XLS_RETURN_IF_ERROR(AddPathToPackage(path, entry, convert_options,
                                          stdlib_path, dslx_paths,
-                                         &package.value(), printed_error));
+                                         module_cache_dir, &package.value(),
+                                         printed_error));
   }
   std::cout << package->DumpIr();
 
@@ -193,12 +209,19 @@ int main(int argc, char* argv[]) {
     package_name = absl::GetFlag(FLAGS_package_name);
   }
 
+  absl::optional<std::filesystem::path> module_cache_dir;
+  if (!absl::GetFlag(FLAGS_module_cache_dir).empty()) {
+    module_cache_dir = absl::GetFlag(FLAGS_module_cache_dir);
+  }
+
   bool emit_fail_as_assert = absl::GetFlag(FLAGS_emit_fail_as_assert);
   bool verify_ir = absl::GetFlag(FLAGS_verify);
+  int64_t num_threads = absl::GetFlag(FLAGS_num_threads);
   bool printed_error = false;
   absl::Status status =
       xls::dslx::RealMain(args, entry, package_name, stdlib_path, dslx_paths,
-                          emit_fail_as_assert, verify_ir, &printed_error);
+                          module_cache_dir, emit_fail_as_assert, verify_ir,
+                          num_threads, &printed_error);
   if (printed_error) {
     return EXIT_FAILURE;
   }
@@ -31,6 +31,9 @@
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/ir_parser.h"
 
 namespace xls::dslx {
 namespace {
@@ -1588,6 +1591,50 @@ proc main {
   ExpectIr(converted, TestName());
 }
 
+TEST(IrConverterTest, ParallelConversionMatchesSerial) {
+  constexpr absl::string_view kProgram = R"(
+fn double<N: u32>(x: bits[N]) -> bits[N] { x + x }
+fn quad<N: u32>(x: bits[N]) -> bits[N] { double(double(x)) }
+fn double_u8(x: u8) -> u8 { double(x) }
+pub fn checked(x: u8) -> u8 {
+  if x == u8:0 { fail!(x) } else { quad(x) }
+}
+fn main(x: u32, y: u8) -> (u32, u8, u8[2]) {
+  let a = for (i, acc): (u32, u32) in range(u32:0, u32:4) {
+    acc + quad(i)
+  }(x);
+  (a, checked(y), map(u8[2]:[y, quad(y)], double_u8))
+}
+)";
+  ConvertOptions serial_options = kFailNoPos;
+  serial_options.emit_fail_as_assert = false;
+  ConvertOptions parallel_options = serial_options;
+  parallel_options.num_threads = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string serial_ir,
+                           ConvertModuleForTest(kProgram, serial_options));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string parallel_ir,
+                           ConvertModuleForTest(kProgram, parallel_options));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> serial,
+                           xls::Parser::ParsePackage(serial_ir));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> parallel,
+                           xls::Parser::ParsePackage(parallel_ir));
+  EXPECT_THAT(parallel->GetFunctionNames(),
+              testing::UnorderedElementsAreArray(serial->GetFunctionNames()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * serial_main,
+                           serial->GetFunction("__test_module__main"));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * parallel_main,
+                           parallel->GetFunction("__test_module__main"));
+  for (int64_t y : {0, 1, 7}) {
+    std::vector<Value> args = {Value(UBits(3, 32)), Value(UBits(y, 8))};
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Value expected,
+        DropInterpreterEvents(InterpretFunction(serial_main, args)));
+    EXPECT_THAT(DropInterpreterEvents(InterpretFunction(parallel_main, args)),
+                status_testing::IsOkAndHolds(expected));
+  }
+}
+
 }  // namespace
 }  // namespace xls::dslx
 
@@ -0,0 +1,176 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/module_cache.h"
+
+#include <unistd.h>
+
+#include <system_error>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/type_info.pb.h"
+#include "xls/dslx/type_info_to_proto.h"
+
+namespace xls::dslx {
+namespace {
+
+// Bump this whenever the serialized form of type information (or the way it
+// is derived by the type checker) changes, so that stale entries are ignored.
+constexpr int64_t kModuleCacheFormatVersion = 1;
+
+// Appends "s" to "out" such that the concatenation of several strings is
+// unambiguous.
+void AppendKeyComponent(absl::string_view s, std::string* out) {
+  absl::StrAppend(out, s.size(), ":", s);
+}
+
+std::string Sha256Hex(absl::string_view data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(absl::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+// Collects the modules transitively imported by the module of "type_info".
+void CollectImportedModules(const TypeInfo& type_info,
+                            absl::flat_hash_set<const Module*>* modules) {
+  for (const auto& [import, info] : type_info.imports()) {
+    if (modules->insert(info.module).second) {
+      CollectImportedModules(*info.type_info, modules);
+    }
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> ModuleCache::AddModule(const Module& module,
+                                                   absl::string_view contents,
+                                                   ImportData* import_data) {
+  std::string key_data;
+  AppendKeyComponent(absl::StrCat(kModuleCacheFormatVersion), &key_data);
+  AppendKeyComponent(module.name(), &key_data);
+  AppendKeyComponent(contents, &key_data);
+  for (const ModuleMember& member : module.top()) {
+    if (!absl::holds_alternative<Import*>(member)) {
+      continue;
+    }
+    const Import* import = absl::get<Import*>(member);
+    XLS_ASSIGN_OR_RETURN(const ModuleInfo* info,
+                         import_data->Get(ImportTokens(import->subject())));
+    XLS_ASSIGN_OR_RETURN(Record record, GetRecord(*info->module));
+    AppendKeyComponent(record.key, &key_data);
+  }
+  std::string key = Sha256Hex(key_data);
+
+  absl::MutexLock lock(&mutex_);
+  records_[&module] =
+      Record{key, static_cast<int64_t>(module.nodes().size())};
+  return key;
+}
+
+absl::StatusOr<ModuleCache::Record> ModuleCache::GetRecord(
+    const Module& module) {
+  absl::MutexLock lock(&mutex_);
+  auto it = records_.find(&module);
+  if (it == records_.end()) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Module %s was not added to the module cache", module.name()));
+  }
+  return it->second;
+}
+
+std::filesystem::path ModuleCache::GetEntryPath(const Module& module,
+                                                const Record& record) const {
+  return directory_ / absl::StrFormat("%s.%s.pb", module.name(), record.key);
+}
+
+absl::StatusOr<TypeInfo*> ModuleCache::Restore(Module* module,
+                                               ImportData* import_data) {
+  XLS_ASSIGN_OR_RETURN(Record record, GetRecord(*module));
+  std::filesystem::path path = GetEntryPath(*module, record);
+  if (!FileExists(path).ok()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "No module cache entry for %s at %s", module->name(), path.string()));
+  }
+  ModuleCacheEntryProto entry;
+  XLS_RETURN_IF_ERROR(ParseProtobinFile(path, &entry));
+  if (entry.module_name() != module->name() || entry.key() != record.key ||
+      entry.node_count() != record.parsed_node_count) {
+    return absl::DataLossError(absl::StrFormat(
+        "Module cache entry %s does not match module %s", path.string(),
+        module->name()));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      TypeInfo * type_info,
+      ModuleTypeInfoFromProto(entry.type_info(), module, import_data));
+  XLS_VLOG(2) << "Restored type information for " << module->name()
+              << " from " << path;
+  return type_info;
+}
+
+absl::Status ModuleCache::Save(const Module& module,
+                               const TypeInfo& type_info) {
+  XLS_RET_CHECK_EQ(type_info.module(), &module);
+  XLS_ASSIGN_OR_RETURN(Record record, GetRecord(module));
+
+  // Type checking can synthesize AST nodes (in the module itself or in the
+  // modules it imports, e.g. for map() invocations); these would not be
+  // recreated by parsing, so such modules cannot be cached.
+  absl::flat_hash_set<const Module*> modules = {&module};
+  CollectImportedModules(type_info, &modules);
+  for (const Module* m : modules) {
+    XLS_ASSIGN_OR_RETURN(Record m_record, GetRecord(*m));
+    if (static_cast<int64_t>(m->nodes().size()) !=
+        m_record.parsed_node_count) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Type checking synthesized AST nodes in module %s", m->name()));
+    }
+  }
+
+  ModuleCacheEntryProto entry;
+  entry.set_module_name(module.name());
+  entry.set_key(record.key);
+  entry.set_node_count(record.parsed_node_count);
+  XLS_ASSIGN_OR_RETURN(*entry.mutable_type_info(),
+                       ModuleTypeInfoToProto(type_info));
+
+  // Write to a temporary file first so concurrent readers (e.g. parallel
+  // builds sharing the cache directory) never observe partial entries.
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  std::filesystem::path path = GetEntryPath(module, record);
+  std::filesystem::path temp_path =
+      absl::StrFormat("%s.%d.tmp", path.string(), getpid());
+  XLS_RETURN_IF_ERROR(SetProtobinFile(temp_path, entry));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to rename %s to %s: %s", temp_path.string(),
+                        path.string(), ec.message()));
+  }
+  XLS_VLOG(2) << "Saved type information for " << module.name() << " to "
+              << path;
+  return absl::OkStatus();
+}
+
+}  // namespace xls::dslx
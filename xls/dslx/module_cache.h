@@ -0,0 +1,94 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_MODULE_CACHE_H_
+#define XLS_DSLX_MODULE_CACHE_H_
+
+#include <filesystem>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/dslx/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/type_info.h"
+
+namespace xls::dslx {
+
+// On-disk cache of typechecked DSLX modules, shared across tool invocations.
+//
+// Every invocation of a DSLX tool typechecks the entire import closure of its
+// entry module (e.g. the standard library). The module cache stores the type
+// information of imported modules in a directory, keyed by a digest of the
+// module text and the keys of all modules it imports, so that later
+// invocations can restore it without re-running type deduction. Parsing is
+// cheap and deterministic, so cached modules are still parsed and the type
+// information is attached to the freshly created AST nodes.
+//
+// Modules whose type information cannot be serialized (e.g. because it holds
+// function values, or type checking synthesized AST nodes) are simply not
+// cached. See DoImport() for how the cache is consulted.
+//
+// A ModuleCache object tracks the modules of a single ImportData (see
+// ImportData::SetModuleCache()) and must outlive it; multiple objects may share
+// the same directory.
+class ModuleCache {
+ public:
+  explicit ModuleCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  // Computes and notes the cache key for "module", which was parsed from
+  // "contents". All modules imported by "module" must already have been added
+  // to the cache (and imported into "import_data").
+  absl::StatusOr<std::string> AddModule(const Module& module,
+                                        absl::string_view contents,
+                                        ImportData* import_data)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Restores the type information of "module" from the cache directory.
+  // Returns a not-found error if there is no entry for the module.
+  absl::StatusOr<TypeInfo*> Restore(Module* module, ImportData* import_data)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Writes the type information of "module" to the cache directory.
+  absl::Status Save(const Module& module, const TypeInfo& type_info)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+ private:
+  struct Record {
+    std::string key;
+    // Number of AST nodes of the module when it was parsed, used to detect
+    // nodes synthesized during type checking.
+    int64_t parsed_node_count;
+  };
+
+  absl::StatusOr<Record> GetRecord(const Module& module)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  std::filesystem::path GetEntryPath(const Module& module,
+                                     const Record& record) const;
+
+  std::filesystem::path directory_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<const Module*, Record> records_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_MODULE_CACHE_H_
@@ -0,0 +1,159 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/module_cache.h"
+
+#include <filesystem>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode_emitter.h"
+#include "xls/dslx/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/import_routines.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+using testing::SizeIs;
+
+constexpr absl::string_view kLibProgram = R"(
+pub struct Point {
+  x: u32,
+  y: u32,
+}
+
+pub enum Color : u2 {
+  RED = 0,
+  BLUE = 1,
+}
+
+pub const FOUR = u32:4;
+
+pub fn id<N: u32>(x: uN[N]) -> uN[N] { x }
+
+pub fn make_point(x: u32) -> Point {
+  Point { x: id(x), y: (id(x[0:16]) as u32) + u32:1 }
+}
+)";
+
+constexpr absl::string_view kMainProgram = R"(
+import lib
+
+fn main() -> u32 {
+  let p = lib::make_point(u32:2);
+  let c = lib::Color::BLUE;
+  p.x + p.y + lib::id(lib::FOUR) + (c as u32)
+}
+)";
+
+// Imports "lib" (from the given directory) through a fresh import data object
+// using the given module cache, and returns the result of running main.
+absl::StatusOr<InterpValue> RunMain(const std::filesystem::path& lib_dir,
+                                    ModuleCache* module_cache,
+                                    const TypecheckFn& lib_typecheck) {
+  std::vector<std::filesystem::path> search_paths = {lib_dir};
+  ImportData import_data(CreateImportData("", search_paths));
+  import_data.SetModuleCache(module_cache);
+  XLS_RETURN_IF_ERROR(DoImport(lib_typecheck, ImportTokens({"lib"}),
+                               &import_data, Span::Fake())
+                          .status());
+  XLS_ASSIGN_OR_RETURN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kMainProgram, "main.x", "main", &import_data));
+  XLS_ASSIGN_OR_RETURN(Function * f, tm.module->GetFunctionOrError("main"));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BytecodeFunction> bf,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, f, SymbolicBindings()));
+  return BytecodeInterpreter::Interpret(&import_data, bf.get(), {});
+}
+
+class ModuleCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    XLS_ASSERT_OK(SetFileContents(lib_dir() / "lib.x", kLibProgram));
+  }
+
+  std::filesystem::path lib_dir() const { return temp_dir_->path(); }
+  std::filesystem::path cache_dir() const {
+    return temp_dir_->path() / "cache";
+  }
+
+  absl::optional<TempDirectory> temp_dir_;
+};
+
+TEST_F(ModuleCacheTest, RestoresTypeInformationWithoutTypechecking) {
+  {
+    ModuleCache module_cache(cache_dir());
+    std::vector<std::filesystem::path> search_paths = {lib_dir()};
+    ImportData import_data(CreateImportData("", search_paths));
+    auto typecheck = [&import_data](Module* module) {
+      return CheckModule(module, &import_data);
+    };
+    import_data.SetModuleCache(&module_cache);
+    XLS_ASSERT_OK(DoImport(typecheck, ImportTokens({"lib"}), &import_data,
+                           Span::Fake())
+                      .status());
+  }
+  EXPECT_THAT(GetDirectoryEntries(cache_dir()), IsOkAndHolds(SizeIs(1)));
+
+  // A new cache object (as in a new tool invocation) restores the type
+  // information of lib from the cache directory, so lib must not be
+  // typechecked again.
+  ModuleCache module_cache(cache_dir());
+  auto fail_typecheck = [](Module* module) -> absl::StatusOr<TypeInfo*> {
+    return absl::InternalError("Unexpectedly typechecked " + module->name());
+  };
+  // x + y + FOUR + BLUE = 2 + 3 + 4 + 1
+  EXPECT_THAT(RunMain(lib_dir(), &module_cache, fail_typecheck),
+              IsOkAndHolds(InterpValue::MakeU32(10)));
+}
+
+TEST_F(ModuleCacheTest, ChangedModuleIsTypecheckedAgain) {
+  {
+    ModuleCache module_cache(cache_dir());
+    std::vector<std::filesystem::path> search_paths = {lib_dir()};
+    ImportData import_data(CreateImportData("", search_paths));
+    auto typecheck = [&import_data](Module* module) {
+      return CheckModule(module, &import_data);
+    };
+    import_data.SetModuleCache(&module_cache);
+    XLS_ASSERT_OK(DoImport(typecheck, ImportTokens({"lib"}), &import_data,
+                           Span::Fake())
+                      .status());
+  }
+
+  XLS_ASSERT_OK(SetFileContents(lib_dir() / "lib.x",
+                                absl::StrCat(kLibProgram, "\n// Changed.\n")));
+  ModuleCache module_cache(cache_dir());
+  auto fail_typecheck = [](Module* module) -> absl::StatusOr<TypeInfo*> {
+    return absl::InternalError("Unexpectedly typechecked " + module->name());
+  };
+  EXPECT_THAT(RunMain(lib_dir(), &module_cache, fail_typecheck),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Unexpectedly typechecked lib")));
+}
+
+}  // namespace
+}  // namespace xls::dslx
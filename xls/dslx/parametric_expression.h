@@ -180,6 +180,9 @@ class ParametricAdd : public ParametricExpression {
                                            const_value());
   }
 
+  const ParametricExpression& lhs() const { return *lhs_; }
+  const ParametricExpression& rhs() const { return *rhs_; }
+
  private:
   std::unique_ptr<ParametricExpression> lhs_;
   std::unique_ptr<ParametricExpression> rhs_;
@@ -230,6 +233,9 @@ class ParametricMul : public ParametricExpression {
                            rhs_->ToRepr());
   }
 
+  const ParametricExpression& lhs() const { return *lhs_; }
+  const ParametricExpression& rhs() const { return *rhs_; }
+
  private:
   std::unique_ptr<ParametricExpression> lhs_;
   std::unique_ptr<ParametricExpression> rhs_;
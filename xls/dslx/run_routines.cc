@@ -14,8 +14,16 @@
 
 #include "xls/dslx/run_routines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <random>
+#include <sstream>
+#include <utility>
 
+#include "absl/synchronization/mutex.h"
+#include "xls/common/math_util.h"
+#include "xls/common/parallel_for.h"
 #include "xls/dslx/bindings.h"
 #include "xls/dslx/bytecode_cache.h"
 #include "xls/dslx/bytecode_emitter.h"
@@ -23,12 +31,16 @@
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/error_printer.h"
+#include "xls/dslx/extract_conversion_order.h"
 #include "xls/dslx/ir_converter.h"
 #include "xls/dslx/mangle.h"
+#include "xls/dslx/module_cache.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/typecheck.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/events.h"
+#include "xls/ir/type.h"
 
 namespace xls::dslx {
 namespace {
@@ -36,10 +48,130 @@ namespace {
 // our test-runner output.
 constexpr int kUnitSpaces = 7;
 constexpr int kQuickcheckSpaces = 15;
+
+// Number of quickcheck samples generated and evaluated as a unit of work.
+constexpr int64_t kQuickCheckBatchSize = 1024;
+
+// Number of batches per thread which StreamQuickCheck evaluates before checking
+// whether a falsifying example has been found.
+constexpr int64_t kQuickCheckBatchesPerThread = 4;
+
+// Collects the output of tasks which may complete in any order and writes it
+// to stderr in task order as soon as all preceding tasks have completed.
+class OrderedOutput {
+ public:
+  explicit OrderedOutput(int64_t task_count)
+      : outputs_(task_count), completed_(task_count, false) {}
+
+  void Complete(int64_t task, std::string output) ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    outputs_[task] = std::move(output);
+    completed_[task] = true;
+    while (next_ < completed_.size() && completed_[next_]) {
+      std::cerr << outputs_[next_] << std::flush;
+      outputs_[next_].clear();
+      ++next_;
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::string> outputs_ ABSL_GUARDED_BY(mutex_);
+  std::vector<bool> completed_ ABSL_GUARDED_BY(mutex_);
+  int64_t next_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Determines whether any visited node produces trace output.
+class TraceFinder : public AstNodeVisitorWithDefault {
+ public:
+  absl::Status HandleFormatMacro(FormatMacro* node) override {
+    produces_traces_ = true;
+    return absl::OkStatus();
+  }
+
+  absl::Status HandleInvocation(Invocation* node) override {
+    auto* name_ref = dynamic_cast<NameRef*>(node->callee());
+    if (name_ref != nullptr && name_ref->identifier() == "trace!") {
+      produces_traces_ = true;
+    }
+    return absl::OkStatus();
+  }
+
+  bool produces_traces() const { return produces_traces_; }
+
+ private:
+  bool produces_traces_ = false;
+};
+
+// Returns the value of the given type made of the bits of `sample` starting at
+// bit `*offset`, and advances `*offset` past them.
+Value ValueFromSampleBits(xls::Type* type, uint64_t sample, int64_t* offset) {
+  if (type->IsTuple()) {
+    std::vector<Value> elements;
+    for (xls::Type* element_type : type->AsTupleOrDie()->element_types()) {
+      elements.push_back(ValueFromSampleBits(element_type, sample, offset));
+    }
+    return Value::Tuple(elements);
+  }
+  if (type->IsArray()) {
+    xls::ArrayType* array_type = type->AsArrayOrDie();
+    std::vector<Value> elements;
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      elements.push_back(
+          ValueFromSampleBits(array_type->element_type(), sample, offset));
+    }
+    return Value::Array(elements).value();
+  }
+  if (type->IsToken()) {
+    return Value::Token();
+  }
+  int64_t bit_count = type->AsBitsOrDie()->bit_count();
+  uint64_t bits = bit_count == 0 ? 0 : sample >> *offset;
+  if (bit_count < 64) {
+    bits &= (uint64_t{1} << bit_count) - 1;
+  }
+  *offset += bit_count;
+  return Value(UBits(bits, bit_count));
+}
+
+// Returns the arguments of the given function for the sample with the given
+// index in an exhaustive quickcheck.
+std::vector<Value> ExhaustiveFunctionArguments(xls::Function* f,
+                                               uint64_t sample) {
+  std::vector<Value> args;
+  int64_t offset = 0;
+  for (xls::Param* param : f->params()) {
+    args.push_back(ValueFromSampleBits(param->GetType(), sample, &offset));
+  }
+  return args;
+}
+
+// Converts the test with the given name to IR for execution in the JIT.
+// Returns an error if the test must run in an interpreter instead: trace
+// output is only printed by the interpreters and test procs are not supported.
+absl::StatusOr<xls::Function*> ConvertTestForJit(
+    Module* module, absl::string_view test_name, TypeInfo* type_info,
+    ImportData* import_data, const ConvertOptions& options, Package* package) {
+  XLS_ASSIGN_OR_RETURN(TestFunction * test, module->GetTest(test_name));
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> order,
+                       GetOrderForEntry(test->fn(), type_info));
+  TraceFinder trace_finder;
+  for (const ConversionRecord& record : order) {
+    XLS_RETURN_IF_ERROR(WalkPostOrder(record.f()->body(), &trace_finder,
+                                      /*want_types=*/false));
+  }
+  if (trace_finder.produces_traces()) {
+    return absl::UnimplementedError(
+        "Trace output is only produced by the interpreters.");
+  }
+  return ConvertTestFunctionIntoPackage(test, import_data, options, package);
+}
+
 }  // namespace
 
 absl::StatusOr<IrJit*> RunComparator::GetOrCompileJitFunction(
     std::string ir_name, xls::Function* ir_function) {
+  absl::MutexLock lock(&mutex_);
   auto it = jit_cache_.find(ir_name);
   if (it != jit_cache_.end()) {
     return it->second.get();
@@ -145,58 +277,213 @@ static bool TestMatchesFilter(absl::string_view test_name,
 absl::StatusOr<QuickCheckResults> DoQuickCheck(xls::Function* xls_function,
                                                std::string ir_name,
                                                RunComparator* run_comparator,
-                                               int64_t seed,
-                                               int64_t num_tests) {
+                                               int64_t seed, int64_t num_tests,
+                                               int64_t num_threads) {
   XLS_ASSIGN_OR_RETURN(IrJit * jit, run_comparator->GetOrCompileJitFunction(
                                         std::move(ir_name), xls_function));
 
+  int64_t batch_count = CeilOfRatio(num_tests, kQuickCheckBatchSize);
+  std::vector<QuickCheckResults> batch_results(batch_count);
+  std::vector<absl::Status> batch_statuses(batch_count);
+  // Index of the first falsifying sample found so far. Samples after it need
+  // not be evaluated.
+  std::atomic<int64_t> first_falsified(num_tests);
+  ParallelFor(batch_count, num_threads, [&](int64_t batch) {
+    QuickCheckResults& results = batch_results[batch];
+    std::seed_seq seed_seq = {
+        static_cast<uint32_t>(seed),
+        static_cast<uint32_t>(static_cast<uint64_t>(seed) >> 32),
+        static_cast<uint32_t>(batch)};
+    std::minstd_rand rng_engine(seed_seq);
+    int64_t end = std::min(num_tests, (batch + 1) * kQuickCheckBatchSize);
+    for (int64_t i = batch * kQuickCheckBatchSize;
+         i < end && i < first_falsified.load(); ++i) {
+      results.arg_sets.push_back(
+          RandomFunctionArguments(xls_function, &rng_engine));
+      // TODO(https://github.com/google/xls/issues/506): 2021-10-15
+      // Assertion failures should work out, but we should consciously decide
+      // if/how we want to dump traces when running QuickChecks (always, for
+      // failures, flag-controlled, ...).
+      absl::StatusOr<Value> result =
+          DropInterpreterEvents(jit->Run(results.arg_sets.back()));
+      if (!result.ok()) {
+        results.arg_sets.pop_back();
+        batch_statuses[batch] = result.status();
+        return;
+      }
+      results.results.push_back(std::move(result).value());
+      if (results.results.back().IsAllZeros()) {
+        // We were able to falsify the xls_function (predicate); samples after
+        // this one are not needed.
+        int64_t current = first_falsified.load();
+        while (i < current &&
+               !first_falsified.compare_exchange_weak(current, i)) {
+        }
+        return;
+      }
+    }
+  });
+
+  // Stitch the batches together in order, stopping at the first falsifying
+  // example. Every sample before it has been evaluated, so the results are the
+  // same as those of a sequential run.
   QuickCheckResults results;
-  std::minstd_rand rng_engine(seed);
-
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, &rng_engine));
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-15
-    // Assertion failures should work out, but we should consciously decide
-    // if/how we want to dump traces when running QuickChecks (always, for
-    // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(
-        xls::Value result,
-        DropInterpreterEvents(jit->Run(results.arg_sets.back())));
-    results.results.push_back(result);
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
+  for (int64_t batch = 0; batch < batch_count; ++batch) {
+    QuickCheckResults& batch_result = batch_results[batch];
+    for (int64_t i = 0; i < batch_result.results.size(); ++i) {
+      results.arg_sets.push_back(std::move(batch_result.arg_sets[i]));
+      results.results.push_back(std::move(batch_result.results[i]));
+      if (results.results.back().IsAllZeros()) {
+        return results;
+      }
     }
+    XLS_RETURN_IF_ERROR(batch_statuses[batch]);
   }
-
   return results;
 }
 
-static absl::Status RunQuickCheck(RunComparator* run_comparator,
-                                  Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+absl::StatusOr<QuickCheckOutcome> StreamQuickCheck(
+    xls::Function* xls_function, std::string ir_name,
+    RunComparator* run_comparator, QuickCheckMode mode, int64_t seed,
+    int64_t num_tests, int64_t num_threads) {
+  XLS_ASSIGN_OR_RETURN(IrJit * jit, run_comparator->GetOrCompileJitFunction(
+                                        std::move(ir_name), xls_function));
+
+  std::vector<xls::Type*> param_types;
+  int64_t bit_count = 0;
+  for (xls::Param* param : xls_function->params()) {
+    param_types.push_back(param->GetType());
+    bit_count += param->GetType()->GetFlatBitCount();
+  }
+  int64_t sample_count = num_tests;
+  if (mode == QuickCheckMode::kExhaustive) {
+    if (bit_count > kMaxExhaustiveQuickCheckBits) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Cannot exhaustively check %s: its arguments have %d bits, the "
+          "maximum is %d.",
+          xls_function->name(), bit_count, kMaxExhaustiveQuickCheckBits));
+    }
+    sample_count = int64_t{1} << bit_count;
+  }
+  xls::Type* return_type = xls_function->return_value()->GetType();
+
+  // Index of the first sample which falsified the predicate or could not be
+  // evaluated, and its arguments or error. Samples after it need not be
+  // evaluated. `first_stop` is only written with `mutex` held.
+  std::atomic<int64_t> first_stop(sample_count);
+  absl::Mutex mutex;
+  std::vector<Value> stop_args;
+  absl::Status stop_status;
+  auto record_stop = [&](int64_t i, std::vector<Value> args,
+                         absl::Status status) {
+    absl::MutexLock lock(&mutex);
+    if (i < first_stop.load()) {
+      first_stop.store(i);
+      stop_args = std::move(args);
+      stop_status = std::move(status);
+    }
+  };
+
+  auto run_batch = [&](int64_t batch) {
+    std::seed_seq seed_seq = {
+        static_cast<uint32_t>(seed),
+        static_cast<uint32_t>(static_cast<uint64_t>(seed) >> 32),
+        static_cast<uint32_t>(batch)};
+    std::minstd_rand rng_engine(seed_seq);
+    // The argument and result buffers are reused by all samples of the batch.
+    std::vector<std::unique_ptr<uint8_t[]>> arg_storage;
+    std::vector<uint8_t*> arg_buffers;
+    for (int64_t i = 0; i < param_types.size(); ++i) {
+      arg_storage.push_back(
+          std::make_unique<uint8_t[]>(jit->GetArgTypeSize(i)));
+      arg_buffers.push_back(arg_storage.back().get());
+    }
+    std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+    int64_t end = std::min(sample_count, (batch + 1) * kQuickCheckBatchSize);
+    for (int64_t i = batch * kQuickCheckBatchSize;
+         i < end && i < first_stop.load(); ++i) {
+      std::vector<Value> args;
+      switch (mode) {
+        case QuickCheckMode::kRandom:
+          args = RandomFunctionArguments(xls_function, &rng_engine);
+          break;
+        case QuickCheckMode::kCornerCases:
+          args = CornerCaseFunctionArguments(xls_function, &rng_engine);
+          break;
+        case QuickCheckMode::kExhaustive:
+          args = ExhaustiveFunctionArguments(xls_function, i);
+          break;
+      }
+      absl::Status status = jit->runtime()->PackArgs(
+          args, param_types, absl::MakeSpan(arg_buffers));
+      if (status.ok()) {
+        status = jit->RunWithViews(absl::MakeSpan(arg_buffers),
+                                   absl::MakeSpan(result_buffer));
+      }
+      if (!status.ok()) {
+        record_stop(i, {}, status);
+        return;
+      }
+      if (jit->runtime()
+              ->UnpackBuffer(result_buffer.data(), return_type)
+              .IsAllZeros()) {
+        record_stop(i, std::move(args), absl::OkStatus());
+        return;
+      }
+    }
+  };
+
+  // Batches are evaluated in chunks of a few batches per thread, stopping
+  // after the first chunk in which a sample falsifies the predicate (or fails
+  // to evaluate). As in DoQuickCheck, every sample before that one has been
+  // evaluated.
+  int64_t batch_count = CeilOfRatio(sample_count, kQuickCheckBatchSize);
+  int64_t chunk_size =
+      kQuickCheckBatchesPerThread *
+      (num_threads == 0 ? DefaultThreadCount() : num_threads);
+  for (int64_t chunk_start = 0;
+       chunk_start < batch_count && first_stop.load() == sample_count;
+       chunk_start += chunk_size) {
+    ParallelFor(std::min(chunk_size, batch_count - chunk_start), num_threads,
+                [&](int64_t i) { run_batch(chunk_start + i); });
+  }
+
+  QuickCheckOutcome outcome;
+  outcome.sample_count = sample_count;
+  if (first_stop.load() < sample_count) {
+    XLS_RETURN_IF_ERROR(stop_status);
+    outcome.sample_count = first_stop.load() + 1;
+    outcome.falsifying_args = std::move(stop_args);
+  }
+  return outcome;
+}
+
+// Returns the IR function for the given quickcheck in the converted package.
+static absl::StatusOr<xls::Function*> GetQuickCheckIrFunction(
+    Package* ir_package, QuickCheck* quickcheck) {
   Function* fn = quickcheck->f();
   XLS_ASSIGN_OR_RETURN(std::string ir_name,
                        MangleDslxName(fn->owner()->name(), fn->identifier(),
                                       CallingConvention::kTypical,
                                       fn->GetFreeParametricKeySet()));
-  XLS_ASSIGN_OR_RETURN(xls::Function * ir_function,
-                       ir_package->GetFunction(ir_name));
+  return ir_package->GetFunction(ir_name);
+}
 
+static absl::Status RunQuickCheck(RunComparator* run_comparator,
+                                  xls::Function* ir_function,
+                                  QuickCheck* quickcheck, TypeInfo* type_info,
+                                  QuickCheckMode mode, int64_t seed,
+                                  int64_t num_threads) {
+  Function* fn = quickcheck->f();
   XLS_ASSIGN_OR_RETURN(
-      QuickCheckResults qc_results,
-      DoQuickCheck(ir_function, std::move(ir_name), run_comparator, seed,
-                   quickcheck->test_count()));
-  const auto& [arg_sets, results] = qc_results;
-  XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
-  if (!last_result.IsZero()) {
-    // Did not find a falsifying example.
+      QuickCheckOutcome outcome,
+      StreamQuickCheck(ir_function, ir_function->name(), run_comparator, mode,
+                       seed, quickcheck->test_count(), num_threads));
+  if (!outcome.falsifying_args.has_value()) {
     return absl::OkStatus();
   }
 
-  const std::vector<Value>& last_argset = arg_sets.back();
+  const std::vector<Value>& last_argset = *outcome.falsifying_args;
   XLS_ASSIGN_OR_RETURN(FunctionType * fn_type,
                        type_info->GetItemAs<FunctionType>(fn));
   const std::vector<std::unique_ptr<ConcreteType>>& params = fn_type->params();
@@ -216,16 +503,17 @@ static absl::Status RunQuickCheck(RunComparator* run_comparator,
   return FailureErrorStatus(
       fn->span(),
       absl::StrFormat("Found falsifying example after %d tests: [%s]",
-                      results.size(), dslx_argset_str));
+                      outcome.sample_count, dslx_argset_str));
 }
 
-using HandleError = const std::function<void(
-    const absl::Status&, absl::string_view test_name, bool is_quickcheck)>;
+using HandleError =
+    const std::function<void(const absl::Status&, absl::string_view test_name,
+                             bool is_quickcheck, std::ostream& os)>;
 
 static absl::Status RunQuickChecksIfJitEnabled(
     Module* entry_module, TypeInfo* type_info, RunComparator* run_comparator,
     Package* ir_package, absl::optional<int64_t> seed,
-    const HandleError& handle_error) {
+    const ParseAndTestOptions& options, const HandleError& handle_error) {
   if (run_comparator == nullptr) {
     std::cerr << "[ SKIPPING QUICKCHECKS  ] (JIT is disabled)" << std::endl;
     return absl::OkStatus();
@@ -240,12 +528,35 @@ static absl::Status RunQuickChecksIfJitEnabled(
             << std::endl;
   for (QuickCheck* quickcheck : entry_module->GetQuickChecks()) {
     const std::string& test_name = quickcheck->identifier();
+    absl::StatusOr<xls::Function*> ir_function =
+        GetQuickCheckIrFunction(ir_package, quickcheck);
+    QuickCheckMode mode = options.quickcheck_corner_cases
+                              ? QuickCheckMode::kCornerCases
+                              : QuickCheckMode::kRandom;
+    int64_t count = quickcheck->test_count();
+    if (ir_function.ok() &&
+        options.max_exhaustive_quickcheck_bits.has_value()) {
+      int64_t bit_count = 0;
+      for (xls::Param* param : ir_function.value()->params()) {
+        bit_count += param->GetType()->GetFlatBitCount();
+      }
+      if (bit_count <= std::min(*options.max_exhaustive_quickcheck_bits,
+                                kMaxExhaustiveQuickCheckBits)) {
+        mode = QuickCheckMode::kExhaustive;
+        count = int64_t{1} << bit_count;
+      }
+    }
     std::cerr << "[ RUN QUICKCHECK        ] " << test_name
-              << " count: " << quickcheck->test_count() << std::endl;
-    absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+              << " count: " << count
+              << (mode == QuickCheckMode::kExhaustive ? " (exhaustive)" : "")
+              << std::endl;
+    absl::Status status = ir_function.status();
+    if (status.ok()) {
+      status = RunQuickCheck(run_comparator, ir_function.value(), quickcheck,
+                             type_info, mode, *seed, options.num_threads);
+    }
     if (!status.ok()) {
-      handle_error(status, test_name, /*is_quickcheck=*/true);
+      handle_error(status, test_name, /*is_quickcheck=*/true, std::cerr);
     } else {
       std::cerr << "[                    OK ] " << test_name << std::endl;
     }
@@ -262,11 +573,12 @@ absl::StatusOr<TestResult> ParseAndTest(absl::string_view program,
                                         absl::string_view filename,
                                         const ParseAndTestOptions& options) {
   int64_t ran = 0;
-  int64_t failed = 0;
+  std::atomic<int64_t> failed(0);
   int64_t skipped = 0;
 
   auto handle_error = [&](const absl::Status& status,
-                          absl::string_view test_name, bool is_quickcheck) {
+                          absl::string_view test_name, bool is_quickcheck,
+                          std::ostream& os) {
     XLS_VLOG(1) << "Handling error; status: " << status
                 << " test_name: " << test_name;
     absl::StatusOr<PositionalErrorData> data_or =
@@ -274,8 +586,8 @@ absl::StatusOr<TestResult> ParseAndTest(absl::string_view program,
     std::string suffix;
     if (data_or.ok()) {
       const auto& data = data_or.value();
-      XLS_CHECK_OK(PrintPositionalError(data.span, data.GetMessageWithType(),
-                                        std::cerr));
+      XLS_CHECK_OK(
+          PrintPositionalError(data.span, data.GetMessageWithType(), os));
     } else {
       // If we can't extract positional data we log the error and put the error
       // status into the "failed" prompted.
@@ -283,14 +595,18 @@ absl::StatusOr<TestResult> ParseAndTest(absl::string_view program,
       suffix = absl::StrCat(": internal error: ", status.ToString());
     }
     std::string spaces((is_quickcheck ? kQuickcheckSpaces : kUnitSpaces), ' ');
-    std::cerr << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name,
-                                    suffix)
-              << std::endl;
+    os << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name, suffix)
+       << std::endl;
     failed += 1;
   };
 
   ImportData import_data(
       CreateImportData(options.stdlib_path, options.dslx_paths));
+  absl::optional<ModuleCache> module_cache;
+  if (options.module_cache_dir.has_value()) {
+    module_cache.emplace(*options.module_cache_dir);
+    import_data.SetModuleCache(&module_cache.value());
+  }
   absl::StatusOr<TypecheckedModule> tm_or =
       ParseAndTypecheck(program, filename, module_name, &import_data);
   if (!tm_or.ok()) {
@@ -346,57 +662,163 @@ absl::StatusOr<TestResult> ParseAndTest(absl::string_view program,
                           options.run_concolic, options.trace_format_preference,
                           post_fn_eval_hook);
 
-  // Run unit tests.
+  auto run_bytecode_test = [&](TestFunction* f,
+                               absl::Status* test_status) -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<BytecodeFunction> bf,
+        BytecodeEmitter::Emit(&import_data, tm_or.value().type_info, f->fn(),
+                              absl::nullopt,
+                              /*fuse_superinstructions=*/true));
+    *test_status =
+        BytecodeInterpreter::Interpret(&import_data, bf.get(), /*params=*/{})
+            .status();
+    return absl::OkStatus();
+  };
+
+  // IR functions which run the tests that execute in the JIT, by test name.
+  // Conversion modifies the package so it is done before any test runs.
+  std::unique_ptr<Package> test_package;
+  absl::flat_hash_map<std::string, xls::Function*> jit_test_functions;
+  auto run_jit_test = [&](TestFunction* f, xls::Function* ir_function,
+                          absl::Status* test_status) -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrJit> jit,
+                         IrJit::Create(ir_function));
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+                         jit->Run(absl::Span<const Value>()));
+    *test_status = InterpreterEventsToStatus(result.events);
+    if (!test_status->ok()) {
+      *test_status = FailureErrorStatus(f->fn()->span(),
+                                        test_status->message());
+    }
+    if (!options.compare_jit_tests) {
+      return absl::OkStatus();
+    }
+    absl::Status bytecode_status;
+    XLS_RETURN_IF_ERROR(run_bytecode_test(f, &bytecode_status));
+    if (bytecode_status.ok() != test_status->ok()) {
+      *test_status = FailureErrorStatus(
+          f->fn()->span(),
+          absl::StrFormat("JIT and bytecode interpreter test outcomes differ; "
+                          "JIT: %s; bytecode interpreter: %s",
+                          test_status->ToString(), bytecode_status.ToString()));
+    }
+    return absl::OkStatus();
+  };
+
+  // Runs a single unit test and stores its result in `test_status`. Returns an
+  // error if the test could not be run at all.
+  auto run_test = [&](const std::string& test_name,
+                      absl::Status* test_status) -> absl::Status {
+    if (auto it = jit_test_functions.find(test_name);
+        it != jit_test_functions.end()) {
+      XLS_ASSIGN_OR_RETURN(TestFunction * f, entry_module->GetTest(test_name));
+      return run_jit_test(f, it->second, test_status);
+    }
+    if (options.bytecode) {
+      XLS_ASSIGN_OR_RETURN(TestFunction * f, entry_module->GetTest(test_name));
+      return run_bytecode_test(f, test_status);
+    }
+    ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
+    if (absl::holds_alternative<TestFunction*>(*member)) {
+      *test_status = interpreter.RunTest(test_name);
+    } else if (absl::holds_alternative<TestProc*>(*member)) {
+      *test_status = interpreter.RunTestProc(test_name);
+    } else {
+      return absl::InvalidArgumentError(absl::StrCat(
+          test_name, " was neither a test function nor a test proc."));
+    }
+    return absl::OkStatus();
+  };
+
+  std::vector<std::string> test_names;
   for (const std::string& test_name : entry_module->GetTestNames()) {
     if (!TestMatchesFilter(test_name, options.test_filter)) {
       skipped += 1;
       continue;
     }
+    test_names.push_back(test_name);
+  }
+  ran = test_names.size();
+
+  if (options.jit_tests) {
+    test_package = std::make_unique<Package>(entry_module->name());
+    for (const std::string& test_name : test_names) {
+      absl::StatusOr<xls::Function*> ir_function = ConvertTestForJit(
+          entry_module, test_name, tm_or.value().type_info, &import_data,
+          options.convert_options, test_package.get());
+      if (ir_function.ok()) {
+        jit_test_functions[test_name] = ir_function.value();
+      } else {
+        XLS_VLOG(1) << "Not running test " << test_name
+                    << " in the JIT: " << ir_function.status();
+      }
+    }
+  }
 
-    ran += 1;
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
+  // Run unit tests. The bytecode interpreter and the JIT only read the (fully
+  // typechecked) module and the converted test package, so their tests may run
+  // concurrently, sharing one bytecode cache. The AST interpreter is stateful
+  // so its tests run one at a time once the concurrent tests have completed.
+  if (options.bytecode || options.compare_jit_tests) {
+    import_data.SetBytecodeCache(
+        std::make_unique<BytecodeCache>(&import_data));
+  }
+  OrderedOutput output(test_names.size());
+  std::vector<absl::Status> run_errors(test_names.size());
+  auto run_and_report = [&](int64_t i) {
+    const std::string& test_name = test_names[i];
+    std::stringstream os;
+    os << "[ RUN UNITTEST  ] " << test_name << std::endl;
     absl::Status status;
-    if (options.bytecode) {
-      auto cache = std::make_unique<BytecodeCache>(&import_data);
-      import_data.SetBytecodeCache(std::move(cache));
-      XLS_ASSIGN_OR_RETURN(TestFunction * f, entry_module->GetTest(test_name));
-      XLS_ASSIGN_OR_RETURN(
-          std::unique_ptr<BytecodeFunction> bf,
-          BytecodeEmitter::Emit(&import_data, tm_or.value().type_info, f->fn(),
-                                absl::nullopt));
-      status =
-          BytecodeInterpreter::Interpret(&import_data, bf.get(), /*params=*/{})
-              .status();
-    } else {
-      ModuleMember* member =
-          entry_module->FindMemberWithName(test_name).value();
-      if (absl::holds_alternative<TestFunction*>(*member)) {
-        status = interpreter.RunTest(test_name);
-      } else if (absl::holds_alternative<TestProc*>(*member)) {
-        status = interpreter.RunTestProc(test_name);
+    // Errors running the test (as opposed to test failures) are returned once
+    // all tests have completed.
+    run_errors[i] = run_test(test_name, &status);
+    if (run_errors[i].ok()) {
+      if (status.ok()) {
+        os << "[            OK ]" << std::endl;
       } else {
-        return absl::InvalidArgumentError(absl::StrCat(
-            test_name, " was neither a test function nor a test proc."));
+        handle_error(status, test_name, /*is_quickcheck=*/false, os);
       }
     }
-
-    if (status.ok()) {
-      std::cerr << "[            OK ]" << std::endl;
+    output.Complete(i, os.str());
+  };
+  std::vector<int64_t> concurrent_tests;
+  std::vector<int64_t> serial_tests;
+  for (int64_t i = 0; i < test_names.size(); ++i) {
+    TestEngine engine = TestEngine::kAstInterpreter;
+    if (jit_test_functions.contains(test_names[i])) {
+      engine = TestEngine::kJit;
+    } else if (options.bytecode) {
+      engine = TestEngine::kBytecodeInterpreter;
+    }
+    if (options.test_engines != nullptr) {
+      (*options.test_engines)[test_names[i]] = engine;
+    }
+    if (engine == TestEngine::kAstInterpreter) {
+      serial_tests.push_back(i);
     } else {
-      handle_error(status, test_name, /*is_quickcheck=*/false);
+      concurrent_tests.push_back(i);
     }
   }
+  ParallelFor(concurrent_tests.size(), options.num_threads,
+              [&](int64_t i) { run_and_report(concurrent_tests[i]); });
+  for (int64_t i : serial_tests) {
+    run_and_report(i);
+  }
+  for (const absl::Status& status : run_errors) {
+    XLS_RETURN_IF_ERROR(status);
+  }
 
   std::cerr << absl::StreamFormat(
                    "[===============] %d test(s) ran; %d failed; %d skipped.",
-                   ran, failed, skipped)
+                   ran, failed.load(), skipped)
             << std::endl;
 
   // Run quickchecks, but only if the JIT is enabled.
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         entry_module, interpreter.current_type_info(), options.run_comparator,
-        ir_package.get(), options.seed, handle_error));
+        ir_package.get(), options.seed, options, handle_error));
   }
 
   return failed == 0 ? TestResult::kAllPassed : TestResult::kSomeFailed;
@@ -18,6 +18,9 @@
 #ifndef XLS_DSLX_RUN_ROUTINES_H_
 #define XLS_DSLX_RUN_ROUTINES_H_
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/interpreter.h"
@@ -57,20 +60,31 @@ class RunComparator {
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
   //
-  // Note: There is no locking in jit compilation or on the jit function cache
-  // so this function is *not* thread-safe.
+  // This function is thread-safe. Compilation happens with the cache lock held
+  // so concurrent requests for the same function compile it only once. The
+  // returned IrJit may be run concurrently from multiple threads.
   absl::StatusOr<IrJit*> GetOrCompileJitFunction(std::string ir_name,
-                                                 xls::Function* ir_function);
+                                                 xls::Function* ir_function)
+      ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
   friend class RunRoutinesTest_TestInvokedFunctionDoesJit_Test;
   friend class RunRoutinesTest_QuickcheckInvokedFunctionDoesJit_Test;
   friend class RunRoutinesTest_NoSeedStillQuickChecks_Test;
 
-  absl::flat_hash_map<std::string, std::unique_ptr<IrJit>> jit_cache_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<IrJit>> jit_cache_
+      ABSL_GUARDED_BY(mutex_);
   CompareMode mode_;
 };
 
+// Engine in which a unit test is executed.
+enum class TestEngine {
+  kAstInterpreter,
+  kBytecodeInterpreter,
+  kJit,
+};
+
 // Optional arguments to ParseAndTest (that have sensible defaults).
 //
 //   test_filter: Test filter specification (e.g. as passed from bazel test
@@ -81,6 +95,28 @@ class RunComparator {
 //   seed: Seed for QuickCheck random input stimulus.
 //   convert_options: Options used in IR conversion, see `ConvertOptions` for
 //    details.
+//   num_threads: Number of threads used to run tests and quickcheck samples;
+//    zero means one per hardware thread. Only tests run in the bytecode
+//    interpreter or the JIT run concurrently. Test results are always
+//    reported in test order, but trace output (e.g. from `trace!`) of
+//    concurrently running tests is written as it is produced and may be
+//    interleaved.
+//   module_cache_dir: If given, typechecked imported modules are cached in (and
+//    restored from) this directory, see `ModuleCache`.
+//   jit_tests: Whether to run test functions by converting them to IR and
+//    executing them in the JIT. Tests which cannot be converted (e.g. which use
+//    procs) or which produce trace output run in the interpreter selected by
+//    `bytecode` instead. With the AST interpreter, these fallback tests run
+//    one at a time after the concurrently run JIT tests.
+//   compare_jit_tests: When running tests in the JIT, whether to also run them
+//    in the bytecode interpreter; the test fails if the outcomes differ.
+//   test_engines: If given, populated with the engine each test ran in, keyed
+//    by test name.
+//   quickcheck_corner_cases: Whether quickcheck samples are biased towards
+//    corner cases (see `CornerCaseValue`) instead of uniformly random.
+//   max_exhaustive_quickcheck_bits: If given, quickchecks whose arguments have
+//    at most this many bits in total are checked on every possible input
+//    instead of on `test_count` samples.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths = {};
@@ -92,6 +128,13 @@ struct ParseAndTestOptions {
   absl::optional<int64_t> seed = absl::nullopt;
   ConvertOptions convert_options;
   bool bytecode = false;
+  int64_t num_threads = 1;
+  absl::optional<std::filesystem::path> module_cache_dir = absl::nullopt;
+  bool jit_tests = false;
+  bool compare_jit_tests = false;
+  absl::flat_hash_map<std::string, TestEngine>* test_engines = nullptr;
+  bool quickcheck_corner_cases = false;
+  absl::optional<int64_t> max_exhaustive_quickcheck_bits = absl::nullopt;
 };
 
 enum class TestResult {
@@ -127,10 +170,52 @@ struct QuickCheckResults {
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
 // length of the returned vectors may be < 1000).
+//
+// Samples are generated and evaluated in fixed-size batches on up to
+// `num_threads` threads (zero means one per hardware thread). Each batch draws
+// its arguments from a generator seeded with `seed` and the batch index, so
+// the results depend only on `seed` and not on the number of threads.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(xls::Function* xls_function,
                                                std::string ir_name,
                                                RunComparator* run_comparator,
-                                               int64_t seed, int64_t num_tests);
+                                               int64_t seed, int64_t num_tests,
+                                               int64_t num_threads = 0);
+
+// How the inputs of a quickcheck are chosen, see `StreamQuickCheck`.
+enum class QuickCheckMode {
+  // Uniformly random samples, as drawn by `DoQuickCheck`.
+  kRandom,
+  // Random samples biased towards corner cases, see `CornerCaseValue`.
+  kCornerCases,
+  // Every possible input, in order of the input bits viewed as a number (with
+  // the first parameter in the least significant bits).
+  kExhaustive,
+};
+
+// Maximum total bit count of the arguments of a function checked in
+// `QuickCheckMode::kExhaustive`.
+inline constexpr int64_t kMaxExhaustiveQuickCheckBits = 48;
+
+struct QuickCheckOutcome {
+  // Number of samples evaluated, up to and including the falsifying example.
+  int64_t sample_count = 0;
+  // Arguments for which xls_function returned false, if any.
+  absl::optional<std::vector<Value>> falsifying_args;
+};
+
+// As DoQuickCheck, but only the falsifying example (if any) is retained.
+// Samples are evaluated in batches which reuse the JIT argument and result
+// buffers, a few batches per thread at a time, so memory use does not depend
+// on the number of samples. In kExhaustive mode `num_tests` is ignored; it is
+// an error if the arguments of xls_function have more than
+// kMaxExhaustiveQuickCheckBits bits.
+//
+// In kRandom mode the samples are the same as those of DoQuickCheck for the
+// same seed.
+absl::StatusOr<QuickCheckOutcome> StreamQuickCheck(
+    xls::Function* xls_function, std::string ir_name,
+    RunComparator* run_comparator, QuickCheckMode mode, int64_t seed,
+    int64_t num_tests, int64_t num_threads = 0);
 
 }  // namespace xls::dslx
 
@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
@@ -105,6 +106,81 @@ fn trivial(x: u5) -> bool { false }
   EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
 }
 
+TEST(RunRoutinesTest, JitTestsPass) {
+  constexpr const char* kProgram = R"(
+fn checked_double(x: u32) -> u32 {
+  if x > u32:100 { fail!(x) } else { x + x }
+}
+
+#![test]
+fn test_double() {
+  let _ = assert_eq(checked_double(u32:21), u32:42);
+  assert_lt(s8:-1, s8:1)
+}
+
+#![test]
+fn test_traced() {
+  let _ = trace_fmt!("x: {}", u32:42);
+  ()
+}
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  absl::flat_hash_map<std::string, TestEngine> test_engines;
+  ParseAndTestOptions options;
+  options.jit_tests = true;
+  options.compare_jit_tests = true;
+  options.num_threads = 4;
+  options.test_engines = &test_engines;
+  absl::StatusOr<TestResult> result =
+      ParseAndTest(kProgram, kModuleName, kFilename, options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed));
+
+  // The traced test falls back to the (default) AST interpreter.
+  EXPECT_THAT(test_engines,
+              testing::UnorderedElementsAre(
+                  testing::Pair("test_double", TestEngine::kJit),
+                  testing::Pair("test_traced", TestEngine::kAstInterpreter)));
+
+  options.bytecode = true;
+  test_engines.clear();
+  result = ParseAndTest(kProgram, kModuleName, kFilename, options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed));
+  EXPECT_THAT(
+      test_engines,
+      testing::UnorderedElementsAre(
+          testing::Pair("test_double", TestEngine::kJit),
+          testing::Pair("test_traced", TestEngine::kBytecodeInterpreter)));
+}
+
+TEST(RunRoutinesTest, FailingJitTest) {
+  constexpr const char* kProgram = R"(
+fn checked_double(x: u32) -> u32 {
+  if x > u32:100 { fail!(x) } else { x + x }
+}
+
+#![test]
+fn test_double() {
+  assert_eq(checked_double(u32:101), u32:202)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  constexpr const char* kModuleName = "test";
+  for (bool compare : {false, true}) {
+    absl::flat_hash_map<std::string, TestEngine> test_engines;
+    ParseAndTestOptions options;
+    options.jit_tests = true;
+    options.compare_jit_tests = compare;
+    options.test_engines = &test_engines;
+    absl::StatusOr<TestResult> result = ParseAndTest(
+        kProgram, kModuleName, std::string(temp_file.path()), options);
+    EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+    EXPECT_THAT(test_engines, testing::UnorderedElementsAre(testing::Pair(
+                                  "test_double", TestEngine::kJit)));
+  }
+}
+
 // Verifies that the QuickCheck mechanism can find counter-examples for a simple
 // erroneous function.
 TEST(QuickcheckTest, QuickCheckBits) {
@@ -226,4 +302,155 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// The samples drawn for a given seed do not depend on the number of threads
+// evaluating them, including where the first falsifying example is found.
+TEST(QuickcheckTest, ThreadCountDoesNotAffectResults) {
+  Package package("sometimes_false");
+  std::string ir_text = R"(
+  fn not_max(x: bits[16]) -> bits[1] {
+    literal.2: bits[16] = literal(value=0xffff)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto sequential, DoQuickCheck(function, kFakeIrName, &jit_comparator,
+                                    seed, num_tests, /*num_threads=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto parallel, DoQuickCheck(function, kFakeIrName, &jit_comparator, seed,
+                                  num_tests, /*num_threads=*/8));
+
+  EXPECT_EQ(sequential.arg_sets, parallel.arg_sets);
+  EXPECT_EQ(sequential.results, parallel.results);
+}
+
+TEST(QuickcheckTest, ExhaustiveFindsSingleFalsifyingInput) {
+  Package package("single_false");
+  std::string ir_text = R"(
+  fn not_magic(x: bits[4], y: (bits[8], bits[4])) -> bits[1] {
+    y0: bits[8] = tuple_index(y, index=0)
+    y1: bits[4] = tuple_index(y, index=1)
+    x_magic: bits[4] = literal(value=5)
+    y0_magic: bits[8] = literal(value=0xa3)
+    y1_magic: bits[4] = literal(value=0xc)
+    x_eq: bits[1] = eq(x, x_magic)
+    y0_eq: bits[1] = eq(y0, y0_magic)
+    y1_eq: bits[1] = eq(y1, y1_magic)
+    all_eq: bits[1] = and(x_eq, y0_eq, y1_eq)
+    ret result: bits[1] = not(all_eq)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckOutcome outcome,
+      StreamQuickCheck(function, kFakeIrName, &jit_comparator,
+                       QuickCheckMode::kExhaustive, /*seed=*/0,
+                       /*num_tests=*/1));
+  // The first parameter occupies the least significant bits of the sample.
+  EXPECT_EQ(outcome.sample_count, 0xca35 + 1);
+  ASSERT_TRUE(outcome.falsifying_args.has_value());
+  EXPECT_THAT(*outcome.falsifying_args,
+              testing::ElementsAre(Value(UBits(5, 4)),
+                                   Value::Tuple({Value(UBits(0xa3, 8)),
+                                                 Value(UBits(0xc, 4))})));
+}
+
+// Samples are evaluated in bounded chunks, so a falsifying input early in the
+// input space of a function at the exhaustive-checking limit is found without
+// visiting (or allocating state for) the rest of the space.
+TEST(QuickcheckTest, ExhaustiveAtBitLimitStopsAtFalsifyingInput) {
+  static_assert(kMaxExhaustiveQuickCheckBits == 48);
+  Package package("wide");
+  std::string ir_text = R"(
+  fn not_magic(x: bits[48]) -> bits[1] {
+    magic: bits[48] = literal(value=5000)
+    ret result: bits[1] = ne(x, magic)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckOutcome outcome,
+      StreamQuickCheck(function, kFakeIrName, &jit_comparator,
+                       QuickCheckMode::kExhaustive, /*seed=*/0,
+                       /*num_tests=*/1, /*num_threads=*/4));
+  EXPECT_EQ(outcome.sample_count, 5001);
+  ASSERT_TRUE(outcome.falsifying_args.has_value());
+  EXPECT_THAT(*outcome.falsifying_args,
+              testing::ElementsAre(Value(UBits(5000, 48))));
+}
+
+TEST(QuickcheckTest, ExhaustiveWithoutFalsifyingInput) {
+  Package package("always_true");
+  std::string ir_text = R"(
+  fn ret_true(x: bits[12]) -> bits[1] {
+    ret eq_value: bits[1] = eq(x, x)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckOutcome outcome,
+      StreamQuickCheck(function, kFakeIrName, &jit_comparator,
+                       QuickCheckMode::kExhaustive, /*seed=*/0,
+                       /*num_tests=*/1, /*num_threads=*/4));
+  EXPECT_EQ(outcome.sample_count, 4096);
+  EXPECT_FALSE(outcome.falsifying_args.has_value());
+}
+
+TEST(QuickcheckTest, CornerCasesFindBoundaryValue) {
+  Package package("not_min_signed");
+  std::string ir_text = R"(
+  fn not_min_signed(x: bits[32]) -> bits[1] {
+    literal.1: bits[32] = literal(value=0x80000000)
+    ret ne.2: bits[1] = ne(x, literal.1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckOutcome outcome,
+      StreamQuickCheck(function, kFakeIrName, &jit_comparator,
+                       QuickCheckMode::kCornerCases, /*seed=*/42,
+                       /*num_tests=*/1000));
+  ASSERT_TRUE(outcome.falsifying_args.has_value());
+  EXPECT_THAT(*outcome.falsifying_args,
+              testing::ElementsAre(Value(UBits(0x80000000, 32))));
+}
+
+// In random mode the samples are those of DoQuickCheck.
+TEST(QuickcheckTest, StreamingMatchesDoQuickCheck) {
+  Package package("sometimes_false");
+  std::string ir_text = R"(
+  fn not_max(x: bits[10]) -> bits[1] {
+    literal.2: bits[10] = literal(value=0x3ff)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 7;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults results,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckOutcome outcome,
+      StreamQuickCheck(function, kFakeIrName, &jit_comparator,
+                       QuickCheckMode::kRandom, seed, num_tests));
+  EXPECT_EQ(outcome.sample_count, results.results.size());
+  ASSERT_TRUE(outcome.falsifying_args.has_value());
+  EXPECT_EQ(*outcome.falsifying_args, results.arg_sets.back());
+}
+
 }  // namespace xls::dslx
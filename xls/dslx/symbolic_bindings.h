@@ -71,7 +71,7 @@ class SymbolicBindings {
   template <typename H>
   friend H AbslHashValue(H h, const SymbolicBindings& self) {
     for (const SymbolicBinding& sb : self.bindings_) {
-      h = H::combine(std::move(h), sb.identifier, sb.value.ToString());
+      h = H::combine(std::move(h), sb.identifier, sb.value);
     }
     return h;
   }
@@ -247,6 +247,21 @@ class TypeInfo {
     return dict_;
   }
 
+  // Accessors for the remaining underlying mappings, e.g. for serialization.
+  // Note that these do not consult the parent (or root) type information.
+  const absl::flat_hash_map<Slice*, SliceData>& slices() const {
+    return slices_;
+  }
+  const absl::flat_hash_map<AstNode*, InterpValue>& const_exprs() const {
+    return const_exprs_;
+  }
+  const absl::flat_hash_map<NameDef*, ConstantDef*>& name_to_const() const {
+    return name_to_const_;
+  }
+  const absl::flat_hash_map<Function*, bool>& requires_implicit_token() const {
+    return requires_implicit_token_;
+  }
+
  private:
   friend class TypeInfoOwner;
 
@@ -14,7 +14,13 @@
 
 #include "xls/dslx/type_info_to_proto.h"
 
+#include <deque>
+#include <tuple>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "xls/common/proto_adaptor_utils.h"
+#include "xls/common/status/ret_check.h"
 
 namespace xls::dslx {
 namespace {
@@ -148,13 +154,31 @@ std::string U8sToString(absl::Span<const uint8_t> bs) {
   return std::string(reinterpret_cast<const char*>(bs.data()), bs.size());
 }
 
+BitsValueProto ToProto(const Bits& bits, bool is_signed) {
+  BitsValueProto proto;
+  proto.set_is_signed(is_signed);
+  proto.set_bit_count(bits.bit_count());
+  *proto.mutable_data() = U8sToString(bits.ToBytes());
+  return proto;
+}
+
 absl::StatusOr<InterpValueProto> ToProto(const InterpValue& v) {
   InterpValueProto proto;
   if (v.IsBits()) {
-    BitsValueProto* bvp = proto.mutable_bits();
-    bvp->set_is_signed(v.IsSBits());
-    bvp->set_bit_count(v.GetBitCount().value());
-    *bvp->mutable_data() = U8sToString(v.GetBitsOrDie().ToBytes());
+    *proto.mutable_bits() = ToProto(v.GetBitsOrDie(), v.IsSBits());
+  } else if (v.IsEnum()) {
+    EnumValueProto* evp = proto.mutable_enum_value();
+    *evp->mutable_enum_def_span() = ToProto(v.type()->span());
+    // Signedness is a property of the enum definition.
+    *evp->mutable_bits() = ToProto(v.GetBitsOrDie(), /*is_signed=*/false);
+  } else if (v.IsTuple() || v.IsArray()) {
+    InterpValuesProto* elements =
+        v.IsTuple() ? proto.mutable_tuple() : proto.mutable_array();
+    for (const InterpValue& element : v.GetValuesOrDie()) {
+      XLS_ASSIGN_OR_RETURN(*elements->add_elements(), ToProto(element));
+    }
+  } else if (v.IsToken()) {
+    proto.mutable_token();
   } else {
     return absl::UnimplementedError("Convert InterpValue to proto: " +
                                     v.ToString());
@@ -169,10 +193,29 @@ absl::StatusOr<ParametricExpressionProto> ToProto(
     ParametricSymbolProto* psproto = proto.mutable_symbol();
     psproto->set_identifier(s->identifier());
     *psproto->mutable_span() = ToProto(s->span());
+  } else if (const auto* c = dynamic_cast<const ParametricConstant*>(&e)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_constant(), ToProto(c->value()));
+    // The value is held directly by the constant, no need to repeat it below.
     return proto;
+  } else if (const auto* add = dynamic_cast<const ParametricAdd*>(&e)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_add()->mutable_lhs(),
+                         ToProto(add->lhs()));
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_add()->mutable_rhs(),
+                         ToProto(add->rhs()));
+  } else if (const auto* mul = dynamic_cast<const ParametricMul*>(&e)) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_mul()->mutable_lhs(),
+                         ToProto(mul->lhs()));
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_mul()->mutable_rhs(),
+                         ToProto(mul->rhs()));
+  } else {
+    return absl::UnimplementedError("Convert ParametricExpression to proto: " +
+                                    e.ToString());
+  }
+  if (e.const_value().has_value()) {
+    XLS_ASSIGN_OR_RETURN(*proto.mutable_const_value(),
+                         ToProto(e.const_value().value()));
   }
-  return absl::UnimplementedError("Convert ParametricExpression to proto: " +
-                                  e.ToString());
+  return proto;
 }
 
 absl::StatusOr<ConcreteTypeDimProto> ToProto(const ConcreteTypeDim& ctd) {
@@ -261,6 +304,9 @@ absl::StatusOr<EnumTypeProto> ToProto(const EnumType& enum_type) {
   XLS_ASSIGN_OR_RETURN(*proto.mutable_enum_def(),
                        ToProto(enum_type.nominal_type()));
   XLS_ASSIGN_OR_RETURN(*proto.mutable_size(), ToProto(enum_type.size()));
+  for (const InterpValue& member : enum_type.members()) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_members(), ToProto(member));
+  }
   return proto;
 }
 
@@ -326,13 +372,77 @@ absl::Span<const uint8_t> ToU8Span(const std::string& s) {
                                    s.size());
 }
 
-absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp) {
+// Modules in which struct and enum definitions referred to from serialized
+// type information are looked up (by span).
+using DefinitionModules = absl::Span<const Module* const>;
+
+std::string ModuleNames(DefinitionModules modules) {
+  return absl::StrJoin(modules, ", ", [](std::string* out, const Module* m) {
+    absl::StrAppend(out, m->name());
+  });
+}
+
+absl::StatusOr<const EnumDef*> FindEnumDef(DefinitionModules modules,
+                                           const SpanProto& span,
+                                           absl::string_view identifier) {
+  for (const Module* m : modules) {
+    if (const EnumDef* enum_def = m->FindEnumDef(FromProto(span))) {
+      return enum_def;
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrFormat("Enum definition not found in module %s: %s",
+                      ModuleNames(modules), identifier));
+}
+
+absl::StatusOr<const StructDef*> FindStructDef(DefinitionModules modules,
+                                               const SpanProto& span,
+                                               absl::string_view identifier) {
+  for (const Module* m : modules) {
+    if (const StructDef* struct_def = m->FindStructDef(FromProto(span))) {
+      return struct_def;
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrFormat("Structure definition not found in module %s: %s",
+                      ModuleNames(modules), identifier));
+}
+
+Bits FromProto(const BitsValueProto& bvp) {
+  return Bits::FromBytes(ToU8Span(bvp.data()), bvp.bit_count());
+}
+
+absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp,
+                                      DefinitionModules modules) {
   switch (ivp.value_oneof_case()) {
     case InterpValueProto::ValueOneofCase::kBits: {
-      return InterpValue::MakeBits(
-          ivp.bits().is_signed(),
-          Bits::FromBytes(ToU8Span(ivp.bits().data()), ivp.bits().bit_count()));
+      return InterpValue::MakeBits(ivp.bits().is_signed(),
+                                   FromProto(ivp.bits()));
+    }
+    case InterpValueProto::ValueOneofCase::kEnumValue: {
+      const EnumValueProto& evp = ivp.enum_value();
+      XLS_ASSIGN_OR_RETURN(
+          const EnumDef* enum_def,
+          FindEnumDef(modules, evp.enum_def_span(), "<enum value>"));
+      return InterpValue::MakeEnum(FromProto(evp.bits()), enum_def);
     }
+    case InterpValueProto::ValueOneofCase::kTuple:
+    case InterpValueProto::ValueOneofCase::kArray: {
+      bool is_tuple =
+          ivp.value_oneof_case() == InterpValueProto::ValueOneofCase::kTuple;
+      std::vector<InterpValue> elements;
+      for (const InterpValueProto& element :
+           is_tuple ? ivp.tuple().elements() : ivp.array().elements()) {
+        XLS_ASSIGN_OR_RETURN(InterpValue value, FromProto(element, modules));
+        elements.push_back(std::move(value));
+      }
+      if (is_tuple) {
+        return InterpValue::MakeTuple(std::move(elements));
+      }
+      return InterpValue::MakeArray(std::move(elements));
+    }
+    case InterpValueProto::ValueOneofCase::kToken:
+      return InterpValue::MakeToken();
     default:
       break;
   }
@@ -343,16 +453,42 @@ absl::StatusOr<InterpValue> FromProto(const InterpValueProto& ivp) {
 }
 
 std::unique_ptr<ParametricSymbol> FromProto(
-    const ParametricSymbolProto& proto) {
-  return std::make_unique<ParametricSymbol>(proto.identifier(),
-                                            FromProto(proto.span()));
+    const ParametricSymbolProto& proto,
+    absl::optional<InterpValue> const_value) {
+  return std::make_unique<ParametricSymbol>(
+      proto.identifier(), FromProto(proto.span()), std::move(const_value));
 }
 
 absl::StatusOr<std::unique_ptr<ParametricExpression>> FromProto(
-    const ParametricExpressionProto& proto) {
+    const ParametricExpressionProto& proto, DefinitionModules modules) {
+  absl::optional<InterpValue> const_value;
+  if (proto.has_const_value()) {
+    XLS_ASSIGN_OR_RETURN(const_value, FromProto(proto.const_value(), modules));
+  }
   switch (proto.expr_oneof_case()) {
     case ParametricExpressionProto::ExprOneofCase::kSymbol: {
-      return FromProto(proto.symbol());
+      return FromProto(proto.symbol(), std::move(const_value));
+    }
+    case ParametricExpressionProto::ExprOneofCase::kConstant: {
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(proto.constant(), modules));
+      return std::make_unique<ParametricConstant>(std::move(value));
+    }
+    case ParametricExpressionProto::ExprOneofCase::kAdd:
+    case ParametricExpressionProto::ExprOneofCase::kMul: {
+      bool is_add = proto.expr_oneof_case() ==
+                    ParametricExpressionProto::ExprOneofCase::kAdd;
+      const ParametricBinaryProto& binary = is_add ? proto.add() : proto.mul();
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> lhs,
+                           FromProto(binary.lhs(), modules));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> rhs,
+                           FromProto(binary.rhs(), modules));
+      if (is_add) {
+        return std::make_unique<ParametricAdd>(std::move(lhs), std::move(rhs),
+                                               std::move(const_value));
+      }
+      return std::make_unique<ParametricMul>(std::move(lhs), std::move(rhs),
+                                             std::move(const_value));
     }
     default:
       break;
@@ -363,15 +499,17 @@ absl::StatusOr<std::unique_ptr<ParametricExpression>> FromProto(
       proto.ShortDebugString());
 }
 
-absl::StatusOr<ConcreteTypeDim> FromProto(const ConcreteTypeDimProto& ctdp) {
+absl::StatusOr<ConcreteTypeDim> FromProto(const ConcreteTypeDimProto& ctdp,
+                                          DefinitionModules modules) {
   switch (ctdp.dim_oneof_case()) {
     case ConcreteTypeDimProto::DimOneofCase::kInterpValue: {
-      XLS_ASSIGN_OR_RETURN(InterpValue iv, FromProto(ctdp.interp_value()));
+      XLS_ASSIGN_OR_RETURN(InterpValue iv,
+                           FromProto(ctdp.interp_value(), modules));
       return ConcreteTypeDim(std::move(iv));
     }
     case ConcreteTypeDimProto::DimOneofCase::kParametric: {
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<ParametricExpression> p,
-                           FromProto(ctdp.parametric()));
+                           FromProto(ctdp.parametric(), modules));
       return ConcreteTypeDim(std::move(p));
     }
     default:
@@ -383,11 +521,11 @@ absl::StatusOr<ConcreteTypeDim> FromProto(const ConcreteTypeDimProto& ctdp) {
 }
 
 absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
-    const ConcreteTypeProto& ctp, const Module& m) {
+    const ConcreteTypeProto& ctp, DefinitionModules modules) {
   switch (ctp.concrete_type_oneof_case()) {
     case ConcreteTypeProto::ConcreteTypeOneofCase::kBitsType: {
       XLS_ASSIGN_OR_RETURN(ConcreteTypeDim dim,
-                           FromProto(ctp.bits_type().dim()));
+                           FromProto(ctp.bits_type().dim(), modules));
       return std::make_unique<BitsType>(ctp.bits_type().is_signed(),
                                         std::move(dim));
     }
@@ -395,16 +533,16 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
       std::vector<std::unique_ptr<ConcreteType>> members;
       for (const ConcreteTypeProto& member : ctp.tuple_type().members()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct,
-                             FromProto(member, m));
+                             FromProto(member, modules));
         members.push_back(std::move(ct));
       }
       return std::make_unique<TupleType>(std::move(members));
     }
     case ConcreteTypeProto::ConcreteTypeOneofCase::kArrayType: {
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> element_type,
-                           FromProto(ctp.array_type().element_type(), m));
+                           FromProto(ctp.array_type().element_type(), modules));
       XLS_ASSIGN_OR_RETURN(ConcreteTypeDim size,
-                           FromProto(ctp.array_type().size()));
+                           FromProto(ctp.array_type().size(), modules));
       return std::make_unique<ArrayType>(std::move(element_type),
                                          std::move(size));
     }
@@ -412,16 +550,13 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
       const EnumTypeProto& etp = ctp.enum_type();
       const EnumDefProto& enum_def_proto = etp.enum_def();
       XLS_ASSIGN_OR_RETURN(ConcreteTypeDim size,
-                           FromProto(ctp.enum_type().size()));
-      const EnumDef* enum_def = m.FindEnumDef(FromProto(enum_def_proto.span()));
-      if (enum_def == nullptr) {
-        return absl::NotFoundError(
-            absl::StrFormat("Enum definition not found in module %s: %s",
-                            m.name(), enum_def_proto.identifier()));
-      }
+                           FromProto(ctp.enum_type().size(), modules));
+      XLS_ASSIGN_OR_RETURN(const EnumDef* enum_def,
+                           FindEnumDef(modules, enum_def_proto.span(),
+                                       enum_def_proto.identifier()));
       std::vector<InterpValue> members;
       for (const InterpValueProto& value : etp.members()) {
-        XLS_ASSIGN_OR_RETURN(InterpValue member, FromProto(value));
+        XLS_ASSIGN_OR_RETURN(InterpValue member, FromProto(value, modules));
         members.push_back(member);
       }
 
@@ -432,11 +567,11 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
       std::vector<std::unique_ptr<ConcreteType>> params;
       for (const ConcreteTypeProto& param : ftp.params()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct,
-                             FromProto(param, m));
+                             FromProto(param, modules));
         params.push_back(std::move(ct));
       }
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> rt,
-                           FromProto(ftp.return_type(), m));
+                           FromProto(ftp.return_type(), modules));
       return std::make_unique<FunctionType>(std::move(params), std::move(rt));
     }
     case ConcreteTypeProto::ConcreteTypeOneofCase::kTokenType: {
@@ -445,17 +580,13 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
     case ConcreteTypeProto::ConcreteTypeOneofCase::kStructType: {
       const StructTypeProto& stp = ctp.struct_type();
       const StructDefProto& struct_def_proto = stp.struct_def();
-      const StructDef* struct_def =
-          m.FindStructDef(FromProto(struct_def_proto.span()));
-      if (struct_def == nullptr) {
-        return absl::NotFoundError(
-            absl::StrFormat("Structure definition not found in module %s: %s",
-                            m.name(), struct_def_proto.identifier()));
-      }
+      XLS_ASSIGN_OR_RETURN(const StructDef* struct_def,
+                           FindStructDef(modules, struct_def_proto.span(),
+                                         struct_def_proto.identifier()));
       std::vector<std::unique_ptr<ConcreteType>> members;
       for (const ConcreteTypeProto& member_proto : stp.members()) {
         XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> member,
-                             FromProto(member_proto, m));
+                             FromProto(member_proto, modules));
         members.push_back(std::move(member));
       }
       return std::make_unique<StructType>(std::move(members), *struct_def);
@@ -470,7 +601,8 @@ absl::StatusOr<std::unique_ptr<ConcreteType>> FromProto(
 
 absl::StatusOr<std::string> ToHumanString(const ConcreteTypeProto& ctp,
                                           const Module& m) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct, FromProto(ctp, m));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> ct,
+                       FromProto(ctp, DefinitionModules({&m})));
   return ct->ToString();
 }
 
@@ -583,6 +715,480 @@ absl::StatusOr<AstNodeKind> FromProto(AstNodeKindProto p) {
       absl::StrCat("Unknown AstNodeKindProto: ", p));
 }
 
+absl::StatusOr<SymbolicBindingsProto> ToProto(const SymbolicBindings& sb) {
+  SymbolicBindingsProto proto;
+  for (const SymbolicBinding& binding : sb.bindings()) {
+    SymbolicBindingProto* binding_proto = proto.add_bindings();
+    binding_proto->set_identifier(binding.identifier);
+    XLS_ASSIGN_OR_RETURN(*binding_proto->mutable_value(),
+                         ToProto(binding.value));
+  }
+  return proto;
+}
+
+absl::StatusOr<SymbolicBindings> FromProto(const SymbolicBindingsProto& proto,
+                                           DefinitionModules modules) {
+  std::vector<std::pair<std::string, InterpValue>> items;
+  for (const SymbolicBindingProto& binding : proto.bindings()) {
+    XLS_ASSIGN_OR_RETURN(InterpValue value,
+                         FromProto(binding.value(), modules));
+    items.push_back({binding.identifier(), std::move(value)});
+  }
+  return SymbolicBindings(items);
+}
+
+// Serializes the tree of type information objects of a module, see
+// ModuleTypeInfoToProto().
+class ModuleTypeInfoSerializer {
+ public:
+  explicit ModuleTypeInfoSerializer(const TypeInfo& root) : root_(root) {}
+
+  absl::StatusOr<ModuleTypeInfoProto> Serialize() {
+    XLS_RETURN_IF_ERROR(AddEntry(&root_).status());
+    for (const auto& [import, info] : root_.imports()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, GetNodeIndex(import));
+      proto_.add_imports(index);
+    }
+    // Serializing the data of a root can discover the roots of further
+    // (imported) modules, via the parents of instantiation type information.
+    EnqueueRoot(&root_);
+    while (!pending_roots_.empty()) {
+      const TypeInfo* root = pending_roots_.front();
+      pending_roots_.pop_front();
+      XLS_RETURN_IF_ERROR(AddRootData(root));
+    }
+    return std::move(proto_);
+  }
+
+ private:
+  void EnqueueRoot(const TypeInfo* root) {
+    if (seen_roots_.insert(root).second) {
+      pending_roots_.push_back(root);
+    }
+  }
+
+  absl::StatusOr<int64_t> GetNodeIndex(const AstNode* node) {
+    const Module* module = node->owner();
+    auto it = node_indices_.find(module);
+    if (it == node_indices_.end()) {
+      absl::flat_hash_map<const AstNode*, int64_t> indices;
+      absl::Span<const std::unique_ptr<AstNode>> nodes = module->nodes();
+      for (int64_t i = 0; i < nodes.size(); ++i) {
+        indices[nodes[i].get()] = i;
+      }
+      it = node_indices_.emplace(module, std::move(indices)).first;
+    }
+    auto node_it = it->second.find(node);
+    XLS_RET_CHECK(node_it != it->second.end())
+        << "AST node not owned by module " << module->name() << ": "
+        << node->ToString();
+    return node_it->second;
+  }
+
+  // Returns the index of the entry for the given (non-root) type information,
+  // adding it and the entries for its parents first if required.
+  absl::StatusOr<int64_t> AddEntry(const TypeInfo* type_info) {
+    if (auto it = entry_indices_.find(type_info); it != entry_indices_.end()) {
+      return it->second;
+    }
+    const TypeInfo* parent = type_info->parent();
+    absl::optional<int64_t> parent_index;
+    if (parent == nullptr) {
+      if (type_info != &root_) {
+        return absl::UnimplementedError(absl::StrCat(
+            "Cannot serialize a reference to the root type information of "
+            "module ",
+            type_info->module()->name()));
+      }
+    } else if (parent->parent() == nullptr) {
+      EnqueueRoot(parent);
+    } else {
+      XLS_ASSIGN_OR_RETURN(parent_index, AddEntry(parent));
+    }
+
+    int64_t index = proto_.entries_size();
+    entry_indices_[type_info] = index;
+    TypeInfoEntryProto* entry = proto_.add_entries();
+    entry->set_module_name(type_info->module()->name());
+    if (parent_index.has_value()) {
+      entry->set_parent(parent_index.value());
+    }
+    for (const auto& [node, type] : type_info->dict()) {
+      NodeTypeProto* node_type = entry->add_types();
+      XLS_ASSIGN_OR_RETURN(int64_t node_index, GetNodeIndex(node));
+      node_type->set_node(node_index);
+      XLS_ASSIGN_OR_RETURN(*node_type->mutable_type(), ToProto(*type));
+    }
+    for (const auto& [node, value] : type_info->const_exprs()) {
+      ConstExprProto* const_expr = entry->add_const_exprs();
+      XLS_ASSIGN_OR_RETURN(int64_t node_index, GetNodeIndex(node));
+      const_expr->set_node(node_index);
+      XLS_ASSIGN_OR_RETURN(*const_expr->mutable_value(), ToProto(value));
+    }
+    for (const auto& [name_def, constant_def] : type_info->name_to_const()) {
+      NameToConstProto* name_to_const = entry->add_name_to_const();
+      XLS_ASSIGN_OR_RETURN(int64_t name_def_index, GetNodeIndex(name_def));
+      XLS_ASSIGN_OR_RETURN(int64_t constant_def_index,
+                           GetNodeIndex(constant_def));
+      name_to_const->set_name_def(name_def_index);
+      name_to_const->set_constant_def(constant_def_index);
+    }
+    return index;
+  }
+
+  absl::Status AddRootData(const TypeInfo* root) {
+    RootTypeInfoDataProto* root_proto = proto_.add_roots();
+    root_proto->set_module_name(root->module()->name());
+    for (const auto& [node, data] : root->slices()) {
+      XLS_ASSIGN_OR_RETURN(int64_t node_index, GetNodeIndex(node));
+      for (const auto& [bindings, start_width] :
+           data.bindings_to_start_width) {
+        SliceStartAndWidthProto* slice = root_proto->add_slices();
+        slice->set_node(node_index);
+        XLS_ASSIGN_OR_RETURN(*slice->mutable_bindings(), ToProto(bindings));
+        slice->set_start(start_width.start);
+        slice->set_width(start_width.width);
+      }
+    }
+    for (const auto& [node, data] : root->instantiations()) {
+      XLS_ASSIGN_OR_RETURN(int64_t node_index, GetNodeIndex(node));
+      // Callee bindings and derived type information are noted separately, so
+      // either may be present for a given caller.
+      absl::flat_hash_set<const SymbolicBindings*> callers;
+      for (const auto& [caller, callee] : data.symbolic_bindings_map) {
+        callers.insert(&caller);
+      }
+      for (const auto& [caller, type_info] : data.instantiations) {
+        if (!data.symbolic_bindings_map.contains(caller)) {
+          callers.insert(&caller);
+        }
+      }
+      for (const SymbolicBindings* caller : callers) {
+        InstantiationProto* instantiation = root_proto->add_instantiations();
+        instantiation->set_node(node_index);
+        XLS_ASSIGN_OR_RETURN(*instantiation->mutable_caller(),
+                             ToProto(*caller));
+        if (auto it = data.symbolic_bindings_map.find(*caller);
+            it != data.symbolic_bindings_map.end()) {
+          XLS_ASSIGN_OR_RETURN(*instantiation->mutable_callee(),
+                               ToProto(it->second));
+        }
+        if (auto it = data.instantiations.find(*caller);
+            it != data.instantiations.end()) {
+          instantiation->set_type_info_noted(true);
+          if (it->second != nullptr) {
+            XLS_ASSIGN_OR_RETURN(int64_t entry_index, AddEntry(it->second));
+            instantiation->set_type_info(entry_index);
+          }
+        }
+      }
+    }
+    for (const auto& [f, required] : root->requires_implicit_token()) {
+      RequiresImplicitTokenProto* proto =
+          root_proto->add_requires_implicit_token();
+      XLS_ASSIGN_OR_RETURN(int64_t node_index, GetNodeIndex(f));
+      proto->set_function(node_index);
+      proto->set_required(required);
+    }
+    return absl::OkStatus();
+  }
+
+  const TypeInfo& root_;
+  ModuleTypeInfoProto proto_;
+  absl::flat_hash_map<const Module*,
+                      absl::flat_hash_map<const AstNode*, int64_t>>
+      node_indices_;
+  absl::flat_hash_map<const TypeInfo*, int64_t> entry_indices_;
+  absl::flat_hash_set<const TypeInfo*> seen_roots_;
+  std::deque<const TypeInfo*> pending_roots_;
+};
+
+// Restores the tree of type information objects of a module, see
+// ModuleTypeInfoFromProto(). All of the serialized data is decoded before any
+// type information is created or modified, so that a failure to decode leaves
+// no partial state behind.
+class ModuleTypeInfoDeserializer {
+ public:
+  ModuleTypeInfoDeserializer(Module* module, ImportData* import_data)
+      : module_(module), import_data_(import_data) {}
+
+  absl::StatusOr<TypeInfo*> Deserialize(const ModuleTypeInfoProto& proto) {
+    XLS_RET_CHECK(
+        !import_data_->type_info_owner().GetRootTypeInfo(module_).ok())
+        << "Module " << module_->name() << " already has type information";
+    XLS_RETURN_IF_ERROR(CollectModules());
+
+    std::vector<Entry> entries;
+    for (int64_t i = 0; i < proto.entries_size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(Entry entry, DecodeEntry(proto.entries(i), i));
+      entries.push_back(std::move(entry));
+    }
+    if (entries.empty() || entries[0].module != module_ ||
+        entries[0].parent.has_value()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Serialized type information does not start with the root of "
+          "module ",
+          module_->name()));
+    }
+    for (const Entry& entry : entries) {
+      if (entry.parent.has_value() &&
+          entries[entry.parent.value()].module != entry.module) {
+        return absl::InvalidArgumentError(
+            "Serialized type information has a parent in another module");
+      }
+    }
+    std::vector<Import*> imports;
+    for (int64_t index : proto.imports()) {
+      XLS_ASSIGN_OR_RETURN(Import * import, GetNode<Import>(module_, index));
+      imports.push_back(import);
+    }
+    std::vector<Root> roots;
+    for (const RootTypeInfoDataProto& root_proto : proto.roots()) {
+      XLS_ASSIGN_OR_RETURN(Root root, DecodeRoot(root_proto, entries.size()));
+      roots.push_back(std::move(root));
+    }
+
+    // Everything decoded successfully, now create the type information.
+    TypeInfoOwner& owner = import_data_->type_info_owner();
+    XLS_ASSIGN_OR_RETURN(TypeInfo * root, owner.New(module_));
+    modules_[module_->name()].root = root;
+    std::vector<TypeInfo*> type_infos = {root};
+    for (int64_t i = 1; i < entries.size(); ++i) {
+      const Entry& entry = entries[i];
+      TypeInfo* parent = entry.parent.has_value()
+                             ? type_infos[entry.parent.value()]
+                             : modules_.at(entry.module->name()).root;
+      XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
+                           owner.New(entry.module, parent));
+      type_infos.push_back(type_info);
+    }
+    for (int64_t i = 0; i < entries.size(); ++i) {
+      for (const auto& [node, type] : entries[i].types) {
+        type_infos[i]->SetItem(node, *type);
+      }
+      for (const auto& [node, value] : entries[i].const_exprs) {
+        type_infos[i]->NoteConstExpr(node, value);
+      }
+      for (const auto& [name_def, constant_def] : entries[i].name_to_const) {
+        type_infos[i]->NoteConstant(name_def, constant_def);
+      }
+    }
+    for (Import* import : imports) {
+      const ModuleInfo* info = imported_.at(import);
+      root->AddImport(import, info->module.get(), info->type_info);
+    }
+    for (const Root& root_data : roots) {
+      TypeInfo* target = modules_.at(root_data.module->name()).root;
+      for (const auto& [node, bindings, start_width] : root_data.slices) {
+        target->AddSliceStartAndWidth(node, bindings, start_width);
+      }
+      for (const DecodedInstantiation& instantiation :
+           root_data.instantiations) {
+        if (instantiation.callee.has_value()) {
+          target->AddInstantiationCallBindings(instantiation.node,
+                                               instantiation.caller,
+                                               *instantiation.callee);
+        }
+        // Instantiations may already have been noted on the roots of imported
+        // modules by other importers; those are left as they are.
+        if (instantiation.type_info_noted &&
+            !target->HasInstantiation(instantiation.node,
+                                      instantiation.caller)) {
+          TypeInfo* derived = instantiation.type_info.has_value()
+                                  ? type_infos[*instantiation.type_info]
+                                  : nullptr;
+          target->SetInstantiationTypeInfo(instantiation.node,
+                                           instantiation.caller, derived);
+        }
+      }
+      for (const auto& [f, required] : root_data.requires_implicit_token) {
+        target->NoteRequiresImplicitToken(f, required);
+      }
+    }
+    return root;
+  }
+
+ private:
+  struct ModuleData {
+    Module* module;
+    // Root type information of the module; for the module being restored this
+    // is only populated once it has been created.
+    TypeInfo* root;
+  };
+
+  struct Entry {
+    Module* module;
+    absl::optional<int64_t> parent;
+    std::vector<std::pair<AstNode*, std::unique_ptr<ConcreteType>>> types;
+    std::vector<std::pair<AstNode*, InterpValue>> const_exprs;
+    std::vector<std::pair<NameDef*, ConstantDef*>> name_to_const;
+  };
+
+  struct DecodedInstantiation {
+    Instantiation* node;
+    SymbolicBindings caller;
+    absl::optional<SymbolicBindings> callee;
+    bool type_info_noted;
+    absl::optional<int64_t> type_info;
+  };
+
+  struct Root {
+    Module* module;
+    std::vector<std::tuple<Slice*, SymbolicBindings, StartAndWidth>> slices;
+    std::vector<DecodedInstantiation> instantiations;
+    std::vector<std::pair<Function*, bool>> requires_implicit_token;
+  };
+
+  // Collects the module being restored and all of the modules it
+  // (transitively) imports; these must already be present in the import data.
+  absl::Status CollectModules() {
+    modules_[module_->name()] = ModuleData{module_, nullptr};
+    definition_modules_.push_back(module_);
+    for (const ModuleMember& member : module_->top()) {
+      if (!absl::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      Import* import = absl::get<Import*>(member);
+      XLS_ASSIGN_OR_RETURN(const ModuleInfo* info,
+                           import_data_->Get(ImportTokens(import->subject())));
+      imported_[import] = info;
+      CollectImportedModule(info->module.get(), info->type_info);
+    }
+    return absl::OkStatus();
+  }
+
+  void CollectImportedModule(Module* module, TypeInfo* root) {
+    if (!modules_.emplace(module->name(), ModuleData{module, root}).second) {
+      return;
+    }
+    definition_modules_.push_back(module);
+    for (const auto& [import, info] : root->imports()) {
+      CollectImportedModule(info.module, info.type_info);
+    }
+  }
+
+  absl::StatusOr<Module*> GetModule(const std::string& name) {
+    auto it = modules_.find(name);
+    if (it == modules_.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Module %s referenced from serialized type information of %s is not "
+          "imported",
+          name, module_->name()));
+    }
+    return it->second.module;
+  }
+
+  template <typename T>
+  absl::StatusOr<T*> GetNode(Module* module, int64_t index) {
+    absl::Span<const std::unique_ptr<AstNode>> nodes = module->nodes();
+    if (index < 0 || index >= nodes.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("AST node index %d out of range for module %s",
+                          index, module->name()));
+    }
+    auto* node = dynamic_cast<T*>(nodes[index].get());
+    if (node == nullptr) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "AST node %d of module %s has an unexpected kind: %s", index,
+          module->name(), nodes[index]->ToString()));
+    }
+    return node;
+  }
+
+  absl::StatusOr<Entry> DecodeEntry(const TypeInfoEntryProto& proto,
+                                    int64_t index) {
+    Entry entry;
+    XLS_ASSIGN_OR_RETURN(entry.module, GetModule(proto.module_name()));
+    if (proto.has_parent()) {
+      // Parents are always serialized before their children.
+      if (proto.parent() < 0 || proto.parent() >= index) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid parent %d for type information entry %d", proto.parent(),
+            index));
+      }
+      entry.parent = proto.parent();
+    }
+    for (const NodeTypeProto& node_type : proto.types()) {
+      XLS_ASSIGN_OR_RETURN(AstNode * node,
+                           GetNode<AstNode>(entry.module, node_type.node()));
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> type,
+                           FromProto(node_type.type(), definition_modules_));
+      entry.types.push_back({node, std::move(type)});
+    }
+    for (const ConstExprProto& const_expr : proto.const_exprs()) {
+      XLS_ASSIGN_OR_RETURN(AstNode * node,
+                           GetNode<AstNode>(entry.module, const_expr.node()));
+      XLS_ASSIGN_OR_RETURN(InterpValue value,
+                           FromProto(const_expr.value(), definition_modules_));
+      entry.const_exprs.push_back({node, std::move(value)});
+    }
+    for (const NameToConstProto& name_to_const : proto.name_to_const()) {
+      XLS_ASSIGN_OR_RETURN(
+          NameDef * name_def,
+          GetNode<NameDef>(entry.module, name_to_const.name_def()));
+      XLS_ASSIGN_OR_RETURN(
+          ConstantDef * constant_def,
+          GetNode<ConstantDef>(entry.module, name_to_const.constant_def()));
+      entry.name_to_const.push_back({name_def, constant_def});
+    }
+    return entry;
+  }
+
+  absl::StatusOr<Root> DecodeRoot(const RootTypeInfoDataProto& proto,
+                                  int64_t entry_count) {
+    Root root;
+    XLS_ASSIGN_OR_RETURN(root.module, GetModule(proto.module_name()));
+    for (const SliceStartAndWidthProto& slice : proto.slices()) {
+      XLS_ASSIGN_OR_RETURN(Slice * node,
+                           GetNode<Slice>(root.module, slice.node()));
+      XLS_ASSIGN_OR_RETURN(SymbolicBindings bindings,
+                           FromProto(slice.bindings(), definition_modules_));
+      root.slices.push_back(
+          {node, std::move(bindings), StartAndWidth{slice.start(),
+                                                    slice.width()}});
+    }
+    for (const InstantiationProto& instantiation : proto.instantiations()) {
+      DecodedInstantiation decoded;
+      XLS_ASSIGN_OR_RETURN(
+          decoded.node,
+          GetNode<Instantiation>(root.module, instantiation.node()));
+      XLS_ASSIGN_OR_RETURN(
+          decoded.caller,
+          FromProto(instantiation.caller(), definition_modules_));
+      if (instantiation.has_callee()) {
+        XLS_ASSIGN_OR_RETURN(
+            decoded.callee,
+            FromProto(instantiation.callee(), definition_modules_));
+      }
+      decoded.type_info_noted = instantiation.type_info_noted();
+      if (instantiation.type_info_noted() && instantiation.has_type_info()) {
+        if (instantiation.type_info() < 0 ||
+            instantiation.type_info() >= entry_count) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Invalid type information entry %d for instantiation",
+              instantiation.type_info()));
+        }
+        decoded.type_info = instantiation.type_info();
+      }
+      root.instantiations.push_back(std::move(decoded));
+    }
+    for (const RequiresImplicitTokenProto& implicit_token :
+         proto.requires_implicit_token()) {
+      XLS_ASSIGN_OR_RETURN(
+          Function * f,
+          GetNode<Function>(root.module, implicit_token.function()));
+      root.requires_implicit_token.push_back({f, implicit_token.required()});
+    }
+    return root;
+  }
+
+  Module* module_;
+  ImportData* import_data_;
+  absl::flat_hash_map<std::string, ModuleData> modules_;
+  std::vector<const Module*> definition_modules_;
+  absl::flat_hash_map<Import*, const ModuleInfo*> imported_;
+};
+
 }  // namespace
 
 absl::StatusOr<std::string> ToHumanString(const AstNodeTypeInfoProto& antip,
@@ -633,4 +1239,16 @@ absl::StatusOr<std::string> ToHumanString(const TypeInfoProto& tip,
   return absl::StrJoin(lines, "\n");
 }
 
+absl::StatusOr<ModuleTypeInfoProto> ModuleTypeInfoToProto(
+    const TypeInfo& root) {
+  XLS_RET_CHECK(root.parent() == nullptr);
+  return ModuleTypeInfoSerializer(root).Serialize();
+}
+
+absl::StatusOr<TypeInfo*> ModuleTypeInfoFromProto(
+    const ModuleTypeInfoProto& proto, Module* module,
+    ImportData* import_data) {
+  return ModuleTypeInfoDeserializer(module, import_data).Deserialize(proto);
+}
+
 }  // namespace xls::dslx
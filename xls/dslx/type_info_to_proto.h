@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_TYPE_INFO_TO_PROTO_H_
 #define XLS_DSLX_TYPE_INFO_TO_PROTO_H_
 
+#include "xls/dslx/import_data.h"
 #include "xls/dslx/type_info.h"
 #include "xls/dslx/type_info.pb.h"
 
@@ -33,6 +34,22 @@ absl::StatusOr<std::string> ToHumanString(const AstNodeTypeInfoProto& antip,
 absl::StatusOr<std::string> ToHumanString(const TypeInfoProto& tip,
                                           const Module& m);
 
+// Converts the given root type information object of a module, together with
+// all of the parametric instantiation type information reachable from it, to
+// protobuf form. Unlike TypeInfoToProto() the result holds everything required
+// to restore the type information via ModuleTypeInfoFromProto(). Returns an
+// unimplemented error if some of the information has no protobuf form (e.g.
+// function values).
+absl::StatusOr<ModuleTypeInfoProto> ModuleTypeInfoToProto(const TypeInfo& root);
+
+// Restores the type information of "module" from the result of
+// ModuleTypeInfoToProto(), i.e. without re-running type deduction. "module"
+// must have been parsed from the same text as the serialized module, and its
+// imports must already be present in "import_data". On error no type
+// information is created or modified.
+absl::StatusOr<TypeInfo*> ModuleTypeInfoFromProto(
+    const ModuleTypeInfoProto& proto, Module* module, ImportData* import_data);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_TYPE_INFO_TO_PROTO_H_
@@ -185,6 +185,11 @@ static absl::Status CheckFunction(Function* f, DeduceCtx* ctx) {
 static absl::Status CheckTest(TestFunction* t, DeduceCtx* ctx) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ConcreteType> body_return_type,
                        ctx->Deduce(t->body()));
+  // As for functions, note whether the test requires an implicit token so that
+  // its body can be converted to IR (e.g. to run the test in the JIT).
+  if (!ctx->type_info()->GetRequiresImplicitToken(t->fn()).has_value()) {
+    ctx->type_info()->NoteRequiresImplicitToken(t->fn(), false);
+  }
   if (body_return_type->IsUnit()) {
     return absl::OkStatus();
   }
@@ -346,6 +351,14 @@ static absl::StatusOr<NameDef*> InstantiateBuiltinParametric(
             "dollar signs.");
       }
     }
+  } else if (builtin_name->identifier() == "assert_eq" ||
+             builtin_name->identifier() == "assert_lt") {
+    // Assertions are converted to IR like fail!() (e.g. so tests can run in the
+    // JIT), so they also require an implicit token.
+    if (f != nullptr && absl::holds_alternative<Function*>(*f)) {
+      ctx->type_info()->NoteRequiresImplicitToken(absl::get<Function*>(*f),
+                                                  true);
+    }
   }
 
   std::vector<const ConcreteType*> arg_type_ptrs;
@@ -18,6 +18,7 @@
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/module_cache.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/type_info_to_proto.h"
 #include "xls/dslx/typecheck.h"
@@ -29,6 +30,9 @@ ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
 ABSL_FLAG(std::string, output_path, "",
           "Path to dump the type information to as a protobin -- if not "
           "provided textual proto is given on stdout.");
+ABSL_FLAG(std::string, module_cache_dir, "",
+          "Directory in which typechecked imported modules are cached across "
+          "invocations (see xls/dslx/module_cache.h); no caching if empty.");
 
 namespace xls::dslx {
 namespace {
@@ -41,10 +45,16 @@ was deduced.
 absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
                       const std::filesystem::path& dslx_stdlib_path,
                       const std::filesystem::path& input_path,
-                      std::optional<std::filesystem::path> output_path) {
+                      std::optional<std::filesystem::path> output_path,
+                      std::optional<std::filesystem::path> module_cache_dir) {
   ImportData import_data(
       CreateImportData(dslx_stdlib_path,
                        /*additional_search_paths=*/dslx_paths));
+  std::optional<ModuleCache> module_cache;
+  if (module_cache_dir.has_value()) {
+    module_cache.emplace(*module_cache_dir);
+    import_data.SetModuleCache(&module_cache.value());
+  }
   XLS_ASSIGN_OR_RETURN(std::string input_contents, GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(input_path.c_str()));
   absl::StatusOr<TypecheckedModule> tm_or = ParseAndTypecheck(
@@ -96,7 +106,13 @@ int main(int argc, char* argv[]) {
 
   std::filesystem::path dslx_stdlib_path(absl::GetFlag(FLAGS_dslx_stdlib_path));
 
+  std::optional<std::filesystem::path> module_cache_dir;
+  if (std::string flag = absl::GetFlag(FLAGS_module_cache_dir);
+      !flag.empty()) {
+    module_cache_dir = flag;
+  }
+
   XLS_QCHECK_OK(xls::dslx::RealMain(dslx_paths, dslx_stdlib_path, input_path,
-                                    output_path));
+                                    output_path, module_cache_dir));
   return EXIT_SUCCESS;
 }
@@ -161,6 +161,34 @@ fn f() -> u32 { o(u32:3) }
   XLS_EXPECT_OK(Typecheck(program));
 }
 
+TEST(TypecheckTest, RepeatedParametricInvocation) {
+  std::string program = R"(
+fn p<N: u32, M: u32 = N + N>(x: bits[N]) -> bits[M] { x ++ x }
+fn f() -> (u64, u64, u16) { (p(u32:1), p(u32:2), p(u8:3)) }
+fn g() -> u64 { p(u32:4) }
+)";
+  XLS_EXPECT_OK(Typecheck(program));
+}
+
+TEST(TypecheckTest, RepeatedParametricInvocationReturnTypeMismatch) {
+  std::string program = R"(
+fn p<N: u32, M: u32 = N + N>(x: bits[N]) -> bits[M] { x ++ x }
+fn f() -> u64 { p(u32:1) }
+fn g() -> u32 { p(u32:2) }
+)";
+  EXPECT_THAT(Typecheck(program), StatusIs(absl::StatusCode::kInvalidArgument,
+                                           HasSubstr("uN[64] vs uN[32]")));
+}
+
+TEST(TypecheckTest, ExplicitParametricFromCallerBindings) {
+  std::string program = R"(
+fn zero<N: u32>() -> bits[N] { uN[N]:0 }
+fn wrap<M: u32>(x: bits[M]) -> bits[M] { x | zero<M>() }
+fn f() -> (u8, u32) { (wrap(u8:1), wrap(u32:1)) }
+)";
+  XLS_EXPECT_OK(Typecheck(program));
+}
+
 TEST(TypecheckTest, ParametricInvocationConflictingArgs) {
   std::string program = R"(
 fn id<N: u32>(x: bits[N], y: bits[N]) -> bits[N] { x }
@@ -0,0 +1,601 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_runner.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/codegen/combinational_generator.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/dslx/bytecode_emitter.h"
+#include "xls/dslx/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/interpreter.h"
+#include "xls/dslx/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/fuzzer/summarize_ir.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/verifier.h"
+#include "xls/jit/ir_jit.h"
+#include "xls/passes/passes.h"
+#include "xls/passes/standard_pipeline.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/simulation/module_simulator.h"
+#include "xls/simulation/verilog_simulators.h"
+
+namespace xls {
+namespace {
+
+// Name of the DSLX module (and of the IR package) of a sample. Matches what
+// ir_converter_main derives from the "sample.x" filename.
+constexpr absl::string_view kModuleName = "sample";
+
+// A command line flag from ir_converter_args or codegen_args, split into its
+// name and (optional) value.
+struct Flag {
+  std::string name;
+  absl::optional<std::string> value;
+};
+
+Flag SplitFlag(absl::string_view arg) {
+  absl::ConsumePrefix(&arg, "-");
+  absl::ConsumePrefix(&arg, "-");
+  Flag flag;
+  size_t eq = arg.find('=');
+  if (eq != absl::string_view::npos) {
+    flag.name = std::string(arg.substr(0, eq));
+    flag.value = std::string(arg.substr(eq + 1));
+  } else {
+    flag.name = std::string(arg);
+  }
+  return flag;
+}
+
+absl::StatusOr<bool> BoolFlagValue(const Flag& flag) {
+  if (!flag.value.has_value() || *flag.value == "true" || *flag.value == "1") {
+    return true;
+  }
+  if (*flag.value == "false" || *flag.value == "0") {
+    return false;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Invalid value for boolean flag --%s: %s", flag.name, *flag.value));
+}
+
+absl::StatusOr<int64_t> IntFlagValue(const Flag& flag) {
+  int64_t value;
+  if (!flag.value.has_value() || !absl::SimpleAtoi(*flag.value, &value)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected integer value for flag --%s", flag.name));
+  }
+  return value;
+}
+
+// Settings of ir_converter_main which are honored by the in-process runner.
+struct IrConverterFlags {
+  absl::optional<std::string> entry;
+  bool emit_fail_as_assert = true;
+};
+
+absl::StatusOr<IrConverterFlags> ParseIrConverterArgs(
+    absl::Span<const std::string> args) {
+  IrConverterFlags flags;
+  for (const std::string& arg : args) {
+    Flag flag = SplitFlag(arg);
+    if (flag.name == "entry") {
+      XLS_RET_CHECK(flag.value.has_value()) << "--entry requires a value";
+      flags.entry = *flag.value;
+    } else if (flag.name == "emit_fail_as_assert") {
+      XLS_ASSIGN_OR_RETURN(flags.emit_fail_as_assert, BoolFlagValue(flag));
+    } else if (flag.name == "noemit_fail_as_assert") {
+      flags.emit_fail_as_assert = false;
+    } else {
+      return absl::UnimplementedError(absl::StrFormat(
+          "IR converter argument not supported in-process: %s", arg));
+    }
+  }
+  return flags;
+}
+
+// Settings of codegen_main which are honored by the in-process runner. The
+// defaults match those of codegen_main as invoked by the Python runner.
+struct CodegenFlags {
+  std::string generator = "pipeline";
+  std::string delay_model = "unit";
+  SchedulingOptions scheduling_options;
+  bool use_system_verilog = true;
+  std::string module_name;
+  std::string reset;
+  bool reset_active_low = false;
+  bool reset_asynchronous = false;
+};
+
+absl::StatusOr<CodegenFlags> ParseCodegenArgs(
+    absl::Span<const std::string> args) {
+  CodegenFlags flags;
+  for (const std::string& arg : args) {
+    Flag flag = SplitFlag(arg);
+    if (flag.name == "generator") {
+      XLS_RET_CHECK(flag.value.has_value()) << "--generator requires a value";
+      flags.generator = *flag.value;
+    } else if (flag.name == "delay_model") {
+      XLS_RET_CHECK(flag.value.has_value()) << "--delay_model requires a value";
+      flags.delay_model = *flag.value;
+    } else if (flag.name == "pipeline_stages") {
+      XLS_ASSIGN_OR_RETURN(int64_t value, IntFlagValue(flag));
+      flags.scheduling_options.pipeline_stages(value);
+    } else if (flag.name == "clock_period_ps") {
+      XLS_ASSIGN_OR_RETURN(int64_t value, IntFlagValue(flag));
+      flags.scheduling_options.clock_period_ps(value);
+    } else if (flag.name == "clock_margin_percent") {
+      XLS_ASSIGN_OR_RETURN(int64_t value, IntFlagValue(flag));
+      flags.scheduling_options.clock_margin_percent(value);
+    } else if (flag.name == "use_system_verilog") {
+      XLS_ASSIGN_OR_RETURN(flags.use_system_verilog, BoolFlagValue(flag));
+    } else if (flag.name == "nouse_system_verilog") {
+      flags.use_system_verilog = false;
+    } else if (flag.name == "module_name") {
+      flags.module_name = flag.value.value_or("");
+    } else if (flag.name == "reset") {
+      flags.reset = flag.value.value_or("");
+    } else if (flag.name == "reset_active_low") {
+      XLS_ASSIGN_OR_RETURN(flags.reset_active_low, BoolFlagValue(flag));
+    } else if (flag.name == "reset_asynchronous") {
+      XLS_ASSIGN_OR_RETURN(flags.reset_asynchronous, BoolFlagValue(flag));
+    } else {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Codegen argument not supported in-process: %s", arg));
+    }
+  }
+  return flags;
+}
+
+std::string ValuesToText(absl::Span<const Value> values) {
+  return absl::StrJoin(values, "\n", [](std::string* out, const Value& v) {
+    absl::StrAppend(out, v.ToString(FormatPreference::kHex));
+  });
+}
+
+std::string ArgsToText(absl::Span<const Value> args) {
+  return absl::StrJoin(args, "; ", [](std::string* out, const Value& v) {
+    absl::StrAppend(out, v.ToString(FormatPreference::kHex));
+  });
+}
+
+int64_t ElapsedNs(absl::Time start) {
+  return absl::ToInt64Nanoseconds(absl::Now() - start);
+}
+
+}  // namespace
+
+absl::Status SampleRunner::Run(const Sample& sample) {
+  std::string input_filename =
+      sample.options().input_is_dslx() ? "sample.x" : "sample.ir";
+  XLS_RETURN_IF_ERROR(WriteFile(input_filename, sample.input_text()));
+  XLS_RETURN_IF_ERROR(
+      WriteFile("options.json", sample.options().ToJsonText()));
+  absl::optional<absl::string_view> args_filename;
+  if (!sample.args_batch().empty()) {
+    XLS_RETURN_IF_ERROR(
+        WriteFile("args.txt", ArgsBatchToText(sample.args_batch())));
+    args_filename = "args.txt";
+  }
+  return RunFromFiles(input_filename, "options.json", args_filename);
+}
+
+absl::Status SampleRunner::RunFromFiles(
+    absl::string_view input_filename, absl::string_view options_filename,
+    absl::optional<absl::string_view> args_filename) {
+  XLS_VLOG(1) << "Reading sample files.";
+  XLS_ASSIGN_OR_RETURN(std::string input_text, ReadFile(input_filename));
+  XLS_ASSIGN_OR_RETURN(std::string options_text, ReadFile(options_filename));
+  XLS_ASSIGN_OR_RETURN(SampleOptions options,
+                       SampleOptions::FromJson(options_text));
+  absl::optional<ArgsBatch> args_batch;
+  if (args_filename.has_value()) {
+    XLS_ASSIGN_OR_RETURN(std::string args_text, ReadFile(*args_filename));
+    XLS_ASSIGN_OR_RETURN(args_batch, ParseArgsBatch(args_text));
+  }
+
+  timing_ = fuzzer::SampleTimingProto();
+  unoptimized_package_.reset();
+  optimized_package_.reset();
+  verilog_text_.clear();
+  signature_.reset();
+
+  absl::Status status = RunInternal(input_text, options, args_batch);
+  if (!status.ok()) {
+    XLS_LOG(ERROR) << "Error when running sample: " << status;
+    XLS_RETURN_IF_ERROR(WriteFile("exception.txt", status.message()));
+  }
+  return status;
+}
+
+absl::Status SampleRunner::RunInternal(
+    const std::string& input_text, const SampleOptions& options,
+    const absl::optional<ArgsBatch>& dslx_args_batch) {
+  ResultsMap results;
+
+  // The IR tools consume the arguments as (unsigned) IR values.
+  absl::optional<std::vector<std::vector<Value>>> args_batch;
+  if (dslx_args_batch.has_value()) {
+    args_batch.emplace();
+    for (const std::vector<dslx::InterpValue>& args : *dslx_args_batch) {
+      XLS_ASSIGN_OR_RETURN(std::vector<Value> ir_args,
+                           dslx::InterpValue::ConvertValuesToIr(args));
+      args_batch->push_back(std::move(ir_args));
+    }
+  }
+
+  std::unique_ptr<Package> package;
+  if (options.input_is_dslx()) {
+    // The module is parsed and typechecked once; interpretation and IR
+    // conversion share the ImportData (and therefore the type information and
+    // any imported modules).
+    dslx::ImportData import_data(dslx::CreateImportData(
+        kDefaultDslxStdlibPath, /*additional_search_paths=*/{}));
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(
+        dslx::TypecheckedModule tm,
+        dslx::ParseAndTypecheck(input_text, "sample.x", kModuleName,
+                                &import_data));
+    if (dslx_args_batch.has_value()) {
+      XLS_VLOG(1) << "Interpreting DSLX file.";
+      XLS_ASSIGN_OR_RETURN(results["interpreted DSLX"],
+                           InterpretDslx(&import_data, tm, *dslx_args_batch));
+      timing_.set_interpret_dslx_ns(ElapsedNs(start));
+    }
+
+    if (!options.convert_to_ir()) {
+      return absl::OkStatus();
+    }
+
+    start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(package, DslxToIr(&import_data, tm, options));
+    timing_.set_convert_ir_ns(ElapsedNs(start));
+  } else {
+    XLS_RETURN_IF_ERROR(WriteFile("sample.ir", input_text));
+    XLS_ASSIGN_OR_RETURN(package,
+                         Parser::ParsePackage(input_text, "sample.ir"));
+  }
+
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  if (args_batch.has_value()) {
+    // Unconditionally evaluate with the interpreter even if using the
+    // JIT. This exercises the interpreter and serves as a reference.
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(
+        results["evaluated unopt IR (interpreter)"],
+        EvaluateIr(f, *args_batch, /*use_jit=*/false, "sample.ir.results"));
+    timing_.set_unoptimized_interpret_ir_ns(ElapsedNs(start));
+
+    if (options.use_jit()) {
+      start = absl::Now();
+      XLS_ASSIGN_OR_RETURN(
+          results["evaluated unopt IR (JIT)"],
+          EvaluateIr(f, *args_batch, /*use_jit=*/true, "sample.ir.results"));
+      timing_.set_unoptimized_jit_ns(ElapsedNs(start));
+    }
+  }
+
+  if (options.optimize_ir()) {
+    absl::Time start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> opt_package,
+                         OptimizeIr(*package));
+    timing_.set_optimize_ns(ElapsedNs(start));
+    XLS_ASSIGN_OR_RETURN(Function * opt_f, opt_package->GetTopAsFunction());
+
+    if (args_batch.has_value()) {
+      if (options.use_jit()) {
+        start = absl::Now();
+        XLS_ASSIGN_OR_RETURN(results["evaluated opt IR (JIT)"],
+                             EvaluateIr(opt_f, *args_batch, /*use_jit=*/true,
+                                        "sample.opt.ir.results"));
+        timing_.set_optimized_jit_ns(ElapsedNs(start));
+      }
+      start = absl::Now();
+      XLS_ASSIGN_OR_RETURN(results["evaluated opt IR (interpreter)"],
+                           EvaluateIr(opt_f, *args_batch, /*use_jit=*/false,
+                                      "sample.opt.ir.results"));
+      timing_.set_optimized_interpret_ir_ns(ElapsedNs(start));
+    }
+
+    if (options.codegen()) {
+      start = absl::Now();
+      XLS_RETURN_IF_ERROR(Codegen(opt_package.get(), options));
+      timing_.set_codegen_ns(ElapsedNs(start));
+
+      if (options.simulate()) {
+        XLS_RET_CHECK(args_batch.has_value());
+        start = absl::Now();
+        XLS_ASSIGN_OR_RETURN(results["simulated"],
+                             Simulate(*args_batch, options));
+        timing_.set_simulate_ns(ElapsedNs(start));
+      }
+    }
+    optimized_package_ = std::move(opt_package);
+  }
+  unoptimized_package_ = std::move(package);
+
+  return CompareResults(results, args_batch);
+}
+
+absl::StatusOr<std::vector<Value>> SampleRunner::InterpretDslx(
+    dslx::ImportData* import_data, const dslx::TypecheckedModule& tm,
+    absl::Span<const std::vector<dslx::InterpValue>> args_batch) {
+  XLS_ASSIGN_OR_RETURN(dslx::Function * f,
+                       tm.module->GetFunctionOrError("main"));
+  XLS_ASSIGN_OR_RETURN(dslx::FunctionType * fn_type,
+                       tm.type_info->GetItemAs<dslx::FunctionType>(f));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<dslx::BytecodeFunction> bf,
+      dslx::BytecodeEmitter::Emit(import_data, tm.type_info, f, absl::nullopt,
+                                  /*fuse_superinstructions=*/true));
+  std::vector<Value> results;
+  results.reserve(args_batch.size());
+  for (const std::vector<dslx::InterpValue>& unsigned_args : args_batch) {
+    XLS_ASSIGN_OR_RETURN(std::vector<dslx::InterpValue> args,
+                         dslx::SignConvertArgs(*fn_type, unsigned_args));
+    XLS_ASSIGN_OR_RETURN(
+        dslx::InterpValue result,
+        dslx::BytecodeInterpreter::Interpret(import_data, bf.get(),
+                                             std::move(args)));
+    XLS_ASSIGN_OR_RETURN(Value ir_result, result.ConvertToIr());
+    results.push_back(std::move(ir_result));
+  }
+  XLS_RETURN_IF_ERROR(WriteFile("sample.x.results", ValuesToText(results)));
+  return results;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> SampleRunner::DslxToIr(
+    dslx::ImportData* import_data, const dslx::TypecheckedModule& tm,
+    const SampleOptions& options) {
+  XLS_VLOG(1) << "Converting DSLX to IR.";
+  XLS_ASSIGN_OR_RETURN(
+      IrConverterFlags flags,
+      ParseIrConverterArgs(
+          options.ir_converter_args().value_or(std::vector<std::string>())));
+  const dslx::ConvertOptions convert_options = {
+      .emit_positions = true,
+      .emit_fail_as_assert = flags.emit_fail_as_assert,
+      .verify_ir = true,
+  };
+  auto package = std::make_unique<Package>(kModuleName);
+  if (flags.entry.has_value()) {
+    XLS_RETURN_IF_ERROR(dslx::ConvertOneFunctionIntoPackage(
+        tm.module, *flags.entry, import_data,
+        /*symbolic_bindings=*/nullptr, convert_options, package.get()));
+  } else {
+    XLS_RETURN_IF_ERROR(dslx::ConvertModuleIntoPackage(
+        tm.module, import_data, convert_options, /*traverse_tests=*/false,
+        package.get()));
+  }
+  XLS_RETURN_IF_ERROR(WriteFile("sample.ir", package->DumpIr()));
+  return package;
+}
+
+absl::StatusOr<std::vector<Value>> SampleRunner::EvaluateIr(
+    Function* f, absl::Span<const std::vector<Value>> args_batch,
+    bool use_jit, absl::string_view results_filename) {
+  XLS_VLOG(1) << absl::StreamFormat("Evaluating IR function %s (%s).",
+                                    f->name(),
+                                    use_jit ? "JIT" : "interpreter");
+  std::unique_ptr<IrJit> jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(jit, IrJit::Create(f));
+  }
+  std::vector<Value> results;
+  results.reserve(args_batch.size());
+  for (const std::vector<Value>& args : args_batch) {
+    Value result;
+    if (use_jit) {
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(jit->Run(args)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(result,
+                           DropInterpreterEvents(InterpretFunction(f, args)));
+    }
+    results.push_back(std::move(result));
+  }
+  XLS_RETURN_IF_ERROR(WriteFile(results_filename, ValuesToText(results)));
+  return results;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> SampleRunner::OptimizeIr(
+    const Package& package) {
+  XLS_VLOG(1) << "Optimizing IR.";
+  // The optimizer runs on a copy obtained by round-tripping the IR through its
+  // text form; this keeps the unoptimized package intact and exercises the IR
+  // parser just as the subprocess-based flow does.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> opt_package,
+                       Parser::ParsePackage(package.DumpIr(), "sample.ir"));
+  std::unique_ptr<CompoundPass> pipeline =
+      CreateStandardPassPipeline(kMaxOptLevel);
+  PassResults pass_results;
+  XLS_RETURN_IF_ERROR(
+      pipeline->Run(opt_package.get(), PassOptions(), &pass_results).status());
+  XLS_RETURN_IF_ERROR(WriteFile("sample.opt.ir", opt_package->DumpIr()));
+  return opt_package;
+}
+
+absl::Status SampleRunner::Codegen(Package* package,
+                                   const SampleOptions& options) {
+  XLS_VLOG(1) << "Generating Verilog.";
+  XLS_ASSIGN_OR_RETURN(
+      CodegenFlags flags,
+      ParseCodegenArgs(
+          options.codegen_args().value_or(std::vector<std::string>())));
+  XLS_RETURN_IF_ERROR(VerifyPackage(package, /*codegen=*/true));
+  XLS_ASSIGN_OR_RETURN(Function * main, package->GetTopAsFunction());
+
+  verilog::ModuleGeneratorResult result;
+  if (flags.generator == "pipeline") {
+    verilog::CodegenOptions codegen_options = verilog::BuildPipelineOptions();
+    codegen_options.use_system_verilog(flags.use_system_verilog);
+    if (!flags.module_name.empty()) {
+      codegen_options.module_name(flags.module_name);
+    }
+    if (!flags.reset.empty()) {
+      codegen_options.reset(flags.reset, flags.reset_asynchronous,
+                            flags.reset_active_low, /*reset_data_path=*/false);
+    }
+    XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                         GetDelayEstimator(flags.delay_model));
+    XLS_ASSIGN_OR_RETURN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(main, *delay_estimator,
+                              flags.scheduling_options));
+    XLS_ASSIGN_OR_RETURN(result, verilog::ToPipelineModuleText(
+                                     schedule, main, codegen_options));
+  } else if (flags.generator == "combinational") {
+    XLS_ASSIGN_OR_RETURN(result, verilog::GenerateCombinationalModule(
+                                     main, flags.use_system_verilog,
+                                     flags.module_name));
+  } else {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid value for --generator: %s. Expected 'pipeline' or "
+        "'combinational'",
+        flags.generator));
+  }
+
+  XLS_RETURN_IF_ERROR(WriteFile("sample.v", result.verilog_text));
+  XLS_RETURN_IF_ERROR(SetTextProtoFile(run_dir_ / "module_sig.textproto",
+                                       result.signature.proto()));
+  verilog_text_ = std::move(result.verilog_text);
+  signature_ = std::move(result.signature);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Value>> SampleRunner::Simulate(
+    absl::Span<const std::vector<Value>> args_batch,
+    const SampleOptions& options) {
+  XLS_VLOG(1) << "Simulating Verilog.";
+  XLS_RET_CHECK(signature_.has_value());
+  const verilog::VerilogSimulator* simulator;
+  if (options.simulator().has_value()) {
+    XLS_ASSIGN_OR_RETURN(simulator,
+                         verilog::GetVerilogSimulator(*options.simulator()));
+  } else {
+    simulator = &verilog::GetDefaultVerilogSimulator();
+  }
+
+  verilog::ModuleSimulator module_simulator(*signature_, verilog_text_,
+                                            simulator);
+  std::vector<absl::flat_hash_map<std::string, Value>> args_sets;
+  args_sets.reserve(args_batch.size());
+  for (const std::vector<Value>& args : args_batch) {
+    using MapT = absl::flat_hash_map<std::string, Value>;
+    XLS_ASSIGN_OR_RETURN(MapT args_set, signature_->ToKwargs(args));
+    args_sets.push_back(std::move(args_set));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> results,
+                       module_simulator.RunBatched(args_sets));
+  XLS_RETURN_IF_ERROR(WriteFile("sample.v.results", ValuesToText(results)));
+  return results;
+}
+
+absl::Status SampleRunner::CompareResults(
+    const ResultsMap& results,
+    const absl::optional<std::vector<std::vector<Value>>>& args_batch) {
+  if (results.empty()) {
+    return absl::OkStatus();
+  }
+
+  if (args_batch.has_value()) {
+    XLS_RET_CHECK_EQ(results.begin()->second.size(), args_batch->size());
+  }
+
+  // All results are IR values (the DSLX results are converted as they are
+  // produced), so signedness does not take part in the comparison.
+  const std::string& reference = results.begin()->first;
+  const std::vector<Value>& reference_values = results.begin()->second;
+  for (const auto& [name, values] : results) {
+    if (values.size() != reference_values.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Results for %s has %d values, %s has %d", reference,
+          reference_values.size(), name, values.size()));
+    }
+    for (int64_t i = 0; i < values.size(); ++i) {
+      if (values[i] == reference_values[i]) {
+        continue;
+      }
+      // Bin all of the sources by whether they match the reference or
+      // 'values'. This helps identify which of the two is likely correct.
+      std::vector<std::string> reference_matches;
+      std::vector<std::string> values_matches;
+      for (const auto& [other_name, other_values] : results) {
+        if (other_values[i] == reference_values[i]) {
+          reference_matches.push_back(other_name);
+        }
+        if (other_values[i] == values[i]) {
+          values_matches.push_back(other_name);
+        }
+      }
+      std::string args = "(args unknown)";
+      if (args_batch.has_value()) {
+        args = ArgsToText((*args_batch)[i]);
+      }
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Result miscompare for sample %d:\nargs: %s\n%s =\n   %s\n%s =\n"
+          "   %s",
+          i, args, absl::StrJoin(reference_matches, ", "),
+          reference_values[i].ToString(FormatPreference::kHex),
+          absl::StrJoin(values_matches, ", "),
+          values[i].ToString(FormatPreference::kHex)));
+    }
+  }
+  return absl::OkStatus();
+}
+
+fuzzer::SampleSummaryProto SampleRunner::Summarize() const {
+  fuzzer::SampleSummaryProto summary;
+  *summary.mutable_timing() = timing_;
+  if (unoptimized_package_ != nullptr) {
+    SummarizePackage(unoptimized_package_.get(),
+                     summary.mutable_unoptimized_nodes());
+  }
+  if (optimized_package_ != nullptr) {
+    SummarizePackage(optimized_package_.get(),
+                     summary.mutable_optimized_nodes());
+  }
+  return summary;
+}
+
+absl::Status SampleRunner::WriteFile(absl::string_view filename,
+                                     absl::string_view content) {
+  return SetFileContents(run_dir_ / filename, content);
+}
+
+absl::StatusOr<std::string> SampleRunner::ReadFile(
+    absl::string_view filename) {
+  return GetFileContents(run_dir_ / filename);
+}
+
+}  // namespace xls
@@ -0,0 +1,130 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SAMPLE_RUNNER_H_
+#define XLS_FUZZER_SAMPLE_RUNNER_H_
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/ir/function.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Runs a fuzzer code sample entirely within the current process.
+//
+// This is the in-process counterpart of the Python SampleRunner in
+// sample_runner.py: rather than invoking ir_converter_main, eval_ir_main,
+// opt_main, codegen_main and simulate_module_main as subprocesses it calls the
+// underlying libraries directly. The DSLX module is parsed and typechecked
+// once into an ImportData that is shared by interpretation and IR conversion,
+// and the IR is evaluated with the interpreter and the JIT without
+// re-serializing results through text files.
+//
+// The runner operates in a single directory supplied at construction time and
+// writes the same artifacts as the Python runner (sample.ir, sample.opt.ir,
+// sample.v, module_sig.textproto, the *.results files and exception.txt on
+// failure) so existing tooling and crasher reproduction keep working.
+class SampleRunner {
+ public:
+  explicit SampleRunner(std::filesystem::path run_dir)
+      : run_dir_(std::move(run_dir)) {}
+
+  // Runs the given sample. The sample input, options and arguments are first
+  // written into the run directory. Returns an error if any step fails or if
+  // the results of the various evaluation methods miscompare; the error text
+  // is also written to exception.txt.
+  absl::Status Run(const Sample& sample);
+
+  // Runs a sample which is read from files. Each filename must be the name of
+  // a file (not a full path) which is contained in the run directory.
+  // `args_filename` is optional.
+  absl::Status RunFromFiles(absl::string_view input_filename,
+                            absl::string_view options_filename,
+                            absl::optional<absl::string_view> args_filename);
+
+  // Elapsed time of each step of the most recent run.
+  const fuzzer::SampleTimingProto& timing() const { return timing_; }
+
+  // Returns a summary of the most recent run: its timing plus the nodes of
+  // the unoptimized and optimized IR (if those steps ran). This is the
+  // in-process equivalent of summarize_ir_main.
+  fuzzer::SampleSummaryProto Summarize() const;
+
+ private:
+  // Named results from each evaluation method. Ordered by name; the first
+  // entry serves as the reference when comparing.
+  using ResultsMap = std::map<std::string, std::vector<Value>>;
+
+  using ArgsBatch = std::vector<std::vector<dslx::InterpValue>>;
+
+  absl::Status RunInternal(const std::string& input_text,
+                           const SampleOptions& options,
+                           const absl::optional<ArgsBatch>& dslx_args_batch);
+
+  // Steps of the pipeline. Each writes its artifacts into the run directory.
+  absl::StatusOr<std::vector<Value>> InterpretDslx(
+      dslx::ImportData* import_data, const dslx::TypecheckedModule& tm,
+      absl::Span<const std::vector<dslx::InterpValue>> args_batch);
+  absl::StatusOr<std::unique_ptr<Package>> DslxToIr(
+      dslx::ImportData* import_data, const dslx::TypecheckedModule& tm,
+      const SampleOptions& options);
+  absl::StatusOr<std::vector<Value>> EvaluateIr(
+      Function* f, absl::Span<const std::vector<Value>> args_batch,
+      bool use_jit, absl::string_view results_filename);
+  absl::StatusOr<std::unique_ptr<Package>> OptimizeIr(const Package& package);
+  absl::Status Codegen(Package* package, const SampleOptions& options);
+  absl::StatusOr<std::vector<Value>> Simulate(
+      absl::Span<const std::vector<Value>> args_batch,
+      const SampleOptions& options);
+
+  absl::Status CompareResults(
+      const ResultsMap& results,
+      const absl::optional<std::vector<std::vector<Value>>>& args_batch);
+
+  absl::Status WriteFile(absl::string_view filename,
+                         absl::string_view content);
+  absl::StatusOr<std::string> ReadFile(absl::string_view filename);
+
+  std::filesystem::path run_dir_;
+  fuzzer::SampleTimingProto timing_;
+
+  // Packages produced by the last successful run, kept for Summarize().
+  std::unique_ptr<Package> unoptimized_package_;
+  std::unique_ptr<Package> optimized_package_;
+
+  // Output of the codegen step, consumed by simulation.
+  std::string verilog_text_;
+  absl::optional<verilog::ModuleSignature> signature_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_RUNNER_H_
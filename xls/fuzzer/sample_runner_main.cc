@@ -0,0 +1,152 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+const char kUsage[] = R"(
+Runs a fuzzer code sample in the given run directory, entirely in-process (no
+subprocesses are spawned for IR conversion, evaluation, optimization or
+codegen). Files are copied into the run directory if they don't already reside
+there. If no run directory is specified then a temporary directory is created.
+
+cpp_sample_runner_main --options_file=OPT_FILE \
+  --input_file=INPUT_FILE \
+  --args_file=ARGS_FILE \
+  [RUN_DIR]
+)";
+
+ABSL_FLAG(std::string, options_file, "",
+          "File to load sample runner options from.");
+ABSL_FLAG(std::string, input_file, "", "Code input file.");
+ABSL_FLAG(std::string, args_file, "",
+          "Optional arguments to use for interpretation and simulation.");
+ABSL_FLAG(std::string, summary_file, "",
+          "Optional file to append a SampleSummariesProto with the IR summary "
+          "and timing of the sample to.");
+ABSL_FLAG(std::string, crasher_path, "",
+          "Optional path to write a crasher file to if the sample fails.");
+
+namespace xls {
+namespace {
+
+// Copies the file to the directory if it is not already in the directory and
+// returns its basename.
+absl::StatusOr<std::string> MaybeCopyFile(const std::filesystem::path& path,
+                                          const std::filesystem::path& dir) {
+  std::filesystem::path basename = path.filename();
+  if (std::filesystem::absolute(path).parent_path() !=
+      std::filesystem::absolute(dir)) {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    XLS_RETURN_IF_ERROR(SetFileContents(dir / basename, contents));
+  }
+  return basename.string();
+}
+
+absl::Status RunSample(const std::filesystem::path& run_dir) {
+  XLS_ASSIGN_OR_RETURN(
+      std::string input_filename,
+      MaybeCopyFile(absl::GetFlag(FLAGS_input_file), run_dir));
+  XLS_ASSIGN_OR_RETURN(
+      std::string options_filename,
+      MaybeCopyFile(absl::GetFlag(FLAGS_options_file), run_dir));
+  absl::optional<std::string> args_filename;
+  if (!absl::GetFlag(FLAGS_args_file).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        args_filename, MaybeCopyFile(absl::GetFlag(FLAGS_args_file), run_dir));
+  }
+
+  SampleRunner runner(run_dir);
+  absl::Status status = runner.RunFromFiles(
+      input_filename, options_filename,
+      args_filename.has_value()
+          ? absl::optional<absl::string_view>(*args_filename)
+          : absl::nullopt);
+
+  if (!status.ok() && !absl::GetFlag(FLAGS_crasher_path).empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string input_text,
+                         GetFileContents(run_dir / input_filename));
+    XLS_ASSIGN_OR_RETURN(std::string options_text,
+                         GetFileContents(run_dir / options_filename));
+    XLS_ASSIGN_OR_RETURN(SampleOptions options,
+                         SampleOptions::FromJson(options_text));
+    std::vector<std::vector<dslx::InterpValue>> args_batch;
+    if (args_filename.has_value()) {
+      XLS_ASSIGN_OR_RETURN(std::string args_text,
+                           GetFileContents(run_dir / *args_filename));
+      XLS_ASSIGN_OR_RETURN(args_batch, ParseArgsBatch(args_text));
+    }
+    Sample sample(std::move(input_text), std::move(options),
+                  std::move(args_batch));
+    XLS_RETURN_IF_ERROR(SetFileContents(absl::GetFlag(FLAGS_crasher_path),
+                                        sample.ToCrasher(status.message())));
+  }
+
+  if (status.ok() && !absl::GetFlag(FLAGS_summary_file).empty()) {
+    // See summarize_ir_main: appending a serialized SampleSummariesProto to a
+    // file holding one yields a valid proto with the samples concatenated.
+    fuzzer::SampleSummariesProto summaries;
+    *summaries.add_samples() = runner.Summarize();
+    XLS_RETURN_IF_ERROR(AppendStringToFile(absl::GetFlag(FLAGS_summary_file),
+                                           summaries.SerializeAsString()));
+  }
+  return status;
+}
+
+absl::Status RealMain(absl::Span<const absl::string_view> positional) {
+  if (positional.empty()) {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+    return RunSample(temp_dir.path());
+  }
+  std::filesystem::path run_dir(positional[0]);
+  if (!std::filesystem::is_directory(run_dir)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "%s is not a directory or does not exist.", run_dir.string()));
+  }
+  return RunSample(run_dir);
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<absl::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  XLS_QCHECK(!absl::GetFlag(FLAGS_options_file).empty())
+      << "--options_file is required.";
+  XLS_QCHECK(!absl::GetFlag(FLAGS_input_file).empty())
+      << "--input_file is required.";
+  XLS_QCHECK_LE(positional_arguments.size(), 1)
+      << "Expected at most one argument.";
+
+  XLS_QCHECK_OK(xls::RealMain(positional_arguments));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_runner.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOk;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr const char* kAddDslx = "fn main(x: u8, y: u8) -> u8 { x + y }";
+
+std::vector<std::vector<dslx::InterpValue>> AddArgsBatch() {
+  return ParseArgsBatch("bits[8]:42; bits[8]:100\nbits[8]:222; bits[8]:240")
+      .value();
+}
+
+std::string ReadRunFile(const TempDirectory& dir, absl::string_view name) {
+  return GetFileContents(dir.path() / name).value();
+}
+
+std::vector<std::string> ReadRunFileLines(const TempDirectory& dir,
+                                          absl::string_view name) {
+  return absl::StrSplit(ReadRunFile(dir, name), '\n', absl::SkipWhitespace());
+}
+
+TEST(SampleRunnerTest, InterpretDslx) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SampleOptions options,
+      SampleOptions::FromJson(R"({"convert_to_ir": false})"));
+  SampleRunner runner(dir.path());
+  XLS_ASSERT_OK(runner.Run(Sample(kAddDslx, options, AddArgsBatch())));
+  EXPECT_THAT(ReadRunFileLines(dir, "sample.x.results"),
+              ElementsAre("bits[8]:0x8e", "bits[8]:0xce"));
+  EXPECT_THAT(FileExists(dir.path() / "sample.ir"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(SampleRunnerTest, InvalidDslxWritesException) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  SampleRunner runner(dir.path());
+  EXPECT_THAT(
+      runner.Run(Sample("syntaxerror!!! fn main(x: u8, y: u8) -> u8 { x + y }",
+                        SampleOptions(), AddArgsBatch())),
+      Not(IsOk()));
+  EXPECT_THAT(ReadRunFile(dir, "exception.txt"),
+              HasSubstr("Expected start of top-level construct"));
+}
+
+TEST(SampleRunnerTest, EvaluateUnoptimizedAndOptimizedIr) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SampleOptions options,
+      SampleOptions::FromJson(R"({"ir_converter_args": ["--entry=main"]})"));
+  SampleRunner runner(dir.path());
+  XLS_ASSERT_OK(runner.Run(Sample(kAddDslx, options, AddArgsBatch())));
+  EXPECT_THAT(ReadRunFile(dir, "sample.ir"), HasSubstr("package sample"));
+  EXPECT_THAT(ReadRunFileLines(dir, "sample.ir.results"),
+              ElementsAre("bits[8]:0x8e", "bits[8]:0xce"));
+  EXPECT_THAT(ReadRunFileLines(dir, "sample.opt.ir.results"),
+              ElementsAre("bits[8]:0x8e", "bits[8]:0xce"));
+
+  fuzzer::SampleSummaryProto summary = runner.Summarize();
+  EXPECT_GT(summary.unoptimized_nodes_size(), 0);
+  EXPECT_GT(summary.optimized_nodes_size(), 0);
+  EXPECT_GT(summary.timing().optimize_ns(), 0);
+}
+
+TEST(SampleRunnerTest, IrInput) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SampleOptions options,
+      SampleOptions::FromJson(R"({"input_is_dslx": false})"));
+  constexpr const char* kIr = R"(package foo
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+)";
+  SampleRunner runner(dir.path());
+  XLS_ASSERT_OK(runner.Run(Sample(kIr, options, AddArgsBatch())));
+  EXPECT_THAT(ReadRunFileLines(dir, "sample.opt.ir.results"),
+              ElementsAre("bits[8]:0x8e", "bits[8]:0xce"));
+}
+
+TEST(SampleRunnerTest, CodegenCombinational) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(SampleOptions options,
+                           SampleOptions::FromJson(R"({
+    "ir_converter_args": ["--entry=main"],
+    "codegen": true,
+    "codegen_args": ["--generator=combinational"]
+  })"));
+  SampleRunner runner(dir.path());
+  XLS_ASSERT_OK(runner.Run(Sample(kAddDslx, options, AddArgsBatch())));
+  std::string verilog = ReadRunFile(dir, "sample.v");
+  EXPECT_THAT(verilog, HasSubstr("endmodule"));
+  // A combinational block should not have a blocking assignment.
+  EXPECT_THAT(verilog, Not(HasSubstr("<=")));
+  XLS_EXPECT_OK(FileExists(dir.path() / "module_sig.textproto"));
+}
+
+TEST(SampleRunnerTest, CodegenPipeline) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(SampleOptions options,
+                           SampleOptions::FromJson(R"({
+    "ir_converter_args": ["--entry=main"],
+    "codegen": true,
+    "codegen_args": ["--generator=pipeline", "--pipeline_stages=2"]
+  })"));
+  SampleRunner runner(dir.path());
+  XLS_ASSERT_OK(runner.Run(Sample(kAddDslx, options, AddArgsBatch())));
+  // A pipelined block should have a blocking assignment.
+  EXPECT_THAT(ReadRunFile(dir, "sample.v"), HasSubstr("<="));
+}
+
+TEST(SampleRunnerTest, UnsupportedCodegenArgument) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(SampleOptions options,
+                           SampleOptions::FromJson(R"({
+    "ir_converter_args": ["--entry=main"],
+    "codegen": true,
+    "codegen_args": ["--no_such_flag"]
+  })"));
+  SampleRunner runner(dir.path());
+  EXPECT_THAT(runner.Run(Sample(kAddDslx, options, AddArgsBatch())),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("--no_such_flag")));
+}
+
+}  // namespace
+}  // namespace xls
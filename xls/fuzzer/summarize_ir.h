@@ -0,0 +1,33 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SUMMARIZE_IR_H_
+#define XLS_FUZZER_SUMMARIZE_IR_H_
+
+#include "google/protobuf/repeated_field.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Appends a NodeProto for every node of every function in the package (op,
+// type and flattened width, plus the same for each of its operands) to
+// `nodes`.
+void SummarizePackage(
+    Package* package,
+    google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SUMMARIZE_IR_H_
@@ -18,8 +18,8 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/summarize_ir.h"
 #include "xls/ir/ir_parser.h"
-#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 
 const char kUsage[] = R"(
@@ -46,34 +46,6 @@ ABSL_FLAG(std::string, summary_file, "", "Summary file to append to.");
 namespace xls {
 namespace {
 
-std::string TypeToString(Type* type) {
-  if (type->IsBits()) {
-    return "bits";
-  } else if (type->IsArray()) {
-    return "array";
-  } else if (type->IsTuple()) {
-    return "tuple";
-  }
-  return "other";
-}
-
-void SummarizePackage(Package* package,
-                      google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes) {
-  for (const auto& function : package->functions()) {
-    for (Node* node : function->nodes()) {
-      fuzzer::NodeProto* node_proto = nodes->Add();
-      node_proto->set_op(OpToString(node->op()));
-      node_proto->set_type(TypeToString(node->GetType()));
-      node_proto->set_width(node->GetType()->GetFlatBitCount());
-      for (Node* operand : node->operands()) {
-        fuzzer::NodeProto* operand_proto = node_proto->add_operands();
-        operand_proto->set_op(OpToString(operand->op()));
-        operand_proto->set_type(TypeToString(operand->GetType()));
-        operand_proto->set_width(operand->GetType()->GetFlatBitCount());
-      }
-    }
-  }
-}
 absl::StatusOr<std::unique_ptr<Package>> ParseFile(absl::string_view path) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
   return Parser::ParsePackage(contents, path);
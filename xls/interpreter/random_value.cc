@@ -58,6 +58,57 @@ std::vector<Value> RandomFunctionArguments(Function* f,
   return inputs;
 }
 
+Value CornerCaseValue(Type* type, std::minstd_rand* engine) {
+  if (type->IsTuple()) {
+    TupleType* tuple_type = type->AsTupleOrDie();
+    std::vector<Value> elements;
+    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+      elements.push_back(CornerCaseValue(tuple_type->element_type(i), engine));
+    }
+    return Value::Tuple(elements);
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    std::vector<Value> elements;
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      elements.push_back(CornerCaseValue(array_type->element_type(), engine));
+    }
+    return Value::Array(elements).value();
+  }
+  if (type->IsToken()) {
+    return Value::Token();
+  }
+  int64_t bit_count = type->AsBitsOrDie()->bit_count();
+  if (bit_count == 0) {
+    return Value(Bits());
+  }
+  // Random bits are drawn as often as all the corner cases together.
+  std::uniform_int_distribution<int32_t> generator(0, 9);
+  switch (generator(*engine)) {
+    case 0:
+      return Value(Bits(bit_count));
+    case 1:
+      return Value(UBits(1, bit_count));
+    case 2:
+      return Value(Bits::AllOnes(bit_count));
+    case 3:
+      return Value(Bits::MinSigned(bit_count));
+    case 4:
+      return Value(Bits::MaxSigned(bit_count));
+    default:
+      return RandomValue(type, engine);
+  }
+}
+
+std::vector<Value> CornerCaseFunctionArguments(Function* f,
+                                               std::minstd_rand* engine) {
+  std::vector<Value> inputs;
+  for (Param* param : f->params()) {
+    inputs.push_back(CornerCaseValue(param->GetType(), engine));
+  }
+  return inputs;
+}
+
 absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
     Function* f, std::minstd_rand* engine, Function* validator,
     int64_t max_attempts) {
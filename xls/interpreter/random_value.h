@@ -37,6 +37,16 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
     Function* f, std::minstd_rand* engine, Function* validator,
     int64_t max_attempts);
 
+// Returns a Value biased towards corner cases using the given engine. Each bits
+// leaf of the type is independently chosen to be zero, one, all ones, the
+// minimum or maximum signed value, or uniformly distributed random bits.
+Value CornerCaseValue(Type* type, std::minstd_rand* engine);
+
+// Returns a set of argument values for the given function biased towards
+// corner cases (see CornerCaseValue) using the given engine.
+std::vector<Value> CornerCaseFunctionArguments(Function* f,
+                                               std::minstd_rand* engine);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_RANDOM_VALUE_H_
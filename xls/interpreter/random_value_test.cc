@@ -111,5 +111,33 @@ TEST(RandomValueTest, RandomOtherTypes) {
   }
 }
 
+TEST(RandomValueTest, CornerCases) {
+  Package p("test_package");
+  std::minstd_rand rng_engine;
+
+  // Every corner case of a 16-bit value is drawn with high probability.
+  absl::flat_hash_set<uint64_t> samples;
+  for (int64_t i = 0; i < 1000; ++i) {
+    Value b = CornerCaseValue(p.GetBitsType(16), &rng_engine);
+    XLS_ASSERT_OK_AND_ASSIGN(uint64_t as_uint64, b.bits().ToUint64());
+    samples.insert(as_uint64);
+  }
+  EXPECT_TRUE(samples.contains(0));
+  EXPECT_TRUE(samples.contains(1));
+  EXPECT_TRUE(samples.contains(0xffff));
+  EXPECT_TRUE(samples.contains(0x8000));
+  EXPECT_TRUE(samples.contains(0x7fff));
+  // Random values are drawn as well.
+  EXPECT_GT(samples.size(), 100);
+
+  // Leaves of aggregates are drawn independently.
+  Value tuple = CornerCaseValue(
+      p.GetTupleType({p.GetBitsType(0), p.GetArrayType(3, p.GetBitsType(8))}),
+      &rng_engine);
+  ASSERT_TRUE(tuple.IsTuple());
+  EXPECT_EQ(tuple.element(0).bits().bit_count(), 0);
+  EXPECT_EQ(tuple.element(1).size(), 3);
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_VALUE_H_
 #define XLS_IR_VALUE_H_
 
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -146,6 +147,11 @@ class Value {
   bool operator==(const Value& other) const;
   bool operator!=(const Value& other) const { return !(*this == other); }
 
+  template <typename H>
+  friend H AbslHashValue(H h, const Value& value) {
+    return H::combine(std::move(h), value.kind_, value.payload_);
+  }
+
  private:
   Value(ValueKind kind, absl::Span<const Value> elements)
       : kind_(kind),
@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/hash/hash_testing.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/package.h"
@@ -151,6 +152,23 @@ TEST(ValueTest, IsAllZeroOnes) {
                    .IsAllOnes());
 }
 
+TEST(ValueTest, Hash) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value array_a, Value::UBitsArray({1, 2, 3}, 8));
+  XLS_ASSERT_OK_AND_ASSIGN(Value array_b, Value::UBitsArray({1, 2, 4}, 8));
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      Value::Token(),
+      Value(UBits(0, 0)),
+      Value(UBits(0, 8)),
+      Value(UBits(42, 8)),
+      Value(UBits(42, 32)),
+      Value::Tuple({}),
+      Value::Tuple({Value(UBits(42, 8))}),
+      Value::Tuple({Value(UBits(42, 8)), Value(UBits(1, 1))}),
+      array_a,
+      array_b,
+  }));
+}
+
 TEST(ValueTest, XBitsArray) {
   Value v0;
 
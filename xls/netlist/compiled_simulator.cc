@@ -0,0 +1,401 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_simulator.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Slots always holding all-zeros and all-ones.
+constexpr int32_t kZeroSlot = 0;
+constexpr int32_t kOneSlot = 1;
+
+// Follows any chain of assignments from the given net to the net providing
+// its value.
+rtl::NetRef ResolveAssigns(const rtl::Module* module, rtl::NetRef net) {
+  const auto& assigns = module->assigns();
+  for (int64_t i = 0; i <= assigns.size(); ++i) {
+    auto it = assigns.find(net);
+    if (it == assigns.end()) {
+      break;
+    }
+    net = it->second;
+  }
+  return net;
+}
+
+}  // namespace
+
+// Lowers a module (and, recursively, the modules it instantiates) into the
+// simulator's program.
+class CompiledSimulator::Compiler {
+ public:
+  Compiler(const rtl::Netlist* netlist, CompiledSimulator* simulator)
+      : netlist_(netlist), simulator_(simulator) {}
+
+  // Emits the ops evaluating "module", whose inputs are held in the given
+  // slots (in the order of Module::inputs()). Returns the slots holding the
+  // module's outputs, in the order of Module::outputs().
+  absl::StatusOr<std::vector<int32_t>> CompileModule(
+      const rtl::Module* module, absl::Span<const int32_t> input_slots);
+
+ private:
+  using SlotMap = absl::flat_hash_map<rtl::NetRef, int32_t>;
+
+  absl::Status CompileCell(const rtl::Module* module, const rtl::Cell* cell,
+                           SlotMap& slots);
+  absl::StatusOr<int32_t> CompileFunction(const rtl::Module* module,
+                                          const rtl::Cell* cell,
+                                          const function::Ast& ast,
+                                          const SlotMap& slots);
+
+  // Returns the slot holding the value of the given cell input net.
+  absl::StatusOr<int32_t> GetSlot(const rtl::Module* module,
+                                  const rtl::Cell* cell, rtl::NetRef net,
+                                  const SlotMap& slots);
+
+  int32_t Emit(Op op, int32_t lhs, int32_t rhs) {
+    int32_t dst = simulator_->slot_count_++;
+    simulator_->program_.push_back(Instruction{op, dst, lhs, rhs});
+    return dst;
+  }
+
+  const rtl::Netlist* netlist_;
+  CompiledSimulator* simulator_;
+
+  // Modules currently being compiled, to reject recursive instantiation.
+  std::vector<const rtl::Module*> module_stack_;
+
+  // Parsed pin functions, keyed by function text. Most cells in a netlist are
+  // instances of a handful of library entries, so this saves re-parsing.
+  absl::flat_hash_map<std::string, function::Ast> asts_;
+};
+
+absl::StatusOr<std::vector<int32_t>> CompiledSimulator::Compiler::CompileModule(
+    const rtl::Module* module, absl::Span<const int32_t> input_slots) {
+  if (std::find(module_stack_.begin(), module_stack_.end(), module) !=
+      module_stack_.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Module %s instantiates itself.", module->name()));
+  }
+  module_stack_.push_back(module);
+
+  XLS_RET_CHECK_EQ(input_slots.size(), module->inputs().size());
+  SlotMap slots;
+  slots[module->zero()] = kZeroSlot;
+  slots[module->one()] = kOneSlot;
+  for (int64_t i = 0; i < input_slots.size(); ++i) {
+    slots[module->inputs()[i]] = input_slots[i];
+  }
+
+  // Order the cells topologically: a cell is ready once every cell driving
+  // one of its inputs has been compiled.
+  absl::flat_hash_map<rtl::NetRef, const rtl::Cell*> drivers;
+  for (const auto& cell : module->cells()) {
+    for (const auto& output : cell->outputs()) {
+      if (output.netref != module->GetDummyRef()) {
+        drivers[output.netref] = cell.get();
+      }
+    }
+  }
+  absl::flat_hash_map<const rtl::Cell*, int64_t> pending_inputs;
+  absl::flat_hash_map<const rtl::Cell*, std::vector<const rtl::Cell*>> users;
+  std::deque<const rtl::Cell*> ready;
+  for (const auto& cell : module->cells()) {
+    int64_t pending = 0;
+    for (const auto& input : cell->inputs()) {
+      auto it = drivers.find(ResolveAssigns(module, input.netref));
+      if (it != drivers.end()) {
+        ++pending;
+        users[it->second].push_back(cell.get());
+      }
+    }
+    pending_inputs[cell.get()] = pending;
+    if (pending == 0) {
+      ready.push_back(cell.get());
+    }
+  }
+
+  int64_t compiled = 0;
+  while (!ready.empty()) {
+    const rtl::Cell* cell = ready.front();
+    ready.pop_front();
+    XLS_RETURN_IF_ERROR(CompileCell(module, cell, slots));
+    ++compiled;
+    for (const rtl::Cell* user : users[cell]) {
+      if (--pending_inputs[user] == 0) {
+        ready.push_back(user);
+      }
+    }
+  }
+  if (compiled != module->cells().size()) {
+    for (const auto& cell : module->cells()) {
+      if (pending_inputs[cell.get()] > 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains a combinational cycle and cannot be simulated. "
+            "Example: cell %s",
+            cell->name()));
+      }
+    }
+  }
+
+  std::vector<int32_t> output_slots;
+  for (const rtl::NetRef output : module->outputs()) {
+    auto it = slots.find(ResolveAssigns(module, output));
+    if (it == slots.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Output %s of module %s is undriven.", output->name(),
+                          module->name()));
+    }
+    output_slots.push_back(it->second);
+  }
+
+  module_stack_.pop_back();
+  return output_slots;
+}
+
+absl::Status CompiledSimulator::Compiler::CompileCell(const rtl::Module* module,
+                                                      const rtl::Cell* cell,
+                                                      SlotMap& slots) {
+  const CellLibraryEntry* entry = cell->cell_library_entry();
+  absl::optional<const rtl::Module*> submodule =
+      netlist_->MaybeGetModule(entry->name());
+  if (submodule.has_value()) {
+    // Inline the instantiated module, matching pins by name as the
+    // Interpreter does.
+    const rtl::Module* child = submodule.value();
+    absl::Span<const std::string> input_names =
+        child->AsCellLibraryEntry()->input_names();
+    std::vector<int32_t> child_input_slots;
+    for (int64_t i = 0; i < child->inputs().size(); ++i) {
+      auto it = std::find_if(
+          cell->inputs().begin(), cell->inputs().end(),
+          [&](const auto& input) { return input.name == input_names[i]; });
+      if (it == cell->inputs().end()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Input pin \"%s\" of module \"%s\" is not connected in cell "
+            "\"%s\".",
+            input_names[i], child->name(), cell->name()));
+      }
+      XLS_ASSIGN_OR_RETURN(int32_t slot,
+                           GetSlot(module, cell, it->netref, slots));
+      child_input_slots.push_back(slot);
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<int32_t> child_output_slots,
+                         CompileModule(child, child_input_slots));
+    for (const auto& output : cell->outputs()) {
+      bool found = false;
+      for (int64_t i = 0; i < child->outputs().size(); ++i) {
+        if (child->outputs()[i]->name() == output.name) {
+          slots[output.netref] = child_output_slots[i];
+          found = true;
+          break;
+        }
+      }
+      XLS_RET_CHECK(found) << absl::StrFormat(
+          "Could not find output pin \"%s\" in module \"%s\", referenced in "
+          "cell \"%s\"!",
+          output.name, child->name(), cell->name());
+    }
+    return absl::OkStatus();
+  }
+
+  const auto& pin_functions = entry->output_pin_to_function();
+  for (const auto& output : cell->outputs()) {
+    if (output.eval != nullptr) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cell %s has a custom evaluation function, which cannot be "
+          "compiled.",
+          cell->name()));
+    }
+    auto function_it = pin_functions.find(output.name);
+    XLS_RET_CHECK(function_it != pin_functions.end())
+        << "No function for pin " << output.name << " of cell "
+        << cell->name();
+    auto ast_it = asts_.find(function_it->second);
+    if (ast_it == asts_.end()) {
+      XLS_ASSIGN_OR_RETURN(function::Ast ast, function::Parser::ParseFunction(
+                                                  function_it->second));
+      ast_it = asts_.insert({function_it->second, std::move(ast)}).first;
+    }
+    XLS_ASSIGN_OR_RETURN(int32_t slot,
+                         CompileFunction(module, cell, ast_it->second, slots));
+    slots[output.netref] = slot;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int32_t> CompiledSimulator::Compiler::CompileFunction(
+    const rtl::Module* module, const rtl::Cell* cell, const function::Ast& ast,
+    const SlotMap& slots) {
+  switch (ast.kind()) {
+    case function::Ast::Kind::kIdentifier: {
+      rtl::NetRef ref = nullptr;
+      for (const auto& input : cell->inputs()) {
+        if (input.name == ast.name()) {
+          ref = input.netref;
+        }
+      }
+      if (ref != nullptr) {
+        return GetSlot(module, cell, ref, slots);
+      }
+      for (const auto& internal : cell->internal_pins()) {
+        if (internal.name == ast.name()) {
+          return absl::UnimplementedError(absl::StrFormat(
+              "Cell %s uses a state table, which cannot be compiled.",
+              cell->name()));
+        }
+      }
+      return absl::NotFoundError(
+          absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                          "or internal signals.",
+                          ast.name(), cell->name()));
+    }
+    case function::Ast::Kind::kLiteralOne:
+      return kOneSlot;
+    case function::Ast::Kind::kLiteralZero:
+      return kZeroSlot;
+    case function::Ast::Kind::kNot: {
+      XLS_ASSIGN_OR_RETURN(
+          int32_t operand,
+          CompileFunction(module, cell, ast.children()[0], slots));
+      return Emit(Op::kNot, operand, operand);
+    }
+    case function::Ast::Kind::kAnd:
+    case function::Ast::Kind::kOr:
+    case function::Ast::Kind::kXor: {
+      XLS_ASSIGN_OR_RETURN(
+          int32_t lhs, CompileFunction(module, cell, ast.children()[0], slots));
+      XLS_ASSIGN_OR_RETURN(
+          int32_t rhs, CompileFunction(module, cell, ast.children()[1], slots));
+      Op op = ast.kind() == function::Ast::Kind::kAnd  ? Op::kAnd
+              : ast.kind() == function::Ast::Kind::kOr ? Op::kOr
+                                                       : Op::kXor;
+      return Emit(op, lhs, rhs);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown AST element type: ", static_cast<int>(ast.kind())));
+}
+
+absl::StatusOr<int32_t> CompiledSimulator::Compiler::GetSlot(
+    const rtl::Module* module, const rtl::Cell* cell, rtl::NetRef net,
+    const SlotMap& slots) {
+  auto it = slots.find(ResolveAssigns(module, net));
+  if (it == slots.end()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Netlist contains unconnected subgraphs and cannot be translated. "
+        "Example: cell %s",
+        cell->name()));
+  }
+  return it->second;
+}
+
+absl::StatusOr<CompiledSimulator> CompiledSimulator::Create(
+    const rtl::Netlist* netlist, const rtl::Module* module) {
+  CompiledSimulator simulator;
+  simulator.slot_count_ = 2;
+  for (int64_t i = 0; i < module->inputs().size(); ++i) {
+    simulator.input_slots_.push_back(simulator.slot_count_++);
+  }
+  Compiler compiler(netlist, &simulator);
+  XLS_ASSIGN_OR_RETURN(
+      simulator.output_slots_,
+      compiler.CompileModule(module, simulator.input_slots_));
+  return simulator;
+}
+
+absl::StatusOr<std::vector<Bits>> CompiledSimulator::Run(
+    absl::Span<const Bits> inputs) const {
+  for (const Bits& input : inputs) {
+    XLS_RET_CHECK_EQ(input.bit_count(), input_slots_.size());
+  }
+
+  std::vector<uint64_t> values(slot_count_ * kWordsPerSlot, 0);
+  std::fill_n(values.begin() + kOneSlot * kWordsPerSlot, kWordsPerSlot,
+              ~uint64_t{0});
+
+  std::vector<Bits> results;
+  results.reserve(inputs.size());
+  for (int64_t base = 0; base < inputs.size(); base += kVectorsPerPass) {
+    int64_t count =
+        std::min<int64_t>(kVectorsPerPass, inputs.size() - base);
+
+    // Transpose the input vectors into bit-per-vector slots.
+    for (int64_t i = 0; i < input_slots_.size(); ++i) {
+      uint64_t* words = &values[input_slots_[i] * kWordsPerSlot];
+      std::fill_n(words, kWordsPerSlot, 0);
+      for (int64_t v = 0; v < count; ++v) {
+        if (inputs[base + v].Get(i)) {
+          words[v / 64] |= uint64_t{1} << (v % 64);
+        }
+      }
+    }
+
+    for (const Instruction& inst : program_) {
+      uint64_t* dst = &values[inst.dst * kWordsPerSlot];
+      const uint64_t* lhs = &values[inst.lhs * kWordsPerSlot];
+      const uint64_t* rhs = &values[inst.rhs * kWordsPerSlot];
+      switch (inst.op) {
+        case Op::kAnd:
+          for (int64_t w = 0; w < kWordsPerSlot; ++w) {
+            dst[w] = lhs[w] & rhs[w];
+          }
+          break;
+        case Op::kOr:
+          for (int64_t w = 0; w < kWordsPerSlot; ++w) {
+            dst[w] = lhs[w] | rhs[w];
+          }
+          break;
+        case Op::kXor:
+          for (int64_t w = 0; w < kWordsPerSlot; ++w) {
+            dst[w] = lhs[w] ^ rhs[w];
+          }
+          break;
+        case Op::kNot:
+          for (int64_t w = 0; w < kWordsPerSlot; ++w) {
+            dst[w] = ~lhs[w];
+          }
+          break;
+      }
+    }
+
+    for (int64_t v = 0; v < count; ++v) {
+      BitsRope rope(output_slots_.size());
+      for (int32_t slot : output_slots_) {
+        uint64_t word = values[slot * kWordsPerSlot + v / 64];
+        rope.push_back((word >> (v % 64)) & 1);
+      }
+      results.push_back(rope.Build());
+    }
+  }
+  return results;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,93 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_SIMULATOR_H_
+#define XLS_NETLIST_COMPILED_SIMULATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Bit-parallel simulator for a netlist module.
+//
+// Where the Interpreter walks the netlist for every input vector, looking up
+// nets in hash maps and re-parsing each cell's function, this simulator
+// compiles the module once: cells are put in topological order (instances of
+// other modules in the netlist are inlined), each output pin function is
+// lowered to a straight-line sequence of bitwise ops, and every net is given
+// a fixed slot. Each slot holds one bit for each of kVectorsPerPass input
+// vectors, so a single pass over the program evaluates that many vectors.
+//
+// Like the Interpreter, the module is evaluated as combinational logic: flops
+// whose function is that of a buffer pass their input through. Cells whose
+// behavior is given by a state table or a custom evaluation function are not
+// supported.
+class CompiledSimulator {
+ public:
+  // Number of 64-bit words in each slot. Ops are applied to all words of a
+  // slot in a fixed-length loop, which the compiler can vectorize.
+  static constexpr int64_t kWordsPerSlot = 4;
+  static constexpr int64_t kVectorsPerPass = 64 * kWordsPerSlot;
+
+  // Compiles the given module, which must be part of "netlist".
+  static absl::StatusOr<CompiledSimulator> Create(const rtl::Netlist* netlist,
+                                                  const rtl::Module* module);
+
+  // Evaluates the module for each of the given input vectors. Bit i of an
+  // input vector is the value of module->inputs()[i]; bit i of the
+  // corresponding result is the value of module->outputs()[i].
+  absl::StatusOr<std::vector<Bits>> Run(absl::Span<const Bits> inputs) const;
+
+  // Number of bitwise ops executed per pass.
+  int64_t op_count() const { return program_.size(); }
+
+ private:
+  enum class Op : uint8_t {
+    kAnd,
+    kOr,
+    kXor,
+    kNot,
+  };
+
+  // Computes slot "dst" from slots "lhs" and "rhs" (the same slot for kNot).
+  struct Instruction {
+    Op op;
+    int32_t dst;
+    int32_t lhs;
+    int32_t rhs;
+  };
+
+  class Compiler;
+
+  CompiledSimulator() = default;
+
+  std::vector<Instruction> program_;
+  int64_t slot_count_ = 0;
+  // Slots holding the module inputs and outputs, in the order of
+  // Module::inputs() and Module::outputs().
+  std::vector<int32_t> input_slots_;
+  std::vector<int32_t> output_slots_;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_SIMULATOR_H_
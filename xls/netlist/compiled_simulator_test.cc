@@ -0,0 +1,122 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_simulator.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Submodules, output assigns, a flop and every combinational fake-library
+// gate type.
+constexpr const char kNetlistText[] = R"(
+module submodule_0 (i2_0, i2_1, o2_0);
+  input i2_0, i2_1;
+  output o2_0;
+
+  AND and0( .A(i2_0), .B(i2_1), .Z(o2_0) );
+endmodule
+
+module main (clk, i0, i1, i2, i3, o0, o1, o2, o3);
+  input clk, i0, i1, i2, i3;
+  output o0, o1, o2, o3;
+  wire res0, res1, res2, res3, res4, res5;
+
+  submodule_0 sub ( .i2_0(i0), .i2_1(i1), .o2_0(res0) );
+  OR or0 ( .A(i2), .B(i3), .Z(res1) );
+  XOR xor0 ( .A(res0), .B(res1), .Z(res2) );
+  AOI21 aoi0 ( .A(i0), .B(res2), .C(i3), .ZN(res3) );
+  NOR4 nor0 ( .A(res3), .B(i1), .C(res0), .D(i2), .ZN(res4) );
+  NAND nand0 ( .A(res4), .B(i3), .ZN(res5) );
+  DFF dff0 ( .D(res5), .CLK(clk), .Q(o0) );
+  INV inv0 ( .A(res3), .ZN(o1) );
+  assign o2 = i2;
+  assign o3 = 1'b1;
+endmodule
+)";
+
+TEST(CompiledSimulatorTest, MatchesInterpreter) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(kNetlistText);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledSimulator simulator,
+                           CompiledSimulator::Create(netlist.get(), module));
+
+  // Cover every input combination several times over, so that the vectors
+  // span more than one pass and the last pass is partial.
+  const int64_t input_count = module->inputs().size();
+  std::vector<Bits> inputs;
+  for (int64_t i = 0; i < 2 * CompiledSimulator::kVectorsPerPass + 7; ++i) {
+    inputs.push_back(UBits(i % (int64_t{1} << input_count), input_count));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bits> results, simulator.Run(inputs));
+  ASSERT_EQ(results.size(), inputs.size());
+
+  Interpreter interpreter(netlist.get());
+  for (int64_t v = 0; v < inputs.size(); ++v) {
+    NetRef2Value input_nets;
+    for (int64_t i = 0; i < input_count; ++i) {
+      input_nets[module->inputs()[i]] = inputs[v].Get(i);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value output_nets,
+                             interpreter.InterpretModule(module, input_nets));
+    ASSERT_EQ(results[v].bit_count(), module->outputs().size());
+    for (int64_t o = 0; o < module->outputs().size(); ++o) {
+      EXPECT_EQ(results[v].Get(o), output_nets.at(module->outputs()[o]))
+          << "vector " << v << ", output " << module->outputs()[o]->name();
+    }
+  }
+}
+
+TEST(CompiledSimulatorTest, StateTablesAreUnimplemented) {
+  constexpr const char kStateTableNetlist[] = R"(
+module main (i0, i1, o0);
+  input i0, i1;
+  output o0;
+
+  STATETABLE_AND and0 ( .A(i0), .B(i1), .Z(o0) );
+endmodule
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(kStateTableNetlist);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(CompiledSimulator::Create(netlist.get(), module),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("state table")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
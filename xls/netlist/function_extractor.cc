@@ -14,12 +14,15 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <system_error>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/variant.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -264,6 +267,21 @@ absl::Status ExtractFromCell(const cell_lib::Block& cell,
   return absl::OkStatus();
 }
 
+// Returns true if the cache file exists and is no older than the library (as
+// with make, equal timestamps count as up to date).
+bool CacheIsFresh(const std::filesystem::path& lib_path,
+                  const std::filesystem::path& cache_path) {
+  std::error_code ec;
+  std::filesystem::file_time_type cache_time =
+      std::filesystem::last_write_time(cache_path, ec);
+  if (ec) {
+    return false;
+  }
+  std::filesystem::file_time_type lib_time =
+      std::filesystem::last_write_time(lib_path, ec);
+  return !ec && cache_time >= lib_time;
+}
+
 }  // namespace
 
 absl::StatusOr<CellLibraryProto> ExtractFunctions(
@@ -272,7 +290,7 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   absl::flat_hash_set<std::string> kind_allowlist(
       {"library", "cell", "pin", "direction", "function", "ff", "next_state",
        "statetable"});
-  cell_lib::Parser parser(&scanner);
+  cell_lib::Parser parser(&scanner, std::move(kind_allowlist));
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<cell_lib::Block> block,
                        parser.ParseLibrary());
@@ -290,6 +308,29 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+absl::StatusOr<CellLibraryProto> ExtractFunctionsCached(
+    const std::filesystem::path& lib_path,
+    const std::filesystem::path& cache_path) {
+  if (!cache_path.empty() && CacheIsFresh(lib_path, cache_path)) {
+    XLS_ASSIGN_OR_RETURN(std::string cache_bytes, GetFileContents(cache_path));
+    CellLibraryProto proto;
+    if (proto.ParseFromString(cache_bytes)) {
+      return proto;
+    }
+    XLS_LOG(WARNING) << "Ignoring unparseable cell library cache "
+                     << cache_path;
+  }
+
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromPath(lib_path.string()));
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto proto, ExtractFunctions(&stream));
+  if (!cache_path.empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(cache_path, proto.SerializeAsString()));
+  }
+  return proto;
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
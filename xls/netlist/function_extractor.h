@@ -15,6 +15,7 @@
 #ifndef XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
+#include <filesystem>
 #include <string>
 
 #include "absl/status/statusor.h"
@@ -31,6 +32,16 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// Extracts the functions from the Liberty file at "lib_path" (which is
+// memory-mapped rather than read in).
+//
+// If "cache_path" is non-empty, it holds a binary CellLibraryProto: when it is
+// at least as new as the library it is loaded instead of parsing the library
+// at all, and otherwise it is (re)written with the extracted proto.
+absl::StatusOr<CellLibraryProto> ExtractFunctionsCached(
+    const std::filesystem::path& lib_path,
+    const std::filesystem::path& cache_path);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
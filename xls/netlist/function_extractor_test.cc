@@ -14,9 +14,14 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <chrono>  // NOLINT
+#include <filesystem>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
@@ -216,6 +221,49 @@ library (simple_statetable_cells) {
   EXPECT_EQ(row.next_internal_signals().at("X"), STATE_TABLE_SIGNAL_HIGH);
 }
 
+TEST(FunctionExtractorTest, CachedExtraction) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path lib_path = temp_dir.path() / "cells.lib";
+  std::filesystem::path cache_path = temp_dir.path() / "cells.pb";
+  XLS_ASSERT_OK(SetFileContents(lib_path, R"(
+library (blah) {
+  cell (cell_1) {
+    pin (i0) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "!i0";
+    }
+  }
+}
+)"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                           ExtractFunctionsCached(lib_path, cache_path));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).name(), "cell_1");
+  XLS_ASSERT_OK_AND_ASSIGN(std::string cache_bytes,
+                           GetFileContents(cache_path));
+  EXPECT_EQ(cache_bytes, proto.SerializeAsString());
+
+  // While the cache is newer than the library, it is used as-is.
+  CellLibraryProto cached_proto;
+  cached_proto.add_entries()->set_name("cached_cell");
+  XLS_ASSERT_OK(SetFileContents(cache_path, cached_proto.SerializeAsString()));
+  XLS_ASSERT_OK_AND_ASSIGN(proto, ExtractFunctionsCached(lib_path, cache_path));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).name(), "cached_cell");
+
+  // Once the library changes, the cache is rebuilt.
+  std::filesystem::last_write_time(
+      lib_path, std::filesystem::last_write_time(cache_path) +
+                    std::chrono::hours(1));
+  XLS_ASSERT_OK_AND_ASSIGN(proto, ExtractFunctionsCached(lib_path, cache_path));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).name(), "cell_1");
+}
+
 }  // namespace
 }  // namespace function
 }  // namespace netlist
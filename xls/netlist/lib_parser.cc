@@ -14,8 +14,15 @@
 
 #include "xls/netlist/lib_parser.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/logging/logging.h"
 
 namespace xls {
@@ -24,18 +31,66 @@ namespace cell_lib {
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromPath(
     absl::string_view path) {
-  std::ifstream file_stream{std::string(path)};
-  if (file_stream.is_open()) {
-    return CharStream(std::move(file_stream));
+  int fd = open(std::string(path).c_str(), O_RDONLY);
+  if (fd < 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not open file at path: ", path));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return absl::InternalError(
+        absl::StrCat("Could not stat file at path: ", path));
+  }
+  if (file_stat.st_size == 0) {
+    // Zero-length mappings are not permitted.
+    close(fd);
+    return CharStream(std::string());
   }
-  return absl::NotFoundError(
-      absl::StrCat("Could not open file at path: ", path));
+  void* mapping =
+      mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    // Not everything can be mapped (e.g. pipes); fall back to reading the file
+    // into memory.
+    XLS_ASSIGN_OR_RETURN(std::string text,
+                         GetFileContents(std::string(path)));
+    return CharStream(std::move(text));
+  }
+  // The file is scanned front to back.
+  madvise(mapping, file_stat.st_size, MADV_SEQUENTIAL);
+  return CharStream(static_cast<const char*>(mapping), file_stat.st_size);
 }
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromText(std::string text) {
   return CharStream(std::move(text));
 }
 
+CharStream::CharStream(std::string text) : text_(std::move(text)) {
+  contents_ = text_;
+}
+
+CharStream::CharStream(const char* mapping, int64_t size)
+    : mapping_(mapping), contents_(mapping, size) {}
+
+CharStream::CharStream(CharStream&& other)
+    : pos_(other.pos_),
+      text_(std::move(other.text_)),
+      mapping_(other.mapping_),
+      cursor_(other.cursor_),
+      last_colno_(other.last_colno_) {
+  // The moved-from view may point into the moved-from text, so recreate it.
+  contents_ = mapping_ == nullptr ? absl::string_view(text_) : other.contents_;
+  other.mapping_ = nullptr;
+  other.contents_ = absl::string_view();
+}
+
+CharStream::~CharStream() {
+  if (mapping_ != nullptr) {
+    munmap(const_cast<char*>(mapping_), contents_.size());
+  }
+}
+
 std::string TokenKindToString(TokenKind kind) {
   switch (kind) {
     case TokenKind::kIdentifier:
@@ -65,52 +120,97 @@ std::string TokenKindToString(TokenKind kind) {
 absl::StatusOr<Token> Scanner::ScanIdentifier() {
   const Pos start_pos = cs_->GetPos();
   XLS_CHECK(IsIdentifierStart(cs_->PeekCharOrDie()));
-  absl::InlinedVector<char, 16> chars;
+  const int64_t start = cs_->cursor();
   while (!cs_->AtEof() && IsIdentifierRest(cs_->PeekCharOrDie())) {
-    chars.push_back(cs_->PopCharOrDie());
+    cs_->DropCharOrDie();
   }
-  return Token::Identifier(
-      start_pos, std::string(absl::string_view(chars.data(), chars.size())));
+  return Token::Identifier(start_pos, cs_->Slice(start, cs_->cursor()));
 }
 
 // Scans a number token.
 absl::StatusOr<Token> Scanner::ScanNumber() {
   const Pos start_pos = cs_->GetPos();
   XLS_CHECK(std::isdigit(cs_->PeekCharOrDie()));
-  absl::InlinedVector<char, 16> chars;
+  const int64_t start = cs_->cursor();
   while (!cs_->AtEof()) {
     if (IsNumberRest(cs_->PeekCharOrDie())) {
-      chars.push_back(cs_->PopCharOrDie());
-    } else if (cs_->TryDropChars('e', '-')) {
-      chars.push_back('e');
-      chars.push_back('-');
-    } else {
+      cs_->DropCharOrDie();
+    } else if (!cs_->TryDropChars('e', '-')) {
       break;
     }
   }
-  return Token::Number(
-      start_pos, std::string(absl::string_view(chars.data(), chars.size())));
+  return Token::Number(start_pos, cs_->Slice(start, cs_->cursor()));
 }
 
 // Scans a string token.
 absl::StatusOr<Token> Scanner::ScanQuotedString() {
   const Pos start_pos = cs_->GetPos();
   XLS_CHECK(cs_->TryDropChar('"'));
-  absl::InlinedVector<char, 16> chars;
+  const int64_t start = cs_->cursor();
   while (true) {
     if (cs_->AtEof()) {
       return absl::InvalidArgumentError(
           "Unexpected end-of-file in string token starting @ " +
           start_pos.ToHumanString());
     }
-    char c = cs_->PopCharOrDie();
-    if (c == '"') {
+    if (cs_->PeekCharOrDie() == '"') {
       break;
     }
-    chars.push_back(c);
+    cs_->DropCharOrDie();
   }
-  return Token::QuotedString(
-      start_pos, std::string(absl::string_view(chars.data(), chars.size())));
+  absl::string_view payload = cs_->Slice(start, cs_->cursor());
+  cs_->DropCharOrDie();
+  return Token::QuotedString(start_pos, payload);
+}
+
+absl::Status Scanner::SkipBlockBody() {
+  XLS_ASSIGN_OR_RETURN(const Token* curl, Peek());
+  if (curl->kind() != TokenKind::kOpenCurl) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected %s to start block body; got %s @ %s",
+        TokenKindToString(TokenKind::kOpenCurl),
+        TokenKindToString(curl->kind()), curl->pos().ToHumanString()));
+  }
+  const Pos start_pos = curl->pos();
+  lookahead_.reset();
+
+  int64_t depth = 1;
+  while (depth > 0) {
+    if (cs_->AtEof()) {
+      return absl::InvalidArgumentError(
+          "Unexpected end-of-file in block body starting @ " +
+          start_pos.ToHumanString());
+    }
+    if (cs_->TryDropChars('/', '*')) {
+      while (!cs_->AtEof() && !cs_->TryDropChars('*', '/')) {
+        cs_->DropCharOrDie();
+      }
+      continue;
+    }
+    if (cs_->TryDropChars('/', '/')) {
+      while (!cs_->AtEof() && !cs_->TryDropChar('\n')) {
+        cs_->DropCharOrDie();
+      }
+      continue;
+    }
+    switch (cs_->PopCharOrDie()) {
+      case '"':
+        // Braces in strings (e.g. in expressions) don't affect nesting.
+        while (!cs_->AtEof() && cs_->PopCharOrDie() != '"') {
+        }
+        break;
+      case '{':
+        depth++;
+        break;
+      case '}':
+        depth--;
+        break;
+      default:
+        break;
+    }
+  }
+  DropWhitespaceAndComments();
+  return absl::OkStatus();
 }
 
 absl::Status Scanner::PeekInternal() {
@@ -373,11 +473,13 @@ absl::StatusOr<std::unique_ptr<Block>> Parser::ParseBlock(
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(block->entries, ParseEntries());
   if (!kind_allowed) {
-    // Save memory on disallowed blocks by clearing out its entries.
-    block->entries.clear();
+    // Save time and memory on disallowed blocks by not parsing their entries
+    // at all.
+    XLS_RETURN_IF_ERROR(scanner_->SkipBlockBody());
+    return block;
   }
+  XLS_ASSIGN_OR_RETURN(block->entries, ParseEntries());
   return block;
 }
 
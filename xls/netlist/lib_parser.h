@@ -20,7 +20,6 @@
 #ifndef XLS_NETLIST_LIB_PARSER_H_
 #define XLS_NETLIST_LIB_PARSER_H_
 
-#include <fstream>
 #include <string>
 
 #include "absl/container/flat_hash_set.h"
@@ -48,33 +47,28 @@ struct Pos {
 
 // Wraps a file as a character stream with a 1- or 2-character lookahead
 // interface.
+//
+// The characters are always held in one contiguous buffer -- either owned text
+// or a read-only memory mapping of the file -- so that tokens can refer to
+// slices of it rather than copying their contents.
 class CharStream {
  public:
+  // Memory-maps the file at "path". The file's pages are only read in as they
+  // are scanned, so this avoids holding a copy of a (potentially very large)
+  // library in memory.
   static absl::StatusOr<CharStream> FromPath(absl::string_view path);
   static absl::StatusOr<CharStream> FromText(std::string text);
 
-  ~CharStream() {
-    if (if_.has_value()) {
-      if_->close();
-    }
-  }
+  ~CharStream();
 
-  CharStream(CharStream&& other) = default;
+  CharStream(CharStream&& other);
+  CharStream& operator=(CharStream&& other) = delete;
 
   Pos GetPos() const { return pos_; }
-  bool AtEof() const {
-    if (if_.has_value()) {
-      return if_->eof();
-    }
-    return cursor_ >= text_.size();
-  }
+  bool AtEof() const { return cursor_ >= contents_.size(); }
   char PeekCharOrDie() {
-    if (if_.has_value()) {
-      XLS_DCHECK(!if_->eof());
-      return if_->peek();
-    }
-    XLS_DCHECK_LT(cursor_, text_.size());
-    return text_[cursor_];
+    XLS_DCHECK_LT(cursor_, contents_.size());
+    return contents_[cursor_];
   }
   char PopCharOrDie() {
     char c = PeekCharOrDie();
@@ -109,9 +103,18 @@ class CharStream {
     return false;
   }
 
+  // Offset of the next character in the stream.
+  int64_t cursor() const { return cursor_; }
+
+  // Returns the characters in [start, end) -- offsets as given by cursor().
+  // The result is valid for the lifetime of this stream.
+  absl::string_view Slice(int64_t start, int64_t end) const {
+    return contents_.substr(start, end - start);
+  }
+
  private:
-  CharStream(std::ifstream file_stream) : if_(std::move(file_stream)) {}
-  CharStream(std::string text) : text_(std::move(text)) {}
+  CharStream(std::string text);
+  CharStream(const char* mapping, int64_t size);
 
   void Unget(char c) {
     cursor_--;
@@ -121,9 +124,6 @@ class CharStream {
     } else {
       pos_.colno--;
     }
-    if (if_.has_value()) {
-      if_->unget();
-    }
   }
 
   void BumpPos(char c) {
@@ -139,13 +139,14 @@ class CharStream {
 
   Pos pos_ = {0, 0};
 
-  // We have both ifstream mode and text mode data, we store both inline.
+  // Owned text, when created from text.
+  std::string text_;
 
-  // ifstream mode
-  absl::optional<std::ifstream> if_;
+  // The file mapping, when created from a path; nullptr otherwise.
+  const char* mapping_ = nullptr;
 
-  // text mode
-  std::string text_;
+  // All of the characters in the stream: either text_ or the mapping.
+  absl::string_view contents_;
   int64_t cursor_ = 0;
   int64_t last_colno_ = 0;
 };
@@ -166,21 +167,24 @@ enum class TokenKind {
 std::string TokenKindToString(TokenKind kind);
 
 // Represents a token in the file's token stream.
+//
+// Payloads are slices of the CharStream the token was scanned from (and so
+// must not outlive it); they are only copied when the parser keeps them.
 class Token {
  public:
-  static Token Identifier(Pos pos, std::string s) {
+  static Token Identifier(Pos pos, absl::string_view s) {
     return Token(TokenKind::kIdentifier, pos, s);
   }
-  static Token QuotedString(Pos pos, std::string s) {
+  static Token QuotedString(Pos pos, absl::string_view s) {
     return Token(TokenKind::kQuotedString, pos, s);
   }
-  static Token Number(Pos pos, std::string s) {
+  static Token Number(Pos pos, absl::string_view s) {
     return Token(TokenKind::kNumber, pos, s);
   }
   static Token Simple(Pos pos, TokenKind kind) { return Token(kind, pos); }
 
   Token(TokenKind kind, Pos pos,
-        absl::optional<std::string> payload = absl::nullopt)
+        absl::optional<absl::string_view> payload = absl::nullopt)
       : kind_(kind), pos_(pos), payload_(payload) {}
 
   std::string ToString() const {
@@ -192,12 +196,12 @@ class Token {
   TokenKind kind() const { return kind_; }
   const Pos& pos() const { return pos_; }
   absl::string_view payload() const { return payload_.value(); }
-  std::string PopPayload() { return std::move(payload_.value()); }
+  std::string PopPayload() { return std::string(payload_.value()); }
 
  private:
   TokenKind kind_;
   Pos pos_;
-  absl::optional<std::string> payload_;
+  absl::optional<absl::string_view> payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Token& token) {
@@ -228,6 +232,11 @@ class Scanner {
 
   bool AtEof() const { return !lookahead_.has_value() && cs_->AtEof(); }
 
+  // Drops a brace-delimited block body; the next token must be its opening
+  // curl. The body is skipped at the character level (only tracking nesting,
+  // strings and comments) rather than tokenized.
+  absl::Status SkipBlockBody();
+
   Pos GetPos() {
     if (lookahead_.has_value()) {
       return lookahead_.value().pos();
@@ -402,9 +411,9 @@ class Parser {
   Scanner* scanner_;
 
   // Optional allowlist of keys (including block kinds) that we're interested in
-  // keeping in the result data structure. "Denied" (non-allowed) block kinds
-  // are still parsed properly, but then may have incomplete data (or not be
-  // present at all) in the resulting data structure.
+  // keeping in the result data structure. "Denied" (non-allowed) blocks keep
+  // their kind and arguments, but their bodies are skipped without being
+  // parsed, so they have no entries in the resulting data structure.
   //
   // This is very useful for minimizing memory usage when we're interested in
   // just a subset of particular fields, e.g. as part of a query.
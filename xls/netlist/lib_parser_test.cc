@@ -19,6 +19,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 
 namespace xls {
@@ -26,6 +27,9 @@ namespace netlist {
 namespace cell_lib {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
 TEST(LibParserTest, ScanSimple) {
   std::string text = "{}()";
   XLS_ASSERT_OK_AND_ASSIGN(auto cs, CharStream::FromText(text));
@@ -159,6 +163,60 @@ library (foo) {
             "))");
 }
 
+TEST(LibParserTest, AllowlistSkipsBlockBodies) {
+  // The body of a disallowed block is skipped without being scanned into
+  // tokens, so braces in strings and comments must not confuse it.
+  std::string text = R"(
+library (foo) {
+  foo (a, "b") {
+    nested () {
+      expr : "}{";
+    }
+    /* } */
+    // }
+    0 ! this would not scan ~
+  }
+  bar () {
+    bar_key: bar_value;
+  }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Block> library,
+      Parse(text, absl::flat_hash_set<std::string>{"library", "bar"}));
+  EXPECT_EQ(library->ToString(),
+            "(block library (foo) ("
+            "(block foo (a b) ()) "
+            "(block bar () ((bar_key \"bar_value\")))"
+            "))");
+}
+
+TEST(LibParserTest, AllowlistUnterminatedBlock) {
+  std::string text = R"(
+library (foo) {
+  foo () {
+    nested () {
+  }
+)";
+  EXPECT_THAT(Parse(text, absl::flat_hash_set<std::string>{"library"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("end-of-file in block body")));
+}
+
+TEST(LibParserTest, ParseFromPath) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile temp_file,
+      TempFile::CreateWithContent("library (foo) { key: value; }", ".lib"));
+  XLS_ASSERT_OK_AND_ASSIGN(auto cs,
+                           CharStream::FromPath(temp_file.path().string()));
+  Scanner scanner(&cs);
+  Parser parser(&scanner);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Block> library,
+                           parser.ParseLibrary());
+  EXPECT_EQ(library->ToString(),
+            "(block library (foo) ((key \"value\")))");
+}
+
 }  // namespace
 }  // namespace cell_lib
 }  // namespace netlist
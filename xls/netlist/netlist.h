@@ -28,6 +28,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -37,6 +38,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/logging/logging.h"
@@ -476,9 +478,13 @@ class AbstractModule {
   absl::flat_hash_map<AbstractNetRef<EvalT>, AbstractNetRef<EvalT>>
       assign_nets_;
   std::vector<std::unique_ptr<AbstractNetDef<EvalT>>> nets_;
-  absl::flat_hash_map<std::string, AbstractNetRef<EvalT>> name_to_netref_;
+  // The keys of these maps refer to the names held by the (heap-allocated, so
+  // address-stable) nets and cells themselves, so that each name is only
+  // stored once.
+  absl::flat_hash_map<absl::string_view, AbstractNetRef<EvalT>>
+      name_to_netref_;
   std::vector<std::unique_ptr<AbstractCell<EvalT>>> cells_;
-  absl::flat_hash_map<std::string, AbstractCell<EvalT>*> name_to_cell_;
+  absl::flat_hash_map<absl::string_view, AbstractCell<EvalT>*> name_to_cell_;
   AbstractNetRef<EvalT> zero_;
   AbstractNetRef<EvalT> one_;
   AbstractNetRef<EvalT> dummy_;
@@ -523,8 +529,12 @@ class AbstractNetlist {
  private:
   // The AbstractNetlist itself manages the CellLibraryEntries corresponding to
   // the LUT4 cells that are used, which are identified by their LUT mask (i.e.
-  // the 16 bit LUT_INIT parameter).
-  absl::flat_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_;
+  // the 16 bit LUT_INIT parameter). Entries are handed out by pointer (so the
+  // map must be pointer-stable) and may be created by concurrently-parsed
+  // modules.
+  absl::Mutex lut_cells_mutex_;
+  absl::node_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_
+      ABSL_GUARDED_BY(lut_cells_mutex_);
   std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules_;
 };
 
@@ -603,7 +613,7 @@ absl::StatusOr<AbstractCell<EvalT>*> AbstractModule<EvalT>::AddCell(
 
   cells_.push_back(std::make_unique<AbstractCell<EvalT>>(cell));
   auto cell_ptr = cells_.back().get();
-  name_to_cell_[cell.name()] = cell_ptr;
+  name_to_cell_[cell_ptr->name()] = cell_ptr;
   return cell_ptr;
 }
 
@@ -622,7 +632,7 @@ absl::Status AbstractModule<EvalT>::AddNetDecl(NetDeclKind kind,
 
   nets_.emplace_back(std::make_unique<AbstractNetDef<EvalT>>(name, kind));
   AbstractNetRef<EvalT> ref = nets_.back().get();
-  name_to_netref_[name] = ref;
+  name_to_netref_[ref->name()] = ref;
   switch (kind) {
     case NetDeclKind::kInput:
       input_nets_.push_back(ref);
@@ -862,6 +872,7 @@ AbstractNetlist<EvalT>::GetOrCreateLut4CellEntry(int64_t lut_mask, EvalT zero,
     return absl::InvalidArgumentError("Mask for LUT4 must be 16 bits");
   }
   uint16_t mask = static_cast<uint16_t>(lut_mask);
+  absl::MutexLock lock(&lut_cells_mutex_);
   auto it = lut_cells_.find(mask);
   if (it == lut_cells_.end()) {
     AbstractCellLibraryEntry<EvalT> entry(
@@ -14,9 +14,12 @@
 
 #include "xls/netlist/netlist_parser.h"
 
+#include <algorithm>
+#include <functional>
 #include <tuple>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
@@ -297,6 +300,163 @@ absl::StatusOr<Token> Scanner::PeekInternal() {
   }
 }
 
+namespace {
+
+bool IsWhitespace(char c) { return c == ' ' || c == '\n' || c == '\t'; }
+
+bool IsNameChar(char c) { return absl::ascii_isalnum(c) || c == '_'; }
+
+// A module found by SplitModules, along with the first name in each of its
+// statements -- a superset of the names of the cells and modules it
+// instantiates.
+struct FoundModule {
+  ModuleText text;
+  absl::flat_hash_set<absl::string_view> statement_heads;
+};
+
+// Finds the module definitions in "text".
+absl::StatusOr<std::vector<FoundModule>> FindModules(absl::string_view text) {
+  std::vector<FoundModule> modules;
+  // Position tracking: the line number of "line_index" in the text.
+  int64_t lineno = 0;
+  size_t line_index = 0;
+  auto pos_of = [&](size_t index) {
+    lineno += std::count(text.begin() + line_index, text.begin() + index, '\n');
+    line_index = index;
+    size_t line_start = text.rfind('\n', index);
+    int64_t colno =
+        line_start == absl::string_view::npos ? index : index - line_start - 1;
+    return Pos{lineno, colno};
+  };
+
+  bool in_module = false;
+  bool expect_name = false;
+  bool at_statement_start = false;
+  size_t module_start = 0;
+  size_t i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    char next = i + 1 < text.size() ? text[i + 1] : '\0';
+    // Comments and attributes are dropped, as by the Scanner.
+    if (c == '/' && next == '/') {
+      i = text.find('\n', i);
+      continue;
+    }
+    if ((c == '/' && next == '*') || (c == '(' && next == '*')) {
+      size_t end = text.find(c == '/' ? "*/" : "*)", i + 2);
+      i = end == absl::string_view::npos ? end : end + 2;
+      continue;
+    }
+    if (IsWhitespace(c)) {
+      ++i;
+      continue;
+    }
+    if (c == '\\' || IsNameChar(c)) {
+      size_t start = i++;
+      while (i < text.size() &&
+             (c == '\\' ? !IsWhitespace(text[i]) : IsNameChar(text[i]))) {
+        ++i;
+      }
+      absl::string_view word = text.substr(start, i - start);
+      if (!in_module) {
+        if (word != "module") {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Expected module definition @ %s; got \"%s\"",
+                              pos_of(start).ToHumanString(), word));
+        }
+        in_module = true;
+        expect_name = true;
+        module_start = start;
+        FoundModule module;
+        module.text.index = modules.size();
+        module.text.pos = pos_of(start);
+        modules.push_back(std::move(module));
+      } else if (expect_name) {
+        modules.back().text.name = word;
+        expect_name = false;
+      } else if (at_statement_start) {
+        at_statement_start = false;
+        if (word == "endmodule") {
+          modules.back().text.text =
+              text.substr(module_start, i - module_start);
+          in_module = false;
+        } else {
+          modules.back().statement_heads.insert(word);
+        }
+      }
+      continue;
+    }
+    if (!in_module || expect_name) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unexpected character '%c' @ %s outside of a module",
+                          c, pos_of(i).ToHumanString()));
+    }
+    at_statement_start = c == ';';
+    ++i;
+  }
+  if (in_module) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Module %s has no endmodule", modules.back().text.name));
+  }
+  return modules;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<std::vector<ModuleText>>> SplitModules(
+    absl::string_view text) {
+  XLS_ASSIGN_OR_RETURN(std::vector<FoundModule> modules, FindModules(text));
+
+  absl::flat_hash_map<absl::string_view, int64_t> index_by_name;
+  for (const FoundModule& module : modules) {
+    if (!index_by_name.emplace(module.text.name, module.text.index).second) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Duplicate definition of module %s @ %s",
+                          module.text.name, module.text.pos.ToHumanString()));
+    }
+  }
+
+  // The wave of a module is one more than the latest wave of the modules it
+  // instantiates; computed depth-first, with -1 marking modules in progress.
+  constexpr int64_t kUnvisited = -2;
+  constexpr int64_t kInProgress = -1;
+  std::vector<int64_t> wave_of(modules.size(), kUnvisited);
+  std::function<absl::Status(int64_t)> visit =
+      [&](int64_t index) -> absl::Status {
+    if (wave_of[index] == kInProgress) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Module %s instantiates itself", modules[index].text.name));
+    }
+    if (wave_of[index] != kUnvisited) {
+      return absl::OkStatus();
+    }
+    wave_of[index] = kInProgress;
+    int64_t wave = 0;
+    for (absl::string_view head : modules[index].statement_heads) {
+      auto it = index_by_name.find(head);
+      if (it == index_by_name.end()) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(visit(it->second));
+      wave = std::max(wave, wave_of[it->second] + 1);
+    }
+    wave_of[index] = wave;
+    return absl::OkStatus();
+  };
+
+  std::vector<std::vector<ModuleText>> waves;
+  for (int64_t i = 0; i < modules.size(); ++i) {
+    XLS_RETURN_IF_ERROR(visit(i));
+    if (waves.size() <= wave_of[i]) {
+      waves.resize(wave_of[i] + 1);
+    }
+  }
+  for (int64_t i = 0; i < modules.size(); ++i) {
+    waves[wave_of[i]].push_back(modules[i].text);
+  }
+  return waves;
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
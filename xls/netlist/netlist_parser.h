@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -30,6 +31,7 @@
 #include "absl/strings/substitute.h"
 #include "absl/types/variant.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/parallel_for.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/string_to_int.h"
@@ -83,7 +85,10 @@ struct Token {
 // Token scanner for netlist files.
 class Scanner {
  public:
-  explicit Scanner(absl::string_view text) : text_(text) {}
+  // "start" is the position of the beginning of "text" in the file, for when
+  // "text" is only part of it (e.g. a single module).
+  explicit Scanner(absl::string_view text, Pos start = Pos{0, 0})
+      : text_(text), lineno_(start.lineno), colno_(start.colno) {}
 
   absl::StatusOr<Token> Peek();
 
@@ -125,6 +130,29 @@ class Scanner {
   absl::optional<Token> lookahead_;
 };
 
+// The text of a single module definition in a netlist, as found by
+// SplitModules.
+struct ModuleText {
+  // Position of the module in the file: 0 for the first module, and so on.
+  int64_t index;
+  absl::string_view name;
+  // From the "module" keyword through "endmodule".
+  absl::string_view text;
+  // Position of the start of "text" in the file.
+  Pos pos;
+};
+
+// Splits netlist text at its module/endmodule boundaries without tokenizing the
+// module bodies, and groups the modules into waves such that every module
+// instantiated by a module in one wave is in an earlier wave -- so the modules
+// within a wave can be parsed independently of each other. The results refer
+// to "text".
+//
+// Returns an error if the text is not a sequence of uniquely-named modules, or
+// if modules (transitively) instantiate themselves.
+absl::StatusOr<std::vector<std::vector<ModuleText>>> SplitModules(
+    absl::string_view text);
+
 template <typename EvalT = bool>
 class AbstractParser {
  public:
@@ -139,6 +167,23 @@ class AbstractParser {
     return ParseNetlist(cell_library, scanner, EvalT{false}, EvalT{true});
   }
 
+  // As ParseNetlist, but splits the text into modules (see SplitModules) and
+  // parses the modules of each wave concurrently, using up to "num_threads"
+  // threads (0 means one per hardware thread). The resulting netlist is the
+  // same as ParseNetlist's, except that a module may also instantiate modules
+  // defined after it in the file.
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       absl::string_view text, int64_t num_threads, EvalT zero,
+                       EvalT one);
+  template <typename = std::is_constructible<EvalT, bool>>
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       absl::string_view text, int64_t num_threads = 0) {
+    return ParseNetlistParallel(cell_library, text, num_threads, EvalT{false},
+                                EvalT{true});
+  }
+
  private:
   explicit AbstractParser(AbstractCellLibrary<EvalT>* cell_library,
                           Scanner* scanner, EvalT zero, EvalT one)
@@ -284,6 +329,12 @@ class AbstractParser {
   // Scanner used for scanning out tokens (in a stream sequence).
   Scanner* scanner_;
 
+  // When parsing modules in parallel, the modules parsed so far, by name. These
+  // are looked up here rather than in the netlist, which is only populated
+  // once all modules have been parsed.
+  const absl::flat_hash_map<absl::string_view, const AbstractModule<EvalT>*>*
+      parsed_modules_ = nullptr;
+
   // Values representing zero/false and one/true in the EvalT type.
   EvalT zero_;
   EvalT one_;
@@ -427,9 +478,16 @@ template <typename EvalT>
 absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
 AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
   XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
-  auto maybe_module = netlist.MaybeGetModule(name);
-  if (maybe_module.has_value()) {
-    return maybe_module.value()->AsCellLibraryEntry();
+  if (parsed_modules_ != nullptr) {
+    auto it = parsed_modules_->find(name);
+    if (it != parsed_modules_->end()) {
+      return it->second->AsCellLibraryEntry();
+    }
+  } else {
+    auto maybe_module = netlist.MaybeGetModule(name);
+    if (maybe_module.has_value()) {
+      return maybe_module.value()->AsCellLibraryEntry();
+    }
   }
   if (name == "SB_LUT4") {
     XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kStartParams));
@@ -786,6 +844,60 @@ AbstractParser<EvalT>::ParseNetlist(AbstractCellLibrary<EvalT>* cell_library,
   return std::move(netlist);
 }
 
+template <typename EvalT>
+absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+AbstractParser<EvalT>::ParseNetlistParallel(
+    AbstractCellLibrary<EvalT>* cell_library, absl::string_view text,
+    int64_t num_threads, EvalT zero, EvalT one) {
+  absl::StatusOr<std::vector<std::vector<ModuleText>>> waves =
+      SplitModules(text);
+  if (!waves.ok()) {
+    // Leave it to the sequential parser to diagnose (or, for forms the split
+    // doesn't understand, accept) the text.
+    XLS_VLOG(1) << "Parsing netlist sequentially: " << waves.status();
+    Scanner scanner(text);
+    return ParseNetlist(cell_library, &scanner, zero, one);
+  }
+
+  auto netlist = std::make_unique<AbstractNetlist<EvalT>>();
+  int64_t module_count = 0;
+  for (const std::vector<ModuleText>& wave : *waves) {
+    module_count += wave.size();
+  }
+  std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules(module_count);
+  absl::flat_hash_map<absl::string_view, const AbstractModule<EvalT>*>
+      parsed_modules;
+  for (const std::vector<ModuleText>& wave : *waves) {
+    std::vector<absl::Status> statuses(wave.size());
+    ParallelFor(wave.size(), num_threads, [&](int64_t i) {
+      Scanner scanner(wave[i].text, wave[i].pos);
+      AbstractParser<EvalT> p(cell_library, &scanner, zero, one);
+      p.parsed_modules_ = &parsed_modules;
+      absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> module =
+          p.ParseModule(*netlist);
+      if (module.ok()) {
+        modules[wave[i].index] = std::move(module).value();
+      } else {
+        statuses[i] = module.status();
+      }
+    });
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+    for (const ModuleText& module_text : wave) {
+      const AbstractModule<EvalT>* module = modules[module_text.index].get();
+      // The cell library entry is created lazily, so create it before modules
+      // in later waves can look it up concurrently.
+      module->AsCellLibraryEntry();
+      parsed_modules[module_text.name] = module;
+    }
+  }
+  for (std::unique_ptr<AbstractModule<EvalT>>& module : modules) {
+    netlist->AddModule(std::move(module));
+  }
+  return std::move(netlist);
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
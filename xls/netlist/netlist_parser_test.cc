@@ -22,6 +22,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
 #include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/fake_cell_library.h"
@@ -32,6 +33,7 @@ namespace rtl {
 namespace {
 
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 TEST(NetlistParserTest, EmptyModule) {
@@ -441,6 +443,125 @@ endmodule)";
   TestAssignHelper(m);
 }
 
+// A hierarchical netlist: "top" instantiates "mid" (defined after it) and
+// "leaf_b", and "mid" instantiates "leaf_a".
+constexpr const char kHierarchicalNetlist[] = R"(// module not_a_module();
+module leaf_a(a, o);
+  input a;
+  output o;
+  /* endmodule */
+  INV inv0(.A(a), .ZN(o));
+endmodule
+
+(* attr = "endmodule" *)
+module leaf_b(a, b, o);
+  input a, b;
+  output o;
+  AND and0(.A(a), .B(b), .Z(o));
+endmodule
+
+module top(a, b, o);
+  input a, b;
+  output o;
+  wire m;
+  mid mid0(.a(a), .o(m));
+  leaf_b leaf0(.a(m), .b(b), .o(o));
+endmodule
+
+module mid(a, o);
+  input a;
+  output o;
+  wire w;
+  leaf_a leaf0(.a(a), .o(w));
+  SB_LUT4 #(.LUT_INIT(16'h8000)) lut0(.I0(w), .I1(w), .I2(w), .I3(w), .O(o));
+endmodule
+)";
+
+TEST(NetlistParserTest, SplitModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<ModuleText>> waves,
+                           SplitModules(kHierarchicalNetlist));
+  std::vector<std::vector<std::string>> wave_names;
+  for (const std::vector<ModuleText>& wave : waves) {
+    wave_names.emplace_back();
+    for (const ModuleText& module : wave) {
+      wave_names.back().push_back(std::string(module.name));
+    }
+  }
+  EXPECT_THAT(wave_names,
+              ElementsAre(ElementsAre("leaf_a", "leaf_b"), ElementsAre("mid"),
+                          ElementsAre("top")));
+
+  const ModuleText& leaf_b = waves[0][1];
+  EXPECT_EQ(leaf_b.index, 1);
+  EXPECT_EQ(leaf_b.pos.ToHumanString(), "10:1");
+  EXPECT_TRUE(absl::StartsWith(leaf_b.text, "module leaf_b("));
+  EXPECT_TRUE(absl::EndsWith(leaf_b.text, "endmodule"));
+}
+
+TEST(NetlistParserTest, SplitModulesErrors) {
+  EXPECT_THAT(SplitModules("module a(); endmodule module a(); endmodule"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Duplicate definition of module a")));
+  EXPECT_THAT(
+      SplitModules("module a(); b b0(); endmodule module b(); a a0(); "
+                   "endmodule"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("instantiates itself")));
+  EXPECT_THAT(SplitModules("module a(); INV i0();"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("no endmodule")));
+  EXPECT_THAT(SplitModules("wire a; module a(); endmodule"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected module definition @ 1:1")));
+}
+
+TEST(NetlistParserTest, ParseNetlistParallel) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlistParallel(
+                               &cell_library, kHierarchicalNetlist,
+                               /*num_threads=*/4));
+  std::vector<std::string> module_names;
+  for (const std::unique_ptr<Module>& module : n->modules()) {
+    module_names.push_back(module->name());
+  }
+  EXPECT_THAT(module_names, ElementsAre("leaf_a", "leaf_b", "top", "mid"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* top, n->GetModule("top"));
+  XLS_ASSERT_OK_AND_ASSIGN(Cell * mid0, top->ResolveCell("mid0"));
+  EXPECT_EQ(mid0->cell_library_entry()->name(), "mid");
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef m, top->ResolveNet("m"));
+  EXPECT_EQ(m->connected_cells().size(), 2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* mid, n->GetModule("mid"));
+  XLS_ASSERT_OK_AND_ASSIGN(Cell * lut0, mid->ResolveCell("lut0"));
+  EXPECT_EQ(lut0->cell_library_entry()->name(), "<lut_0x8000>");
+}
+
+TEST(NetlistParserTest, ParseNetlistParallelErrorPosition) {
+  std::string netlist = R"(module a(i, o);
+  input i;
+  output o;
+  INV inv0(.A(i), .ZN(o));
+endmodule
+module b(i, o);
+  input i;
+  output o;
+  INV c0(.A(i) .ZN(o));
+endmodule
+)";
+  // Positions in errors are relative to the file, not the module.
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  EXPECT_THAT(Parser::ParseNetlistParallel(&cell_library, netlist),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("got Token{dot, @9:16}")));
+
+  // Text the split doesn't handle is left to the sequential parser.
+  EXPECT_THAT(Parser::ParseNetlistParallel(&cell_library, "module a(); INV;"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected name token")));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
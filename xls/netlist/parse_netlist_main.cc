@@ -15,6 +15,8 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
@@ -23,6 +25,9 @@
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(bool, show_clusters, false, "Show the logic clusters found.");
+ABSL_FLAG(int64_t, num_threads, 0,
+          "Number of threads to parse the netlist's modules with; 0 means one "
+          "per hardware thread.");
 
 namespace xls {
 namespace {
@@ -39,10 +44,17 @@ absl::Status RealMain(absl::string_view netlist_path,
   }
 
   XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<netlist::rtl::Netlist> netlist,
-      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<netlist::rtl::Netlist> netlist,
+                       netlist::rtl::Parser::ParseNetlistParallel(
+                           &cell_library, netlist_text,
+                           absl::GetFlag(FLAGS_num_threads)));
+  absl::Duration elapsed = absl::Now() - start;
+  std::cout << absl::StreamFormat(
+                   "parsed %.1f MB in %s (%.1f MB/s)",
+                   netlist_text.size() / 1e6, absl::FormatDuration(elapsed),
+                   netlist_text.size() / 1e6 / absl::ToDoubleSeconds(elapsed))
+            << std::endl;
   netlist::rtl::Module* module = netlist->modules()[0].get();
   std::cout << "nets:  " << module->nets().size() << std::endl;
   std::cout << "cells: " << module->cells().size() << std::endl;
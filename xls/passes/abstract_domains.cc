@@ -0,0 +1,257 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/abstract_domains.h"
+
+#include "absl/types/optional.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/abstract_node_evaluator.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/interval.h"
+#include "xls/ir/nodes.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_evaluator.h"
+
+namespace xls {
+
+TernaryVector TernaryDomain::Join(const TernaryVector& a,
+                                  const TernaryVector& b) const {
+  XLS_CHECK_EQ(a.size(), b.size());
+  TernaryVector result(a.size());
+  for (int64_t i = 0; i < a.size(); ++i) {
+    result[i] = a[i] == b[i] ? a[i] : TernaryValue::kUnknown;
+  }
+  return result;
+}
+
+absl::StatusOr<TernaryVector> TernaryDomain::Transfer(
+    Node* node, absl::Span<const TernaryVector> operands) const {
+  auto unknown = [](Node* n) {
+    return TernaryVector(n->BitCountOrDie(), TernaryValue::kUnknown);
+  };
+  // Wide shifts are quadratic in the width of the operand in the abstract
+  // evaluator. Use the same limit as TernaryQueryEngine.
+  if ((node->op() == Op::kShrl || node->op() == Op::kShra ||
+       node->op() == Op::kShll) &&
+      node->GetType()->GetFlatBitCount() > 256) {
+    return unknown(node);
+  }
+  TernaryEvaluator evaluator;
+  return AbstractEvaluate(node, operands, &evaluator,
+                          /*default_handler=*/unknown);
+}
+
+namespace {
+
+// Returns the sum (or difference) of the two intervals, or absl::nullopt if
+// the result wraps around for some but not all values in the intervals, in
+// which case the result is not representable as a single interval.
+absl::optional<Interval> AddIntervals(const Interval& a, const Interval& b) {
+  int64_t width = a.BitCount();
+  Bits lower = bits_ops::Add(bits_ops::ZeroExtend(a.LowerBound(), width + 1),
+                             bits_ops::ZeroExtend(b.LowerBound(), width + 1));
+  Bits upper = bits_ops::Add(bits_ops::ZeroExtend(a.UpperBound(), width + 1),
+                             bits_ops::ZeroExtend(b.UpperBound(), width + 1));
+  bool lower_wraps = lower.msb();
+  bool upper_wraps = upper.msb();
+  if (lower_wraps != upper_wraps) {
+    return absl::nullopt;
+  }
+  return Interval(lower.Slice(0, width), upper.Slice(0, width));
+}
+
+absl::optional<Interval> SubIntervals(const Interval& a, const Interval& b) {
+  bool lower_wraps = bits_ops::ULessThan(a.LowerBound(), b.UpperBound());
+  bool upper_wraps = bits_ops::ULessThan(a.UpperBound(), b.LowerBound());
+  if (lower_wraps != upper_wraps) {
+    return absl::nullopt;
+  }
+  return Interval(bits_ops::Sub(a.LowerBound(), b.UpperBound()),
+                  bits_ops::Sub(a.UpperBound(), b.LowerBound()));
+}
+
+// Applies the given interval operation to every pair of intervals in 'lhs' and
+// 'rhs' and returns the union of the results.
+IntervalSet PairwiseIntervalOp(
+    const IntervalSet& lhs, const IntervalSet& rhs,
+    absl::optional<Interval> (*op)(const Interval&, const Interval&)) {
+  IntervalSet result(lhs.BitCount());
+  for (const Interval& a : lhs.Intervals()) {
+    for (const Interval& b : rhs.Intervals()) {
+      absl::optional<Interval> interval = op(a, b);
+      if (!interval.has_value()) {
+        return IntervalSet::Maximal(lhs.BitCount());
+      }
+      result.AddInterval(*interval);
+    }
+  }
+  result.Normalize();
+  return result;
+}
+
+IntervalSet BoolInterval(absl::optional<bool> value) {
+  if (!value.has_value()) {
+    return IntervalSet::Maximal(1);
+  }
+  return IntervalSet::Precise(UBits(*value ? 1 : 0, 1));
+}
+
+// Returns the value of 'lhs < rhs' (or 'lhs <= rhs' if 'or_equal' is true) if
+// it is the same for all values in the sets.
+absl::optional<bool> ULessThan(const IntervalSet& lhs, const IntervalSet& rhs,
+                               bool or_equal) {
+  absl::optional<Interval> lhs_hull = lhs.ConvexHull();
+  absl::optional<Interval> rhs_hull = rhs.ConvexHull();
+  if (!lhs_hull.has_value() || !rhs_hull.has_value()) {
+    return absl::nullopt;
+  }
+  auto less = [&](const Bits& a, const Bits& b) {
+    return or_equal ? bits_ops::ULessThanOrEqual(a, b)
+                    : bits_ops::ULessThan(a, b);
+  };
+  if (less(lhs_hull->UpperBound(), rhs_hull->LowerBound())) {
+    return true;
+  }
+  if (!less(lhs_hull->LowerBound(), rhs_hull->UpperBound())) {
+    return false;
+  }
+  return absl::nullopt;
+}
+
+absl::optional<bool> Equals(const IntervalSet& lhs, const IntervalSet& rhs) {
+  if (lhs.IsPrecise() && rhs.IsPrecise()) {
+    return lhs.GetPreciseValue().value() == rhs.GetPreciseValue().value();
+  }
+  if (IntervalSet::Intersect(lhs, rhs).IsEmpty()) {
+    return false;
+  }
+  return absl::nullopt;
+}
+
+absl::optional<bool> Not(absl::optional<bool> value) {
+  if (!value.has_value()) {
+    return absl::nullopt;
+  }
+  return !*value;
+}
+
+}  // namespace
+
+IntervalSet IntervalDomain::Join(const IntervalSet& a,
+                                 const IntervalSet& b) const {
+  if (a == b) {
+    return a;
+  }
+  return MinimizeIntervals(IntervalSet::Combine(a, b), max_interval_count_);
+}
+
+IntervalSet IntervalDomain::Widen(const IntervalSet& previous,
+                                  const IntervalSet& next) const {
+  if (previous == next) {
+    return next;
+  }
+  absl::optional<Interval> previous_hull = previous.ConvexHull();
+  absl::optional<Interval> next_hull = next.ConvexHull();
+  if (!previous_hull.has_value() || !next_hull.has_value()) {
+    return next;
+  }
+  int64_t width = next.BitCount();
+  Bits lower = bits_ops::ULessThan(next_hull->LowerBound(),
+                                   previous_hull->LowerBound())
+                   ? Bits(width)
+                   : next_hull->LowerBound();
+  Bits upper = bits_ops::UGreaterThan(next_hull->UpperBound(),
+                                      previous_hull->UpperBound())
+                   ? Bits::AllOnes(width)
+                   : next_hull->UpperBound();
+  IntervalSet result(width);
+  result.AddInterval(Interval(lower, upper));
+  result.Normalize();
+  return result;
+}
+
+absl::StatusOr<IntervalSet> IntervalDomain::Transfer(
+    Node* node, absl::Span<const IntervalSet> operands) const {
+  int64_t width = node->BitCountOrDie();
+  switch (node->op()) {
+    case Op::kIdentity:
+      return operands[0];
+    case Op::kAdd:
+      return MinimizeIntervals(
+          PairwiseIntervalOp(operands[0], operands[1], AddIntervals),
+          max_interval_count_);
+    case Op::kSub:
+      return MinimizeIntervals(
+          PairwiseIntervalOp(operands[0], operands[1], SubIntervals),
+          max_interval_count_);
+    case Op::kZeroExt:
+      return operands[0].ZeroExtend(width);
+    case Op::kBitSlice: {
+      // A slice of the low bits preserves intervals whose values fit in the
+      // slice width.
+      const IntervalSet& operand = operands[0];
+      absl::optional<Interval> hull = operand.ConvexHull();
+      if (node->As<BitSlice>()->start() == 0 && hull.has_value() &&
+          hull->UpperBound()
+              .Slice(width, operand.BitCount() - width)
+              .IsZero()) {
+        IntervalSet result(width);
+        for (const Interval& interval : operand.Intervals()) {
+          result.AddInterval(Interval(interval.LowerBound().Slice(0, width),
+                                      interval.UpperBound().Slice(0, width)));
+        }
+        result.Normalize();
+        return result;
+      }
+      return IntervalSet::Maximal(width);
+    }
+    case Op::kSel: {
+      Select* sel = node->As<Select>();
+      const IntervalSet& selector = operands[0];
+      if (selector.IsPrecise()) {
+        const Bits& index = selector.GetPreciseValue().value();
+        if (bits_ops::ULessThan(index, sel->cases().size())) {
+          return operands[1 + index.ToUint64().value()];
+        }
+        return operands.back();
+      }
+      IntervalSet result = operands[1];
+      for (const IntervalSet& choice : operands.subspan(2)) {
+        result = Join(result, choice);
+      }
+      return result;
+    }
+    case Op::kULt:
+      return BoolInterval(
+          ULessThan(operands[0], operands[1], /*or_equal=*/false));
+    case Op::kULe:
+      return BoolInterval(
+          ULessThan(operands[0], operands[1], /*or_equal=*/true));
+    case Op::kUGt:
+      return BoolInterval(
+          ULessThan(operands[1], operands[0], /*or_equal=*/false));
+    case Op::kUGe:
+      return BoolInterval(
+          ULessThan(operands[1], operands[0], /*or_equal=*/true));
+    case Op::kEq:
+      return BoolInterval(Equals(operands[0], operands[1]));
+    case Op::kNe:
+      return BoolInterval(Not(Equals(operands[0], operands[1])));
+    default:
+      return IntervalSet::Maximal(width);
+  }
+}
+
+}  // namespace xls
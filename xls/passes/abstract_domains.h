@@ -0,0 +1,77 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_ABSTRACT_DOMAINS_H_
+#define XLS_PASSES_ABSTRACT_DOMAINS_H_
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/interval_set.h"
+#include "xls/ir/node.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+
+// Lattice domains for use with AbstractInterpreter (abstract_interpreter.h).
+
+// Domain of ternary vectors: each bit is known zero, known one, or unknown.
+// The lattice has finite height so no widening is required.
+class TernaryDomain {
+ public:
+  using Element = TernaryVector;
+
+  Element Top(int64_t bit_count) const {
+    return TernaryVector(bit_count, TernaryValue::kUnknown);
+  }
+  Element FromBits(const Bits& bits) const {
+    return ternary_ops::BitsToTernary(bits);
+  }
+  Element Join(const Element& a, const Element& b) const;
+  Element Widen(const Element& previous, const Element& next) const {
+    return next;
+  }
+  absl::StatusOr<Element> Transfer(Node* node,
+                                   absl::Span<const Element> operands) const;
+};
+
+// Domain of sets of unsigned intervals. The number of intervals in each
+// element is bounded by 'max_interval_count'; joins which exceed the bound
+// merge the intervals separated by the smallest gaps. Widening replaces a
+// growing bound with the extreme value of the type (zero or all ones).
+class IntervalDomain {
+ public:
+  using Element = IntervalSet;
+
+  explicit IntervalDomain(int64_t max_interval_count = 16)
+      : max_interval_count_(max_interval_count) {}
+
+  Element Top(int64_t bit_count) const {
+    return IntervalSet::Maximal(bit_count);
+  }
+  Element FromBits(const Bits& bits) const {
+    return IntervalSet::Precise(bits);
+  }
+  Element Join(const Element& a, const Element& b) const;
+  Element Widen(const Element& previous, const Element& next) const;
+  absl::StatusOr<Element> Transfer(Node* node,
+                                   absl::Span<const Element> operands) const;
+
+ private:
+  int64_t max_interval_count_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_ABSTRACT_DOMAINS_H_
@@ -0,0 +1,68 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/abstract_interpretation_query_engine.h"
+
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+absl::StatusOr<ReachedFixpoint> AbstractInterpretationQueryEngine::Populate(
+    FunctionBase* f) {
+  XLS_RETURN_IF_ERROR(ternary_.Run(f));
+  XLS_RETURN_IF_ERROR(intervals_.Run(f));
+  return ReachedFixpoint::Unknown;
+}
+
+LeafTypeTree<IntervalSet> AbstractInterpretationQueryEngine::GetIntervals(
+    Node* node) const {
+  // Intersect the interval analysis with the intervals implied by the known
+  // bits as neither domain subsumes the other.
+  return LeafTypeTree<IntervalSet>::Zip<IntervalSet, IntervalSet>(
+      IntervalSet::Intersect, QueryEngine::GetIntervals(node),
+      intervals_.GetValue(node));
+}
+
+bool AbstractInterpretationQueryEngine::AtMostOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  int64_t maybe_one_count = 0;
+  for (const TreeBitLocation& location : bits) {
+    if (!IsKnown(location) || IsOne(location)) {
+      maybe_one_count++;
+    }
+  }
+  return maybe_one_count <= 1;
+}
+
+bool AbstractInterpretationQueryEngine::AtLeastOneTrue(
+    absl::Span<TreeBitLocation const> bits) const {
+  for (const TreeBitLocation& location : bits) {
+    if (IsOne(location)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AbstractInterpretationQueryEngine::KnownEquals(
+    const TreeBitLocation& a, const TreeBitLocation& b) const {
+  return IsKnown(a) && IsKnown(b) && IsOne(a) == IsOne(b);
+}
+
+bool AbstractInterpretationQueryEngine::KnownNotEquals(
+    const TreeBitLocation& a, const TreeBitLocation& b) const {
+  return IsKnown(a) && IsKnown(b) && IsOne(a) != IsOne(b);
+}
+
+}  // namespace xls
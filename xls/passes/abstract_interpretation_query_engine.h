@@ -0,0 +1,76 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_ABSTRACT_INTERPRETATION_QUERY_ENGINE_H_
+#define XLS_PASSES_ABSTRACT_INTERPRETATION_QUERY_ENGINE_H_
+
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/passes/abstract_domains.h"
+#include "xls/passes/abstract_interpreter.h"
+#include "xls/passes/query_engine.h"
+
+namespace xls {
+
+// A query engine backed by abstract interpretation in the ternary and interval
+// domains (see abstract_interpreter.h). Unlike TernaryQueryEngine and
+// RangeQueryEngine, values flow through tuples and, for procs, through the
+// state feedback loop: facts about the proc state hold across all iterations
+// of the proc rather than treating the state parameter as unknown.
+class AbstractInterpretationQueryEngine : public QueryEngine {
+ public:
+  AbstractInterpretationQueryEngine() {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
+
+  bool IsTracked(Node* node) const override {
+    return ternary_.IsTracked(node);
+  }
+
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
+    return ternary_.GetValue(node);
+  }
+
+  LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override;
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override;
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override;
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override;
+
+  // Neither domain tracks relationships between bits.
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return false;
+  }
+
+  absl::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return absl::nullopt;
+  }
+
+ private:
+  AbstractInterpreter<TernaryDomain> ternary_;
+  AbstractInterpreter<IntervalDomain> intervals_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_ABSTRACT_INTERPRETATION_QUERY_ENGINE_H_
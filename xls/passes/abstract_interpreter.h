@@ -0,0 +1,298 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_ABSTRACT_INTERPRETER_H_
+#define XLS_PASSES_ABSTRACT_INTERPRETER_H_
+
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+
+// A generic abstract interpreter over XLS IR. The interpreter computes an
+// abstract value for every node in a function or proc by iterating transfer
+// functions of a lattice domain to a fixpoint. Aggregate types are handled by
+// the interpreter itself: the abstract value of a node is a LeafTypeTree of
+// domain elements, one per leaf of the node's type, and tuple construction,
+// tuple indexing and selects of aggregates are interpreted structurally.
+//
+// For procs the state parameter is seeded with the abstraction of the initial
+// value and the abstract value of the next-state node is joined back into the
+// state after each iteration until the state stops changing. After
+// 'widening_delay' iterations the domain's widening operator is applied to
+// guarantee termination for domains of unbounded height (e.g., intervals). The
+// resulting abstract values hold for every activation of the proc.
+//
+// DomainT must provide:
+//
+//   // The abstract value of a single bits-typed (or token) leaf.
+//   using Element = ...;
+//
+//   // The least precise element (no information) of the given width.
+//   Element Top(int64_t bit_count) const;
+//
+//   // The abstraction of the given concrete value.
+//   Element FromBits(const Bits& bits) const;
+//
+//   // The least upper bound of the two elements.
+//   Element Join(const Element& a, const Element& b) const;
+//
+//   // Widening operator applied to the proc state once the widening delay is
+//   // exceeded. 'next' is always at least as large as 'previous'. Domains of
+//   // finite height may simply return 'next'.
+//   Element Widen(const Element& previous, const Element& next) const;
+//
+//   // Transfer function for a bits-typed node with bits-typed operands.
+//   absl::StatusOr<Element> Transfer(Node* node,
+//                                    absl::Span<const Element> operands) const;
+//
+// Element must be copyable and equality comparable.
+template <typename DomainT>
+class AbstractInterpreter {
+ public:
+  using Element = typename DomainT::Element;
+  using ElementTree = LeafTypeTree<Element>;
+
+  struct Options {
+    // Number of proc iterations performed before widening the state.
+    int64_t widening_delay = 8;
+
+    // Maximum number of proc iterations. If no fixpoint is reached within this
+    // limit the state is conservatively set to top.
+    int64_t max_iterations = 64;
+  };
+
+  explicit AbstractInterpreter(DomainT domain = DomainT(),
+                               Options options = Options())
+      : domain_(std::move(domain)), options_(options) {}
+
+  // Computes abstract values for every node in 'f'. May be called multiple
+  // times; each invocation discards the results of the previous one.
+  absl::Status Run(FunctionBase* f);
+
+  bool IsTracked(Node* node) const { return values_.contains(node); }
+
+  // Returns the abstract value of the given node. The node must be tracked.
+  const ElementTree& GetValue(Node* node) const { return values_.at(node); }
+
+  // Returns the number of iterations over the proc state required to reach a
+  // fixpoint (one for functions).
+  int64_t iteration_count() const { return iteration_count_; }
+
+  // Returns whether the widening operator was applied to the proc state.
+  bool widened() const { return widened_; }
+
+  const DomainT& domain() const { return domain_; }
+
+ private:
+  ElementTree Top(Type* type) const {
+    ElementTree tree(type);
+    for (int64_t i = 0; i < tree.size(); ++i) {
+      tree.elements()[i] =
+          domain_.Top(tree.leaf_types()[i]->GetFlatBitCount());
+    }
+    return tree;
+  }
+
+  absl::StatusOr<ElementTree> FromValue(const Value& value, Type* type) const {
+    XLS_ASSIGN_OR_RETURN(LeafTypeTree<Value> value_tree,
+                         ValueToLeafTypeTree(value, type));
+    ElementTree tree(type);
+    for (int64_t i = 0; i < tree.size(); ++i) {
+      const Value& leaf = value_tree.elements()[i];
+      tree.elements()[i] =
+          leaf.IsBits() ? domain_.FromBits(leaf.bits()) : domain_.Top(0);
+    }
+    return tree;
+  }
+
+  ElementTree JoinTrees(const ElementTree& a, const ElementTree& b) const {
+    ElementTree result(a.type());
+    for (int64_t i = 0; i < result.size(); ++i) {
+      result.elements()[i] = domain_.Join(a.elements()[i], b.elements()[i]);
+    }
+    return result;
+  }
+
+  ElementTree WidenTrees(const ElementTree& previous,
+                         const ElementTree& next) const {
+    ElementTree result(previous.type());
+    for (int64_t i = 0; i < result.size(); ++i) {
+      result.elements()[i] =
+          domain_.Widen(previous.elements()[i], next.elements()[i]);
+    }
+    return result;
+  }
+
+  // Computes the abstract value of 'node' from the current abstract values of
+  // its operands.
+  absl::StatusOr<ElementTree> Evaluate(Node* node) const;
+
+  DomainT domain_;
+  Options options_;
+  absl::flat_hash_map<Node*, ElementTree> values_;
+
+  // The current abstract value of the proc state parameter.
+  ElementTree state_;
+
+  int64_t iteration_count_ = 0;
+  bool widened_ = false;
+};
+
+template <typename DomainT>
+absl::StatusOr<typename AbstractInterpreter<DomainT>::ElementTree>
+AbstractInterpreter<DomainT>::Evaluate(Node* node) const {
+  Type* type = node->GetType();
+  switch (node->op()) {
+    case Op::kLiteral:
+      return FromValue(node->As<Literal>()->value(), type);
+    case Op::kParam:
+      if (node->function_base()->IsProc() &&
+          node == node->function_base()->AsProcOrDie()->StateParam()) {
+        return state_;
+      }
+      return Top(type);
+    case Op::kTuple: {
+      std::vector<ElementTree> elements;
+      elements.reserve(node->operand_count());
+      for (Node* operand : node->operands()) {
+        elements.push_back(values_.at(operand));
+      }
+      return ElementTree(type, elements);
+    }
+    case Op::kTupleIndex:
+      return values_.at(node->operand(0))
+          .CopySubtree({node->As<TupleIndex>()->index()});
+    case Op::kSel:
+      if (!type->IsBits()) {
+        // Without knowledge of the selector any case may be chosen.
+        Select* sel = node->As<Select>();
+        std::vector<Node*> choices(sel->cases().begin(), sel->cases().end());
+        if (sel->default_value().has_value()) {
+          choices.push_back(*sel->default_value());
+        }
+        ElementTree result = values_.at(choices.front());
+        for (Node* choice : absl::MakeConstSpan(choices).subspan(1)) {
+          result = JoinTrees(result, values_.at(choice));
+        }
+        return result;
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (!type->IsBits() || OpIsSideEffecting(node->op()) ||
+      std::any_of(node->operands().begin(), node->operands().end(),
+                  [](Node* o) { return !o->GetType()->IsBits(); })) {
+    return Top(type);
+  }
+  std::vector<Element> operands;
+  operands.reserve(node->operand_count());
+  for (Node* operand : node->operands()) {
+    operands.push_back(values_.at(operand).Get({}));
+  }
+  XLS_ASSIGN_OR_RETURN(Element result, domain_.Transfer(node, operands));
+  ElementTree tree(type);
+  tree.Set({}, result);
+  return tree;
+}
+
+template <typename DomainT>
+absl::Status AbstractInterpreter<DomainT>::Run(FunctionBase* f) {
+  values_.clear();
+  iteration_count_ = 0;
+  widened_ = false;
+
+  Proc* proc = f->IsProc() ? f->AsProcOrDie() : nullptr;
+  if (proc != nullptr) {
+    XLS_ASSIGN_OR_RETURN(state_, FromValue(proc->InitValue(),
+                                           proc->StateParam()->GetType()));
+  }
+
+  // Nodes are evaluated in topological order from a worklist so that on
+  // subsequent proc iterations only the nodes transitively dependent upon the
+  // state parameter are reevaluated.
+  std::vector<Node*> topo_order = TopoSort(f).AsVector();
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  for (int64_t i = 0; i < topo_order.size(); ++i) {
+    topo_index[topo_order[i]] = i;
+  }
+  absl::btree_set<int64_t> worklist;
+  for (int64_t i = 0; i < topo_order.size(); ++i) {
+    worklist.insert(i);
+  }
+
+  while (true) {
+    ++iteration_count_;
+    while (!worklist.empty()) {
+      Node* node = topo_order[*worklist.begin()];
+      worklist.erase(worklist.begin());
+      XLS_ASSIGN_OR_RETURN(ElementTree value, Evaluate(node));
+      auto it = values_.find(node);
+      if (it != values_.end() && it->second == value) {
+        continue;
+      }
+      values_[node] = std::move(value);
+      for (Node* user : node->users()) {
+        worklist.insert(topo_index.at(user));
+      }
+    }
+    if (proc == nullptr) {
+      return absl::OkStatus();
+    }
+
+    ElementTree next_state = JoinTrees(state_, values_.at(proc->NextState()));
+    if (iteration_count_ > options_.widening_delay) {
+      next_state = WidenTrees(state_, next_state);
+      widened_ = true;
+    }
+    if (next_state == state_) {
+      XLS_VLOG(3) << absl::StreamFormat(
+          "Abstract interpretation of proc %s reached a fixpoint after %d "
+          "iterations",
+          proc->name(), iteration_count_);
+      return absl::OkStatus();
+    }
+    if (iteration_count_ >= options_.max_iterations) {
+      XLS_VLOG(3) << absl::StreamFormat(
+          "Abstract interpretation of proc %s did not converge after %d "
+          "iterations; assuming nothing about the state",
+          proc->name(), iteration_count_);
+      next_state = Top(proc->StateParam()->GetType());
+      if (next_state == state_) {
+        return absl::OkStatus();
+      }
+    }
+    state_ = std::move(next_state);
+    worklist.insert(topo_index.at(proc->StateParam()));
+  }
+}
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_ABSTRACT_INTERPRETER_H_
@@ -0,0 +1,138 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/abstract_interpreter.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/interval.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/ternary.h"
+#include "xls/passes/abstract_domains.h"
+#include "xls/passes/abstract_interpretation_query_engine.h"
+
+namespace xls {
+namespace {
+
+class AbstractInterpreterTest : public IrTestBase {
+ protected:
+  std::string TernaryString(const AbstractInterpreter<TernaryDomain>& interp,
+                            BValue value,
+                            absl::Span<const int64_t> index = {}) {
+    return ToString(interp.GetValue(value.node()).Get(index));
+  }
+
+  IntervalSet Intervals(const AbstractInterpreter<IntervalDomain>& interp,
+                        BValue value, absl::Span<const int64_t> index = {}) {
+    return interp.GetValue(value.node()).Get(index);
+  }
+
+  static IntervalSet MakeIntervalSet(int64_t lo, int64_t hi,
+                                     int64_t bit_count) {
+    IntervalSet result(bit_count);
+    result.AddInterval(Interval(UBits(lo, bit_count), UBits(hi, bit_count)));
+    result.Normalize();
+    return result;
+  }
+};
+
+TEST_F(AbstractInterpreterTest, TernaryThroughTuples) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue concat = fb.Concat({fb.Literal(UBits(0b10, 2)), x});
+  BValue tuple = fb.Tuple({concat, x});
+  BValue element = fb.TupleIndex(tuple, 0);
+  BValue result = fb.And(element, fb.Literal(UBits(0b111100, 6)));
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(result).status());
+
+  AbstractInterpreter<TernaryDomain> interp;
+  XLS_ASSERT_OK(interp.Run(result.node()->function_base()));
+  EXPECT_EQ(interp.iteration_count(), 1);
+  EXPECT_EQ(TernaryString(interp, tuple, {0}), "0b10_XXXX");
+  EXPECT_EQ(TernaryString(interp, tuple, {1}), "0bXXXX");
+  EXPECT_EQ(TernaryString(interp, result), "0b10_XX00");
+}
+
+TEST_F(AbstractInterpreterTest, ProcStateConstantElement) {
+  // The first element of the state is never modified and the second is a free
+  // running counter.
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(),
+                 Value::Tuple({Value(UBits(42, 8)), Value(UBits(0, 32))}),
+                 "tkn", "st", p.get());
+  BValue constant = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue counter = pb.TupleIndex(pb.GetStateParam(), 1);
+  BValue next_counter = pb.Add(counter, pb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build(pb.GetTokenParam(), pb.Tuple({constant, next_counter})));
+
+  AbstractInterpreter<TernaryDomain> ternary;
+  XLS_ASSERT_OK(ternary.Run(proc));
+  EXPECT_EQ(TernaryString(ternary, constant), "0b0010_1010");
+  EXPECT_TRUE(
+      ternary_ops::AllUnknown(ternary.GetValue(counter.node()).Get({})));
+
+  // The counter only converges by widening.
+  AbstractInterpreter<IntervalDomain> intervals;
+  XLS_ASSERT_OK(intervals.Run(proc));
+  EXPECT_TRUE(intervals.widened());
+  EXPECT_EQ(Intervals(intervals, constant), MakeIntervalSet(42, 42, 8));
+  EXPECT_TRUE(Intervals(intervals, counter).IsMaximal());
+}
+
+TEST_F(AbstractInterpreterTest, ProcStateAlternatingValues) {
+  // The state alternates between 3 and 5.
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(), Value(UBits(3, 8)), "tkn", "st", p.get());
+  BValue next_state = pb.Subtract(pb.Literal(UBits(8, 8)), pb.GetStateParam());
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc,
+                           pb.Build(pb.GetTokenParam(), next_state));
+
+  AbstractInterpreter<IntervalDomain> intervals;
+  XLS_ASSERT_OK(intervals.Run(proc));
+  EXPECT_FALSE(intervals.widened());
+  EXPECT_EQ(Intervals(intervals, pb.GetStateParam()),
+            IntervalSet::Combine(MakeIntervalSet(3, 3, 8),
+                                 MakeIntervalSet(5, 5, 8)));
+  EXPECT_EQ(Intervals(intervals, next_state),
+            Intervals(intervals, pb.GetStateParam()));
+}
+
+TEST_F(AbstractInterpreterTest, QueryEngineProvesStateElementConstant) {
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(),
+                 Value::Tuple({Value(UBits(7, 4)), Value(UBits(0, 16))}),
+                 "tkn", "st", p.get());
+  BValue constant = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue data = pb.TupleIndex(pb.GetStateParam(), 1);
+  BValue next_data = pb.Add(data, pb.ZeroExtend(constant, 16));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build(pb.GetTokenParam(), pb.Tuple({constant, next_data})));
+
+  AbstractInterpretationQueryEngine query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(proc).status());
+  EXPECT_TRUE(query_engine.AllBitsKnown(constant.node()));
+  EXPECT_EQ(query_engine.GetIntervals(constant.node()).Get({}),
+            MakeIntervalSet(7, 7, 4));
+  EXPECT_FALSE(query_engine.AllBitsKnown(data.node()));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,7 +14,18 @@
 
 #include "xls/passes/constant_folding_pass.h"
 
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/function_interpreter.h"
@@ -23,28 +34,151 @@
 
 namespace xls {
 
+namespace {
+
+// Returns true if the given node can be folded to a literal once the values of
+// its operands are known.
+bool IsFoldable(Node* node) {
+  // Avoid any types with tokens because literal tokens are not allowed.
+  return !node->Is<Literal>() && !TypeHasToken(node->GetType()) &&
+         !OpIsSideEffecting(node->op());
+}
+
+}  // namespace
+
+absl::StatusOr<Value> ConstantEvaluationCache::Evaluate(
+    Node* node, absl::Span<const Value> operand_values) {
+  int64_t hash = absl::Hash<std::pair<Op, absl::Span<const Value>>>()(
+      {node->op(), operand_values});
+  std::vector<std::list<Entry>::iterator>& bucket = buckets_[hash];
+  for (std::list<Entry>::iterator it : bucket) {
+    if (absl::MakeConstSpan(it->operand_values) == operand_values &&
+        node->IsDefinitelyEqualTo(it->node)) {
+      ++hits_;
+      entries_.splice(entries_.begin(), entries_, it);
+      return it->result;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
+  entries_.push_front(
+      Entry{hash, node,
+            std::vector<Value>(operand_values.begin(), operand_values.end()),
+            result});
+  bucket.push_back(entries_.begin());
+
+  if (static_cast<int64_t>(entries_.size()) > capacity_) {
+    std::list<Entry>::iterator lru = std::prev(entries_.end());
+    auto bucket_it = buckets_.find(lru->hash);
+    std::vector<std::list<Entry>::iterator>& lru_bucket = bucket_it->second;
+    lru_bucket.erase(std::find(lru_bucket.begin(), lru_bucket.end(), lru));
+    if (lru_bucket.empty()) {
+      buckets_.erase(bucket_it);
+    }
+    entries_.erase(lru);
+  }
+  return result;
+}
+
 absl::StatusOr<bool> ConstantFoldingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
-  bool changed = false;
-  for (Node* node : TopoSort(f)) {
-    // Fold any non-side-effecting op with constant paramters. Avoid any types
-    // with tokens because literal tokens are not allowed.
-    // TODO(meheff): 2019/6/26 Consider not folding loops with large trip counts
-    // to avoid hanging at compile time.
-    if (!node->Is<Literal>() && !TypeHasToken(node->GetType()) &&
-        !OpIsSideEffecting(node->op()) &&
-        std::all_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return o->Is<Literal>(); })) {
-      XLS_VLOG(2) << "Folding: " << *node;
-      std::vector<Value> operand_values;
-      for (Node* operand : node->operands()) {
-        operand_values.push_back(operand->As<Literal>()->value());
+  // Fold any non-side-effecting op with constant operands. Rather than
+  // replacing each foldable node with a literal which is then consumed by the
+  // next foldable node, whole constant subgraphs are evaluated in place and
+  // only the nodes on the boundary of each subgraph (those with uses outside
+  // of the subgraph) are replaced with literals. Interior nodes become dead.
+  // TODO(meheff): 2019/6/26 Consider not folding loops with large trip counts
+  // to avoid hanging at compile time.
+  std::vector<Node*> topo_order = TopoSort(f).AsVector();
+
+  // Determine the constant nodes up front so the boundary of each constant
+  // subgraph is known before any value is computed.
+  absl::flat_hash_set<Node*> constant_nodes;
+  for (Node* node : topo_order) {
+    if (node->Is<Literal>() ||
+        (IsFoldable(node) &&
+         std::all_of(node->operands().begin(), node->operands().end(),
+                     [&](Node* n) { return constant_nodes.contains(n); }))) {
+      constant_nodes.insert(node);
+    }
+  }
+  auto is_constant = [&](Node* n) { return constant_nodes.contains(n); };
+  auto is_boundary = [&](Node* n) {
+    return n->users().empty() || f->HasImplicitUse(n) ||
+           !std::all_of(n->users().begin(), n->users().end(), is_constant);
+  };
+
+  // The number of constant users of each folded node which have not been
+  // evaluated yet. Once this reaches zero the value of an interior node is no
+  // longer needed and is released, so memory is bounded by the live constant
+  // values rather than by every intermediate value in the subgraph. The
+  // evaluation cache is bounded separately and does not depend on liveness.
+  absl::flat_hash_map<Node*, int64_t> pending_users;
+  for (Node* node : topo_order) {
+    if (is_constant(node) && !node->Is<Literal>()) {
+      pending_users[node] =
+          std::count_if(node->users().begin(), node->users().end(),
+                        is_constant);
+    }
+  }
+
+  absl::flat_hash_map<Node*, Value> folded_values;
+  auto get_value = [&](Node* n) -> const Value& {
+    if (n->Is<Literal>()) {
+      return n->As<Literal>()->value();
+    }
+    return folded_values.at(n);
+  };
+  auto release_if_dead = [&](Node* n) {
+    if (pending_users.at(n) == 0 && !is_boundary(n)) {
+      folded_values.erase(n);
+    }
+  };
+
+  ConstantEvaluationCache cache;
+  std::vector<Value> operand_values;
+  int64_t evaluated_count = 0;
+  for (Node* node : topo_order) {
+    if (!is_constant(node) || node->Is<Literal>()) {
+      continue;
+    }
+    operand_values.clear();
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(get_value(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(Value result, cache.Evaluate(node, operand_values));
+    folded_values[node] = std::move(result);
+    ++evaluated_count;
+
+    for (int64_t i = 0; i < node->operand_count(); ++i) {
+      Node* operand = node->operand(i);
+      bool seen = std::find(node->operands().begin(),
+                            node->operands().begin() + i,
+                            operand) != node->operands().begin() + i;
+      if (operand->Is<Literal>() || seen) {
+        continue;
       }
-      XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
-      XLS_RETURN_IF_ERROR(node->ReplaceUsesWithNew<Literal>(result).status());
-      changed = true;
+      --pending_users.at(operand);
+      release_if_dead(operand);
+    }
+    release_if_dead(node);
+  }
+
+  // Replace the boundary nodes of the constant subgraphs with literals. A node
+  // is on the boundary if it has a non-constant user, an implicit use (e.g.,
+  // function return value), or no users at all.
+  bool changed = false;
+  for (Node* node : topo_order) {
+    if (node->Is<Literal>() || !is_constant(node) || !is_boundary(node)) {
+      continue;
     }
+    XLS_VLOG(2) << "Folding: " << *node;
+    XLS_RETURN_IF_ERROR(
+        node->ReplaceUsesWithNew<Literal>(folded_values.at(node)).status());
+    changed = true;
   }
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Evaluated %d constant nodes (%d cache hits)", evaluated_count,
+      cache.hits());
 
   return changed;
 }
@@ -15,12 +15,60 @@
 #ifndef XLS_PASSES_CONSTANT_FOLDING_PASS_H_
 #define XLS_PASSES_CONSTANT_FOLDING_PASS_H_
 
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
 #include "xls/passes/passes.h"
 
 namespace xls {
 
+// Memoizes the result of evaluating nodes on constant operand values, keyed by
+// the op, the attributes of the node and the operand values. Unrolled loops
+// and table generators often contain many structurally identical nodes applied
+// to identical constant operands (e.g., the same shift-and-xor step of a CRC
+// computation) which need only be evaluated once.
+//
+// The cache holds at most 'capacity' entries and evicts the least recently
+// used entry when full. Entries refer to the nodes which created them so the
+// cache must not outlive those nodes.
+class ConstantEvaluationCache {
+ public:
+  static constexpr int64_t kDefaultCapacity = 4096;
+
+  explicit ConstantEvaluationCache(int64_t capacity = kDefaultCapacity)
+      : capacity_(capacity) {}
+
+  // Returns the value of 'node' applied to 'operand_values', evaluating the
+  // node only if an equivalent evaluation is cached.
+  absl::StatusOr<Value> Evaluate(Node* node,
+                                 absl::Span<const Value> operand_values);
+
+  int64_t hits() const { return hits_; }
+  int64_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    int64_t hash;
+    Node* node;
+    std::vector<Value> operand_values;
+    Value result;
+  };
+
+  int64_t capacity_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<int64_t, std::vector<std::list<Entry>::iterator>>
+      buckets_;
+  int64_t hits_ = 0;
+};
+
 // Pass which performs constant folding. Every op with only literal operands is
 // replaced by a equivalent literal. Runs DCE after constant folding.
 class ConstantFoldingPass : public FunctionBasePass {
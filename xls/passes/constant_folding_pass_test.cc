@@ -14,14 +14,19 @@
 
 #include "xls/passes/constant_folding_pass.h"
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/passes/dce_pass.h"
@@ -145,5 +150,146 @@ TEST_F(ConstantFoldingPassTest, GateOp) {
   EXPECT_THAT(f->return_value(), m::Gate(m::Literal(), m::Literal()));
 }
 
+TEST_F(ConstantFoldingPassTest, ConstantSubgraph) {
+  // A deep chain of constant operations with a single non-constant user is
+  // folded into one literal.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue crc = fb.Literal(UBits(0xffffffff, 32));
+  for (int64_t i = 0; i < 64; ++i) {
+    BValue shifted = fb.Shrl(crc, fb.Literal(UBits(1, 32)));
+    BValue lsb = fb.BitSlice(crc, /*start=*/0, /*width=*/1);
+    BValue mask = fb.Negate(fb.ZeroExtend(lsb, 32));
+    crc = fb.Xor(shifted, fb.And(mask, fb.Literal(UBits(0xEDB88320, 32))));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Add(x, crc)));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Add(m::Param("x"), m::Literal()));
+  EXPECT_EQ(f->node_count(), 3);
+}
+
+TEST_F(ConstantFoldingPassTest, MultipleUsersOfFoldedNode) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn multiple_users(x: bits[8]) -> (bits[8], bits[8], bits[8]) {
+        one: bits[8] = literal(value=1)
+        two: bits[8] = literal(value=2)
+        three: bits[8] = add(one, two)
+        six: bits[8] = add(three, three)
+        seven: bits[8] = add(six, one)
+        plus_three: bits[8] = add(x, three)
+        ret result: (bits[8], bits[8], bits[8]) = tuple(plus_three, six, seven)
+     }
+  )",
+                                                       p.get()));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Add(m::Param("x"), m::Literal(3)), m::Literal(6),
+                       m::Literal(7)));
+}
+
+TEST_F(ConstantFoldingPassTest, InteriorValueUsedAcrossSubgraph) {
+  // The value of 'first' must be retained until its last (constant) user is
+  // evaluated, even though many other interior values are released before
+  // then.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue first = fb.Not(fb.Literal(UBits(42, 32)));
+  BValue value = first;
+  for (int64_t i = 0; i < 16; ++i) {
+    value = fb.Add(fb.Not(value), fb.Literal(UBits(i, 32)));
+  }
+  BValue last = fb.Subtract(value, first);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Add(x, last)));
+
+  uint32_t expected = ~uint32_t{42};
+  uint32_t first_value = expected;
+  for (uint32_t i = 0; i < 16; ++i) {
+    expected = ~expected + i;
+  }
+  expected -= first_value;
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Add(m::Param("x"), m::Literal(UBits(expected, 32))));
+}
+
+
+// Builds an unrolled CRC32 computation of 'steps' steps starting from a
+// constant seed.
+BValue BuildCrcSteps(FunctionBuilder* fb, int64_t steps) {
+  BValue crc = fb->Literal(UBits(0xffffffff, 32));
+  for (int64_t i = 0; i < steps; ++i) {
+    BValue shifted = fb->Shrl(crc, fb->Literal(UBits(1, 32)));
+    BValue lsb = fb->BitSlice(crc, /*start=*/0, /*width=*/1);
+    BValue mask = fb->Negate(fb->ZeroExtend(lsb, 32));
+    crc = fb->Xor(shifted, fb->And(mask, fb->Literal(UBits(0xEDB88320, 32))));
+  }
+  return crc;
+}
+
+TEST_F(ConstantFoldingPassTest, EvaluationCacheHitsOnRepeatedSteps) {
+  // Two identical unrolled CRC computations. Every node of the second is
+  // equivalent to a node of the first, regardless of whether the value of the
+  // first has been released.
+  constexpr int64_t kSteps = 8;
+  constexpr int64_t kNodesPerStep = 6;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = BuildCrcSteps(&fb, kSteps);
+  BValue b = BuildCrcSteps(&fb, kSteps);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({a, b})));
+
+  ConstantEvaluationCache cache;
+  absl::flat_hash_map<Node*, Value> values;
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Literal>()) {
+      values[node] = node->As<Literal>()->value();
+      continue;
+    }
+    std::vector<Value> operand_values;
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(values.at(operand));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(values[node],
+                             cache.Evaluate(node, operand_values));
+  }
+  EXPECT_GE(cache.hits(), kSteps * kNodesPerStep);
+  EXPECT_EQ(values.at(a.node()), values.at(b.node()));
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Literal());
+}
+
+TEST_F(ConstantFoldingPassTest, EvaluationCacheIsBounded) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = BuildCrcSteps(&fb, 8);
+  BValue b = BuildCrcSteps(&fb, 8);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({a, b})));
+
+  ConstantEvaluationCache cache(/*capacity=*/4);
+  absl::flat_hash_map<Node*, Value> values;
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Literal>()) {
+      values[node] = node->As<Literal>()->value();
+      continue;
+    }
+    std::vector<Value> operand_values;
+    for (Node* operand : node->operands()) {
+      operand_values.push_back(values.at(operand));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(values[node],
+                             cache.Evaluate(node, operand_values));
+    EXPECT_LE(cache.size(), 4);
+  }
+  EXPECT_EQ(values.at(a.node()), values.at(b.node()));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,11 +14,13 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 
 namespace xls {
@@ -49,59 +51,104 @@ absl::Span<Node* const> GetOperandsForCse(
   return *span_backing_store;
 }
 
-}  // namespace
+template <typename... Ts>
+size_t HashValues(const Ts&... values) {
+  return absl::Hash<std::tuple<const Ts&...>>()(std::tie(values...));
+}
 
-absl::StatusOr<bool> CsePass::RunOnFunctionBaseInternal(
-    FunctionBase* f, const PassOptions& options, PassResults* results) const {
-  // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
-    std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
+// Returns a hash of the attributes of the given node which participate in
+// Node::IsDefinitelyEqualTo (e.g., literal values and slice bounds). Without
+// these, nodes which differ only in their attributes (such as all literals of
+// the same type) would hash to the same value and the hash-consing table
+// would degrade to pairwise comparisons. Attributes not handled here (e.g.,
+// the function of an invoke which is compared structurally) are simply not
+// included in the hash which is conservative.
+size_t HashNodeAttributes(Node* node) {
+  switch (node->op()) {
+    case Op::kLiteral:
+      return HashValues(node->As<Literal>()->value());
+    case Op::kBitSlice:
+      return HashValues(node->As<BitSlice>()->start(),
+                        node->As<BitSlice>()->width());
+    case Op::kDynamicBitSlice:
+      return HashValues(node->As<DynamicBitSlice>()->width());
+    case Op::kArraySlice:
+      return HashValues(node->As<ArraySlice>()->width());
+    case Op::kSignExt:
+    case Op::kZeroExt:
+      return HashValues(node->As<ExtendOp>()->new_bit_count());
+    case Op::kTupleIndex:
+      return HashValues(node->As<TupleIndex>()->index());
+    case Op::kDecode:
+      return HashValues(node->As<Decode>()->width());
+    case Op::kOneHot:
+      return HashValues(node->As<OneHot>()->priority());
+    case Op::kCountedFor:
+      return HashValues(node->As<CountedFor>()->trip_count(),
+                        node->As<CountedFor>()->stride());
+    default:
+      return 0;
+  }
+}
+
+// Hash and equality functors which define the hash-consing table used for
+// CSE. Two nodes are in the same equivalence class if they have the same op,
+// type, attributes and (after commutative normalization) operands.
+struct CseNodeHash {
+  size_t operator()(Node* node) const {
     std::vector<Node*> span_backing_store;
-    for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
-      values_to_hash.push_back(operand->id());
+    absl::Span<Node* const> operands =
+        GetOperandsForCse(node, &span_backing_store);
+    std::vector<int64_t> operand_ids;
+    operand_ids.reserve(operands.size());
+    for (Node* operand : operands) {
+      operand_ids.push_back(operand->id());
+    }
+    // Types are uniqued within a package but compared structurally by
+    // IsDefinitelyEqualTo so hash the flat bit count rather than the pointer.
+    return HashValues(node->op(), node->GetType()->GetFlatBitCount(),
+                      operand_ids, HashNodeAttributes(node));
+  }
+};
+
+struct CseNodeEq {
+  bool operator()(Node* a, Node* b) const {
+    if (a == b) {
+      return true;
     }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
-    return hasher(values_to_hash);
-  };
+    std::vector<Node*> a_span_backing_store;
+    std::vector<Node*> b_span_backing_store;
+    return GetOperandsForCse(a, &a_span_backing_store) ==
+               GetOperandsForCse(b, &b_span_backing_store) &&
+           a->IsDefinitelyEqualTo(b);
+  }
+};
 
+}  // namespace
+
+absl::StatusOr<bool> CsePass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const PassOptions& options, PassResults* results) const {
+  // Hash-cons every node in topological order. Because operands are visited
+  // before their users and replaced nodes are never inserted, the operands of
+  // each node are already canonical when the node is hashed, so structurally
+  // identical expressions of arbitrary depth are commoned in a single pass.
   bool changed = false;
-  absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
-  node_buckets.reserve(f->node_count());
+  absl::flat_hash_set<Node*, CseNodeHash, CseNodeEq> representatives;
+  representatives.reserve(f->node_count());
   for (Node* node : TopoSort(f)) {
     if (OpIsSideEffecting(node->op())) {
       continue;
     }
-
-    int64_t hash = node_hash(node);
-    if (!node_buckets.contains(hash)) {
-      node_buckets[hash].push_back(node);
+    auto [it, inserted] = representatives.insert(node);
+    if (inserted) {
       continue;
     }
-    bool replaced = false;
-    std::vector<Node*> node_span_backing_store;
-    absl::Span<Node* const> node_operands_for_cse =
-        GetOperandsForCse(node, &node_span_backing_store);
-    for (Node* candidate : node_buckets.at(hash)) {
-      std::vector<Node*> candidate_span_backing_store;
-      if (node_operands_for_cse ==
-              GetOperandsForCse(candidate, &candidate_span_backing_store) &&
-          node->IsDefinitelyEqualTo(candidate)) {
-        XLS_VLOG(3) << absl::StreamFormat(
-            "Replacing %s with equivalent node %s", node->GetName(),
-            candidate->GetName());
-        XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
-        changed = true;
-        replaced = true;
-        break;
-      }
-    }
-    if (!replaced) {
-      node_buckets[hash].push_back(node);
-    }
+    Node* representative = *it;
+    XLS_VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
+                                      node->GetName(),
+                                      representative->GetName());
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(representative));
+    changed = true;
   }
 
   return changed;
@@ -212,5 +212,42 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, DistinctLiteralsAndSlices) {
+  // Nodes which differ only in their attributes must not be commoned.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue lit1 = fb.Literal(UBits(1, 32));
+  BValue lit2 = fb.Literal(UBits(2, 32));
+  BValue slice_lo = fb.BitSlice(x, /*start=*/0, /*width=*/8);
+  BValue slice_hi = fb.BitSlice(x, /*start=*/8, /*width=*/8);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      fb.BuildWithReturnValue(fb.Tuple({lit1, lit2, slice_lo, slice_hi})));
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+  EXPECT_EQ(f->node_count(), 6);
+}
+
+TEST_F(CsePassTest, ManyLiterals) {
+  // Each of the kLiteralCount distinct literal values appears twice.
+  constexpr int64_t kLiteralCount = 2000;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> elements;
+  for (int64_t copy = 0; copy < 2; ++copy) {
+    for (int64_t i = 0; i < kLiteralCount; ++i) {
+      elements.push_back(fb.Literal(UBits(i, 32)));
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple(elements)));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), kLiteralCount + 1);
+  for (int64_t i = 0; i < kLiteralCount; ++i) {
+    EXPECT_EQ(f->return_value()->operand(i),
+              f->return_value()->operand(kLiteralCount + i));
+  }
+}
+
 }  // namespace
 }  // namespace xls
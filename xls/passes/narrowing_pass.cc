@@ -24,6 +24,7 @@
 #include "xls/ir/op.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/value_helpers.h"
+#include "xls/passes/abstract_interpretation_query_engine.h"
 #include "xls/passes/query_engine.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -768,6 +769,11 @@ static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
     std::vector<std::unique_ptr<QueryEngine>> engines;
     engines.push_back(std::move(ternary_query_engine));
     engines.push_back(std::move(range_query_engine));
+    if (f->IsProc()) {
+      // Abstract interpretation through the state feedback loop can prove
+      // facts about the proc state which hold across all iterations.
+      engines.push_back(std::make_unique<AbstractInterpretationQueryEngine>());
+    }
     query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
   } else {
     query_engine = std::make_unique<TernaryQueryEngine>();
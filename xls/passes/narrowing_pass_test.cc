@@ -397,6 +397,55 @@ TEST_P(NarrowingPassTest, ConvertArrayIndexToSelect) {
   }
 }
 
+TEST_P(NarrowingPassTest, ProcStateBoundedThroughFeedback) {
+  // The counter state element wraps at 16 so with range analysis the
+  // comparison is always true across all iterations of the proc.
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(),
+                 Value::Tuple({Value(UBits(0, 32)), Value(UBits(0, 1))}),
+                 "tkn", "st", p.get());
+  BValue counter = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue next_counter = pb.ZeroExtend(
+      pb.BitSlice(pb.Add(counter, pb.Literal(UBits(1, 32))), /*start=*/0,
+                  /*width=*/4),
+      32);
+  BValue in_range = pb.ULt(counter, pb.Literal(UBits(16, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build(pb.GetTokenParam(), pb.Tuple({next_counter, in_range})));
+
+  if (GetParam()) {
+    ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+    EXPECT_THAT(proc->NextState(), m::Tuple(m::ZeroExt(), m::Literal(1)));
+  } else {
+    EXPECT_THAT(proc->NextState(),
+                m::Tuple(m::ZeroExt(), m::ULt(m::TupleIndex(), m::Literal())));
+    ASSERT_THAT(Run(p.get()), IsOkAndHolds(false));
+    EXPECT_THAT(proc->NextState(),
+                m::Tuple(m::ZeroExt(), m::ULt(m::TupleIndex(), m::Literal())));
+  }
+}
+
+TEST_P(NarrowingPassTest, ProcStateGrowingThroughFeedback) {
+  // The counter state element grows without bound (until it wraps) so the
+  // comparison must not be folded.
+  auto p = CreatePackage();
+  ProcBuilder pb(TestName(),
+                 Value::Tuple({Value(UBits(0, 32)), Value(UBits(0, 1))}),
+                 "tkn", "st", p.get());
+  BValue counter = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue next_counter = pb.Add(counter, pb.Literal(UBits(1, 32)));
+  BValue in_range = pb.ULt(counter, pb.Literal(UBits(16, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build(pb.GetTokenParam(), pb.Tuple({next_counter, in_range})));
+
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(false));
+  EXPECT_THAT(proc->NextState(),
+              m::Tuple(m::Add(m::TupleIndex(), m::Literal(1)),
+                       m::ULt(m::TupleIndex(), m::Literal(16))));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NarrowingPassTestInstantiation, NarrowingPassTest,
     testing::Values(false, true),
@@ -70,6 +70,12 @@ struct PassOptions {
   // chains of selects. Otherwise, this optimization is skipped, since it can
   // sometimes reduce output quality.
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
+
+  // If this is not `std::nullopt`, share expensive operations feeding mutually
+  // exclusive select arms as long as the critical-path delay of the function
+  // grows by no more than the given number of picoseconds. Otherwise, resource
+  // sharing is skipped, since it trades delay for area.
+  std::optional<int64_t> resource_sharing_max_delay_increase_ps = std::nullopt;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -0,0 +1,295 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proc_state_optimization_pass.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/optional.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/interval.h"
+#include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/ternary.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/passes/abstract_interpretation_query_engine.h"
+
+namespace xls {
+
+namespace {
+
+// What to do with each element of the proc state.
+enum class ElementAction { kKeep, kRemoveDead, kRemoveConstant, kNarrow };
+
+std::string ElementActionToString(ElementAction action) {
+  switch (action) {
+    case ElementAction::kKeep:
+      return "keep";
+    case ElementAction::kRemoveDead:
+      return "dead";
+    case ElementAction::kRemoveConstant:
+      return "constant";
+    case ElementAction::kNarrow:
+      return "narrow";
+  }
+  XLS_LOG(FATAL) << "Invalid element action: " << static_cast<int>(action);
+}
+
+// Returns the number of leading bits of the given bits-typed state element
+// which are zero in every iteration of the proc.
+int64_t CountLeadingZeroStateBits(Proc* proc, int64_t element,
+                                  const QueryEngine& query_engine) {
+  TernaryVector ternary =
+      query_engine.GetTernary(proc->StateParam()).Get({element});
+  int64_t known_zeros = 0;
+  for (auto it = ternary.rbegin();
+       it != ternary.rend() && *it == TernaryValue::kKnownZero; ++it) {
+    ++known_zeros;
+  }
+  int64_t interval_zeros = 0;
+  absl::optional<Interval> hull =
+      query_engine.GetIntervals(proc->StateParam()).Get({element}).ConvexHull();
+  if (hull.has_value()) {
+    interval_zeros = hull->UpperBound().CountLeadingZeros();
+  }
+  return std::max(known_zeros, interval_zeros);
+}
+
+// Returns whether every leaf of the given state element is fully known in
+// every iteration of the proc.
+bool IsConstantStateElement(Proc* proc, int64_t element,
+                            const QueryEngine& query_engine) {
+  LeafTypeTree<TernaryVector> ternary =
+      query_engine.GetTernary(proc->StateParam()).CopySubtree({element});
+  for (const TernaryVector& leaf : ternary.elements()) {
+    if (std::any_of(leaf.begin(), leaf.end(), ternary_ops::IsUnknown)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns which state elements can (transitively) affect side-effecting
+// operations or the next token.
+std::vector<bool> ComputeLiveStateElements(
+    Proc* proc, const std::vector<std::vector<Node*>>& element_uses,
+    Tuple* next_state) {
+  absl::flat_hash_map<Node*, int64_t> element_of;
+  for (int64_t i = 0; i < element_uses.size(); ++i) {
+    for (Node* use : element_uses[i]) {
+      element_of[use] = i;
+    }
+  }
+
+  std::vector<bool> live(element_uses.size(), false);
+  std::vector<Node*> worklist;
+  absl::flat_hash_set<Node*> visited;
+  auto add_root = [&](Node* node) {
+    if (visited.insert(node).second) {
+      worklist.push_back(node);
+    }
+  };
+  for (Node* node : proc->nodes()) {
+    if (OpIsSideEffecting(node->op())) {
+      add_root(node);
+    }
+  }
+  add_root(proc->NextToken());
+
+  // Walk backwards from the roots. Reaching a use of a state element makes the
+  // element live which in turn makes the computation of its next value live.
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    auto it = element_of.find(node);
+    if (it != element_of.end() && !live[it->second]) {
+      live[it->second] = true;
+      add_root(next_state->operand(it->second));
+    }
+    for (Node* operand : node->operands()) {
+      add_root(operand);
+    }
+  }
+  return live;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ProcStateOptimizationPass::RunOnProcInternal(
+    Proc* proc, const PassOptions& options, PassResults* results) const {
+  Type* state_type = proc->StateType();
+  if (!state_type->IsTuple() || TypeHasToken(state_type)) {
+    return false;
+  }
+  for (Node* user : proc->StateParam()->users()) {
+    if (!user->Is<TupleIndex>()) {
+      return false;
+    }
+  }
+  int64_t element_count = state_type->AsTupleOrDie()->size();
+
+  // Analyze the proc before modifying it.
+  AbstractInterpretationQueryEngine query_engine;
+  XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
+
+  // Make the next state an explicit tuple so each element has a distinct next
+  // value node.
+  if (!proc->NextState()->Is<Tuple>()) {
+    std::vector<Node*> elements;
+    for (int64_t i = 0; i < element_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * element,
+                           proc->MakeNode<TupleIndex>(
+                               absl::nullopt, proc->NextState(), i));
+      elements.push_back(element);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * next_state,
+                         proc->MakeNode<Tuple>(absl::nullopt, elements));
+    XLS_RETURN_IF_ERROR(proc->SetNextState(next_state));
+  }
+  Tuple* next_state = proc->NextState()->As<Tuple>();
+
+  std::vector<std::vector<Node*>> element_uses(element_count);
+  for (Node* user : proc->StateParam()->users()) {
+    element_uses[user->As<TupleIndex>()->index()].push_back(user);
+  }
+  std::vector<bool> live =
+      ComputeLiveStateElements(proc, element_uses, next_state);
+
+  std::vector<ElementAction> actions(element_count, ElementAction::kKeep);
+  std::vector<int64_t> new_widths(element_count);
+  bool changed = false;
+  for (int64_t i = 0; i < element_count; ++i) {
+    Type* element_type = state_type->AsTupleOrDie()->element_type(i);
+    new_widths[i] = element_type->GetFlatBitCount();
+    if (!live[i]) {
+      actions[i] = ElementAction::kRemoveDead;
+    } else if (IsConstantStateElement(proc, i, query_engine)) {
+      actions[i] = ElementAction::kRemoveConstant;
+    } else if (element_type->IsBits()) {
+      // Keep at least one bit. An element which is always zero is constant
+      // but may not be identified as such by the ternary analysis.
+      int64_t leading_zeros =
+          std::min(CountLeadingZeroStateBits(proc, i, query_engine),
+                   new_widths[i] - 1);
+      if (leading_zeros > 0) {
+        actions[i] = ElementAction::kNarrow;
+        new_widths[i] -= leading_zeros;
+      }
+    }
+    if (actions[i] != ElementAction::kKeep) {
+      XLS_VLOG(2) << absl::StrFormat("Proc %s state element %d: %s",
+                                     proc->name(), i,
+                                     ElementActionToString(actions[i]));
+      changed = true;
+    }
+  }
+  if (!changed) {
+    return false;
+  }
+
+  // Replace the uses of each state element. Elements which are kept get a
+  // placeholder literal which is replaced by an element of the new state
+  // parameter once it has been created.
+  std::vector<Node*> placeholders;
+  std::vector<Value> new_init_values;
+  std::vector<int64_t> kept_elements;
+  for (int64_t i = 0; i < element_count; ++i) {
+    Type* element_type = state_type->AsTupleOrDie()->element_type(i);
+    const Value& init_value = proc->InitValue().element(i);
+    Node* replacement;
+    switch (actions[i]) {
+      case ElementAction::kRemoveDead: {
+        // The value is never observed so any value will do.
+        XLS_ASSIGN_OR_RETURN(replacement,
+                             proc->MakeNode<Literal>(
+                                 absl::nullopt, ZeroOfType(element_type)));
+        break;
+      }
+      case ElementAction::kRemoveConstant: {
+        XLS_ASSIGN_OR_RETURN(replacement, proc->MakeNode<Literal>(
+                                              absl::nullopt, init_value));
+        break;
+      }
+      case ElementAction::kKeep: {
+        XLS_ASSIGN_OR_RETURN(replacement,
+                             proc->MakeNode<Literal>(
+                                 absl::nullopt, ZeroOfType(element_type)));
+        placeholders.push_back(replacement);
+        new_init_values.push_back(init_value);
+        kept_elements.push_back(i);
+        break;
+      }
+      case ElementAction::kNarrow: {
+        XLS_ASSIGN_OR_RETURN(
+            Node * placeholder,
+            proc->MakeNode<Literal>(absl::nullopt,
+                                    Value(UBits(0, new_widths[i]))));
+        XLS_ASSIGN_OR_RETURN(replacement,
+                             proc->MakeNode<ExtendOp>(
+                                 absl::nullopt, placeholder,
+                                 element_type->GetFlatBitCount(),
+                                 Op::kZeroExt));
+        placeholders.push_back(placeholder);
+        new_init_values.push_back(
+            Value(init_value.bits().Slice(0, new_widths[i])));
+        kept_elements.push_back(i);
+        break;
+      }
+    }
+    for (Node* use : element_uses[i]) {
+      XLS_RETURN_IF_ERROR(use->ReplaceUsesWith(replacement));
+      XLS_RETURN_IF_ERROR(proc->RemoveNode(use));
+    }
+  }
+
+  // Build the new next state from the next values of the kept elements. This
+  // is done after replacing the element uses above as the next value of an
+  // element may be a use of another element.
+  std::vector<Node*> new_next_elements;
+  for (int64_t i : kept_elements) {
+    Node* next_element = next_state->operand(i);
+    if (actions[i] == ElementAction::kNarrow) {
+      XLS_ASSIGN_OR_RETURN(next_element,
+                           proc->MakeNode<BitSlice>(absl::nullopt, next_element,
+                                                    /*start=*/0,
+                                                    new_widths[i]));
+    }
+    new_next_elements.push_back(next_element);
+  }
+  XLS_ASSIGN_OR_RETURN(Node * new_next_state,
+                       proc->MakeNode<Tuple>(next_state->loc(),
+                                             new_next_elements));
+  XLS_RETURN_IF_ERROR(proc->ReplaceState(proc->StateParam()->name(),
+                                         new_next_state,
+                                         Value::Tuple(new_init_values)));
+  for (int64_t j = 0; j < placeholders.size(); ++j) {
+    XLS_ASSIGN_OR_RETURN(
+        Node * element,
+        proc->MakeNode<TupleIndex>(absl::nullopt, proc->StateParam(), j));
+    XLS_RETURN_IF_ERROR(placeholders[j]->ReplaceUsesWith(element));
+    XLS_RETURN_IF_ERROR(proc->RemoveNode(placeholders[j]));
+  }
+
+  return true;
+}
+
+}  // namespace xls
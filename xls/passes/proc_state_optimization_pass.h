@@ -0,0 +1,54 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PROC_STATE_OPTIMIZATION_PASS_H_
+#define XLS_PASSES_PROC_STATE_OPTIMIZATION_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/ir/proc.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+
+// Pass which removes and narrows elements of tuple-typed proc state. Each
+// element of the state is treated as a separate register:
+//
+//  * Elements which can not affect any side-effecting operation (sends,
+//    asserts, etc) either directly or through other live state elements are
+//    removed.
+//
+//  * Elements which are proven by abstract interpretation over the state
+//    feedback loop to hold their initial value in every iteration are replaced
+//    by a literal and removed.
+//
+//  * Bits-typed elements with leading bits proven to be zero in every
+//    iteration are narrowed.
+//
+// Procs whose state is not a tuple or whose state is used other than via
+// tuple-index operations are not transformed.
+class ProcStateOptimizationPass : public ProcPass {
+ public:
+  ProcStateOptimizationPass()
+      : ProcPass("proc_state_opt", "Proc state optimization") {}
+  ~ProcStateOptimizationPass() override {}
+
+ protected:
+  absl::StatusOr<bool> RunOnProcInternal(Proc* proc,
+                                         const PassOptions& options,
+                                         PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PROC_STATE_OPTIMIZATION_PASS_H_
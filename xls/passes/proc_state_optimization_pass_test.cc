@@ -0,0 +1,166 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proc_state_optimization_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/passes/dce_pass.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class ProcStateOptimizationPassTest : public IrTestBase {
+ protected:
+  ProcStateOptimizationPassTest() = default;
+
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    XLS_ASSIGN_OR_RETURN(bool changed, ProcStateOptimizationPass().Run(
+                                           p, PassOptions(), &results));
+    // Run dce to clean things up.
+    for (FunctionBase* f : p->GetFunctionBases()) {
+      XLS_RETURN_IF_ERROR(DeadCodeEliminationPass()
+                              .RunOnFunctionBase(f, PassOptions(), &results)
+                              .status());
+    }
+    return changed;
+  }
+};
+
+TEST_F(ProcStateOptimizationPassTest, RemoveDeadStateElement) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * channel,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb(TestName(),
+                 Value::Tuple({Value(UBits(0, 32)), Value(UBits(0, 32))}),
+                 "token", "state", p.get());
+  BValue a = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue b = pb.TupleIndex(pb.GetStateParam(), 1);
+  BValue one = pb.Literal(UBits(1, 32));
+  BValue token = pb.Send(channel, pb.GetTokenParam(), a);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, pb.Build(token, pb.Tuple({pb.Add(a, one), pb.Add(b, one)})));
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(proc->StateType(), p->GetTupleType({p->GetBitsType(32)}));
+  EXPECT_EQ(proc->InitValue(), Value::Tuple({Value(UBits(0, 32))}));
+  EXPECT_THAT(proc->NextState(),
+              m::Tuple(m::Add(m::TupleIndex(m::Param("state"), 0),
+                              m::Literal(1))));
+  EXPECT_THAT(proc->NextToken(),
+              m::Send(m::Param("token"),
+                      m::TupleIndex(m::Param("state"), 0)));
+}
+
+TEST_F(ProcStateOptimizationPassTest, RemoveConstantStateElement) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * channel,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb(TestName(),
+                 Value::Tuple({Value(UBits(5, 32)), Value(UBits(0, 32))}),
+                 "token", "state", p.get());
+  BValue step = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue accum = pb.TupleIndex(pb.GetStateParam(), 1);
+  BValue next_accum = pb.Add(accum, step);
+  BValue token = pb.Send(channel, pb.GetTokenParam(), next_accum);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc,
+                           pb.Build(token, pb.Tuple({step, next_accum})));
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(proc->StateType(), p->GetTupleType({p->GetBitsType(32)}));
+  EXPECT_EQ(proc->InitValue(), Value::Tuple({Value(UBits(0, 32))}));
+  EXPECT_THAT(proc->NextState(),
+              m::Tuple(m::Add(m::TupleIndex(m::Param("state"), 0),
+                              m::Literal(5))));
+}
+
+TEST_F(ProcStateOptimizationPassTest, NarrowStateElement) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * channel,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  // The state element alternates between 3 and 5 so only the low three bits
+  // need to be stored.
+  ProcBuilder pb(TestName(), Value::Tuple({Value(UBits(3, 32))}), "token",
+                 "state", p.get());
+  BValue x = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue token = pb.Send(channel, pb.GetTokenParam(), x);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      pb.Build(token, pb.Tuple({pb.Subtract(pb.Literal(UBits(8, 32)), x)})));
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(proc->StateType(), p->GetTupleType({p->GetBitsType(3)}));
+  EXPECT_EQ(proc->InitValue(), Value::Tuple({Value(UBits(3, 3))}));
+  EXPECT_THAT(
+      proc->NextToken(),
+      m::Send(m::Param("token"),
+              m::ZeroExt(m::TupleIndex(m::Param("state"), 0))));
+  EXPECT_THAT(proc->NextState(),
+              m::Tuple(m::BitSlice(
+                  m::Sub(m::Literal(8),
+                         m::ZeroExt(m::TupleIndex(m::Param("state"), 0))),
+                  /*start=*/0, /*width=*/3)));
+}
+
+TEST_F(ProcStateOptimizationPassTest, NonTupleState) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * channel,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb(TestName(), Value(UBits(5, 32)), "token", "state", p.get());
+  BValue token = pb.Send(channel, pb.GetTokenParam(), pb.GetStateParam());
+  XLS_ASSERT_OK(pb.Build(token, pb.GetStateParam()).status());
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(ProcStateOptimizationPassTest, UnchangedState) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      StreamingChannel * channel,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb(TestName(), Value::Tuple({Value(UBits(0, 32))}), "token",
+                 "state", p.get());
+  BValue x = pb.TupleIndex(pb.GetStateParam(), 0);
+  BValue token = pb.Send(channel, pb.GetTokenParam(), x);
+  XLS_ASSERT_OK(
+      pb.Build(token, pb.Tuple({pb.Add(x, pb.Literal(UBits(1, 32)))}))
+          .status());
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
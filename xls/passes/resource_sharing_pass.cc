@@ -0,0 +1,360 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/resource_sharing_pass.h"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/optional.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
+
+namespace xls {
+
+namespace {
+
+// Returns true if the operation is expensive enough to be worth sharing.
+bool IsShareableOp(Op op) {
+  switch (op) {
+    case Op::kAdd:
+    case Op::kSub:
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if 'a' and 'b' can be implemented by a single operation with
+// muxed operands.
+bool AreCompatible(Node* a, Node* b) {
+  if (a->op() != b->op() || a->GetType() != b->GetType() ||
+      a->operand_count() != b->operand_count()) {
+    return false;
+  }
+  for (int64_t i = 0; i < a->operand_count(); ++i) {
+    if (a->operand(i)->GetType() != b->operand(i)->GetType()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rough area estimate in units of two-input muxes. A full adder is counted as
+// two muxes.
+int64_t EstimateAreaFromBitCount(Node* node) {
+  int64_t width = node->GetType()->GetFlatBitCount();
+  switch (node->op()) {
+    case Op::kAdd:
+    case Op::kSub:
+      return 2 * width;
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      return 2 * node->operand(0)->BitCountOrDie() *
+             node->operand(1)->BitCountOrDie();
+    case Op::kSel:
+    case Op::kOneHotSel:
+      // One mux per bit for each additional arm.
+      return width * std::max(int64_t{1}, node->operand_count() - 2);
+    default:
+      return width;
+  }
+}
+
+// Area and timing estimates for the nodes of a function. Timing is expressed
+// as the arrival time of the output of each node and the longest delay from
+// the output of each node to the end of the function.
+class CostModel {
+ public:
+  explicit CostModel(const DelayEstimator& delay_estimator)
+      : delay_estimator_(delay_estimator) {}
+
+  // (Re)computes the timing of every node in the function.
+  void Update(FunctionBase* f) {
+    arrival_.clear();
+    tail_.clear();
+    critical_path_delay_ = 0;
+    std::vector<Node*> topo_order = TopoSort(f).AsVector();
+    for (Node* node : topo_order) {
+      int64_t start = 0;
+      for (Node* operand : node->operands()) {
+        start = std::max(start, arrival_.at(operand));
+      }
+      arrival_[node] = start + GetDelay(node);
+      critical_path_delay_ = std::max(critical_path_delay_, arrival_[node]);
+    }
+    for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+      int64_t tail = 0;
+      for (Node* user : (*it)->users()) {
+        tail = std::max(tail, tail_.at(user) + GetDelay(user));
+      }
+      tail_[*it] = tail;
+    }
+  }
+
+  int64_t GetDelay(Node* node) const {
+    // Not all operations have a delay model. Treat these as free.
+    absl::StatusOr<int64_t> delay =
+        delay_estimator_.GetOperationDelayInPs(node);
+    return delay.ok() ? delay.value() : 0;
+  }
+
+  int64_t GetArea(Node* node) const { return EstimateAreaFromBitCount(node); }
+
+  int64_t arrival(Node* node) const { return arrival_.at(node); }
+  int64_t tail(Node* node) const { return tail_.at(node); }
+  int64_t critical_path_delay() const { return critical_path_delay_; }
+
+ private:
+  const DelayEstimator& delay_estimator_;
+  absl::flat_hash_map<Node*, int64_t> arrival_;
+  absl::flat_hash_map<Node*, int64_t> tail_;
+  int64_t critical_path_delay_ = 0;
+};
+
+// Returns the arms of the given select or one-hot-select. The default value of
+// a select is the last arm.
+std::vector<Node*> GetArms(Node* select) {
+  if (select->Is<Select>()) {
+    Select* sel = select->As<Select>();
+    std::vector<Node*> arms(sel->cases().begin(), sel->cases().end());
+    if (sel->default_value().has_value()) {
+      arms.push_back(*sel->default_value());
+    }
+    return arms;
+  }
+  OneHotSelect* ohs = select->As<OneHotSelect>();
+  return std::vector<Node*>(ohs->cases().begin(), ohs->cases().end());
+}
+
+Node* GetSelector(Node* select) {
+  return select->Is<Select>() ? select->As<Select>()->selector()
+                              : select->As<OneHotSelect>()->selector();
+}
+
+// Creates a select of the same kind and with the same selector as 'select'
+// with the given arms.
+absl::StatusOr<Node*> MakeSelectLike(Node* select,
+                                     absl::Span<Node* const> arms) {
+  FunctionBase* f = select->function_base();
+  if (select->Is<Select>()) {
+    Select* sel = select->As<Select>();
+    std::vector<Node*> cases(arms.begin(), arms.begin() + sel->cases().size());
+    absl::optional<Node*> default_value;
+    if (sel->default_value().has_value()) {
+      default_value = arms.back();
+    }
+    return f->MakeNode<Select>(select->loc(), sel->selector(), cases,
+                               default_value);
+  }
+  std::vector<Node*> cases(arms.begin(), arms.end());
+  return f->MakeNode<OneHotSelect>(select->loc(), GetSelector(select), cases);
+}
+
+// Partitions the arms of the select which are candidates for sharing into
+// groups of compatible operations. Each group is a list of arm indices.
+std::vector<std::vector<int64_t>> GetShareableGroups(
+    Node* select, absl::Span<Node* const> arms) {
+  FunctionBase* f = select->function_base();
+  std::vector<std::vector<int64_t>> groups;
+  for (int64_t i = 0; i < arms.size(); ++i) {
+    Node* arm = arms[i];
+    // The operation can only be removed if the select is its only user.
+    if (!IsShareableOp(arm->op()) || arm->users().size() != 1 ||
+        f->HasImplicitUse(arm) || arm == GetSelector(select)) {
+      continue;
+    }
+    auto it = std::find_if(groups.begin(), groups.end(),
+                           [&](const std::vector<int64_t>& group) {
+                             return AreCompatible(arms[group.front()], arm);
+                           });
+    if (it == groups.end()) {
+      groups.push_back({i});
+    } else {
+      it->push_back(i);
+    }
+  }
+  return groups;
+}
+
+// Attempts to share the operations in the arms of 'select' indicated by
+// 'group'. Returns the replacement select, or nullptr if sharing is not
+// possible or not profitable.
+absl::StatusOr<Node*> ShareGroup(Node* select, absl::Span<const int64_t> group,
+                                 const QueryEngine& query_engine,
+                                 const CostModel& cost_model,
+                                 int64_t max_delay_increase_ps) {
+  std::vector<Node*> arms = GetArms(select);
+  Node* selector = GetSelector(select);
+  absl::flat_hash_set<Node*> distinct_ops;
+  for (int64_t i : group) {
+    distinct_ops.insert(arms[i]);
+  }
+  if (distinct_ops.size() < 2) {
+    return nullptr;
+  }
+
+  if (select->Is<OneHotSelect>()) {
+    std::vector<TreeBitLocation> selector_bits;
+    for (int64_t i : group) {
+      selector_bits.push_back(TreeBitLocation(selector, i));
+    }
+    if (!query_engine.AtMostOneTrue(selector_bits)) {
+      return nullptr;
+    }
+  }
+
+  Node* representative = arms[group.front()];
+  int64_t select_width = std::max(int64_t{1}, select->BitCountOrDie());
+  int64_t area_saved = (static_cast<int64_t>(distinct_ops.size()) - 1) *
+                       cost_model.GetArea(representative);
+  for (Node* operand : representative->operands()) {
+    area_saved -= cost_model.GetArea(select) * operand->BitCountOrDie() /
+                  select_width;
+  }
+  if (area_saved <= 0) {
+    return nullptr;
+  }
+
+  // Sharing moves the operation behind a mux on its operands. Estimate the new
+  // arrival time of the select output and reject the sharing if it lengthens
+  // the critical path too much.
+  int64_t mux_delay = cost_model.GetDelay(select);
+  int64_t operands_arrival = cost_model.arrival(selector);
+  for (Node* op : distinct_ops) {
+    for (Node* operand : op->operands()) {
+      operands_arrival =
+          std::max(operands_arrival, cost_model.arrival(operand));
+    }
+  }
+  int64_t select_start = operands_arrival + mux_delay +
+                         cost_model.GetDelay(representative);
+  for (int64_t i = 0; i < arms.size(); ++i) {
+    if (!distinct_ops.contains(arms[i])) {
+      select_start = std::max(select_start, cost_model.arrival(arms[i]));
+    }
+  }
+  int64_t path_delay = select_start + mux_delay + cost_model.tail(select);
+  if (path_delay > cost_model.critical_path_delay() + max_delay_increase_ps) {
+    XLS_VLOG(3) << absl::StreamFormat(
+        "Not sharing %s operations of %s: path delay %dps exceeds limit %dps",
+        OpToString(representative->op()), select->GetName(), path_delay,
+        cost_model.critical_path_delay() + max_delay_increase_ps);
+    return nullptr;
+  }
+
+  XLS_VLOG(2) << absl::StreamFormat(
+      "Sharing %d %s operations of %s (estimated area saved: %d)",
+      distinct_ops.size(), OpToString(representative->op()),
+      select->GetName(), area_saved);
+
+  // Build a mux for each operand of the shared operation. Arms which are not
+  // part of the group are don't-cares for a select. For a one-hot-select they
+  // must be zero so the result is the operand of the selected group arm.
+  FunctionBase* f = select->function_base();
+  absl::flat_hash_set<int64_t> group_set(group.begin(), group.end());
+  std::vector<Node*> shared_operands;
+  for (int64_t j = 0; j < representative->operand_count(); ++j) {
+    Node* filler = representative->operand(j);
+    if (select->Is<OneHotSelect>()) {
+      XLS_ASSIGN_OR_RETURN(
+          filler, f->MakeNode<Literal>(select->loc(),
+                                       ZeroOfType(filler->GetType())));
+    }
+    std::vector<Node*> operand_arms;
+    for (int64_t i = 0; i < arms.size(); ++i) {
+      operand_arms.push_back(group_set.contains(i) ? arms[i]->operand(j)
+                                                   : filler);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * operand_mux,
+                         MakeSelectLike(select, operand_arms));
+    shared_operands.push_back(operand_mux);
+  }
+  XLS_ASSIGN_OR_RETURN(Node * shared, representative->Clone(shared_operands));
+
+  std::vector<Node*> new_arms = arms;
+  for (int64_t i : group) {
+    new_arms[i] = shared;
+  }
+  XLS_ASSIGN_OR_RETURN(Node * new_select, MakeSelectLike(select, new_arms));
+  XLS_RETURN_IF_ERROR(select->ReplaceUsesWith(new_select));
+  return new_select;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ResourceSharingPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const PassOptions& options, PassResults* results) const {
+  std::optional<int64_t> max_delay_increase_ps =
+      max_delay_increase_ps_.has_value()
+          ? max_delay_increase_ps_
+          : options.resource_sharing_max_delay_increase_ps;
+  if (!max_delay_increase_ps.has_value()) {
+    return false;
+  }
+
+  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
+  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+
+  CostModel cost_model(delay_estimator_ == nullptr
+                           ? GetStandardDelayEstimator()
+                           : *delay_estimator_);
+  cost_model.Update(f);
+
+  bool changed = false;
+  for (Node* node : TopoSort(f)) {
+    if ((!node->Is<Select>() && !node->Is<OneHotSelect>()) ||
+        !node->GetType()->IsBits() || node->IsDead()) {
+      continue;
+    }
+    // Groups are computed up front. Each replacement select has the same arms
+    // as the select it replaces so the arm indices remain valid.
+    Node* select = node;
+    std::vector<Node*> arms = GetArms(select);
+    for (const std::vector<int64_t>& group : GetShareableGroups(select, arms)) {
+      XLS_ASSIGN_OR_RETURN(Node * new_select,
+                           ShareGroup(select, group, query_engine, cost_model,
+                                      max_delay_increase_ps.value()));
+      if (new_select != nullptr) {
+        select = new_select;
+        cost_model.Update(f);
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+}  // namespace xls
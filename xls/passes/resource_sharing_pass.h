@@ -0,0 +1,71 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_RESOURCE_SHARING_PASS_H_
+#define XLS_PASSES_RESOURCE_SHARING_PASS_H_
+
+#include <optional>
+
+#include "absl/status/statusor.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+
+// Pass which shares expensive arithmetic operations (multiplies, divides,
+// adds, etc) which feed mutually exclusive arms of a select. For example:
+//
+//   sel(s, cases=[umul(a, b), umul(c, d)])
+//
+// becomes:
+//
+//   umul(sel(s, cases=[a, c]), sel(s, cases=[b, d]))
+//
+// Arms of a select are always mutually exclusive. Arms of a one-hot-select are
+// shared only if the query engine proves that at most one of the respective
+// selector bits is set.
+//
+// Sharing trades area for delay as the operand muxes are placed in front of the
+// shared operation. A set of operations is shared only if the estimated area
+// saved exceeds the area of the added muxes and the critical-path delay of the
+// function grows by no more than the delay budget. Area is estimated from bit
+// widths.
+class ResourceSharingPass : public FunctionBasePass {
+ public:
+  // 'max_delay_increase_ps' is the delay budget. If not given, the budget is
+  // taken from PassOptions::resource_sharing_max_delay_increase_ps, and the
+  // pass does nothing if that is not set either. 'delay_estimator' defaults to
+  // the standard delay estimator.
+  explicit ResourceSharingPass(
+      std::optional<int64_t> max_delay_increase_ps = std::nullopt,
+      const DelayEstimator* delay_estimator = nullptr)
+      : FunctionBasePass("resource_sharing", "Resource sharing"),
+        max_delay_increase_ps_(max_delay_increase_ps),
+        delay_estimator_(delay_estimator) {}
+  ~ResourceSharingPass() override {}
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const PassOptions& options,
+      PassResults* results) const override;
+
+ private:
+  std::optional<int64_t> max_delay_increase_ps_;
+  const DelayEstimator* delay_estimator_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_RESOURCE_SHARING_PASS_H_
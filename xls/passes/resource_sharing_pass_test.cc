@@ -0,0 +1,217 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/resource_sharing_pass.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/dce_pass.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class ResourceSharingPassTest : public IrTestBase {
+ protected:
+  ResourceSharingPassTest() = default;
+
+  absl::StatusOr<bool> Run(Function* f, int64_t max_delay_increase_ps) {
+    XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                         GetDelayEstimator("unit"));
+    PassResults results;
+    XLS_ASSIGN_OR_RETURN(
+        bool changed,
+        ResourceSharingPass(max_delay_increase_ps, delay_estimator)
+            .RunOnFunctionBase(f, PassOptions(), &results));
+    XLS_RETURN_IF_ERROR(DeadCodeEliminationPass()
+                            .RunOnFunctionBase(f, PassOptions(), &results)
+                            .status());
+    return changed;
+  }
+};
+
+TEST_F(ResourceSharingPassTest, ShareMultipliersUnderSelect) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  fb.Select(s, {fb.UMul(a, b), fb.UMul(c, d)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/100), IsOkAndHolds(true));
+  auto shared_mul =
+      m::UMul(m::Select(m::Param("s"), {m::Param("a"), m::Param("c")}),
+              m::Select(m::Param("s"), {m::Param("b"), m::Param("d")}));
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::Param("s"), {shared_mul, shared_mul}));
+  EXPECT_EQ(f->return_value()->operand(1), f->return_value()->operand(2));
+}
+
+TEST_F(ResourceSharingPassTest, ShareSubsetOfArms) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(2));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  fb.Select(s, {fb.UMul(a, b), fb.Add(a, b), fb.UMul(c, d)},
+            /*default_value=*/fb.Literal(UBits(0, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/100), IsOkAndHolds(true));
+  auto shared_mul = m::UMul(
+      m::Select(m::Param("s"), {m::Param("a"), m::Param("a"), m::Param("c")},
+                m::Param("a")),
+      m::Select(m::Param("s"), {m::Param("b"), m::Param("b"), m::Param("d")},
+                m::Param("b")));
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::Param("s"),
+                        {shared_mul, m::Add(m::Param("a"), m::Param("b")),
+                         shared_mul},
+                        m::Literal(0)));
+}
+
+TEST_F(ResourceSharingPassTest, DelayLimitPreventsSharing) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  fb.Select(s, {fb.UMul(a, b), fb.UMul(c, d)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // Sharing adds a mux to the critical path.
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/0), IsOkAndHolds(false));
+}
+
+TEST_F(ResourceSharingPassTest, DelayBudgetFromPassOptions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  fb.Select(s, {fb.UMul(a, b), fb.UMul(c, d)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  ResourceSharingPass pass(/*max_delay_increase_ps=*/std::nullopt,
+                           delay_estimator);
+  PassResults results;
+  // Without a delay budget the pass is disabled.
+  EXPECT_THAT(pass.RunOnFunctionBase(f, PassOptions(), &results),
+              IsOkAndHolds(false));
+
+  PassOptions options;
+  options.resource_sharing_max_delay_increase_ps = 100;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+}
+
+TEST_F(ResourceSharingPassTest, AddersNotWorthSharing) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  fb.Select(s, {fb.Add(a, b), fb.Add(c, d)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // The two operand muxes are as large as the adder saved.
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/100), IsOkAndHolds(false));
+}
+
+TEST_F(ResourceSharingPassTest, OperationWithOtherUsersNotShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  BValue ab = fb.UMul(a, b);
+  fb.Tuple({fb.Select(s, {ab, fb.UMul(c, d)}), ab});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/100), IsOkAndHolds(false));
+}
+
+TEST_F(ResourceSharingPassTest, ShareUnderExclusiveOneHotSelect) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  BValue selector = fb.Concat({s, fb.Not(s)});
+  fb.OneHotSelect(selector, {fb.UMul(a, b), fb.UMul(c, d)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/100), IsOkAndHolds(true));
+  auto shared_mul = m::UMul(
+      m::OneHotSelect(m::Concat(), {m::Param("a"), m::Param("c")}),
+      m::OneHotSelect(m::Concat(), {m::Param("b"), m::Param("d")}));
+  EXPECT_THAT(f->return_value(),
+              m::OneHotSelect(m::Concat(), {shared_mul, shared_mul}));
+}
+
+TEST_F(ResourceSharingPassTest, NonExclusiveOneHotSelectNotShared) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue s = fb.Param("s", p->GetBitsType(2));
+  BValue a = fb.Param("a", u32);
+  BValue b = fb.Param("b", u32);
+  BValue c = fb.Param("c", u32);
+  BValue d = fb.Param("d", u32);
+  fb.OneHotSelect(s, {fb.UMul(a, b), fb.UMul(c, d)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, /*max_delay_increase_ps=*/100), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
@@ -38,7 +38,9 @@
 #include "xls/passes/map_inlining_pass.h"
 #include "xls/passes/narrowing_pass.h"
 #include "xls/passes/proc_inlining_pass.h"
+#include "xls/passes/proc_state_optimization_pass.h"
 #include "xls/passes/reassociation_pass.h"
+#include "xls/passes/resource_sharing_pass.h"
 #include "xls/passes/select_simplification_pass.h"
 #include "xls/passes/sparsify_select_pass.h"
 #include "xls/passes/strength_reduction_pass.h"
@@ -126,6 +128,9 @@ std::unique_ptr<CompoundPass> CreateStandardPassPipeline(int64_t opt_level) {
   top->Add<DeadCodeEliminationPass>();
   top->Add<ArithSimplificationPass>(opt_level);
   top->Add<DeadCodeEliminationPass>();
+  // Only runs when PassOptions::resource_sharing_max_delay_increase_ps is set.
+  top->Add<ResourceSharingPass>();
+  top->Add<DeadCodeEliminationPass>();
   top->Add<CsePass>();
   top->Add<SparsifySelectPass>();
   top->Add<DeadCodeEliminationPass>();
@@ -135,6 +140,8 @@ std::unique_ptr<CompoundPass> CreateStandardPassPipeline(int64_t opt_level) {
 
   top->Add<ProcInliningPass>();
   top->Add<DeadCodeEliminationPass>();
+  top->Add<ProcStateOptimizationPass>();
+  top->Add<DeadCodeEliminationPass>();
 
   top->Add<BddSimplificationPass>(std::min(int64_t{3}, opt_level));
   top->Add<DeadCodeEliminationPass>();
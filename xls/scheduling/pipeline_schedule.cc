@@ -22,8 +22,12 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/data_structures/binary_search.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/function_partition.h"
+#include "xls/scheduling/resource_sharing.h"
 #include "xls/scheduling/schedule_bounds.h"
 
 namespace xls {
@@ -347,6 +351,106 @@ std::vector<int64_t> MiddleFirstOrder(int64_t first, int64_t last) {
   return ret;
 }
 
+// Moves nodes which may share a functional unit between cycles to balance
+// their number in each modulo slot (cycle modulo `initiation_interval`). The
+// number of units needed for a resource class is the largest number of its
+// operations in any one slot. A node is only moved within the cycles allowed
+// by its operands and users, and only if the cycle it moves to still meets the
+// clock period.
+absl::Status BalanceModuloSlots(FunctionBase* f, int64_t initiation_interval,
+                                int64_t schedule_length,
+                                int64_t clock_period_ps,
+                                const DelayEstimator& delay_estimator,
+                                ScheduleCycleMap* cycle_map) {
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+
+  // Shareable nodes grouped by resource class. Classes are kept in order of
+  // first appearance so the result is deterministic.
+  std::vector<ResourceClass> resource_classes;
+  absl::flat_hash_map<ResourceClass, std::vector<Node*>> class_nodes;
+  for (Node* node : topo_sort) {
+    absl::optional<ResourceClass> resource_class = GetResourceClass(node);
+    if (!resource_class.has_value() || f->HasImplicitUse(node)) {
+      continue;
+    }
+    if (!class_nodes.contains(*resource_class)) {
+      resource_classes.push_back(*resource_class);
+    }
+    class_nodes[*resource_class].push_back(node);
+  }
+
+  auto meets_timing = [&](int64_t cycle) -> absl::StatusOr<bool> {
+    std::vector<Node*> nodes;
+    for (Node* node : topo_sort) {
+      if (cycle_map->at(node) == cycle) {
+        nodes.push_back(node);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t critical_path,
+                         ComputeCriticalPath(nodes, delay_estimator));
+    return critical_path <= clock_period_ps;
+  };
+
+  for (const ResourceClass& resource_class : resource_classes) {
+    const std::vector<Node*>& nodes = class_nodes.at(resource_class);
+    std::vector<int64_t> slot_counts(initiation_interval, 0);
+    for (Node* node : nodes) {
+      ++slot_counts[cycle_map->at(node) % initiation_interval];
+    }
+
+    // Each move takes a node from a slot with the maximum count to a slot
+    // with at least two fewer nodes, which strictly decreases the sum of the
+    // squares of the counts, so this terminates.
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      int64_t max_count =
+          *std::max_element(slot_counts.begin(), slot_counts.end());
+      for (Node* node : nodes) {
+        int64_t original_cycle = cycle_map->at(node);
+        if (slot_counts[original_cycle % initiation_interval] != max_count) {
+          continue;
+        }
+        int64_t earliest = 0;
+        for (Node* operand : node->operands()) {
+          earliest = std::max(earliest, cycle_map->at(operand));
+        }
+        int64_t latest = schedule_length - 1;
+        for (Node* user : node->users()) {
+          latest = std::min(latest, cycle_map->at(user));
+        }
+        for (int64_t cycle = earliest; cycle <= latest; ++cycle) {
+          if (slot_counts[cycle % initiation_interval] + 1 >= max_count) {
+            continue;
+          }
+          // Removing the node from its original cycle cannot lengthen that
+          // cycle's critical path so only the new cycle needs checking.
+          (*cycle_map)[node] = cycle;
+          XLS_ASSIGN_OR_RETURN(bool meets_timing_in_cycle,
+                               meets_timing(cycle));
+          if (meets_timing_in_cycle) {
+            XLS_VLOG(3) << absl::StreamFormat(
+                "Moved %s from cycle %d to cycle %d", node->GetName(),
+                original_cycle, cycle);
+            --slot_counts[original_cycle % initiation_interval];
+            ++slot_counts[cycle % initiation_interval];
+            changed = true;
+            break;
+          }
+          (*cycle_map)[node] = original_cycle;
+        }
+        if (changed) {
+          break;
+        }
+      }
+    }
+    XLS_VLOG(2) << absl::StreamFormat(
+        "%s: %d operations, %d units", resource_class.ToString(), nodes.size(),
+        *std::max_element(slot_counts.begin(), slot_counts.end()));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
@@ -377,8 +481,11 @@ std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
 
 PipelineSchedule::PipelineSchedule(FunctionBase* function_base,
                                    ScheduleCycleMap cycle_map,
-                                   absl::optional<int64_t> length)
-    : function_base_(function_base), cycle_map_(std::move(cycle_map)) {
+                                   absl::optional<int64_t> length,
+                                   int64_t initiation_interval)
+    : function_base_(function_base),
+      cycle_map_(std::move(cycle_map)),
+      initiation_interval_(initiation_interval) {
   // Build the mapping from cycle to the vector of nodes in that cycle.
   int64_t max_cycle = MaximumCycle(cycle_map_);
   if (length.has_value()) {
@@ -418,7 +525,8 @@ absl::StatusOr<PipelineSchedule> PipelineSchedule::FromProto(
       cycle_map[node] = stage.stage();
     }
   }
-  return PipelineSchedule(function, cycle_map);
+  return PipelineSchedule(function, cycle_map, /*length=*/absl::nullopt,
+                          proto.initiation_interval());
 }
 
 absl::Span<Node* const> PipelineSchedule::nodes_in_cycle(int64_t cycle) const {
@@ -463,6 +571,74 @@ class DelayEstimatorWithInputDelay : public DelayEstimator {
   const DelayEstimator* base_delay_estimator_;
   int64_t input_delay_;
 };
+
+// Charges operations which may share a functional unit in a pipeline with an
+// initiation interval greater than one for the multiplexers codegen inserts to
+// select the operands of the shared unit in each phase (see
+// ModuloResourceSharingPass). Without this, a schedule which meets timing can
+// produce a block which does not.
+class DelayEstimatorWithSharingMuxes : public DelayEstimator {
+ public:
+  DelayEstimatorWithSharingMuxes(const DelayEstimator& base,
+                                 int64_t initiation_interval)
+      : DelayEstimator(absl::StrFormat("%s_with_sharing_muxes", base.name())),
+        base_delay_estimator_(&base),
+        initiation_interval_(initiation_interval) {}
+
+  virtual absl::StatusOr<int64_t> GetOperationDelayInPs(
+      Node* node) const override {
+    XLS_ASSIGN_OR_RETURN(int64_t base_delay,
+                         base_delay_estimator_->GetOperationDelayInPs(node));
+    absl::optional<ResourceClass> resource_class = GetResourceClass(node);
+    if (initiation_interval_ == 1 || !resource_class.has_value()) {
+      return base_delay;
+    }
+    // The operand muxes are in parallel.
+    int64_t mux_delay = 0;
+    for (int64_t bit_count : resource_class->operand_bit_counts) {
+      XLS_ASSIGN_OR_RETURN(int64_t operand_mux_delay,
+                           GetMuxDelayInPs(bit_count));
+      mux_delay = std::max(mux_delay, operand_mux_delay);
+    }
+    return base_delay + mux_delay;
+  }
+
+ private:
+  // Returns the delay of a select on the phase counter between
+  // `initiation_interval_` values of the given width. The delay model only
+  // estimates existing nodes so the select is built in a scratch package.
+  absl::StatusOr<int64_t> GetMuxDelayInPs(int64_t bit_count) const {
+    auto it = mux_delays_.find(bit_count);
+    if (it != mux_delays_.end()) {
+      return it->second;
+    }
+    Package package("sharing_mux");
+    FunctionBuilder fb("sharing_mux", &package);
+    int64_t phase_width = Bits::MinBitCountUnsigned(initiation_interval_ - 1);
+    BValue phase = fb.Param("phase", package.GetBitsType(phase_width));
+    std::vector<BValue> cases;
+    for (int64_t i = 0; i < initiation_interval_; ++i) {
+      cases.push_back(
+          fb.Param(absl::StrCat("case_", i), package.GetBitsType(bit_count)));
+    }
+    absl::optional<BValue> default_value;
+    if ((int64_t{1} << phase_width) > initiation_interval_) {
+      default_value = cases.front();
+    }
+    fb.Select(phase, cases, default_value);
+    XLS_ASSIGN_OR_RETURN(Function * f, fb.Build());
+    XLS_ASSIGN_OR_RETURN(
+        int64_t delay,
+        base_delay_estimator_->GetOperationDelayInPs(f->return_value()));
+    mux_delays_[bit_count] = delay;
+    return delay;
+  }
+
+  const DelayEstimator* base_delay_estimator_;
+  int64_t initiation_interval_;
+  // Mux delays by operand width.
+  mutable absl::flat_hash_map<int64_t, int64_t> mux_delays_;
+};
 }  // namespace
 
 /*static*/ absl::StatusOr<PipelineSchedule> PipelineSchedule::Run(
@@ -472,8 +648,21 @@ class DelayEstimatorWithInputDelay : public DelayEstimator {
                             ? options.additional_input_delay_ps().value()
                             : 0;
 
-  DelayEstimatorWithInputDelay delay_estimator_with_delay(delay_estimator,
-                                                          input_delay);
+  DelayEstimatorWithInputDelay delay_estimator_with_input_delay(
+      delay_estimator, input_delay);
+
+  int64_t initiation_interval = options.initiation_interval().value_or(1);
+  if (initiation_interval < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Initiation interval must be positive, is %d", initiation_interval));
+  }
+  if (initiation_interval > 1 && !f->IsFunction()) {
+    return absl::UnimplementedError(
+        "Only functions may be scheduled with an initiation interval greater "
+        "than one.");
+  }
+  DelayEstimatorWithSharingMuxes delay_estimator_with_delay(
+      delay_estimator_with_input_delay, initiation_interval);
 
   int64_t clock_period_ps;
   if (options.clock_period_ps().has_value()) {
@@ -526,7 +715,13 @@ class DelayEstimatorWithInputDelay : public DelayEstimator {
       cycle_map[node] = bounds.lb(node);
     }
   }
-  auto schedule = PipelineSchedule(f, cycle_map, options.pipeline_stages());
+  if (initiation_interval > 1) {
+    XLS_RETURN_IF_ERROR(BalanceModuloSlots(
+        f, initiation_interval, schedule_length, clock_period_ps,
+        delay_estimator_with_delay, &cycle_map));
+  }
+  auto schedule = PipelineSchedule(f, cycle_map, options.pipeline_stages(),
+                                   initiation_interval);
   XLS_RETURN_IF_ERROR(
       schedule.VerifyTiming(clock_period_ps, delay_estimator_with_delay));
   XLS_VLOG_LINES(3, "Schedule\n" + schedule.ToString());
@@ -635,6 +830,9 @@ PipelineScheduleProto PipelineSchedule::ToProto() const {
       stage->add_nodes(node->GetName());
     }
   }
+  if (initiation_interval_ != 1) {
+    proto.set_initiation_interval(initiation_interval_);
+  }
   return proto;
 }
 
@@ -62,6 +62,12 @@ std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length);
 //
 // Once the clock period and pipeline length are determined, a schedule is
 // produced which minimizes the number of pipeline registers.
+//
+// If an initiation interval greater than one is specified, operations which
+// may share a functional unit (see xls/scheduling/resource_sharing.h) are then
+// moved between cycles, within the slack allowed by their dependencies and
+// the clock period, to balance them across modulo slots. This reduces the
+// number of units required after sharing.
 class SchedulingOptions {
  public:
   explicit SchedulingOptions(
@@ -119,6 +125,17 @@ class SchedulingOptions {
     return additional_input_delay_ps_;
   }
 
+  // Sets/gets the initiation interval of the pipeline: the number of cycles
+  // between successive inputs. Only functions may be scheduled with an
+  // initiation interval greater than one.
+  SchedulingOptions& initiation_interval(int64_t value) {
+    initiation_interval_ = value;
+    return *this;
+  }
+  absl::optional<int64_t> initiation_interval() const {
+    return initiation_interval_;
+  }
+
  private:
   SchedulingStrategy strategy_;
   absl::optional<int64_t> clock_period_ps_;
@@ -126,6 +143,7 @@ class SchedulingOptions {
   absl::optional<int64_t> clock_margin_percent_;
   absl::optional<int64_t> period_relaxation_percent_;
   absl::optional<int64_t> additional_input_delay_ps_;
+  absl::optional<int64_t> initiation_interval_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
@@ -148,10 +166,14 @@ class PipelineSchedule {
   // length is not given, then the length equal to the largest cycle in cycle
   // map minus one.
   PipelineSchedule(FunctionBase* function_base, ScheduleCycleMap cycle_map,
-                   absl::optional<int64_t> length = absl::nullopt);
+                   absl::optional<int64_t> length = absl::nullopt,
+                   int64_t initiation_interval = 1);
 
   FunctionBase* function_base() const { return function_base_; }
 
+  // Returns the number of cycles between successive inputs of the pipeline.
+  int64_t initiation_interval() const { return initiation_interval_; }
+
   // Returns whether the given node is contained in this schedule.
   bool IsScheduled(Node* node) const { return cycle_map_.contains(node); }
 
@@ -200,6 +222,8 @@ class PipelineSchedule {
 
   // The nodes scheduled each cycle.
   std::vector<std::vector<Node*>> cycle_to_nodes_;
+
+  int64_t initiation_interval_;
 };
 
 }  // namespace xls
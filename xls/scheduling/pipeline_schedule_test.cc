@@ -745,5 +745,103 @@ TEST_F(PipelineScheduleTest, ProcScheduleWithInputDelay) {
   }
 }
 
+TEST_F(PipelineScheduleTest, InitiationIntervalBalancesModuloSlots) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue x = fb.Param("x", u32);
+  BValue y = fb.Param("y", u32);
+  BValue z = fb.Param("z", u32);
+  BValue m1 = fb.UMul(x, y);
+  BValue m2 = fb.UMul(y, z);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func,
+                           fb.BuildWithReturnValue(fb.Add(m1, m2)));
+
+  SchedulingOptions options;
+  options.pipeline_stages(2).clock_period_ps(3);
+  {
+    // Both multiplies are scheduled in the first stage to minimize registers.
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(func, TestDelayEstimator(), options));
+    EXPECT_EQ(schedule.initiation_interval(), 1);
+    EXPECT_EQ(schedule.cycle(m1.node()), 0);
+    EXPECT_EQ(schedule.cycle(m2.node()), 0);
+  }
+  {
+    // With an initiation interval of two the multiplies are placed in
+    // different modulo slots so they can share a multiplier. Each multiply is
+    // charged for the mux selecting the operands of the shared multiplier, so
+    // the second multiply and the add take the whole clock period.
+    options.initiation_interval(2);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(func, TestDelayEstimator(), options));
+    EXPECT_EQ(schedule.initiation_interval(), 2);
+    EXPECT_EQ(schedule.length(), 2);
+    EXPECT_NE(schedule.cycle(m1.node()), schedule.cycle(m2.node()));
+    XLS_EXPECT_OK(schedule.VerifyTiming(3, TestDelayEstimator()));
+
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule clone,
+        PipelineSchedule::FromProto(func, schedule.ToProto()));
+    EXPECT_EQ(clone.initiation_interval(), 2);
+  }
+  {
+    // The multiplies cannot move if doing so would violate timing once the
+    // mux is included.
+    options.clock_period_ps(2);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(func, TestDelayEstimator(), options));
+    EXPECT_EQ(schedule.cycle(m1.node()), schedule.cycle(m2.node()));
+  }
+}
+
+TEST_F(PipelineScheduleTest, InitiationIntervalChargesSharingMuxDelay) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue x = fb.Param("x", u32);
+  BValue y = fb.Param("y", u32);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func,
+                           fb.BuildWithReturnValue(fb.UMul(x, y)));
+
+  // A multiply fits in the clock period on its own but not behind the mux
+  // which selects the operands of a shared multiplier.
+  SchedulingOptions options;
+  options.pipeline_stages(2).clock_period_ps(1);
+  XLS_EXPECT_OK(PipelineSchedule::Run(func, TestDelayEstimator(), options));
+  options.initiation_interval(2);
+  EXPECT_THAT(PipelineSchedule::Run(func, TestDelayEstimator(), options),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       HasSubstr("greater delay (2ps) than the clock period")));
+}
+
+TEST_F(PipelineScheduleTest, InvalidInitiationInterval) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+  EXPECT_THAT(
+      PipelineSchedule::Run(
+          func, TestDelayEstimator(),
+          SchedulingOptions().pipeline_stages(1).initiation_interval(0)),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Initiation interval must be positive")));
+}
+
+TEST_F(PipelineScheduleTest, ProcWithInitiationInterval) {
+  Package p("p");
+  TokenlessProcBuilder pb("the_proc", Value(UBits(42, 16)), "tkn", "st", &p);
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(pb.GetStateParam()));
+  EXPECT_THAT(
+      PipelineSchedule::Run(
+          proc, TestDelayEstimator(),
+          SchedulingOptions().pipeline_stages(2).initiation_interval(2)),
+      StatusIs(absl::StatusCode::kUnimplemented,
+               HasSubstr("Only functions may be scheduled")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,49 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/resource_sharing.h"
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+
+namespace xls {
+
+std::string ResourceClass::ToString() const {
+  return absl::StrFormat("%s(%s) -> bits[%d]", OpToString(op),
+                         absl::StrJoin(operand_bit_counts, ", "), bit_count);
+}
+
+absl::optional<ResourceClass> GetResourceClass(Node* node) {
+  switch (node->op()) {
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      break;
+    default:
+      return absl::nullopt;
+  }
+  ResourceClass resource_class;
+  resource_class.op = node->op();
+  for (Node* operand : node->operands()) {
+    resource_class.operand_bit_counts.push_back(
+        operand->GetType()->GetFlatBitCount());
+  }
+  resource_class.bit_count = node->GetType()->GetFlatBitCount();
+  return resource_class;
+}
+
+}  // namespace xls
@@ -0,0 +1,76 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_RESOURCE_SHARING_H_
+#define XLS_SCHEDULING_RESOURCE_SHARING_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+// Describes a kind of functional unit which may be shared between the
+// operations of a pipeline with an initiation interval greater than one. In
+// such a pipeline a stage holds valid data only once every `II` cycles, so
+// operations in stages whose index differs modulo the initiation interval (that
+// is, which are in different "modulo slots") never execute in the same cycle
+// and can be multiplexed onto a single unit.
+//
+// Two operations may share a unit only if they perform the same operation on
+// operands and results of the same widths.
+struct ResourceClass {
+  Op op;
+  std::vector<int64_t> operand_bit_counts;
+  int64_t bit_count;
+
+  std::string ToString() const;
+
+  bool operator==(const ResourceClass& other) const {
+    return op == other.op && operand_bit_counts == other.operand_bit_counts &&
+           bit_count == other.bit_count;
+  }
+  bool operator!=(const ResourceClass& other) const {
+    return !(*this == other);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const ResourceClass& resource_class) {
+    return H::combine(std::move(h), resource_class.op,
+                      resource_class.operand_bit_counts,
+                      resource_class.bit_count);
+  }
+};
+
+// Returns the resource class of the given node if it performs an operation
+// which is expensive enough to be worth sharing (multiplies, divides, and
+// modulus). Returns absl::nullopt otherwise.
+absl::optional<ResourceClass> GetResourceClass(Node* node);
+
+// The number of operations of a resource class and the number of functional
+// units which implement them.
+struct ResourceUsage {
+  ResourceClass resource_class;
+  int64_t operation_count;
+  int64_t unit_count;
+};
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_RESOURCE_SHARING_H_
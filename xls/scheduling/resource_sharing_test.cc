@@ -0,0 +1,69 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/resource_sharing.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+class ResourceSharingTest : public IrTestBase {};
+
+TEST_F(ResourceSharingTest, ShareableOperations) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue z = fb.Param("z", p->GetBitsType(16));
+  BValue umul = fb.UMul(x, y);
+  BValue umul_other_order = fb.UMul(y, x);
+  BValue umul_narrow_operand = fb.UMul(x, z, /*result_width=*/32);
+  BValue umul_wide_result = fb.UMul(x, y, /*result_width=*/64);
+  BValue sdiv = fb.SDiv(x, y);
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  absl::optional<ResourceClass> umul_class = GetResourceClass(umul.node());
+  ASSERT_TRUE(umul_class.has_value());
+  EXPECT_EQ(umul_class->op, Op::kUMul);
+  EXPECT_THAT(umul_class->operand_bit_counts, ElementsAre(32, 32));
+  EXPECT_EQ(umul_class->bit_count, 32);
+  EXPECT_EQ(umul_class->ToString(), "umul(32, 32) -> bits[32]");
+
+  EXPECT_EQ(GetResourceClass(umul_other_order.node()), umul_class);
+  EXPECT_NE(GetResourceClass(umul_narrow_operand.node()), umul_class);
+  EXPECT_NE(GetResourceClass(umul_wide_result.node()), umul_class);
+
+  absl::optional<ResourceClass> sdiv_class = GetResourceClass(sdiv.node());
+  ASSERT_TRUE(sdiv_class.has_value());
+  EXPECT_EQ(sdiv_class->op, Op::kSDiv);
+
+  EXPECT_FALSE(GetResourceClass(add.node()).has_value());
+  EXPECT_FALSE(GetResourceClass(x.node()).has_value());
+
+  absl::flat_hash_set<ResourceClass> classes = {
+      *umul_class, *GetResourceClass(umul_other_order.node()), *sdiv_class};
+  EXPECT_EQ(classes.size(), 2);
+}
+
+}  // namespace
+}  // namespace xls
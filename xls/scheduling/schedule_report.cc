@@ -0,0 +1,156 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_report.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+// Delay information for a node computed over the nodes of its stage.
+struct NodeTiming {
+  int64_t node_delay_ps;
+
+  // Delay from the start of the stage through the node.
+  int64_t path_delay_ps;
+
+  // The operand in the same stage through which the longest path to the node
+  // passes, or nullptr if there is none.
+  Node* critical_operand;
+};
+
+ScheduledNodeProto ToScheduledNodeProto(Node* node, const NodeTiming& timing) {
+  ScheduledNodeProto proto;
+  proto.set_node(node->GetName());
+  proto.set_op(OpToString(node->op()));
+  proto.set_node_delay_ps(timing.node_delay_ps);
+  proto.set_path_delay_ps(timing.path_delay_ps);
+  proto.set_bit_count(node->GetType()->GetFlatBitCount());
+  return proto;
+}
+
+}  // namespace
+
+absl::StatusOr<ScheduleReportProto> GenerateScheduleReport(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    absl::optional<int64_t> clock_period_ps, int64_t top_k) {
+  XLS_RET_CHECK_GE(top_k, 0);
+  FunctionBase* f = schedule.function_base();
+
+  absl::flat_hash_map<Node*, NodeTiming> timing;
+  for (Node* node : TopoSort(f)) {
+    NodeTiming& node_timing = timing[node];
+    XLS_ASSIGN_OR_RETURN(node_timing.node_delay_ps,
+                         delay_estimator.GetOperationDelayInPs(node));
+    node_timing.critical_operand = nullptr;
+    int64_t delay_to_node_start = 0;
+    for (Node* operand : node->operands()) {
+      if (schedule.cycle(operand) == schedule.cycle(node) &&
+          timing.at(operand).path_delay_ps > delay_to_node_start) {
+        delay_to_node_start = timing.at(operand).path_delay_ps;
+        node_timing.critical_operand = operand;
+      }
+    }
+    node_timing.path_delay_ps = delay_to_node_start + node_timing.node_delay_ps;
+  }
+
+  ScheduleReportProto report;
+  report.set_function(f->name());
+  report.set_initiation_interval(schedule.initiation_interval());
+
+  // The last node of the critical path of each stage.
+  std::vector<Node*> critical_path_ends(schedule.length(), nullptr);
+  int64_t critical_stage = 0;
+  for (int64_t stage = 0; stage < schedule.length(); ++stage) {
+    for (Node* node : schedule.nodes_in_cycle(stage)) {
+      Node*& end = critical_path_ends[stage];
+      if (end == nullptr ||
+          timing.at(node).path_delay_ps > timing.at(end).path_delay_ps) {
+        end = node;
+      }
+    }
+    auto stage_delay = [&](int64_t s) -> int64_t {
+      Node* end = critical_path_ends[s];
+      return end == nullptr ? 0 : timing.at(end).path_delay_ps;
+    };
+    if (stage_delay(stage) > stage_delay(critical_stage)) {
+      critical_stage = stage;
+    }
+    StageReportProto* stage_report = report.add_stages();
+    stage_report->set_stage(stage);
+    stage_report->set_node_count(schedule.nodes_in_cycle(stage).size());
+    stage_report->set_critical_path_delay_ps(stage_delay(stage));
+  }
+  int64_t period_ps = clock_period_ps.value_or(
+      report.stages().empty()
+          ? 0
+          : report.stages(critical_stage).critical_path_delay_ps());
+  report.set_clock_period_ps(period_ps);
+  report.set_critical_stage(critical_stage);
+
+  int64_t interior_register_bits = 0;
+  for (int64_t stage = 0; stage < schedule.length(); ++stage) {
+    StageReportProto* stage_report = report.mutable_stages(stage);
+    stage_report->set_slack_ps(period_ps -
+                               stage_report->critical_path_delay_ps());
+
+    std::vector<Node*> critical_path;
+    for (Node* node = critical_path_ends[stage]; node != nullptr;
+         node = timing.at(node).critical_operand) {
+      critical_path.push_back(node);
+    }
+    // Sort by decreasing delay. Ties are broken by path order so the report is
+    // deterministic.
+    std::reverse(critical_path.begin(), critical_path.end());
+    std::stable_sort(critical_path.begin(), critical_path.end(),
+                     [&](Node* a, Node* b) {
+                       return timing.at(a).node_delay_ps >
+                              timing.at(b).node_delay_ps;
+                     });
+    for (int64_t i = 0; i < std::min<int64_t>(top_k, critical_path.size());
+         ++i) {
+      *stage_report->add_critical_path_nodes() =
+          ToScheduledNodeProto(critical_path[i], timing.at(critical_path[i]));
+    }
+
+    std::vector<Node*> live_out = schedule.GetLiveOutOfCycle(stage);
+    int64_t register_bits = 0;
+    for (Node* node : live_out) {
+      register_bits += node->GetType()->GetFlatBitCount();
+    }
+    stage_report->set_pipeline_register_bits(register_bits);
+    if (stage + 1 < schedule.length()) {
+      interior_register_bits += register_bits;
+    }
+    std::stable_sort(live_out.begin(), live_out.end(), [](Node* a, Node* b) {
+      return a->GetType()->GetFlatBitCount() > b->GetType()->GetFlatBitCount();
+    });
+    for (int64_t i = 0; i < std::min<int64_t>(top_k, live_out.size()); ++i) {
+      *stage_report->add_pipeline_register_nodes() =
+          ToScheduledNodeProto(live_out[i], timing.at(live_out[i]));
+    }
+  }
+  report.set_interior_pipeline_register_bits(interior_register_bits);
+  return report;
+}
+
+}  // namespace xls
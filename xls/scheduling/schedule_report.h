@@ -0,0 +1,39 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_SCHEDULE_REPORT_H_
+#define XLS_SCHEDULING_SCHEDULE_REPORT_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/schedule_report.pb.h"
+
+namespace xls {
+
+// Generates a report of the critical path delay and pipeline register bits of
+// each stage of the given schedule. Slack is measured against
+// `clock_period_ps` or, if not given, against the delay of the slowest stage.
+// At most `top_k` nodes are listed for the critical path and the pipeline
+// registers of each stage.
+absl::StatusOr<ScheduleReportProto> GenerateScheduleReport(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    absl::optional<int64_t> clock_period_ps, int64_t top_k = 5);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULE_REPORT_H_
@@ -0,0 +1,145 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_report.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+class TestDelayEstimator : public DelayEstimator {
+ public:
+  TestDelayEstimator() : DelayEstimator("test") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    switch (node->op()) {
+      case Op::kConcat:
+      case Op::kLiteral:
+      case Op::kParam:
+        return 0;
+      case Op::kSDiv:
+        return 2;
+      default:
+        return 1;
+    }
+  }
+};
+
+class ScheduleReportTest : public IrTestBase {
+ protected:
+  // Returns the names of the nodes in the given list.
+  std::vector<std::string> NodeNames(
+      const google::protobuf::RepeatedPtrField<ScheduledNodeProto>& nodes) {
+    std::vector<std::string> names;
+    for (const ScheduledNodeProto& node : nodes) {
+      names.push_back(node.node());
+    }
+    return names;
+  }
+};
+
+TEST_F(ScheduleReportTest, TwoStagePipeline) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue z = fb.Param("z", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y, /*loc=*/absl::nullopt, "sum");
+  BValue quotient = fb.SDiv(sum, y, /*loc=*/absl::nullopt, "quotient");
+  BValue inverted = fb.Not(quotient, /*loc=*/absl::nullopt, "inverted");
+  BValue concat = fb.Concat({inverted, z}, /*loc=*/absl::nullopt, "concat");
+  BValue result = fb.Negate(concat, /*loc=*/absl::nullopt, "result");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  PipelineSchedule schedule(f, {{x.node(), 0},
+                                {y.node(), 0},
+                                {z.node(), 0},
+                                {sum.node(), 0},
+                                {quotient.node(), 0},
+                                {inverted.node(), 0},
+                                {concat.node(), 1},
+                                {result.node(), 1}});
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleReportProto report,
+      GenerateScheduleReport(schedule, TestDelayEstimator(),
+                             /*clock_period_ps=*/5, /*top_k=*/2));
+  EXPECT_EQ(report.function(), f->name());
+  EXPECT_EQ(report.clock_period_ps(), 5);
+  EXPECT_EQ(report.initiation_interval(), 1);
+  EXPECT_EQ(report.critical_stage(), 0);
+  EXPECT_EQ(report.interior_pipeline_register_bits(), 40);
+  ASSERT_EQ(report.stages_size(), 2);
+
+  const StageReportProto& stage0 = report.stages(0);
+  EXPECT_EQ(stage0.stage(), 0);
+  EXPECT_EQ(stage0.node_count(), 6);
+  EXPECT_EQ(stage0.critical_path_delay_ps(), 4);
+  EXPECT_EQ(stage0.slack_ps(), 1);
+  EXPECT_THAT(NodeNames(stage0.critical_path_nodes()),
+              ElementsAre("quotient", "sum"));
+  EXPECT_EQ(stage0.critical_path_nodes(0).op(), "sdiv");
+  EXPECT_EQ(stage0.critical_path_nodes(0).node_delay_ps(), 2);
+  EXPECT_EQ(stage0.critical_path_nodes(0).path_delay_ps(), 3);
+  EXPECT_EQ(stage0.pipeline_register_bits(), 40);
+  EXPECT_THAT(NodeNames(stage0.pipeline_register_nodes()),
+              ElementsAre("inverted", "z"));
+  EXPECT_EQ(stage0.pipeline_register_nodes(1).bit_count(), 8);
+
+  const StageReportProto& stage1 = report.stages(1);
+  EXPECT_EQ(stage1.stage(), 1);
+  EXPECT_EQ(stage1.critical_path_delay_ps(), 1);
+  EXPECT_EQ(stage1.slack_ps(), 4);
+  // The concat has no delay so it is not part of the critical path.
+  EXPECT_THAT(NodeNames(stage1.critical_path_nodes()), ElementsAre("result"));
+  EXPECT_EQ(stage1.pipeline_register_bits(), 40);
+  EXPECT_THAT(NodeNames(stage1.pipeline_register_nodes()),
+              ElementsAre("result"));
+}
+
+TEST_F(ScheduleReportTest, SlackAgainstSlowestStage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue negated = fb.Negate(x);
+  BValue result = fb.Not(fb.Not(negated));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  PipelineSchedule schedule(f, {{x.node(), 0},
+                                {negated.node(), 0},
+                                {result.node()->operand(0), 1},
+                                {result.node(), 1}});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleReportProto report,
+      GenerateScheduleReport(schedule, TestDelayEstimator(),
+                             /*clock_period_ps=*/absl::nullopt));
+  EXPECT_EQ(report.clock_period_ps(), 2);
+  EXPECT_EQ(report.critical_stage(), 1);
+  EXPECT_EQ(report.interior_pipeline_register_bits(), 32);
+  ASSERT_EQ(report.stages_size(), 2);
+  EXPECT_EQ(report.stages(0).slack_ps(), 1);
+  EXPECT_EQ(report.stages(1).slack_ps(), 0);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,205 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/aig.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace xls {
+namespace solvers {
+
+std::string AigLiteral::ToString() const {
+  if (IsConstant()) {
+    return negated() ? "true" : "false";
+  }
+  return absl::StrCat(negated() ? "~" : "", "n", node());
+}
+
+Aig::Aig() {
+  // The constant node.
+  nodes_.push_back({AigLiteral::False(), AigLiteral::False()});
+}
+
+AigLiteral Aig::NewInput() {
+  int64_t node = nodes_.size();
+  nodes_.push_back({AigLiteral::True(), AigLiteral::True()});
+  ++input_count_;
+  return AigLiteral(node, /*negated=*/false);
+}
+
+AigLiteral Aig::And(AigLiteral a, AigLiteral b) {
+  if (a.code() > b.code()) {
+    std::swap(a, b);
+  }
+  // Constants have the smallest codes, so only "a" can be one.
+  if (a == AigLiteral::False() || a == ~b) {
+    return AigLiteral::False();
+  }
+  if (a == AigLiteral::True() || a == b) {
+    return b;
+  }
+
+  absl::optional<AigLiteral> rewritten;
+  if (IsAnd(a.node()) && IsAnd(b.node())) {
+    rewritten = RewriteTwoLevel(a, b);
+  }
+  if (!rewritten.has_value() && IsAnd(a.node())) {
+    rewritten = RewriteOneLevel(a, b);
+  }
+  if (!rewritten.has_value() && IsAnd(b.node())) {
+    rewritten = RewriteOneLevel(b, a);
+  }
+  if (rewritten.has_value()) {
+    ++rewrite_count_;
+    return *rewritten;
+  }
+
+  auto [it, inserted] =
+      and_gates_.insert({{a.code(), b.code()}, node_count()});
+  if (!inserted) {
+    ++structural_hash_hits_;
+    return AigLiteral(it->second, /*negated=*/false);
+  }
+  nodes_.push_back({a, b});
+  return AigLiteral(it->second, /*negated=*/false);
+}
+
+absl::optional<AigLiteral> Aig::RewriteOneLevel(AigLiteral a, AigLiteral b) {
+  AigLiteral a0 = fanin0(a.node());
+  AigLiteral a1 = fanin1(a.node());
+  if (!a.negated()) {
+    // Contradiction: (x & y) & ~x => 0.
+    if (a0 == ~b || a1 == ~b) {
+      return AigLiteral::False();
+    }
+    // Idempotence: (x & y) & x => x & y.
+    if (a0 == b || a1 == b) {
+      return a;
+    }
+    return absl::nullopt;
+  }
+  // Subsumption: ~(x & y) & ~x => ~x.
+  if (a0 == ~b || a1 == ~b) {
+    return b;
+  }
+  // Substitution: ~(x & y) & x => x & ~y.
+  if (a0 == b) {
+    return And(b, ~a1);
+  }
+  if (a1 == b) {
+    return And(b, ~a0);
+  }
+  return absl::nullopt;
+}
+
+absl::optional<AigLiteral> Aig::RewriteTwoLevel(AigLiteral a, AigLiteral b) {
+  if (a.negated() && !b.negated()) {
+    std::swap(a, b);
+  }
+  AigLiteral a0 = fanin0(a.node());
+  AigLiteral a1 = fanin1(a.node());
+  AigLiteral b0 = fanin0(b.node());
+  AigLiteral b1 = fanin1(b.node());
+  auto any_complementary = [&]() {
+    return a0 == ~b0 || a0 == ~b1 || a1 == ~b0 || a1 == ~b1;
+  };
+  if (!a.negated() && !b.negated()) {
+    // Contradiction: (x & y) & (~x & z) => 0.
+    if (any_complementary()) {
+      return AigLiteral::False();
+    }
+    // Idempotence: (x & y) & (x & z) => (x & y) & z.
+    if (b0 == a0 || b0 == a1) {
+      return And(a, b1);
+    }
+    if (b1 == a0 || b1 == a1) {
+      return And(a, b0);
+    }
+    return absl::nullopt;
+  }
+  if (!a.negated()) {
+    // "a" is positive and "b" negated.
+    // Subsumption: (x & y) & ~(~x & z) => x & y.
+    if (any_complementary()) {
+      return a;
+    }
+    // Substitution: (x & y) & ~(x & z) => (x & y) & ~z.
+    if (b0 == a0 || b0 == a1) {
+      return And(a, ~b1);
+    }
+    if (b1 == a0 || b1 == a1) {
+      return And(a, ~b0);
+    }
+    return absl::nullopt;
+  }
+  // Resolution: ~(x & y) & ~(x & ~y) => ~x.
+  if ((a0 == b0 && a1 == ~b1) || (a0 == b1 && a1 == ~b0)) {
+    return ~a0;
+  }
+  if ((a1 == b1 && a0 == ~b0) || (a1 == b0 && a0 == ~b1)) {
+    return ~a1;
+  }
+  return absl::nullopt;
+}
+
+SatLiteral AigSatEncoder::Encode(AigLiteral literal) {
+  SatLiteral encoded = EncodeNode(literal.node());
+  return literal.negated() ? ~encoded : encoded;
+}
+
+SatLiteral AigSatEncoder::EncodeNode(int64_t root) {
+  // Gates are encoded in post order, with an explicit stack as AIGs of
+  // arithmetic can be very deep.
+  std::vector<int64_t> stack = {root};
+  while (!stack.empty()) {
+    int64_t node = stack.back();
+    if (encoded_.contains(node)) {
+      stack.pop_back();
+      continue;
+    }
+    if (!aig_->IsAnd(node)) {
+      SatLiteral variable = SatLiteral::Positive(solver_->NewVariable());
+      if (node == 0) {
+        solver_->AddClause({~variable});
+      }
+      encoded_.insert({node, variable});
+      stack.pop_back();
+      continue;
+    }
+    AigLiteral fanin0 = aig_->fanin0(node);
+    AigLiteral fanin1 = aig_->fanin1(node);
+    bool ready = true;
+    for (AigLiteral fanin : {fanin0, fanin1}) {
+      if (!encoded_.contains(fanin.node())) {
+        stack.push_back(fanin.node());
+        ready = false;
+      }
+    }
+    if (!ready) {
+      continue;
+    }
+    stack.pop_back();
+    SatLiteral x = Encode(fanin0);
+    SatLiteral y = Encode(fanin1);
+    SatLiteral gate = SatLiteral::Positive(solver_->NewVariable());
+    solver_->AddClause({~gate, x});
+    solver_->AddClause({~gate, y});
+    solver_->AddClause({gate, ~x, ~y});
+    encoded_.insert({node, gate});
+  }
+  return encoded_.at(root);
+}
+
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,148 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_AIG_H_
+#define XLS_SOLVERS_AIG_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "xls/common/logging/logging.h"
+#include "xls/solvers/sat_solver.h"
+
+namespace xls {
+namespace solvers {
+
+// A literal of an and-inverter graph: an AIG node or its complement.
+class AigLiteral {
+ public:
+  static AigLiteral False() { return AigLiteral(0); }
+  static AigLiteral True() { return AigLiteral(1); }
+
+  // The default literal is the constant false.
+  AigLiteral() : code_(0) {}
+  AigLiteral(int64_t node, bool negated)
+      : code_((static_cast<uint32_t>(node) << 1) |
+              static_cast<uint32_t>(negated)) {}
+
+  int64_t node() const { return code_ >> 1; }
+  bool negated() const { return (code_ & 1) != 0; }
+  bool IsConstant() const { return node() == 0; }
+
+  // Dense encoding of the literal (2 * node + negated).
+  uint32_t code() const { return code_; }
+
+  AigLiteral operator~() const { return AigLiteral(code_ ^ 1); }
+  bool operator==(const AigLiteral& other) const {
+    return code_ == other.code_;
+  }
+  bool operator!=(const AigLiteral& other) const {
+    return code_ != other.code_;
+  }
+
+  std::string ToString() const;
+
+ private:
+  explicit AigLiteral(uint32_t code) : code_(code) {}
+
+  uint32_t code_;
+};
+
+// An and-inverter graph: a Boolean circuit of two-input AND gates with
+// optionally complemented edges. Node 0 is the constant false.
+//
+// And() never creates redundant gates: requests for an existing gate return
+// it (structural hashing), and the two-level minimization rules of Brummayer
+// and Biere ("Local Two-Level And-Inverter Graph Minimization without
+// Blowup", 2006) rewrite gates whose inputs are themselves gates, e.g.,
+// a & (a & b) => a & b, or a & ~(a & b) => a & ~b.
+class Aig {
+ public:
+  Aig();
+
+  Aig(const Aig&) = delete;
+  Aig& operator=(const Aig&) = delete;
+
+  // Returns a new primary input.
+  AigLiteral NewInput();
+
+  AigLiteral And(AigLiteral a, AigLiteral b);
+  AigLiteral Or(AigLiteral a, AigLiteral b) { return ~And(~a, ~b); }
+
+  bool IsInput(int64_t node) const {
+    return nodes_.at(node).first == AigLiteral::True();
+  }
+  bool IsAnd(int64_t node) const {
+    return node != 0 && nodes_.at(node).first != AigLiteral::True();
+  }
+  AigLiteral fanin0(int64_t node) const {
+    XLS_CHECK(IsAnd(node));
+    return nodes_[node].first;
+  }
+  AigLiteral fanin1(int64_t node) const {
+    XLS_CHECK(IsAnd(node));
+    return nodes_[node].second;
+  }
+
+  // Number of nodes, including the constant.
+  int64_t node_count() const { return nodes_.size(); }
+  int64_t input_count() const { return input_count_; }
+  int64_t and_count() const { return node_count() - input_count() - 1; }
+
+  // Number of calls to And() answered by an existing gate or a rewrite rather
+  // than by a new gate.
+  int64_t structural_hash_hits() const { return structural_hash_hits_; }
+  int64_t rewrite_count() const { return rewrite_count_; }
+
+ private:
+  // Applies the rewriting rules where "a" is an AND gate, returning nullopt
+  // if none applies.
+  absl::optional<AigLiteral> RewriteOneLevel(AigLiteral a, AigLiteral b);
+  absl::optional<AigLiteral> RewriteTwoLevel(AigLiteral a, AigLiteral b);
+
+  // Fanins of each node. Inputs have fanins True, which is never a fanin of
+  // an AND gate.
+  std::vector<std::pair<AigLiteral, AigLiteral>> nodes_;
+  absl::flat_hash_map<std::pair<uint32_t, uint32_t>, int64_t> and_gates_;
+  int64_t input_count_ = 0;
+  int64_t structural_hash_hits_ = 0;
+  int64_t rewrite_count_ = 0;
+};
+
+// Encodes AIG literals as SAT literals by the Tseitin transformation. Only the
+// cones of influence of the encoded literals are added to the solver, each
+// gate once, so a single encoder can incrementally serve many queries.
+class AigSatEncoder {
+ public:
+  AigSatEncoder(const Aig* aig, SatSolver* solver)
+      : aig_(aig), solver_(solver) {}
+
+  SatLiteral Encode(AigLiteral literal);
+
+ private:
+  SatLiteral EncodeNode(int64_t node);
+
+  const Aig* aig_;
+  SatSolver* solver_;
+  absl::flat_hash_map<int64_t, SatLiteral> encoded_;
+};
+
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_AIG_H_
@@ -0,0 +1,483 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/aig_ir_translator.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/abstract_evaluator.h"
+#include "xls/ir/abstract_node_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/solvers/equivalence_utils.h"
+#include "xls/solvers/sat_solver.h"
+
+namespace xls {
+namespace solvers {
+namespace aig {
+namespace {
+
+// Abstract evaluator whose bits are AIG literals, i.e., which bit-blasts IR
+// operations into the AIG.
+class AigEvaluator : public AbstractEvaluator<AigLiteral, AigEvaluator> {
+ public:
+  explicit AigEvaluator(Aig* aig) : aig_(aig) {}
+
+  AigLiteral One() const { return AigLiteral::True(); }
+  AigLiteral Zero() const { return AigLiteral::False(); }
+  AigLiteral Not(const AigLiteral& input) const { return ~input; }
+  AigLiteral And(const AigLiteral& a, const AigLiteral& b) const {
+    return aig_->And(a, b);
+  }
+  AigLiteral Or(const AigLiteral& a, const AigLiteral& b) const {
+    return aig_->Or(a, b);
+  }
+
+ private:
+  Aig* aig_;
+};
+
+void FlattenValue(const Value& value, AigVector* result) {
+  if (value.IsBits()) {
+    for (int64_t i = 0; i < value.bits().bit_count(); ++i) {
+      result->push_back(value.bits().Get(i) ? AigLiteral::True()
+                                            : AigLiteral::False());
+    }
+    return;
+  }
+  if (value.IsTuple() || value.IsArray()) {
+    for (const Value& element : value.elements()) {
+      FlattenValue(element, result);
+    }
+  }
+}
+
+AigVector Slice(const AigVector& input, int64_t start, int64_t width) {
+  return AigVector(input.begin() + start, input.begin() + start + width);
+}
+
+std::vector<AigVector> ArrayElements(const AigVector& array, ArrayType* type) {
+  int64_t width = type->element_type()->GetFlatBitCount();
+  std::vector<AigVector> elements;
+  for (int64_t i = 0; i < type->size(); ++i) {
+    elements.push_back(Slice(array, i * width, width));
+  }
+  return elements;
+}
+
+// Selects elements[index], or the last element if "index" is out of bounds.
+AigVector SelectClamped(AigEvaluator* evaluator, const AigVector& index,
+                        absl::Span<const AigVector> elements) {
+  if (index.empty() || elements.size() == 1) {
+    return elements.front();
+  }
+  if (index.size() < 63 && (int64_t{1} << index.size()) <= elements.size()) {
+    // All values of "index" are in bounds.
+    return evaluator->Select(
+        index, elements.subspan(0, int64_t{1} << index.size()));
+  }
+  return evaluator->Select(index, elements, elements.back());
+}
+
+AigVector FlatArrayIndex(AigEvaluator* evaluator, Type* type,
+                         const AigVector& array,
+                         absl::Span<const AigVector> indices) {
+  AigVector result = array;
+  for (const AigVector& index : indices) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    result = SelectClamped(evaluator, index, ArrayElements(result, array_type));
+    type = array_type->element_type();
+  }
+  return result;
+}
+
+// Out-of-bounds updates leave the array unchanged.
+AigVector FlatArrayUpdate(AigEvaluator* evaluator, Type* type,
+                          const AigVector& array, const AigVector& value,
+                          absl::Span<const AigVector> indices) {
+  if (indices.empty()) {
+    return value;
+  }
+  ArrayType* array_type = type->AsArrayOrDie();
+  const AigVector& index = indices.front();
+  std::vector<AigVector> elements = ArrayElements(array, array_type);
+  AigVector result;
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    const AigVector& element = elements[i];
+    AigVector updated =
+        FlatArrayUpdate(evaluator, array_type->element_type(), element, value,
+                        indices.subspan(1));
+    AigVector selected = element;
+    if (Bits::MinBitCountUnsigned(i) <= index.size()) {
+      AigLiteral hit =
+          evaluator->Equals(index, evaluator->BitsToVector(
+                                       UBits(i, index.size())));
+      selected = evaluator->Select({hit}, {element, updated});
+    }
+    result.insert(result.end(), selected.begin(), selected.end());
+  }
+  return result;
+}
+
+// Elements [start, start + width) of the array, where out-of-bounds indices
+// select the last element.
+AigVector FlatArraySlice(AigEvaluator* evaluator, ArrayType* type,
+                         const AigVector& array, const AigVector& start,
+                         int64_t width) {
+  std::vector<AigVector> elements = ArrayElements(array, type);
+  int64_t index_width = start.size() + Bits::MinBitCountUnsigned(width) + 1;
+  AigVector wide_start = evaluator->ZeroExtend(start, index_width);
+  AigVector result;
+  for (int64_t i = 0; i < width; ++i) {
+    AigVector index = evaluator->Add(
+        wide_start, evaluator->BitsToVector(UBits(i, index_width)));
+    AigVector element = SelectClamped(evaluator, index, elements);
+    result.insert(result.end(), element.begin(), element.end());
+  }
+  return result;
+}
+
+// Searches for an assignment of the parameters of "f" under which "violation"
+// holds.
+absl::StatusOr<ProofReport> Refute(Aig* aig, AigLiteral violation,
+                                   Function* f,
+                                   const AigIrTranslator& translator,
+                                   absl::Duration timeout) {
+  ProofReport report;
+  report.and_count = aig->and_count();
+  report.structural_hash_hits = aig->structural_hash_hits();
+  report.rewrite_count = aig->rewrite_count();
+  if (violation == AigLiteral::False()) {
+    // Settled by the AIG construction alone.
+    report.result = ProofResult::kProven;
+    return report;
+  }
+
+  SatSolver solver;
+  AigSatEncoder encoder(aig, &solver);
+  solver.AddClause({encoder.Encode(violation)});
+  // The parameters are encoded up front so their values are in the model.
+  std::vector<std::vector<SatLiteral>> param_bits;
+  for (Param* param : f->params()) {
+    std::vector<SatLiteral>& bits = param_bits.emplace_back();
+    for (AigLiteral literal : translator.GetTranslation(param)) {
+      bits.push_back(encoder.Encode(literal));
+    }
+  }
+  SatResult result =
+      solver.Solve({}, std::numeric_limits<int64_t>::max(),
+                   absl::Now() + timeout);
+  report.conflict_count = solver.conflict_count();
+  XLS_VLOG(1) << absl::StreamFormat(
+      "SAT: %s after %d conflicts, %d decisions, %d propagations",
+      SatResultToString(result), solver.conflict_count(),
+      solver.decision_count(), solver.propagation_count());
+  switch (result) {
+    case SatResult::kUnsatisfiable:
+      report.result = ProofResult::kProven;
+      break;
+    case SatResult::kUnknown:
+      report.result = ProofResult::kUnknown;
+      break;
+    case SatResult::kSatisfiable: {
+      report.result = ProofResult::kDisproven;
+      std::vector<Value> counterexample;
+      for (int64_t i = 0; i < f->params().size(); ++i) {
+        absl::InlinedVector<bool, 64> bits;
+        for (SatLiteral literal : param_bits[i]) {
+          bits.push_back(solver.ModelValue(literal));
+        }
+        counterexample.push_back(
+            FlatBitsToValue(f->param(i)->GetType(), bits));
+      }
+      report.counterexample = std::move(counterexample);
+      break;
+    }
+  }
+  return report;
+}
+
+}  // namespace
+
+absl::Status AigIrTranslator::Translate(
+    Function* f, absl::Span<Node* const> roots,
+    absl::optional<absl::Span<const AigVector>> params) {
+  if (params.has_value()) {
+    XLS_RET_CHECK_EQ(params->size(), f->params().size());
+  }
+  absl::flat_hash_set<Node*> cone;
+  std::vector<Node*> worklist(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (cone.insert(node).second) {
+      worklist.insert(worklist.end(), node->operands().begin(),
+                      node->operands().end());
+    }
+  }
+
+  for (Node* node : TopoSort(f)) {
+    // Parameters are always translated, so that values can be given for all
+    // of them.
+    if (node->Is<Param>()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, f->GetParamIndex(node->As<Param>()));
+      AigVector& translation = translations_[node];
+      if (params.has_value()) {
+        translation = (*params)[index];
+        XLS_RET_CHECK_EQ(translation.size(),
+                         node->GetType()->GetFlatBitCount());
+      } else {
+        for (int64_t i = 0; i < node->GetType()->GetFlatBitCount(); ++i) {
+          translation.push_back(aig_->NewInput());
+        }
+      }
+      continue;
+    }
+    if (!roots.empty() && !cone.contains(node)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(translations_[node], TranslateNode(node));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<AigVector> AigIrTranslator::TranslateNode(Node* node) {
+  std::vector<AigVector> operands;
+  for (Node* operand : node->operands()) {
+    operands.push_back(translations_.at(operand));
+  }
+  // Operands of commutative operations are put in a canonical order, so that
+  // structural hashing also merges, e.g., umul(x, y) and umul(y, x).
+  if (OpIsCommutative(node->op())) {
+    std::sort(operands.begin(), operands.end(),
+              [](const AigVector& a, const AigVector& b) {
+                if (a.size() != b.size()) {
+                  return a.size() < b.size();
+                }
+                return std::lexicographical_compare(
+                    a.begin(), a.end(), b.begin(), b.end(),
+                    [](AigLiteral x, AigLiteral y) {
+                      return x.code() < y.code();
+                    });
+              });
+  }
+  AigEvaluator evaluator(aig_);
+  auto concat_operands = [&]() {
+    AigVector result;
+    for (const AigVector& operand : operands) {
+      result.insert(result.end(), operand.begin(), operand.end());
+    }
+    return result;
+  };
+
+  switch (node->op()) {
+    case Op::kTuple:
+    case Op::kArray:
+    case Op::kArrayConcat:
+      return concat_operands();
+    case Op::kTupleIndex: {
+      TupleType* type = node->operand(0)->GetType()->AsTupleOrDie();
+      int64_t index = node->As<TupleIndex>()->index();
+      int64_t start = 0;
+      for (int64_t i = 0; i < index; ++i) {
+        start += type->element_type(i)->GetFlatBitCount();
+      }
+      return Slice(operands[0], start,
+                   type->element_type(index)->GetFlatBitCount());
+    }
+    case Op::kArrayIndex:
+      return FlatArrayIndex(&evaluator, node->operand(0)->GetType(),
+                            operands[0],
+                            absl::MakeConstSpan(operands).subspan(1));
+    case Op::kArrayUpdate:
+      return FlatArrayUpdate(&evaluator, node->operand(0)->GetType(),
+                             operands[0], operands[1],
+                             absl::MakeConstSpan(operands).subspan(2));
+    case Op::kArraySlice:
+      return FlatArraySlice(&evaluator,
+                            node->operand(0)->GetType()->AsArrayOrDie(),
+                            operands[0], operands[1],
+                            node->As<ArraySlice>()->width());
+    case Op::kDynamicBitSlice:
+      // Bits shifted in from beyond the operand are zero, as are the
+      // out-of-bounds bits of the slice.
+      return evaluator.BitSlice(
+          evaluator.ShiftRightLogical(operands[0], operands[1]), 0,
+          node->BitCountOrDie());
+    case Op::kGate: {
+      AigVector result;
+      for (AigLiteral bit : operands[1]) {
+        result.push_back(aig_->And(operands[0].front(), bit));
+      }
+      return result;
+    }
+    case Op::kLiteral: {
+      AigVector result;
+      FlattenValue(node->As<Literal>()->value(), &result);
+      return result;
+    }
+    case Op::kAfterAll:
+    case Op::kAssert:
+    case Op::kCover:
+    case Op::kTrace:
+      // Tokens have no bits.
+      return AigVector();
+    default:
+      break;
+  }
+
+  absl::Status status = absl::OkStatus();
+  XLS_ASSIGN_OR_RETURN(
+      AigVector result,
+      AbstractEvaluate(node, absl::MakeConstSpan(operands), &evaluator,
+                       [&](Node* n) {
+                         status = absl::UnimplementedError(
+                             "Unsupported node for AIG translation: " +
+                             n->ToString());
+                         return AigVector();
+                       }));
+  XLS_RETURN_IF_ERROR(status);
+  XLS_RET_CHECK_EQ(result.size(), node->GetType()->GetFlatBitCount())
+      << node->ToString();
+  return result;
+}
+
+Value FlatBitsToValue(Type* type, absl::Span<const bool> bits) {
+  XLS_CHECK_EQ(bits.size(), type->GetFlatBitCount());
+  if (type->IsBits()) {
+    return Value(Bits(bits));
+  }
+  if (type->IsTuple()) {
+    std::vector<Value> elements;
+    int64_t start = 0;
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      int64_t width = element_type->GetFlatBitCount();
+      elements.push_back(
+          FlatBitsToValue(element_type, bits.subspan(start, width)));
+      start += width;
+    }
+    return Value::TupleOwned(std::move(elements));
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    int64_t width = array_type->element_type()->GetFlatBitCount();
+    std::vector<Value> elements;
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      elements.push_back(FlatBitsToValue(array_type->element_type(),
+                                         bits.subspan(i * width, width)));
+    }
+    return Value::ArrayOrDie(elements);
+  }
+  return Value::Token();
+}
+
+std::string ProofResultToString(ProofResult result) {
+  switch (result) {
+    case ProofResult::kProven:
+      return "proven";
+    case ProofResult::kDisproven:
+      return "disproven";
+    case ProofResult::kUnknown:
+      return "unknown";
+  }
+  XLS_LOG(FATAL) << "Invalid ProofResult: " << static_cast<int>(result);
+}
+
+std::string ProofReport::ToString() const {
+  return absl::StrFormat(
+      "%s (%d AND gates, %d structural hash hits, %d rewrites, %d conflicts)",
+      ProofResultToString(result), and_count, structural_hash_hits,
+      rewrite_count, conflict_count);
+}
+
+absl::StatusOr<ProofReport> Prove(Function* f, Node* subject,
+                                  z3::Predicate p, absl::Duration timeout) {
+  std::vector<Node*> roots = {subject};
+  if (p.kind() == z3::PredicateKind::kEqualToNode) {
+    roots.push_back(p.node());
+  }
+  Aig aig;
+  AigIrTranslator translator(&aig);
+  XLS_RETURN_IF_ERROR(translator.Translate(f, roots));
+
+  // All token types are equal.
+  if (subject->GetType()->IsToken() &&
+      p.kind() == z3::PredicateKind::kEqualToNode &&
+      p.node()->GetType()->IsToken()) {
+    ProofReport report;
+    report.result = ProofResult::kProven;
+    return report;
+  }
+  if (!subject->GetType()->IsBits()) {
+    return absl::InvalidArgumentError(
+        "Cannot prove properties of non-bits-typed node: " +
+        subject->ToString());
+  }
+  AigEvaluator evaluator(&aig);
+  const AigVector& value = translator.GetTranslation(subject);
+  // The negation of the predicate, which must be unsatisfiable.
+  AigLiteral violation;
+  switch (p.kind()) {
+    case z3::PredicateKind::kEqualToZero:
+      violation = evaluator.OrReduce(value).front();
+      break;
+    case z3::PredicateKind::kNotEqualToZero:
+      violation = ~evaluator.OrReduce(value).front();
+      break;
+    case z3::PredicateKind::kEqualToNode:
+      XLS_RET_CHECK(subject->GetType()->IsEqualTo(p.node()->GetType()));
+      violation = ~evaluator.Equals(value, translator.GetTranslation(p.node()));
+      break;
+  }
+  return Refute(&aig, violation, f, translator, timeout);
+}
+
+absl::StatusOr<bool> TryProve(Function* f, Node* subject, z3::Predicate p,
+                              absl::Duration timeout) {
+  XLS_ASSIGN_OR_RETURN(ProofReport report, Prove(f, subject, p, timeout));
+  return report.result == ProofResult::kProven;
+}
+
+absl::StatusOr<ProofReport> ProveEquivalence(Function* a, Function* b,
+                                             absl::Duration timeout) {
+  XLS_RETURN_IF_ERROR(CheckSameSignature(a, b));
+  Aig aig;
+  AigIrTranslator translator(&aig);
+  XLS_RETURN_IF_ERROR(translator.Translate(a, {a->return_value()}));
+  std::vector<AigVector> params;
+  for (Param* param : a->params()) {
+    params.push_back(translator.GetTranslation(param));
+  }
+  XLS_RETURN_IF_ERROR(translator.Translate(b, {b->return_value()},
+                                           absl::MakeConstSpan(params)));
+  AigEvaluator evaluator(&aig);
+  AigLiteral violation =
+      ~evaluator.Equals(translator.GetTranslation(a->return_value()),
+                        translator.GetTranslation(b->return_value()));
+  return Refute(&aig, violation, a, translator, timeout);
+}
+
+}  // namespace aig
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,130 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Bit-blasting of XLS IR to an and-inverter graph (AIG), and proofs over the
+// AIG with the in-tree CDCL SAT solver.
+//
+// This is an alternative to the Z3 translation (z3_ir_translator.h): rather
+// than handing bit-vector terms to Z3's bit-blaster, the IR is bit-blasted
+// with AbstractEvaluator directly into a structurally hashed and locally
+// rewritten AIG. Structural hashing merges identical logic across the whole
+// translation -- including across the two sides of an equivalence check --
+// before any clause reaches the solver, which is where most of the time goes
+// on arithmetic-heavy designs.
+
+#ifndef XLS_SOLVERS_AIG_IR_TRANSLATOR_H_
+#define XLS_SOLVERS_AIG_IR_TRANSLATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
+#include "xls/solvers/aig.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls {
+namespace solvers {
+namespace aig {
+
+// The bits of an IR value in the AIG. Values of aggregate type are flattened:
+// tuple and array elements are laid out in index order, each bits value least
+// significant bit first.
+using AigVector = std::vector<AigLiteral>;
+
+// Translates XLS IR functions into an AIG. Several functions may be translated
+// into the same AIG (e.g., with shared parameters), so that structural hashing
+// applies across them.
+class AigIrTranslator {
+ public:
+  explicit AigIrTranslator(Aig* aig) : aig_(aig) {}
+
+  // Translates the nodes of "f" in the cones of influence of "roots" (or all
+  // nodes, if "roots" is empty). The parameters of "f" are translated to
+  // "params" if given, else to fresh inputs. Invokes, maps and loops are not
+  // supported; inline and unroll these first.
+  absl::Status Translate(
+      Function* f, absl::Span<Node* const> roots = {},
+      absl::optional<absl::Span<const AigVector>> params = absl::nullopt);
+
+  const AigVector& GetTranslation(const Node* node) const {
+    return translations_.at(node);
+  }
+
+  Aig* aig() const { return aig_; }
+
+ private:
+  absl::StatusOr<AigVector> TranslateNode(Node* node);
+
+  Aig* aig_;
+  absl::flat_hash_map<const Node*, AigVector> translations_;
+};
+
+// Converts flattened bits (see AigVector) back to a value of the given type.
+Value FlatBitsToValue(Type* type, absl::Span<const bool> bits);
+
+enum class ProofResult {
+  kProven,
+  // A counterexample was found.
+  kDisproven,
+  // The time limit was reached first.
+  kUnknown,
+};
+
+std::string ProofResultToString(ProofResult result);
+
+struct ProofReport {
+  ProofResult result;
+
+  // For kDisproven, argument values for which the property does not hold.
+  absl::optional<std::vector<Value>> counterexample;
+
+  // Size of the AIG and effort of the solver.
+  int64_t and_count = 0;
+  int64_t structural_hash_hits = 0;
+  int64_t rewrite_count = 0;
+  int64_t conflict_count = 0;
+
+  std::string ToString() const;
+};
+
+// Attempts to prove that node "subject" in function "f" satisfies the given
+// predicate over all possible inputs, within "timeout".
+absl::StatusOr<ProofReport> Prove(Function* f, Node* subject,
+                                  z3::Predicate p, absl::Duration timeout);
+
+// As above, but only returns whether the predicate was proven, like
+// z3::TryProve.
+absl::StatusOr<bool> TryProve(Function* f, Node* subject, z3::Predicate p,
+                              absl::Duration timeout);
+
+// Attempts to prove that functions "a" and "b", which must have the same
+// signature, return the same value for all arguments, within "timeout".
+absl::StatusOr<ProofReport> ProveEquivalence(Function* a, Function* b,
+                                             absl::Duration timeout);
+
+}  // namespace aig
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_AIG_IR_TRANSLATOR_H_
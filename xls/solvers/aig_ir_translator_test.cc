@@ -0,0 +1,279 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/aig_ir_translator.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using solvers::aig::AigIrTranslator;
+using solvers::aig::FlatBitsToValue;
+using solvers::aig::ProofReport;
+using solvers::aig::ProofResult;
+using solvers::aig::Prove;
+using solvers::aig::ProveEquivalence;
+using solvers::z3::Predicate;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+class AigIrTranslatorTest : public IrTestBase {
+ protected:
+  const absl::Duration kTimeout = absl::Seconds(60);
+};
+
+TEST_F(AigIrTranslatorTest, ProveEqualToZero) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8]) -> bits[8] {
+  not.1: bits[8] = not(x)
+  ret and.2: bits[8] = and(x, not.1)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProofReport report,
+      Prove(f, f->return_value(), Predicate::EqualToZero(), kTimeout));
+  EXPECT_EQ(report.result, ProofResult::kProven);
+  // Decided by the AIG construction alone.
+  EXPECT_EQ(report.and_count, 0);
+  EXPECT_EQ(report.conflict_count, 0);
+}
+
+TEST_F(AigIrTranslatorTest, DisproveNotEqualToZero) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProofReport report,
+      Prove(f, f->return_value(), Predicate::NotEqualToZero(), kTimeout));
+  EXPECT_EQ(report.result, ProofResult::kDisproven);
+  ASSERT_TRUE(report.counterexample.has_value());
+  ASSERT_THAT(*report.counterexample, SizeIs(2));
+  uint64_t x = report.counterexample->at(0).bits().ToUint64().value();
+  uint64_t y = report.counterexample->at(1).bits().ToUint64().value();
+  EXPECT_EQ((x + y) % 256, 0);
+}
+
+TEST_F(AigIrTranslatorTest, MultiplicationCommutes) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[1] {
+  umul.1: bits[8] = umul(x, y)
+  umul.2: bits[8] = umul(y, x)
+  ret eq.3: bits[1] = eq(umul.1, umul.2)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * a, f->GetNode("umul.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * b, f->GetNode("umul.2"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool proven,
+      solvers::aig::TryProve(f, a, Predicate::EqualTo(b), kTimeout));
+  EXPECT_TRUE(proven);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      proven,
+      solvers::aig::TryProve(f, f->return_value(),
+                             Predicate::NotEqualToZero(), kTimeout));
+  EXPECT_TRUE(proven);
+}
+
+TEST_F(AigIrTranslatorTest, ProofNeedsSearch) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[16], y: bits[16]) -> bits[16] {
+  add.1: bits[16] = add(x, y)
+  ret sub.2: bits[16] = sub(add.1, y)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProofReport report,
+      Prove(f, f->return_value(), Predicate::EqualTo(f->param(0)), kTimeout));
+  EXPECT_EQ(report.result, ProofResult::kProven);
+  EXPECT_GT(report.and_count, 0);
+}
+
+TEST_F(AigIrTranslatorTest, AggregateOperations) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(a: bits[4][3], i: bits[2], t: (bits[4], bits[2])) -> bits[1] {
+  array_index.1: bits[4] = array_index(a, indices=[i])
+  literal.2: bits[2] = literal(value=0)
+  literal.3: bits[2] = literal(value=1)
+  literal.4: bits[2] = literal(value=2)
+  array_index.5: bits[4] = array_index(a, indices=[literal.2])
+  array_index.6: bits[4] = array_index(a, indices=[literal.3])
+  array_index.7: bits[4] = array_index(a, indices=[literal.4])
+  sel.8: bits[4] = sel(i, cases=[array_index.5, array_index.6],
+                       default=array_index.7)
+  tuple_index.9: bits[4] = tuple_index(t, index=0)
+  array_update.10: bits[4][3] = array_update(a, tuple_index.9, indices=[i])
+  array_index.11: bits[4] = array_index(array_update.10, indices=[i])
+  sel.12: bits[4] = sel(i, cases=[tuple_index.9, tuple_index.9,
+                                  tuple_index.9], default=array_index.7)
+  eq.13: bits[1] = eq(array_index.1, sel.8)
+  eq.14: bits[1] = eq(array_index.11, sel.12)
+  ret and.15: bits[1] = and(eq.13, eq.14)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool proven,
+      solvers::aig::TryProve(f, f->return_value(),
+                             Predicate::NotEqualToZero(), kTimeout));
+  EXPECT_TRUE(proven);
+}
+
+TEST_F(AigIrTranslatorTest, EquivalenceByStructuralHashing) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[32], y: bits[32], z: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  ret and.2: bits[32] = and(add.1, z)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[32], y: bits[32], z: bits[32]) -> bits[32] {
+  add.3: bits[32] = add(y, x)
+  ret and.4: bits[32] = and(z, add.3)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(ProofReport report,
+                           ProveEquivalence(a, b, kTimeout));
+  EXPECT_EQ(report.result, ProofResult::kProven);
+  // Both sides map to the same gates, so no search is needed.
+  EXPECT_EQ(report.conflict_count, 0);
+  EXPECT_GT(report.structural_hash_hits, 0);
+}
+
+TEST_F(AigIrTranslatorTest, NotEquivalent) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+  add.1: bits[8] = add(x, y)
+  ult.2: bits[1] = ult(x, y)
+  ret tuple.3: (bits[8], bits[1]) = tuple(add.1, ult.2)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+  sub.4: bits[8] = sub(x, y)
+  ugt.5: bits[1] = ugt(y, x)
+  ret tuple.6: (bits[8], bits[1]) = tuple(sub.4, ugt.5)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(ProofReport report,
+                           ProveEquivalence(a, b, kTimeout));
+  EXPECT_EQ(report.result, ProofResult::kDisproven);
+  ASSERT_TRUE(report.counterexample.has_value());
+  ASSERT_THAT(*report.counterexample, SizeIs(2));
+  // x + y != x - y iff 2 * y != 0 (mod 256).
+  uint64_t y = report.counterexample->at(1).bits().ToUint64().value();
+  EXPECT_NE(y % 128, 0);
+}
+
+TEST_F(AigIrTranslatorTest, DifferentSignatures) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[4]) -> bits[4] {
+  ret neg.2: bits[4] = neg(x)
+}
+)",
+                                                       p.get()));
+  EXPECT_THAT(ProveEquivalence(a, b, kTimeout),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("different signatures")));
+}
+
+TEST_F(AigIrTranslatorTest, NonBitsSubject) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8]) -> (bits[8]) {
+  ret tuple.1: (bits[8]) = tuple(x)
+}
+)",
+                                                       p.get()));
+  EXPECT_THAT(
+      solvers::aig::TryProve(f, f->return_value(), Predicate::EqualToZero(),
+                             kTimeout),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("non-bits-typed")));
+}
+
+TEST_F(AigIrTranslatorTest, FlatBitsToValue) {
+  auto p = CreatePackage();
+  Type* type = p->GetTupleType(
+      {p->GetBitsType(3), p->GetArrayType(2, p->GetBitsType(2))});
+  bool bits[] = {true, false, true, false, true, true, false};
+  EXPECT_EQ(FlatBitsToValue(type, bits),
+            Value::Tuple({Value(UBits(5, 3)),
+                          Value::ArrayOrDie({Value(UBits(2, 2)),
+                                             Value(UBits(1, 2))})}));
+}
+
+TEST_F(AigIrTranslatorTest, TranslateSharedParams) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[4], y: bits[4]) -> bits[4] {
+  ret xor.1: bits[4] = xor(x, y)
+}
+)",
+                                                       p.get()));
+  solvers::Aig aig;
+  AigIrTranslator translator(&aig);
+  XLS_ASSERT_OK(translator.Translate(f));
+  EXPECT_EQ(aig.input_count(), 8);
+  int64_t and_count = aig.and_count();
+  std::vector<solvers::aig::AigVector> params = {
+      translator.GetTranslation(f->param(1)),
+      translator.GetTranslation(f->param(0))};
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, ParseFunction(R"(
+fn g(x: bits[4], y: bits[4]) -> bits[4] {
+  ret xor.2: bits[4] = xor(x, y)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK(
+      translator.Translate(g, {g->return_value()}, absl::MakeSpan(params)));
+  // The second translation reuses the inputs and the gates of the first.
+  EXPECT_EQ(aig.input_count(), 8);
+  EXPECT_EQ(aig.and_count(), and_count);
+  EXPECT_EQ(translator.GetTranslation(g->return_value()),
+            translator.GetTranslation(f->return_value()));
+}
+
+}  // namespace
+}  // namespace xls
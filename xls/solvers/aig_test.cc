@@ -0,0 +1,122 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/aig.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/solvers/sat_solver.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+TEST(AigTest, Constants) {
+  Aig aig;
+  AigLiteral a = aig.NewInput();
+  EXPECT_EQ(aig.And(a, AigLiteral::False()), AigLiteral::False());
+  EXPECT_EQ(aig.And(AigLiteral::True(), a), a);
+  EXPECT_EQ(aig.And(a, a), a);
+  EXPECT_EQ(aig.And(a, ~a), AigLiteral::False());
+  EXPECT_EQ(aig.Or(a, ~a), AigLiteral::True());
+  EXPECT_EQ(aig.and_count(), 0);
+}
+
+TEST(AigTest, StructuralHashing) {
+  Aig aig;
+  AigLiteral a = aig.NewInput();
+  AigLiteral b = aig.NewInput();
+  AigLiteral ab = aig.And(a, b);
+  EXPECT_EQ(aig.And(b, a), ab);
+  EXPECT_EQ(aig.And(a, b), ab);
+  EXPECT_NE(aig.And(a, ~b), ab);
+  EXPECT_EQ(aig.and_count(), 2);
+  EXPECT_EQ(aig.structural_hash_hits(), 2);
+  EXPECT_TRUE(aig.IsAnd(ab.node()));
+  EXPECT_TRUE(aig.IsInput(a.node()));
+  EXPECT_EQ(aig.fanin0(ab.node()), a);
+  EXPECT_EQ(aig.fanin1(ab.node()), b);
+}
+
+TEST(AigTest, OneLevelRewrites) {
+  Aig aig;
+  AigLiteral a = aig.NewInput();
+  AigLiteral b = aig.NewInput();
+  AigLiteral ab = aig.And(a, b);
+  // Contradiction.
+  EXPECT_EQ(aig.And(ab, ~a), AigLiteral::False());
+  // Idempotence.
+  EXPECT_EQ(aig.And(b, ab), ab);
+  // Subsumption.
+  EXPECT_EQ(aig.And(~ab, ~b), ~b);
+  // Substitution.
+  EXPECT_EQ(aig.And(~ab, a), aig.And(a, ~b));
+  EXPECT_GE(aig.rewrite_count(), 4);
+}
+
+TEST(AigTest, TwoLevelRewrites) {
+  Aig aig;
+  AigLiteral a = aig.NewInput();
+  AigLiteral b = aig.NewInput();
+  AigLiteral c = aig.NewInput();
+  AigLiteral ab = aig.And(a, b);
+  AigLiteral not_a_c = aig.And(~a, c);
+  AigLiteral ac = aig.And(a, c);
+  // Contradiction.
+  EXPECT_EQ(aig.And(ab, not_a_c), AigLiteral::False());
+  // Subsumption.
+  EXPECT_EQ(aig.And(ab, ~not_a_c), ab);
+  // Resolution.
+  EXPECT_EQ(aig.And(~ab, ~aig.And(a, ~b)), ~a);
+  // Idempotence and substitution produce the same gates as the rewritten
+  // expressions built directly.
+  EXPECT_EQ(aig.And(ab, ac), aig.And(ab, c));
+  EXPECT_EQ(aig.And(ab, ~ac), aig.And(ab, ~c));
+}
+
+TEST(AigTest, EncodeXor) {
+  Aig aig;
+  AigLiteral a = aig.NewInput();
+  AigLiteral b = aig.NewInput();
+  AigLiteral x = aig.And(aig.Or(a, b), ~aig.And(a, b));
+
+  SatSolver solver;
+  AigSatEncoder encoder(&aig, &solver);
+  SatLiteral sat_x = encoder.Encode(x);
+  SatLiteral sat_a = encoder.Encode(a);
+  SatLiteral sat_b = encoder.Encode(b);
+  // Encoding again reuses the variables.
+  EXPECT_EQ(encoder.Encode(x), sat_x);
+  EXPECT_EQ(encoder.Encode(~x), ~sat_x);
+
+  EXPECT_EQ(solver.Solve({sat_x, sat_a, sat_b}), SatResult::kUnsatisfiable);
+  EXPECT_EQ(solver.Solve({~sat_x, sat_a, ~sat_b}),
+            SatResult::kUnsatisfiable);
+  ASSERT_EQ(solver.Solve({sat_x, sat_a}), SatResult::kSatisfiable);
+  EXPECT_FALSE(solver.ModelValue(sat_b));
+}
+
+TEST(AigTest, EncodeConstant) {
+  Aig aig;
+  SatSolver solver;
+  AigSatEncoder encoder(&aig, &solver);
+  EXPECT_EQ(solver.Solve({encoder.Encode(AigLiteral::True())}),
+            SatResult::kSatisfiable);
+  EXPECT_EQ(solver.Solve({encoder.Encode(AigLiteral::False())}),
+            SatResult::kUnsatisfiable);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace xls
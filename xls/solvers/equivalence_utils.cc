@@ -0,0 +1,32 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/equivalence_utils.h"
+
+#include "absl/strings/str_format.h"
+
+namespace xls {
+namespace solvers {
+
+absl::Status CheckSameSignature(Function* a, Function* b) {
+  if (!a->GetType()->IsEqualTo(b->GetType())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Functions %s and %s have different signatures: %s vs %s", a->name(),
+        b->name(), a->GetType()->ToString(), b->GetType()->ToString()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace solvers
+}  // namespace xls
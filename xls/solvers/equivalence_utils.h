@@ -0,0 +1,31 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_EQUIVALENCE_UTILS_H_
+#define XLS_SOLVERS_EQUIVALENCE_UTILS_H_
+
+#include "absl/status/status.h"
+#include "xls/ir/function.h"
+
+namespace xls {
+namespace solvers {
+
+// Returns an InvalidArgumentError unless "a" and "b" have the same parameter
+// and return types, i.e., unless they can be checked for equivalence.
+absl::Status CheckSameSignature(Function* a, Function* b);
+
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_EQUIVALENCE_UTILS_H_
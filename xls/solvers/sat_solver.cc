@@ -0,0 +1,516 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/sat_solver.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+// Number of conflicts between restarts is this unit times the Luby sequence.
+constexpr int64_t kRestartUnit = 100;
+
+// Decay factors of the variable and clause activities.
+constexpr double kVariableDecay = 0.95;
+constexpr double kClauseDecay = 0.999;
+
+// Returns the i-th element (starting at zero) of the Luby sequence
+// 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+int64_t Luby(int64_t i) {
+  int64_t size = 1;
+  int64_t power = 1;
+  while (size < i + 1) {
+    size = 2 * size + 1;
+    power *= 2;
+  }
+  while (size - 1 != i) {
+    size = (size - 1) / 2;
+    power /= 2;
+    i %= size;
+  }
+  return power;
+}
+
+}  // namespace
+
+std::string SatLiteral::ToString() const {
+  return absl::StrCat(negated() ? "~" : "", "v", variable());
+}
+
+std::string SatResultToString(SatResult result) {
+  switch (result) {
+    case SatResult::kSatisfiable:
+      return "satisfiable";
+    case SatResult::kUnsatisfiable:
+      return "unsatisfiable";
+    case SatResult::kUnknown:
+      return "unknown";
+  }
+  XLS_LOG(FATAL) << "Invalid SatResult: " << static_cast<int>(result);
+}
+
+int64_t SatSolver::NewVariable() {
+  int64_t variable = assignment_.size();
+  assignment_.push_back(kUndef);
+  level_.push_back(0);
+  reason_.push_back(kNoReason);
+  saved_phase_.push_back(false);
+  seen_.push_back(false);
+  activity_.push_back(0.0);
+  heap_position_.push_back(-1);
+  watches_.emplace_back();
+  watches_.emplace_back();
+  HeapInsert(variable);
+  return variable;
+}
+
+bool SatSolver::AddClause(absl::Span<const SatLiteral> literals) {
+  XLS_CHECK_EQ(decision_level(), 0);
+  if (!ok_) {
+    return false;
+  }
+  std::vector<SatLiteral> clause(literals.begin(), literals.end());
+  std::sort(clause.begin(), clause.end(),
+            [](SatLiteral a, SatLiteral b) { return a.code() < b.code(); });
+  std::vector<SatLiteral> simplified;
+  for (int64_t i = 0; i < clause.size(); ++i) {
+    XLS_CHECK_LT(clause[i].variable(), variable_count());
+    if (Value(clause[i]) == kTrue ||
+        (i > 0 && clause[i] == ~clause[i - 1])) {
+      // Satisfied at the top level, or a tautology.
+      return true;
+    }
+    if (Value(clause[i]) == kFalse || (i > 0 && clause[i] == clause[i - 1])) {
+      continue;
+    }
+    simplified.push_back(clause[i]);
+  }
+  if (simplified.empty()) {
+    ok_ = false;
+  } else if (simplified.size() == 1) {
+    Enqueue(simplified.front(), kNoReason);
+    ok_ = Propagate() == kNoReason;
+  } else {
+    AttachClause(std::move(simplified), /*learned=*/false);
+  }
+  return ok_;
+}
+
+SatSolver::ClauseRef SatSolver::AttachClause(std::vector<SatLiteral> literals,
+                                             bool learned) {
+  XLS_CHECK_GE(literals.size(), 2);
+  ClauseRef ref;
+  if (free_clauses_.empty()) {
+    ref = clauses_.size();
+    clauses_.emplace_back();
+  } else {
+    ref = free_clauses_.back();
+    free_clauses_.pop_back();
+  }
+  Clause& clause = clauses_[ref];
+  clause.literals = std::move(literals);
+  clause.learned = learned;
+  clause.deleted = false;
+  clause.activity = 0.0;
+  watches_[(~clause.literals[0]).code()].push_back(
+      {ref, clause.literals[1]});
+  watches_[(~clause.literals[1]).code()].push_back(
+      {ref, clause.literals[0]});
+  if (learned) {
+    learned_clauses_.push_back(ref);
+  }
+  return ref;
+}
+
+void SatSolver::Enqueue(SatLiteral literal, ClauseRef reason) {
+  int64_t variable = literal.variable();
+  assignment_[variable] = literal.negated() ? kFalse : kTrue;
+  level_[variable] = decision_level();
+  reason_[variable] = reason;
+  trail_.push_back(literal);
+}
+
+SatSolver::ClauseRef SatSolver::Propagate() {
+  while (propagation_head_ < trail_.size()) {
+    SatLiteral literal = trail_[propagation_head_++];
+    SatLiteral false_literal = ~literal;
+    ++propagation_count_;
+    // The clauses watching "false_literal"; at most one of their watched
+    // literals may be false, so each must find a new watch or propagate.
+    std::vector<Watcher>& watchers = watches_[literal.code()];
+    int64_t kept = 0;
+    int64_t i = 0;
+    while (i < watchers.size()) {
+      Watcher watcher = watchers[i++];
+      if (Value(watcher.blocker) == kTrue) {
+        watchers[kept++] = watcher;
+        continue;
+      }
+      Clause& clause = clauses_[watcher.clause];
+      std::vector<SatLiteral>& literals = clause.literals;
+      if (literals[0] == false_literal) {
+        std::swap(literals[0], literals[1]);
+      }
+      SatLiteral first = literals[0];
+      if (first != watcher.blocker && Value(first) == kTrue) {
+        watchers[kept++] = {watcher.clause, first};
+        continue;
+      }
+      bool found_watch = false;
+      for (int64_t k = 2; k < literals.size(); ++k) {
+        if (Value(literals[k]) != kFalse) {
+          std::swap(literals[1], literals[k]);
+          watches_[(~literals[1]).code()].push_back({watcher.clause, first});
+          found_watch = true;
+          break;
+        }
+      }
+      if (found_watch) {
+        continue;
+      }
+      watchers[kept++] = {watcher.clause, first};
+      if (Value(first) == kFalse) {
+        while (i < watchers.size()) {
+          watchers[kept++] = watchers[i++];
+        }
+        watchers.resize(kept);
+        propagation_head_ = trail_.size();
+        return watcher.clause;
+      }
+      Enqueue(first, watcher.clause);
+    }
+    watchers.resize(kept);
+  }
+  return kNoReason;
+}
+
+int64_t SatSolver::Analyze(ClauseRef conflict,
+                           std::vector<SatLiteral>* learned) {
+  learned->clear();
+  // Placeholder for the asserting literal.
+  learned->push_back(SatLiteral::Positive(0));
+  int64_t open_paths = 0;
+  int64_t index = trail_.size() - 1;
+  bool first = true;
+  SatLiteral implied = SatLiteral::Positive(0);
+  do {
+    Clause& clause = clauses_[conflict];
+    if (clause.learned) {
+      BumpClause(&clause);
+    }
+    // Except for the conflict itself, the first literal of a reason clause is
+    // the literal it implied.
+    for (int64_t j = first ? 0 : 1; j < clause.literals.size(); ++j) {
+      SatLiteral literal = clause.literals[j];
+      int64_t variable = literal.variable();
+      if (seen_[variable] || level_[variable] == 0) {
+        continue;
+      }
+      BumpVariable(variable);
+      seen_[variable] = true;
+      if (level_[variable] >= decision_level()) {
+        ++open_paths;
+      } else {
+        learned->push_back(literal);
+      }
+    }
+    // Continue with the most recently assigned literal in the conflict.
+    while (!seen_[trail_[index].variable()]) {
+      --index;
+    }
+    implied = trail_[index--];
+    conflict = reason_[implied.variable()];
+    seen_[implied.variable()] = false;
+    --open_paths;
+    first = false;
+  } while (open_paths > 0);
+  (*learned)[0] = ~implied;
+
+  // Drop literals implied by other literals of the clause.
+  std::vector<SatLiteral> analyzed(learned->begin() + 1, learned->end());
+  int64_t kept = 1;
+  for (int64_t i = 1; i < learned->size(); ++i) {
+    if (!IsRedundant((*learned)[i])) {
+      (*learned)[kept++] = (*learned)[i];
+    }
+  }
+  learned->resize(kept);
+  for (SatLiteral literal : analyzed) {
+    seen_[literal.variable()] = false;
+  }
+
+  if (learned->size() == 1) {
+    return 0;
+  }
+  // The literal with the highest level (below the current one) becomes the
+  // second watch; backtracking to its level makes the clause assert.
+  int64_t max_index = 1;
+  for (int64_t i = 2; i < learned->size(); ++i) {
+    if (level_[(*learned)[i].variable()] >
+        level_[(*learned)[max_index].variable()]) {
+      max_index = i;
+    }
+  }
+  std::swap((*learned)[1], (*learned)[max_index]);
+  return level_[(*learned)[1].variable()];
+}
+
+bool SatSolver::IsRedundant(SatLiteral literal) const {
+  ClauseRef reason = reason_[literal.variable()];
+  if (reason == kNoReason) {
+    return false;
+  }
+  const Clause& clause = clauses_[reason];
+  for (int64_t j = 1; j < clause.literals.size(); ++j) {
+    int64_t variable = clause.literals[j].variable();
+    if (!seen_[variable] && level_[variable] > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SatSolver::Backtrack(int64_t level) {
+  if (decision_level() <= level) {
+    return;
+  }
+  for (int64_t i = trail_.size() - 1; i >= trail_limits_[level]; --i) {
+    int64_t variable = trail_[i].variable();
+    saved_phase_[variable] = !trail_[i].negated();
+    assignment_[variable] = kUndef;
+    reason_[variable] = kNoReason;
+    if (heap_position_[variable] < 0) {
+      HeapInsert(variable);
+    }
+  }
+  trail_.resize(trail_limits_[level]);
+  trail_limits_.resize(level);
+  propagation_head_ = trail_.size();
+}
+
+int64_t SatSolver::PickBranchVariable() {
+  while (!heap_.empty()) {
+    int64_t variable = HeapPop();
+    if (assignment_[variable] == kUndef) {
+      return variable;
+    }
+  }
+  return -1;
+}
+
+void SatSolver::BumpVariable(int64_t variable) {
+  activity_[variable] += variable_increment_;
+  if (activity_[variable] > 1e100) {
+    for (double& activity : activity_) {
+      activity *= 1e-100;
+    }
+    variable_increment_ *= 1e-100;
+  }
+  if (heap_position_[variable] >= 0) {
+    HeapSiftUp(heap_position_[variable]);
+  }
+}
+
+void SatSolver::BumpClause(Clause* clause) {
+  clause->activity += clause_increment_;
+  if (clause->activity > 1e20) {
+    for (ClauseRef ref : learned_clauses_) {
+      clauses_[ref].activity *= 1e-20;
+    }
+    clause_increment_ *= 1e-20;
+  }
+}
+
+void SatSolver::ReduceLearnedClauses() {
+  std::sort(learned_clauses_.begin(), learned_clauses_.end(),
+            [&](ClauseRef a, ClauseRef b) {
+              return clauses_[a].activity < clauses_[b].activity;
+            });
+  // Delete the less active half, except for binary clauses and clauses which
+  // are the reason for a current assignment.
+  std::vector<ClauseRef> kept;
+  for (int64_t i = 0; i < learned_clauses_.size(); ++i) {
+    ClauseRef ref = learned_clauses_[i];
+    Clause& clause = clauses_[ref];
+    SatLiteral first = clause.literals[0];
+    bool locked =
+        reason_[first.variable()] == ref && Value(first) == kTrue;
+    if (i >= learned_clauses_.size() / 2 || clause.literals.size() == 2 ||
+        locked) {
+      kept.push_back(ref);
+      continue;
+    }
+    clause.deleted = true;
+    clause.literals.clear();
+    free_clauses_.push_back(ref);
+  }
+  learned_clauses_ = std::move(kept);
+  // Deleted clauses may be reused, so no stale watchers may remain.
+  for (std::vector<Watcher>& watchers : watches_) {
+    watchers.erase(std::remove_if(watchers.begin(), watchers.end(),
+                                  [&](const Watcher& watcher) {
+                                    return clauses_[watcher.clause].deleted;
+                                  }),
+                   watchers.end());
+  }
+}
+
+SatResult SatSolver::Solve(absl::Span<const SatLiteral> assumptions,
+                           int64_t conflict_limit, absl::Time deadline) {
+  model_.clear();
+  if (!ok_) {
+    return SatResult::kUnsatisfiable;
+  }
+  int64_t conflicts = 0;
+  int64_t restarts = 0;
+  int64_t conflicts_until_restart = kRestartUnit * Luby(restarts);
+  int64_t iterations = 0;
+  std::vector<SatLiteral> learned;
+  while (true) {
+    ClauseRef conflict = Propagate();
+    if (conflict != kNoReason) {
+      ++conflict_count_;
+      ++conflicts;
+      --conflicts_until_restart;
+      if (decision_level() == 0) {
+        ok_ = false;
+        return SatResult::kUnsatisfiable;
+      }
+      int64_t level = Analyze(conflict, &learned);
+      Backtrack(level);
+      if (learned.size() == 1) {
+        Enqueue(learned.front(), kNoReason);
+      } else {
+        ClauseRef ref = AttachClause(learned, /*learned=*/true);
+        BumpClause(&clauses_[ref]);
+        Enqueue(learned.front(), ref);
+      }
+      variable_increment_ /= kVariableDecay;
+      clause_increment_ /= kClauseDecay;
+      continue;
+    }
+
+    if (conflicts >= conflict_limit ||
+        (++iterations % 256 == 0 && absl::Now() > deadline)) {
+      Backtrack(0);
+      return SatResult::kUnknown;
+    }
+    if (conflicts_until_restart <= 0) {
+      conflicts_until_restart = kRestartUnit * Luby(++restarts);
+      Backtrack(0);
+    }
+    if (static_cast<int64_t>(learned_clauses_.size()) -
+            static_cast<int64_t>(trail_.size()) >=
+        max_learned_clauses_) {
+      ReduceLearnedClauses();
+      max_learned_clauses_ += max_learned_clauses_ / 10;
+    }
+
+    // Assumptions are decided first, one per decision level.
+    absl::optional<SatLiteral> decision;
+    while (decision_level() < assumptions.size()) {
+      SatLiteral assumption = assumptions[decision_level()];
+      LBool value = Value(assumption);
+      if (value == kTrue) {
+        trail_limits_.push_back(trail_.size());
+      } else if (value == kFalse) {
+        Backtrack(0);
+        return SatResult::kUnsatisfiable;
+      } else {
+        decision = assumption;
+        break;
+      }
+    }
+    if (!decision.has_value()) {
+      int64_t variable = PickBranchVariable();
+      if (variable < 0) {
+        model_.resize(variable_count());
+        for (int64_t v = 0; v < variable_count(); ++v) {
+          model_[v] = assignment_[v] == kTrue;
+        }
+        Backtrack(0);
+        return SatResult::kSatisfiable;
+      }
+      decision = saved_phase_[variable] ? SatLiteral::Positive(variable)
+                                        : SatLiteral::Negative(variable);
+      ++decision_count_;
+    }
+    trail_limits_.push_back(trail_.size());
+    Enqueue(*decision, kNoReason);
+  }
+}
+
+void SatSolver::HeapInsert(int64_t variable) {
+  heap_position_[variable] = heap_.size();
+  heap_.push_back(variable);
+  HeapSiftUp(heap_.size() - 1);
+}
+
+int64_t SatSolver::HeapPop() {
+  int64_t top = heap_.front();
+  int64_t last = heap_.back();
+  heap_.pop_back();
+  heap_position_[top] = -1;
+  if (!heap_.empty()) {
+    heap_[0] = last;
+    heap_position_[last] = 0;
+    HeapSiftDown(0);
+  }
+  return top;
+}
+
+void SatSolver::HeapSiftUp(int64_t position) {
+  int64_t variable = heap_[position];
+  while (position > 0) {
+    int64_t parent = (position - 1) / 2;
+    if (!HeapLess(heap_[parent], variable)) {
+      break;
+    }
+    heap_[position] = heap_[parent];
+    heap_position_[heap_[position]] = position;
+    position = parent;
+  }
+  heap_[position] = variable;
+  heap_position_[variable] = position;
+}
+
+void SatSolver::HeapSiftDown(int64_t position) {
+  int64_t variable = heap_[position];
+  while (true) {
+    int64_t child = 2 * position + 1;
+    if (child >= heap_.size()) {
+      break;
+    }
+    if (child + 1 < heap_.size() && HeapLess(heap_[child], heap_[child + 1])) {
+      ++child;
+    }
+    if (!HeapLess(variable, heap_[child])) {
+      break;
+    }
+    heap_[position] = heap_[child];
+    heap_position_[heap_[position]] = position;
+    position = child;
+  }
+  heap_[position] = variable;
+  heap_position_[variable] = position;
+}
+
+}  // namespace solvers
+}  // namespace xls
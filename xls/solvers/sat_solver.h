@@ -0,0 +1,211 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SOLVERS_SAT_SOLVER_H_
+#define XLS_SOLVERS_SAT_SOLVER_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+namespace solvers {
+
+// A literal of a SAT problem: a variable or its negation.
+class SatLiteral {
+ public:
+  SatLiteral() : code_(0) {}
+  static SatLiteral Positive(int64_t variable) {
+    return SatLiteral(static_cast<uint32_t>(variable) << 1);
+  }
+  static SatLiteral Negative(int64_t variable) {
+    return SatLiteral((static_cast<uint32_t>(variable) << 1) | 1);
+  }
+
+  int64_t variable() const { return code_ >> 1; }
+  bool negated() const { return (code_ & 1) != 0; }
+
+  // Dense encoding of the literal (2 * variable + negated), for use as an
+  // index.
+  uint32_t code() const { return code_; }
+
+  SatLiteral operator~() const { return SatLiteral(code_ ^ 1); }
+  bool operator==(const SatLiteral& other) const {
+    return code_ == other.code_;
+  }
+  bool operator!=(const SatLiteral& other) const {
+    return code_ != other.code_;
+  }
+
+  std::string ToString() const;
+
+ private:
+  explicit SatLiteral(uint32_t code) : code_(code) {}
+
+  uint32_t code_;
+};
+
+enum class SatResult {
+  kSatisfiable,
+  kUnsatisfiable,
+  // The conflict or time limit was reached before a result was found.
+  kUnknown,
+};
+
+std::string SatResultToString(SatResult result);
+
+// A conflict-driven clause learning (CDCL) SAT solver: two-watched-literal
+// propagation, first-UIP clause learning with clause minimization, VSIDS
+// decisions with phase saving, Luby restarts and periodic reduction of the
+// learned clause database.
+//
+// The solver is incremental: clauses may be added between calls to Solve(),
+// and each call may make assumptions that only hold for that call.
+class SatSolver {
+ public:
+  SatSolver() = default;
+
+  SatSolver(const SatSolver&) = delete;
+  SatSolver& operator=(const SatSolver&) = delete;
+
+  // Returns a fresh variable.
+  int64_t NewVariable();
+  int64_t variable_count() const { return assignment_.size(); }
+
+  // Adds the clause (disjunction of literals) to the problem. Returns false if
+  // the problem is now trivially unsatisfiable.
+  bool AddClause(absl::Span<const SatLiteral> literals);
+
+  // Attempts to find an assignment satisfying all clauses and "assumptions".
+  // Gives up with kUnknown after "conflict_limit" conflicts or when
+  // "deadline" has passed.
+  SatResult Solve(absl::Span<const SatLiteral> assumptions = {},
+                  int64_t conflict_limit = std::numeric_limits<int64_t>::max(),
+                  absl::Time deadline = absl::InfiniteFuture());
+
+  // Returns the value of the variable/literal in the satisfying assignment
+  // found by the last call to Solve(), which must have returned kSatisfiable.
+  bool ModelValue(int64_t variable) const {
+    XLS_CHECK_LT(variable, model_.size());
+    return model_[variable];
+  }
+  bool ModelValue(SatLiteral literal) const {
+    return ModelValue(literal.variable()) != literal.negated();
+  }
+
+  int64_t conflict_count() const { return conflict_count_; }
+  int64_t decision_count() const { return decision_count_; }
+  int64_t propagation_count() const { return propagation_count_; }
+
+ private:
+  // Truth values; kUndef is used for unassigned variables.
+  enum LBool : int8_t { kFalse = 0, kTrue = 1, kUndef = 2 };
+
+  // Index of a clause in clauses_.
+  using ClauseRef = int32_t;
+  static constexpr ClauseRef kNoReason = -1;
+
+  struct Clause {
+    std::vector<SatLiteral> literals;
+    bool learned = false;
+    bool deleted = false;
+    double activity = 0.0;
+  };
+
+  // Entry in the watch list of a literal: the clause watching the literal,
+  // plus another literal of the clause which (if true) spares visiting it.
+  struct Watcher {
+    ClauseRef clause;
+    SatLiteral blocker;
+  };
+
+  LBool Value(SatLiteral literal) const {
+    LBool value = assignment_[literal.variable()];
+    if (value == kUndef) {
+      return kUndef;
+    }
+    return static_cast<LBool>(value ^ static_cast<int8_t>(literal.negated()));
+  }
+  int64_t decision_level() const { return trail_limits_.size(); }
+
+  ClauseRef AttachClause(std::vector<SatLiteral> literals, bool learned);
+  void Enqueue(SatLiteral literal, ClauseRef reason);
+
+  // Propagates all enqueued assignments. Returns the conflicting clause, if
+  // any, else kNoReason.
+  ClauseRef Propagate();
+
+  // Derives the first-UIP clause from the conflict, returning the level to
+  // backtrack to. The asserting literal is the first of "learned".
+  int64_t Analyze(ClauseRef conflict, std::vector<SatLiteral>* learned);
+  bool IsRedundant(SatLiteral literal) const;
+  void Backtrack(int64_t level);
+
+  // Returns the unassigned variable with the highest activity, or -1 if all
+  // variables are assigned.
+  int64_t PickBranchVariable();
+
+  void BumpVariable(int64_t variable);
+  void BumpClause(Clause* clause);
+  void ReduceLearnedClauses();
+
+  // Binary max-heap of unassigned variables ordered by activity.
+  void HeapInsert(int64_t variable);
+  int64_t HeapPop();
+  void HeapSiftUp(int64_t position);
+  void HeapSiftDown(int64_t position);
+  bool HeapLess(int64_t a, int64_t b) const {
+    return activity_[a] < activity_[b];
+  }
+
+  std::vector<Clause> clauses_;
+  std::vector<ClauseRef> learned_clauses_;
+  std::vector<ClauseRef> free_clauses_;
+  std::vector<std::vector<Watcher>> watches_;
+
+  std::vector<LBool> assignment_;
+  std::vector<int64_t> level_;
+  std::vector<ClauseRef> reason_;
+  std::vector<bool> saved_phase_;
+  std::vector<bool> seen_;
+  std::vector<SatLiteral> trail_;
+  std::vector<int64_t> trail_limits_;
+  int64_t propagation_head_ = 0;
+
+  std::vector<double> activity_;
+  double variable_increment_ = 1.0;
+  double clause_increment_ = 1.0;
+  std::vector<int64_t> heap_;
+  // Position of each variable in heap_, or -1 if not in the heap.
+  std::vector<int64_t> heap_position_;
+
+  std::vector<bool> model_;
+  // False once an empty clause has been derived at decision level zero.
+  bool ok_ = true;
+  int64_t max_learned_clauses_ = 4096;
+
+  int64_t conflict_count_ = 0;
+  int64_t decision_count_ = 0;
+  int64_t propagation_count_ = 0;
+};
+
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_SAT_SOLVER_H_
@@ -0,0 +1,183 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/sat_solver.h"
+
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+using Clause = std::vector<SatLiteral>;
+
+bool IsSatisfiedBy(const Clause& clause,
+                   const std::vector<bool>& assignment) {
+  for (SatLiteral literal : clause) {
+    if (assignment[literal.variable()] != literal.negated()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Adds the clauses stating that "pigeons" pigeons sit in "holes" holes, at
+// most one per hole.
+void AddPigeonhole(int64_t pigeons, int64_t holes, SatSolver* solver) {
+  std::vector<std::vector<int64_t>> sits(pigeons);
+  for (int64_t p = 0; p < pigeons; ++p) {
+    Clause some_hole;
+    for (int64_t h = 0; h < holes; ++h) {
+      sits[p].push_back(solver->NewVariable());
+      some_hole.push_back(SatLiteral::Positive(sits[p][h]));
+    }
+    solver->AddClause(some_hole);
+  }
+  for (int64_t h = 0; h < holes; ++h) {
+    for (int64_t p = 0; p < pigeons; ++p) {
+      for (int64_t q = p + 1; q < pigeons; ++q) {
+        solver->AddClause({SatLiteral::Negative(sits[p][h]),
+                           SatLiteral::Negative(sits[q][h])});
+      }
+    }
+  }
+}
+
+TEST(SatSolverTest, Empty) {
+  SatSolver solver;
+  EXPECT_EQ(solver.Solve(), SatResult::kSatisfiable);
+}
+
+TEST(SatSolverTest, Simple) {
+  SatSolver solver;
+  int64_t x = solver.NewVariable();
+  int64_t y = solver.NewVariable();
+  EXPECT_TRUE(solver.AddClause({SatLiteral::Positive(x),
+                                SatLiteral::Positive(y)}));
+  EXPECT_TRUE(solver.AddClause({SatLiteral::Negative(x)}));
+  ASSERT_EQ(solver.Solve(), SatResult::kSatisfiable);
+  EXPECT_FALSE(solver.ModelValue(x));
+  EXPECT_TRUE(solver.ModelValue(y));
+  EXPECT_TRUE(solver.ModelValue(SatLiteral::Negative(x)));
+
+  EXPECT_FALSE(solver.AddClause({SatLiteral::Negative(y)}));
+  EXPECT_EQ(solver.Solve(), SatResult::kUnsatisfiable);
+}
+
+TEST(SatSolverTest, Tautology) {
+  SatSolver solver;
+  int64_t x = solver.NewVariable();
+  EXPECT_TRUE(
+      solver.AddClause({SatLiteral::Positive(x), SatLiteral::Negative(x)}));
+  EXPECT_EQ(solver.Solve(), SatResult::kSatisfiable);
+}
+
+TEST(SatSolverTest, Assumptions) {
+  SatSolver solver;
+  int64_t x = solver.NewVariable();
+  int64_t y = solver.NewVariable();
+  solver.AddClause({SatLiteral::Positive(x), SatLiteral::Positive(y)});
+  EXPECT_EQ(solver.Solve({SatLiteral::Negative(x), SatLiteral::Negative(y)}),
+            SatResult::kUnsatisfiable);
+  ASSERT_EQ(solver.Solve({SatLiteral::Negative(x)}), SatResult::kSatisfiable);
+  EXPECT_TRUE(solver.ModelValue(y));
+  // Assumptions only hold for a single call.
+  ASSERT_EQ(solver.Solve({SatLiteral::Negative(y)}), SatResult::kSatisfiable);
+  EXPECT_TRUE(solver.ModelValue(x));
+}
+
+TEST(SatSolverTest, Pigeonhole) {
+  SatSolver solver;
+  AddPigeonhole(/*pigeons=*/7, /*holes=*/6, &solver);
+  EXPECT_EQ(solver.Solve(), SatResult::kUnsatisfiable);
+  EXPECT_GT(solver.conflict_count(), 0);
+}
+
+TEST(SatSolverTest, PigeonholeFits) {
+  SatSolver solver;
+  AddPigeonhole(/*pigeons=*/6, /*holes=*/6, &solver);
+  EXPECT_EQ(solver.Solve(), SatResult::kSatisfiable);
+}
+
+TEST(SatSolverTest, ConflictLimit) {
+  SatSolver solver;
+  AddPigeonhole(/*pigeons=*/10, /*holes=*/9, &solver);
+  EXPECT_EQ(solver.Solve({}, /*conflict_limit=*/10), SatResult::kUnknown);
+}
+
+TEST(SatSolverTest, RandomThreeSatMatchesBruteForce) {
+  constexpr int64_t kVariables = 12;
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<int64_t> variable(0, kVariables - 1);
+  std::bernoulli_distribution negated(0.5);
+  int64_t satisfiable_count = 0;
+  for (int64_t instance = 0; instance < 200; ++instance) {
+    // Near the phase transition, so both results are common.
+    std::vector<Clause> clauses(51);
+    for (Clause& clause : clauses) {
+      for (int64_t i = 0; i < 3; ++i) {
+        int64_t v = variable(engine);
+        clause.push_back(negated(engine) ? SatLiteral::Negative(v)
+                                         : SatLiteral::Positive(v));
+      }
+    }
+    bool expected_satisfiable = false;
+    for (int64_t bits = 0; bits < (1 << kVariables); ++bits) {
+      std::vector<bool> assignment(kVariables);
+      for (int64_t v = 0; v < kVariables; ++v) {
+        assignment[v] = ((bits >> v) & 1) != 0;
+      }
+      bool all = true;
+      for (const Clause& clause : clauses) {
+        all = all && IsSatisfiedBy(clause, assignment);
+      }
+      if (all) {
+        expected_satisfiable = true;
+        break;
+      }
+    }
+
+    SatSolver solver;
+    for (int64_t v = 0; v < kVariables; ++v) {
+      solver.NewVariable();
+    }
+    for (const Clause& clause : clauses) {
+      solver.AddClause(clause);
+    }
+    SatResult result = solver.Solve();
+    ASSERT_EQ(result, expected_satisfiable ? SatResult::kSatisfiable
+                                           : SatResult::kUnsatisfiable)
+        << "instance " << instance;
+    if (expected_satisfiable) {
+      ++satisfiable_count;
+      std::vector<bool> model(kVariables);
+      for (int64_t v = 0; v < kVariables; ++v) {
+        model[v] = solver.ModelValue(v);
+      }
+      for (const Clause& clause : clauses) {
+        EXPECT_TRUE(IsSatisfiedBy(clause, model)) << "instance " << instance;
+      }
+    }
+  }
+  EXPECT_GT(satisfiable_count, 0);
+  EXPECT_LT(satisfiable_count, 200);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace xls
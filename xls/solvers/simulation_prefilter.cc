@@ -0,0 +1,261 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/simulation_prefilter.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/jit/ir_jit.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+// Arguments are packed at offsets which are multiples of this many bytes (the
+// alignment of heap allocations) so that each is suitably aligned for the JIT.
+constexpr int64_t kBufferAlignment = 16;
+
+int64_t RoundUpToAlignment(int64_t bytes) {
+  return (bytes + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+// Builds in the empty function "query" a function with the same parameters as
+// "f" which returns a bits[1] value that is one iff "subject" violates the
+// predicate. Only the cones of influence of the compared nodes are copied.
+absl::Status BuildViolationFunction(Function* f, Node* subject,
+                                    z3::Predicate p, Function* query) {
+  std::vector<Node*> roots = {subject};
+  if (p.kind() == z3::PredicateKind::kEqualToNode) {
+    roots.push_back(p.node());
+  }
+  absl::flat_hash_set<Node*> cone;
+  std::vector<Node*> worklist = roots;
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (!cone.insert(node).second) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      worklist.push_back(operand);
+    }
+  }
+
+  absl::flat_hash_map<Node*, Node*> original_to_clone;
+  // All parameters are cloned, in order, so that arguments for "query" are
+  // also arguments for "f".
+  for (Param* param : f->params()) {
+    XLS_ASSIGN_OR_RETURN(original_to_clone[param],
+                         param->CloneInNewFunction({}, query));
+  }
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Param>() || !cone.contains(node)) {
+      continue;
+    }
+    std::vector<Node*> cloned_operands;
+    for (Node* operand : node->operands()) {
+      cloned_operands.push_back(original_to_clone.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(original_to_clone[node],
+                         node->CloneInNewFunction(cloned_operands, query));
+  }
+
+  Node* value = original_to_clone.at(subject);
+  Node* violation;
+  switch (p.kind()) {
+    case z3::PredicateKind::kEqualToZero:
+    case z3::PredicateKind::kNotEqualToZero: {
+      XLS_ASSIGN_OR_RETURN(
+          Literal * zero,
+          query->MakeNode<Literal>(subject->loc(),
+                                   Value(UBits(0, subject->BitCountOrDie()))));
+      XLS_ASSIGN_OR_RETURN(
+          violation,
+          query->MakeNode<CompareOp>(
+              subject->loc(), value, zero,
+              p.kind() == z3::PredicateKind::kEqualToZero ? Op::kNe
+                                                          : Op::kEq));
+      break;
+    }
+    case z3::PredicateKind::kEqualToNode:
+      XLS_ASSIGN_OR_RETURN(violation, query->MakeNode<CompareOp>(
+                                          subject->loc(), value,
+                                          original_to_clone.at(p.node()),
+                                          Op::kNe));
+      break;
+  }
+  return query->set_return_value(violation);
+}
+
+// Returns the arguments for sample number "index"; the first half of the
+// samples are biased towards corner cases.
+std::vector<Value> SampleArguments(Function* f, int64_t index,
+                                   const PrefilterOptions& options,
+                                   std::minstd_rand* engine) {
+  return index < options.samples / 2 ? CornerCaseFunctionArguments(f, engine)
+                                     : RandomFunctionArguments(f, engine);
+}
+
+absl::StatusOr<absl::optional<std::vector<Value>>> SimulateWithJit(
+    Function* query, const PrefilterOptions& options, int64_t* sample_count) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrJit> jit, IrJit::Create(query));
+  std::vector<Type*> param_types;
+  std::vector<int64_t> arg_offsets;
+  int64_t sample_bytes = 0;
+  for (int64_t i = 0; i < query->params().size(); ++i) {
+    param_types.push_back(query->param(i)->GetType());
+    arg_offsets.push_back(sample_bytes);
+    sample_bytes += RoundUpToAlignment(jit->GetArgTypeSize(i));
+  }
+  Type* return_type = query->return_value()->GetType();
+
+  // The arguments of a whole batch are generated and packed into a single
+  // buffer up front, then evaluated back to back.
+  int64_t batch_size = std::max<int64_t>(1, options.batch_size);
+  std::vector<uint8_t> batch_buffer(batch_size * sample_bytes);
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  std::vector<std::vector<Value>> batch_args(batch_size);
+  std::vector<uint8_t*> arg_buffers(param_types.size());
+  std::minstd_rand engine(options.seed);
+  for (int64_t start = 0; start < options.samples; start += batch_size) {
+    int64_t end = std::min(options.samples, start + batch_size);
+    for (int64_t i = start; i < end; ++i) {
+      std::vector<Value>& args = batch_args[i - start];
+      args = SampleArguments(query, i, options, &engine);
+      uint8_t* sample = batch_buffer.data() + (i - start) * sample_bytes;
+      for (int64_t j = 0; j < args.size(); ++j) {
+        arg_buffers[j] = sample + arg_offsets[j];
+      }
+      XLS_RETURN_IF_ERROR(jit->runtime()->PackArgs(
+          args, param_types, absl::MakeSpan(arg_buffers)));
+    }
+    for (int64_t i = start; i < end; ++i) {
+      uint8_t* sample = batch_buffer.data() + (i - start) * sample_bytes;
+      for (int64_t j = 0; j < arg_buffers.size(); ++j) {
+        arg_buffers[j] = sample + arg_offsets[j];
+      }
+      XLS_RETURN_IF_ERROR(jit->RunWithViews(absl::MakeSpan(arg_buffers),
+                                            absl::MakeSpan(result_buffer)));
+      ++*sample_count;
+      if (jit->runtime()
+              ->UnpackBuffer(result_buffer.data(), return_type)
+              .IsAllOnes()) {
+        return std::move(batch_args[i - start]);
+      }
+    }
+  }
+  return absl::nullopt;
+}
+
+absl::StatusOr<absl::optional<std::vector<Value>>> SimulateWithInterpreter(
+    Function* query, const PrefilterOptions& options, int64_t* sample_count) {
+  std::minstd_rand engine(options.seed);
+  for (int64_t i = 0; i < options.samples; ++i) {
+    std::vector<Value> args = SampleArguments(query, i, options, &engine);
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+                         InterpretFunction(query, args));
+    ++*sample_count;
+    if (result.value.IsAllOnes()) {
+      return args;
+    }
+  }
+  return absl::nullopt;
+}
+
+}  // namespace
+
+std::string PrefilterStats::ToString() const {
+  return absl::StrFormat(
+      "%d queries, %d short-circuited by simulation (%d samples, %s), %d "
+      "passed to the solver (%s)",
+      query_count, short_circuit_count, sample_count,
+      absl::FormatDuration(simulation_time), solver_count,
+      absl::FormatDuration(solver_time));
+}
+
+absl::StatusOr<absl::optional<std::vector<Value>>>
+SimulationPrefilter::FindCounterexample(Function* f, Node* subject,
+                                        z3::Predicate p) {
+  if (options_.samples <= 0 || !subject->GetType()->IsBits() ||
+      (p.kind() == z3::PredicateKind::kEqualToNode &&
+       p.node()->GetType() != subject->GetType())) {
+    return absl::nullopt;
+  }
+  XLS_RET_CHECK_EQ(subject->function_base(), f);
+
+  absl::Time start = absl::Now();
+  // The query is built in the package of "f" (so that it may invoke the same
+  // functions) and removed again once simulated.
+  Function* query = f->package()->AddFunction(std::make_unique<Function>(
+      absl::StrCat(f->name(), "__prefilter_query"), f->package()));
+  absl::StatusOr<absl::optional<std::vector<Value>>> counterexample;
+  absl::Status status = BuildViolationFunction(f, subject, p, query);
+  if (!status.ok()) {
+    counterexample = status;
+  } else if (options_.engine == SimulationEngine::kJit) {
+    counterexample = SimulateWithJit(query, options_, &stats_.sample_count);
+  } else {
+    counterexample =
+        SimulateWithInterpreter(query, options_, &stats_.sample_count);
+  }
+  XLS_RETURN_IF_ERROR(f->package()->RemoveFunction(query));
+  stats_.simulation_time += absl::Now() - start;
+  return counterexample;
+}
+
+absl::StatusOr<PrefilterResult> SimulationPrefilter::TryProve(
+    Function* f, Node* subject, z3::Predicate p, absl::Duration timeout) {
+  ++stats_.query_count;
+  absl::StatusOr<absl::optional<std::vector<Value>>> counterexample =
+      FindCounterexample(f, subject, p);
+  if (!counterexample.ok()) {
+    // Simulation is only an optimization; the solver may still succeed.
+    XLS_VLOG(1) << "Simulation of " << subject->GetName() << " "
+                << p.ToString() << " failed: " << counterexample.status();
+  } else if (counterexample->has_value()) {
+    ++stats_.short_circuit_count;
+    PrefilterResult result;
+    result.proven = false;
+    result.counterexample = std::move(counterexample->value());
+    return result;
+  }
+
+  ++stats_.solver_count;
+  absl::Time start = absl::Now();
+  absl::StatusOr<bool> proven = prover_(f, subject, p, timeout);
+  stats_.solver_time += absl::Now() - start;
+  XLS_RETURN_IF_ERROR(proven.status());
+  PrefilterResult result;
+  result.proven = proven.value();
+  return result;
+}
+
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,129 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Simulation-based pre-filtering of solver queries.
+//
+// Most queries posed while disproving candidate rewrites are false, and for
+// most of those a handful of random or corner-case arguments exhibit a
+// counterexample. SimulationPrefilter evaluates the predicate on such
+// arguments (with the JIT, in batches) before invoking the solver, and only
+// pays for a solver call when simulation finds nothing.
+
+#ifndef XLS_SOLVERS_SIMULATION_PREFILTER_H_
+#define XLS_SOLVERS_SIMULATION_PREFILTER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls {
+namespace solvers {
+
+enum class SimulationEngine {
+  // Compiles the query with the JIT. Best when many samples are evaluated.
+  kJit,
+  // Evaluates the query with the IR interpreter, which has no compilation
+  // cost; useful for small sample counts.
+  kInterpreter,
+};
+
+struct PrefilterOptions {
+  // Number of argument sets to simulate before invoking the solver; zero
+  // disables simulation. The first half are biased towards corner cases, the
+  // rest are uniformly random.
+  int64_t samples = 2048;
+
+  // Number of argument sets generated and packed for the simulator at a time.
+  int64_t batch_size = 256;
+
+  // Seed for generating the simulation arguments.
+  int64_t seed = 0;
+
+  SimulationEngine engine = SimulationEngine::kJit;
+};
+
+// Counters accumulated over all queries posed to a SimulationPrefilter.
+struct PrefilterStats {
+  int64_t query_count = 0;
+  // Queries disproven by simulation, without invoking the solver.
+  int64_t short_circuit_count = 0;
+  // Queries passed on to the solver.
+  int64_t solver_count = 0;
+  // Total number of argument sets simulated.
+  int64_t sample_count = 0;
+
+  absl::Duration simulation_time;
+  absl::Duration solver_time;
+
+  std::string ToString() const;
+};
+
+struct PrefilterResult {
+  bool proven;
+
+  // Argument values for which the predicate does not hold, if the query was
+  // disproven by simulation. (Disproofs by the solver carry no
+  // counterexample.)
+  absl::optional<std::vector<Value>> counterexample;
+};
+
+// Signature of the solver invoked for queries which simulation can't
+// disprove, e.g., z3::TryProve.
+using ProverFn = std::function<absl::StatusOr<bool>(
+    Function* f, Node* subject, z3::Predicate p, absl::Duration timeout)>;
+
+// Front end for TryProve-style queries which first searches for a
+// counterexample by simulation.
+class SimulationPrefilter {
+ public:
+  explicit SimulationPrefilter(PrefilterOptions options = PrefilterOptions(),
+                               ProverFn prover = z3::TryProve)
+      : options_(options), prover_(std::move(prover)) {}
+
+  // Attempts to prove node "subject" in function "f" satisfies the given
+  // predicate over all possible inputs. The solver is only invoked (with the
+  // given timeout) if simulation finds no counterexample.
+  absl::StatusOr<PrefilterResult> TryProve(Function* f, Node* subject,
+                                           z3::Predicate p,
+                                           absl::Duration timeout);
+
+  // Only runs the simulation: returns argument values for which the predicate
+  // does not hold, or nullopt if none of the samples is a counterexample.
+  // Queries which can't be simulated (e.g., of token-typed nodes) also return
+  // nullopt.
+  absl::StatusOr<absl::optional<std::vector<Value>>> FindCounterexample(
+      Function* f, Node* subject, z3::Predicate p);
+
+  const PrefilterStats& stats() const { return stats_; }
+
+ private:
+  PrefilterOptions options_;
+  ProverFn prover_;
+  PrefilterStats stats_;
+};
+
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_SIMULATION_PREFILTER_H_
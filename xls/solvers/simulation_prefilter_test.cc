@@ -0,0 +1,207 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/simulation_prefilter.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace solvers {
+namespace {
+
+using z3::Predicate;
+using ::testing::SizeIs;
+
+class SimulationPrefilterTest
+    : public IrTestBase,
+      public testing::WithParamInterface<SimulationEngine> {
+ protected:
+  const absl::Duration kTimeout = absl::Seconds(60);
+
+  PrefilterOptions Options() {
+    PrefilterOptions options;
+    options.samples = 512;
+    options.batch_size = 64;
+    options.engine = GetParam();
+    return options;
+  }
+};
+
+TEST_P(SimulationPrefilterTest, ShortCircuitsFalseQuery) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+)",
+                                                       p.get()));
+  int64_t solver_calls = 0;
+  SimulationPrefilter prefilter(
+      Options(), [&](Function*, Node*, Predicate, absl::Duration) {
+        ++solver_calls;
+        return false;
+      });
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PrefilterResult result,
+      prefilter.TryProve(f, f->return_value(), Predicate::NotEqualToZero(),
+                         kTimeout));
+  EXPECT_FALSE(result.proven);
+  ASSERT_TRUE(result.counterexample.has_value());
+  ASSERT_THAT(*result.counterexample, SizeIs(2));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> value,
+                           InterpretFunction(f, *result.counterexample));
+  EXPECT_TRUE(value.value.IsAllZeros());
+
+  EXPECT_EQ(solver_calls, 0);
+  EXPECT_EQ(prefilter.stats().query_count, 1);
+  EXPECT_EQ(prefilter.stats().short_circuit_count, 1);
+  EXPECT_EQ(prefilter.stats().solver_count, 0);
+  EXPECT_GT(prefilter.stats().sample_count, 0);
+  // The query function is removed from the package again.
+  EXPECT_THAT(p->functions(), SizeIs(1));
+}
+
+TEST_P(SimulationPrefilterTest, ProvesWithSolver) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8]) -> bits[8] {
+  not.1: bits[8] = not(x)
+  ret and.2: bits[8] = and(x, not.1)
+}
+)",
+                                                       p.get()));
+  SimulationPrefilter prefilter(Options());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PrefilterResult result,
+      prefilter.TryProve(f, f->return_value(), Predicate::EqualToZero(),
+                         kTimeout));
+  EXPECT_TRUE(result.proven);
+  EXPECT_FALSE(result.counterexample.has_value());
+  EXPECT_EQ(prefilter.stats().short_circuit_count, 0);
+  EXPECT_EQ(prefilter.stats().solver_count, 1);
+  EXPECT_EQ(prefilter.stats().sample_count, 512);
+}
+
+TEST_P(SimulationPrefilterTest, RareCounterexampleFallsBackToSolver) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32]) -> bits[1] {
+  literal.1: bits[32] = literal(value=0x5a3c71e2)
+  ret eq.2: bits[1] = eq(x, literal.1)
+}
+)",
+                                                       p.get()));
+  SimulationPrefilter prefilter(Options());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PrefilterResult result,
+      prefilter.TryProve(f, f->return_value(), Predicate::EqualToZero(),
+                         kTimeout));
+  EXPECT_FALSE(result.proven);
+  EXPECT_FALSE(result.counterexample.has_value());
+  EXPECT_EQ(prefilter.stats().solver_count, 1);
+}
+
+TEST_P(SimulationPrefilterTest, EqualToNode) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(x, x)
+  literal.2: bits[8] = literal(value=1)
+  shll.3: bits[8] = shll(x, literal.2)
+  umul.4: bits[8] = umul(x, literal.2)
+  ret sub.5: bits[8] = sub(y, x)
+}
+)",
+                                                       p.get()));
+  SimulationPrefilter prefilter(Options());
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, f->GetNode("add.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * shll, f->GetNode("shll.3"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * umul, f->GetNode("umul.4"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PrefilterResult result,
+      prefilter.TryProve(f, add, Predicate::EqualTo(shll), kTimeout));
+  EXPECT_TRUE(result.proven);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, prefilter.TryProve(f, add, Predicate::EqualTo(umul), kTimeout));
+  EXPECT_FALSE(result.proven);
+  ASSERT_TRUE(result.counterexample.has_value());
+  // Arguments are given for all parameters of "f", even those outside of the
+  // cones of the compared nodes.
+  ASSERT_THAT(*result.counterexample, SizeIs(2));
+  uint64_t x = result.counterexample->at(0).bits().ToUint64().value();
+  EXPECT_NE((2 * x) % 256, x);
+
+  EXPECT_EQ(prefilter.stats().query_count, 2);
+  EXPECT_EQ(prefilter.stats().short_circuit_count, 1);
+  EXPECT_EQ(prefilter.stats().solver_count, 1);
+}
+
+TEST_P(SimulationPrefilterTest, InvokesAreSimulated) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+fn double(x: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, x)
+}
+
+top fn f(x: bits[8]) -> bits[8] {
+  ret invoke.2: bits[8] = invoke(x, to_apply=double)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetTopAsFunction());
+  SimulationPrefilter prefilter(Options(), [](Function*, Node*, Predicate,
+                                              absl::Duration) { return true; });
+  XLS_ASSERT_OK_AND_ASSIGN(
+      absl::optional<std::vector<Value>> counterexample,
+      prefilter.FindCounterexample(f, f->return_value(),
+                                   Predicate::NotEqualToZero()));
+  ASSERT_TRUE(counterexample.has_value());
+  EXPECT_EQ(counterexample->at(0).bits().ToUint64().value() % 128, 0);
+}
+
+TEST_P(SimulationPrefilterTest, SimulationDisabled) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8]) -> bits[8] {
+  ret identity.1: bits[8] = identity(x)
+}
+)",
+                                                       p.get()));
+  PrefilterOptions options = Options();
+  options.samples = 0;
+  SimulationPrefilter prefilter(options);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PrefilterResult result,
+      prefilter.TryProve(f, f->return_value(), Predicate::EqualToZero(),
+                         kTimeout));
+  EXPECT_FALSE(result.proven);
+  EXPECT_EQ(prefilter.stats().sample_count, 0);
+  EXPECT_EQ(prefilter.stats().solver_count, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimulationPrefilterTestInstantiation,
+                         SimulationPrefilterTest,
+                         testing::Values(SimulationEngine::kJit,
+                                         SimulationEngine::kInterpreter));
+
+}  // namespace
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,110 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Equivalence checking of two XLS IR functions by SAT sweeping.
+//
+// Proving two large functions equivalent with a single query over their
+// return values often times out, even when (as for the input and output of the
+// optimizer) the functions share most of their internal structure. SAT
+// sweeping exploits that structure:
+//
+//  1. Both functions are simulated on the same random and corner-case
+//     arguments, giving each bits-typed node a signature of its values.
+//  2. Each node of the second function whose signature matches a node of the
+//     first is a candidate equivalence. Candidates are proven bottom-up (in
+//     topological order), each with a query over the cones of influence of
+//     the two nodes only.
+//  3. Once a pair is proven equivalent, both nodes are replaced by a single
+//     free variable (a cut point) in all later queries, so those only have to
+//     reason about the logic above the last proven pairs.
+//
+// Cut points over-approximate the logic below them, so a failed candidate
+// proof does not imply that the nodes differ; such candidates are simply left
+// unmerged. Only the final comparison of the return values falls back to a
+// query without cut points.
+
+#ifndef XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
+#define XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+
+struct EquivalenceOptions {
+  // Number of argument sets to simulate to compute node signatures. The first
+  // half are biased towards corner cases, the rest are uniformly random.
+  int64_t simulation_samples = 128;
+
+  // Seed for generating the simulation arguments.
+  int64_t seed = 0;
+
+  // Time allowed for proving each candidate pair of internal nodes. Candidates
+  // which can't be proven in this time are left unmerged.
+  absl::Duration candidate_timeout = absl::Seconds(1);
+
+  // Time allowed for each of the final queries over the return values.
+  absl::Duration timeout = absl::InfiniteDuration();
+};
+
+enum class EquivalenceResult {
+  // The functions produce the same value for all arguments.
+  kEquivalent,
+  // The functions produce different values for some arguments.
+  kNotEquivalent,
+  // The solver timed out before reaching a conclusion.
+  kUnknown,
+};
+
+std::string EquivalenceResultToString(EquivalenceResult result);
+
+struct EquivalenceReport {
+  EquivalenceResult result;
+
+  // If the functions were found to differ during simulation, the arguments
+  // for which they differ. (Differences found by the solver are only
+  // described in "solver_output".)
+  absl::optional<std::vector<Value>> counterexample;
+
+  // Output of the solver for the last query over the return values, including
+  // a model demonstrating a difference, if found. Empty if no such query was
+  // needed.
+  std::string solver_output;
+
+  // Number of candidate pairs of internal nodes with matching signatures, and
+  // the number of those proven equivalent.
+  int64_t candidate_pairs = 0;
+  int64_t proven_pairs = 0;
+};
+
+// Attempts to prove that functions "a" and "b" are equivalent. The functions
+// must have the same signature and must not contain invokes, maps or loops;
+// inline and unroll these first.
+absl::StatusOr<EquivalenceReport> TryProveEquivalence(
+    Function* a, Function* b, const EquivalenceOptions& options);
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
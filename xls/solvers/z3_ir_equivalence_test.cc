@@ -0,0 +1,158 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/solvers/z3_ir_equivalence.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using solvers::z3::EquivalenceOptions;
+using solvers::z3::EquivalenceReport;
+using solvers::z3::EquivalenceResult;
+using solvers::z3::TryProveEquivalence;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+class Z3IrEquivalenceTest : public IrTestBase {};
+
+TEST_F(Z3IrEquivalenceTest, EquivalentAfterReassociation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[16], y: bits[16], z: bits[16]) -> bits[16] {
+  m: bits[16] = umul(x, y)
+  s: bits[16] = add(m, z)
+  ret r: bits[16] = xor(s, x)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[16], y: bits[16], z: bits[16]) -> bits[16] {
+  m: bits[16] = umul(y, x)
+  s: bits[16] = add(z, m)
+  ret r: bits[16] = xor(x, s)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(EquivalenceReport report,
+                           TryProveEquivalence(a, b, EquivalenceOptions()));
+  EXPECT_EQ(report.result, EquivalenceResult::kEquivalent);
+  // The params, product, sum and result all match up.
+  EXPECT_EQ(report.candidate_pairs, 6);
+  EXPECT_EQ(report.proven_pairs, 6);
+}
+
+TEST_F(Z3IrEquivalenceTest, EquivalentTupleResults) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+  s: bits[8] = sub(x, y)
+  c: bits[1] = ult(x, y)
+  ret t: (bits[8], bits[1]) = tuple(s, c)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+  n: bits[8] = neg(y)
+  s: bits[8] = add(x, n)
+  c: bits[1] = ugt(y, x)
+  ret t: (bits[8], bits[1]) = tuple(s, c)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(EquivalenceReport report,
+                           TryProveEquivalence(a, b, EquivalenceOptions()));
+  EXPECT_EQ(report.result, EquivalenceResult::kEquivalent);
+}
+
+TEST_F(Z3IrEquivalenceTest, DifferenceFoundBySimulation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[8], y: bits[8]) -> bits[8] {
+  ret r: bits[8] = add(x, y)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[8], y: bits[8]) -> bits[8] {
+  ret r: bits[8] = sub(x, y)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(EquivalenceReport report,
+                           TryProveEquivalence(a, b, EquivalenceOptions()));
+  EXPECT_EQ(report.result, EquivalenceResult::kNotEquivalent);
+  ASSERT_TRUE(report.counterexample.has_value());
+  EXPECT_THAT(*report.counterexample, SizeIs(2));
+  EXPECT_THAT(report.solver_output, IsEmpty());
+}
+
+TEST_F(Z3IrEquivalenceTest, DifferenceFoundBySolver) {
+  // The functions only differ for a single value of "x", which simulation is
+  // unlikely to hit.
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[32], y: bits[32]) -> bits[32] {
+  ret r: bits[32] = add(x, y)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[32], y: bits[32]) -> bits[32] {
+  s: bits[32] = add(x, y)
+  k: bits[32] = literal(value=0x12345678)
+  zero: bits[32] = literal(value=0)
+  e: bits[1] = eq(x, k)
+  ret r: bits[32] = sel(e, cases=[s, zero])
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(EquivalenceReport report,
+                           TryProveEquivalence(a, b, EquivalenceOptions()));
+  EXPECT_EQ(report.result, EquivalenceResult::kNotEquivalent);
+  EXPECT_FALSE(report.counterexample.has_value());
+  EXPECT_THAT(report.solver_output, Not(IsEmpty()));
+  // "r" of "b" matches "r" of "a" in simulation, but can't be proven.
+  EXPECT_EQ(report.proven_pairs, report.candidate_pairs - 1);
+}
+
+TEST_F(Z3IrEquivalenceTest, DifferentSignatures) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * a, ParseFunction(R"(
+fn a(x: bits[8]) -> bits[8] {
+  ret r: bits[8] = neg(x)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * b, ParseFunction(R"(
+fn b(x: bits[4]) -> bits[4] {
+  ret r: bits[4] = neg(x)
+}
+)",
+                                                       p.get()));
+  EXPECT_THAT(TryProveEquivalence(a, b, EquivalenceOptions()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("different signatures")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -186,6 +186,18 @@ absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
   return translator;
 }
 
+absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
+    Function* function, absl::Span<Node* const> roots) {
+  Z3_config config = Z3_mk_config();
+  Z3_set_param_value(config, "proof", "true");
+  auto translator = absl::WrapUnique(new IrTranslator(config, function));
+  for (Node* root : roots) {
+    XLS_RET_CHECK_EQ(root->function_base(), function) << root->GetName();
+    XLS_RETURN_IF_ERROR(root->Accept(translator.get()));
+  }
+  return translator;
+}
+
 absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
     Z3_context ctx, Function* function,
     absl::Span<const Z3_ast> imported_params) {
@@ -1220,7 +1232,14 @@ absl::StatusOr<Z3_ast> PredicateToObjective(Predicate p, Z3_ast a,
 
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout) {
-  XLS_ASSIGN_OR_RETURN(auto translator, IrTranslator::CreateAndTranslate(f));
+  // Only the cone of influence of the nodes being compared is relevant to the
+  // proof.
+  std::vector<Node*> roots = {subject};
+  if (p.kind() == PredicateKind::kEqualToNode) {
+    roots.push_back(p.node());
+  }
+  XLS_ASSIGN_OR_RETURN(auto translator,
+                       IrTranslator::CreateAndTranslate(f, roots));
   translator->SetTimeout(timeout);
   Z3_ast value = translator->GetTranslation(subject);
 
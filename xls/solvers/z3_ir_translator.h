@@ -47,6 +47,12 @@ class IrTranslator : public DfsVisitorWithDefault {
   static absl::StatusOr<std::unique_ptr<IrTranslator>> CreateAndTranslate(
       Function* function);
 
+  // As above, but only translates the cone of influence of "roots": the roots
+  // and, transitively, their operands. Nodes outside of the cone cost no
+  // translation time and need not be supported by the translator.
+  static absl::StatusOr<std::unique_ptr<IrTranslator>> CreateAndTranslate(
+      Function* function, absl::Span<Node* const> roots);
+
   // Translates the given function into a Z3 AST using a preexisting context
   // (i.e., that used by another Z3Translator). This binds the given function
   // to use the specified (already translated) parameters. This is to enable two
@@ -93,6 +93,22 @@ TEST_F(Z3IrTranslatorTest, ParamMinusSelfIsZero) {
   EXPECT_TRUE(proven);
 }
 
+TEST_F(Z3IrTranslatorTest, ProofIgnoresNodesOutsideCone) {
+  // The translator doesn't support udiv, but the node being proven doesn't
+  // depend on it.
+  const std::string program = R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  sub.1: bits[32] = sub(x, x)
+  ret udiv.2: bits[32] = udiv(x, y)
+}
+)";
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  EXPECT_THAT(TryProve(f, FindNode("sub.1", f), Predicate::EqualToZero(),
+                       absl::InfiniteDuration()),
+              IsOkAndHolds(true));
+}
+
 TEST_F(Z3IrTranslatorTest, XPlusYMinusYIsX) {
   const std::string program = R"(
 fn f(x: bits[32], y: bits[32]) -> bits[32] {
@@ -14,11 +14,18 @@
 
 #include "xls/solvers/z3_lec.h"
 
+#include <algorithm>
 #include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
 
 #include "absl/base/internal/sysinfo.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/strip.h"
 #include "xls/codegen/vast.h"
@@ -33,6 +40,8 @@ namespace xls {
 namespace solvers {
 namespace z3 {
 
+using netlist::CellKind;
+using netlist::rtl::Cell;
 using netlist::rtl::Module;
 using netlist::rtl::Netlist;
 using netlist::rtl::NetRef;
@@ -48,17 +57,33 @@ bool CheckingSingleStage(absl::optional<PipelineSchedule> schedule,
 std::vector<const Node*> SetToIdSortedVector(
     const absl::flat_hash_set<const Node*> set) {
   std::vector<const Node*> nodes(set.begin(), set.end());
-  std::sort(nodes.begin(), nodes.end(),
-            [](const Node* a, const Node* b) { return a->id() < b->id(); });
+  // Ids are not necessarily unique (e.g. a parameter may share an id with a
+  // node), so ties are broken by name to make the order deterministic.
+  std::sort(nodes.begin(), nodes.end(), [](const Node* a, const Node* b) {
+    return std::make_pair(a->id(), a->GetName()) <
+           std::make_pair(b->id(), b->GetName());
+  });
   return nodes;
 }
 
+// 64-bit FNV-1a. Used rather than absl::Hash because fingerprints are persisted
+// across runs, and absl::Hash is seeded per process.
+uint64_t Fnv1a64(absl::string_view text) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : text) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
   auto lec = absl::WrapUnique<Lec>(
       new Lec(params.ir_package, params.ir_function, params.netlist,
-              params.netlist_module_name, absl::nullopt, 0));
+              params.netlist_module_name, absl::nullopt, 0,
+              params.solver_threads));
   XLS_RETURN_IF_ERROR(lec->Init());
   return lec;
 }
@@ -69,20 +94,23 @@ absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateForStage(
     const LecParams& params, const PipelineSchedule& schedule, int stage) {
   auto lec = absl::WrapUnique<Lec>(
       new Lec(params.ir_package, params.ir_function, params.netlist,
-              params.netlist_module_name, schedule, stage));
+              params.netlist_module_name, schedule, stage,
+              params.solver_threads));
   XLS_RETURN_IF_ERROR(lec->Init());
   return lec;
 }
 
 Lec::Lec(Package* ir_package, Function* ir_function, Netlist* netlist,
          const std::string& netlist_module_name,
-         absl::optional<PipelineSchedule> schedule, int stage)
+         absl::optional<PipelineSchedule> schedule, int stage,
+         absl::optional<int> solver_threads)
     : ir_package_(ir_package),
       ir_function_(ir_function),
       netlist_(netlist),
       netlist_module_name_(netlist_module_name),
       schedule_(schedule),
-      stage_(stage) {}
+      stage_(stage),
+      solver_threads_(solver_threads) {}
 
 Lec::~Lec() {
   if (model_) {
@@ -142,7 +170,8 @@ absl::Status Lec::Init() {
 
   Z3_ast eval_node = Z3_mk_and(ctx(), eq_nodes.size(), eq_nodes.data());
   eval_node = Z3_mk_not(ctx(), eval_node);
-  solver_ = CreateSolver(ctx(), std::thread::hardware_concurrency());
+  solver_ = CreateSolver(
+      ctx(), solver_threads_.value_or(std::thread::hardware_concurrency()));
   Z3_solver_assert(ctx(), solver_.value(), eval_node);
 
   return absl::OkStatus();
@@ -266,9 +295,20 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   return absl::OkStatus();
 }
 
+void Lec::SetTimeout(absl::Duration timeout) {
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+                     absl::ToInt64Milliseconds(timeout));
+  Z3_solver_set_params(ctx(), solver_.value(), params);
+  Z3_params_dec_ref(ctx(), params);
+}
+
 bool Lec::Run() {
   XLS_LOG(INFO) << "Beginning execution";
-  satisfiable_ = Z3_solver_check(ctx(), solver_.value()) == Z3_L_TRUE;
+  Z3_lbool result = Z3_solver_check(ctx(), solver_.value());
+  undetermined_ = result == Z3_L_UNDEF;
+  satisfiable_ = result == Z3_L_TRUE;
   if (satisfiable_) {
     model_ = Z3_solver_get_model(ctx(), solver_.value());
     Z3_model_inc_ref(ctx(), model_.value());
@@ -315,6 +355,109 @@ std::string Lec::ResultToString() {
   return absl::StrJoin(output, "\n");
 }
 
+absl::StatusOr<std::string> Lec::Fingerprint() {
+  std::vector<std::string> pieces;
+  if (CheckingSingleStage(schedule_, stage_)) {
+    pieces.push_back(absl::StrCat("stage ", stage_));
+    absl::flat_hash_set<const Node*> inputs;
+    for (const auto& pair : input_mapping_) {
+      inputs.insert(pair.first);
+    }
+    for (const Node* input : SetToIdSortedVector(inputs)) {
+      pieces.push_back(absl::StrCat("input ", input->GetName(), ": ",
+                                    input->GetType()->ToString()));
+    }
+    absl::flat_hash_set<const Node*> stage_nodes(
+        schedule_->nodes_in_cycle(stage_).begin(),
+        schedule_->nodes_in_cycle(stage_).end());
+    for (const Node* node : SetToIdSortedVector(stage_nodes)) {
+      pieces.push_back(node->ToString());
+    }
+    for (const Node* node : ir_output_nodes_) {
+      pieces.push_back(absl::StrCat("output ", node->GetName()));
+    }
+  } else {
+    pieces.push_back(ir_function_->DumpIr());
+  }
+  XLS_ASSIGN_OR_RETURN(std::string cone, NetlistConeToString());
+  pieces.push_back(cone);
+  return absl::StrFormat("%016x", Fnv1a64(absl::StrJoin(pieces, "\n")));
+}
+
+absl::StatusOr<std::string> Lec::NetlistConeToString() {
+  absl::flat_hash_map<NetRef, const Cell*> drivers;
+  for (const auto& cell : module_->cells()) {
+    for (const auto& output : cell->outputs()) {
+      drivers[output.netref] = cell.get();
+    }
+  }
+
+  // Walk backwards from the nets holding the compared outputs. For a single
+  // stage these are the outputs of the stage's output registers, and the walk
+  // passes through those registers but stops at any other.
+  std::vector<NetRef> worklist;
+  absl::flat_hash_set<NetRef> roots;
+  for (const Node* node : ir_output_nodes_) {
+    XLS_ASSIGN_OR_RETURN(std::vector<NetRef> refs, GetIrNetrefs(node));
+    for (NetRef ref : refs) {
+      if (ref != nullptr) {
+        worklist.push_back(ref);
+        roots.insert(ref);
+      }
+    }
+  }
+  std::reverse(worklist.begin(), worklist.end());
+
+  bool stop_at_flops = CheckingSingleStage(schedule_, stage_);
+  std::vector<std::string> lines;
+  absl::flat_hash_set<NetRef> visited;
+  while (!worklist.empty()) {
+    NetRef net = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(net).second) {
+      continue;
+    }
+
+    auto it = drivers.find(net);
+    if (it == drivers.end()) {
+      // Module inputs and constants.
+      lines.push_back(absl::StrCat("net ", net->name()));
+      continue;
+    }
+    const Cell* cell = it->second;
+    if (stop_at_flops && cell->kind() == CellKind::kFlop &&
+        !roots.contains(net)) {
+      lines.push_back(
+          absl::StrCat("boundary ", cell->name(), " ", net->name()));
+      continue;
+    }
+
+    // The functions of the cell's output pins are included so that the
+    // fingerprint also changes when the cell library does.
+    const auto* entry = cell->cell_library_entry();
+    std::string line = absl::StrCat("cell ", cell->name(), " ", entry->name());
+    std::vector<std::pair<std::string, std::string>> pin_functions(
+        entry->output_pin_to_function().begin(),
+        entry->output_pin_to_function().end());
+    std::sort(pin_functions.begin(), pin_functions.end());
+    for (const auto& [pin, function] : pin_functions) {
+      absl::StrAppend(&line, " ", pin, ":(", function, ")");
+    }
+    for (const auto& output : cell->outputs()) {
+      absl::StrAppend(&line, " ", output.name, "=", output.netref->name());
+    }
+    for (const auto& input : cell->inputs()) {
+      absl::StrAppend(&line, " ", input.name, "=", input.netref->name());
+    }
+    lines.push_back(line);
+    for (auto input = cell->inputs().rbegin(); input != cell->inputs().rend();
+         ++input) {
+      worklist.push_back(input->netref);
+    }
+  }
+  return absl::StrJoin(lines, "\n");
+}
+
 absl::Status Lec::CreateIrTranslator() {
   XLS_ASSIGN_OR_RETURN(ir_translator_,
                        IrTranslator::CreateAndTranslate(ir_function_));
@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
@@ -46,6 +47,10 @@ struct LecParams {
 
   // The name of the module (inside "netlist") to compare.
   std::string netlist_module_name;
+
+  // The number of threads the solver may use. Defaults to one per hardware
+  // thread; callers running several checks concurrently should lower this.
+  absl::optional<int> solver_threads;
 };
 
 // Class for performing logical equivalence checks between a function specified
@@ -73,9 +78,27 @@ class Lec {
   // Constraints can not be currently specified with per-stage evaluation.
   absl::Status AddConstraints(Function* constraints);
 
+  // Bounds the time the solver may spend in Run(). Unlike interrupting the
+  // context from a signal handler, this is safe to use when several Lec
+  // objects are being run concurrently.
+  void SetTimeout(absl::Duration timeout);
+
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // Returns true if the last Run() neither proved nor disproved equivalence,
+  // e.g., because the solver timed out or was interrupted. Run()'s return
+  // value is meaningless in that case.
+  bool Undetermined() const { return undetermined_; }
+
+  // Returns a stable (across processes) fingerprint of everything this check
+  // depends on: the IR nodes being compared and the netlist cells in the cone
+  // of logic driving the corresponding netlist outputs. For a per-stage check,
+  // the netlist cone stops at the registers bounding the stage, so editing
+  // the logic of one stage leaves the fingerprints of the others unchanged.
+  // Suitable as a key for caching proof results.
+  absl::StatusOr<std::string> Fingerprint();
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -87,7 +110,8 @@ class Lec {
  private:
   Lec(Package* ir_package, Function* ir_function,
       netlist::rtl::Netlist* netlist, const std::string& netlist_module_name,
-      absl::optional<PipelineSchedule> schedule, int stage);
+      absl::optional<PipelineSchedule> schedule, int stage,
+      absl::optional<int> solver_threads);
   absl::Status Init();
   absl::Status CreateIrTranslator();
   absl::Status CreateNetlistTranslator();
@@ -131,6 +155,10 @@ class Lec {
   // current model.
   std::pair<std::string, std::string> GetComparisonStrings(const Node* node);
 
+  // Returns a canonical textual description of the netlist logic driving this
+  // check's outputs; see Fingerprint().
+  absl::StatusOr<std::string> NetlistConeToString();
+
   // Replaces any values in the given string (nl_string) with "don't care"
   // markers if the corresponding AST nodes aren't present, i.e., if the source
   // wires aren't present in the netlist.
@@ -154,6 +182,7 @@ class Lec {
 
   absl::optional<PipelineSchedule> schedule_;
   int stage_;
+  absl::optional<int> solver_threads_;
 
   // Z3 elements are, under the hood, void pointers, but let's respect the
   // interface and use absl::optional to determine live-ness.
@@ -162,6 +191,7 @@ class Lec {
   // Satisfiable is equivalent to "model_.has_value()", but having an explicit
   // value is more understandable.
   bool satisfiable_;
+  bool undetermined_ = false;
   absl::optional<Z3_model> model_;
 };
 
@@ -17,11 +17,13 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist.pb.h"
 #include "xls/netlist/netlist_parser.h"
 
 namespace xls {
@@ -466,6 +468,136 @@ endmodule
   }
 }
 
+// Returns the per-stage fingerprints of the three-stage and/or/not pipeline
+// used above when checked against the given netlist.
+absl::StatusOr<std::vector<std::string>> StageFingerprints(
+    const std::string& netlist_text, netlist::CellLibrary* cell_library) {
+  std::string ir_text = R"(
+package p
+
+top fn main(i0: bits[1], i1: bits[1], i2: bits[1], i3: bits[1]) -> bits[1] {
+  and.1: bits[1] = and(i0, i1)
+  and.2: bits[1] = and(i2, i3)
+  or.3: bits[1] = or(and.1, and.2)
+  ret not.4: bits[1] = not(or.3)
+}
+)";
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * entry_function, package->GetTopAsFunction());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : entry_function->nodes()) {
+    if (node->Is<Param>() ||
+        node->GetName().find("and") != std::string::npos) {
+      cycle_map[node] = 0;
+    } else if (node->GetName().find("or") != std::string::npos) {
+      cycle_map[node] = 1;
+    } else {
+      cycle_map[node] = 2;
+    }
+  }
+  PipelineSchedule schedule(entry_function, cycle_map, /*length=*/3);
+
+  std::vector<std::string> fingerprints;
+  for (int i = 0; i < schedule.length(); i++) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Lec> lec,
+                         Lec::CreateForStage(params, schedule, i));
+    XLS_ASSIGN_OR_RETURN(std::string fingerprint, lec->Fingerprint());
+    fingerprints.push_back(fingerprint);
+  }
+  return fingerprints;
+}
+
+// Netlist of the three-stage and/or/not pipeline with the cell of the second
+// stage-0 AND left as a parameter ($0).
+constexpr const char kStagedNetlistTemplate[] = R"(
+module main ( clk, i3, i2, i1, i0, out_0);
+  input clk, i3, i2, i1, i0;
+  output out_0;
+  wire p0_i3, p0_i2, p0_i1, p0_i0,
+       p1_and_1_comb, p1_and_2_comb, p1_and_1, p1_and_2,
+       p2_or_3_comb, p2_or_3;
+
+  DFF p0_i3_reg ( .D(i3), .CLK(clk), .Q(p0_i3) );
+  DFF p0_i2_reg ( .D(i2), .CLK(clk), .Q(p0_i2) );
+  DFF p0_i1_reg ( .D(i1), .CLK(clk), .Q(p0_i1) );
+  DFF p0_i0_reg ( .D(i0), .CLK(clk), .Q(p0_i0) );
+
+  AND p1_and_1 ( .A(p0_i0), .B(p0_i1), .Z(p1_and_1_comb) );
+  $0 p1_and_2 ( .A(p0_i2), .B(p0_i3), .Z(p1_and_2_comb) );
+  DFF p1_and_1_reg ( .D(p1_and_1_comb), .CLK(clk), .Q(p1_and_1) );
+  DFF p1_and_2_reg ( .D(p1_and_2_comb), .CLK(clk), .Q(p1_and_2) );
+
+  OR p2_or_3 ( .A(p1_and_1), .B(p1_and_2), .Z(p2_or_3_comb) );
+  DFF p2_or_3_reg ( .D(p2_or_3_comb), .CLK(clk), .Q(p2_or_3) );
+
+  INV p3_not_4 ( .A(p2_or_3), .ZN(out_0) );
+endmodule
+)";
+
+// Verifies that editing the netlist logic of one stage changes only that
+// stage's fingerprint.
+TEST(Z3LecTest, StageFingerprintsTrackNetlistEdits) {
+  XLS_ASSERT_OK_AND_ASSIGN(netlist::CellLibrary cell_library,
+                           netlist::MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> original,
+      StageFingerprints(absl::Substitute(kStagedNetlistTemplate, "AND"),
+                        &cell_library));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> again,
+      StageFingerprints(absl::Substitute(kStagedNetlistTemplate, "AND"),
+                        &cell_library));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> edited,
+      StageFingerprints(absl::Substitute(kStagedNetlistTemplate, "OR"),
+                        &cell_library));
+  ASSERT_EQ(original.size(), 3);
+  EXPECT_EQ(original, again);
+  EXPECT_NE(original[0], edited[0]);
+  EXPECT_EQ(original[1], edited[1]);
+  EXPECT_EQ(original[2], edited[2]);
+}
+
+// Verifies that changing the function of a cell in the library changes the
+// fingerprints of the stages using that cell, even if the netlist does not
+// change.
+TEST(Z3LecTest, StageFingerprintsTrackCellLibraryEdits) {
+  XLS_ASSERT_OK_AND_ASSIGN(netlist::CellLibrary cell_library,
+                           netlist::MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(netlist::CellLibraryProto proto,
+                           cell_library.ToProto());
+  for (netlist::CellLibraryEntryProto& entry : *proto.mutable_entries()) {
+    if (entry.name() == "AND") {
+      entry.mutable_output_pin_list()->mutable_pins(0)->set_function("A|B");
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(netlist::CellLibrary edited_cell_library,
+                           netlist::CellLibrary::FromProto(proto));
+
+  std::string netlist_text = absl::Substitute(kStagedNetlistTemplate, "AND");
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::string> original,
+                           StageFingerprints(netlist_text, &cell_library));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> edited,
+      StageFingerprints(netlist_text, &edited_cell_library));
+  ASSERT_EQ(original.size(), 3);
+  EXPECT_NE(original[0], edited[0]);
+  EXPECT_EQ(original[1], edited[1]);
+  EXPECT_EQ(original[2], edited[2]);
+}
+
 }  // namespace
 }  // namespace z3
 }  // namespace solvers
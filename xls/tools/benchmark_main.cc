@@ -80,6 +80,11 @@ ABSL_FLAG(int64_t, convert_array_index_to_select, -1,
           "equal to the given number of possible indices (by range analysis) "
           "into chains of selects. Otherwise, this optimization is skipped, "
           "since it can sometimes reduce output quality.");
+ABSL_FLAG(int64_t, resource_sharing_max_delay_increase_ps, -1,
+          "If specified, share expensive operations feeding mutually "
+          "exclusive select arms as long as the critical-path delay grows by "
+          "no more than the given number of picoseconds. Otherwise, resource "
+          "sharing is skipped.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
@@ -126,6 +131,12 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
       (convert_array_index_to_select < 0)
           ? std::nullopt
           : std::make_optional(convert_array_index_to_select);
+  int64_t resource_sharing_max_delay_increase_ps =
+      absl::GetFlag(FLAGS_resource_sharing_max_delay_increase_ps);
+  pass_options.resource_sharing_max_delay_increase_ps =
+      (resource_sharing_max_delay_increase_ps < 0)
+          ? std::nullopt
+          : std::make_optional(resource_sharing_max_delay_increase_ps);
   PassResults pass_results;
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package, pass_options, &pass_results).status());
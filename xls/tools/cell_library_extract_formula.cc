@@ -34,8 +34,8 @@ Example invocation:
 )";
 
 ABSL_FLAG(bool, stream_from_file, false,
-          "Uses a file stream instead of loading into memory (to reduce memory "
-          "usage)");
+          "Memory-maps the file instead of loading it into memory (to reduce "
+          "memory usage)");
 
 namespace xls {
 namespace netlist {
@@ -61,7 +61,7 @@ absl::Status DumpOutputPinExpressions(absl::string_view cell_name,
 absl::Status RealMain(absl::string_view path, absl::string_view cell_name,
                       bool stream_from_file) {
   // Either make a char stream that loads the file entirely into memory or
-  // streams it from disk. Since these files can get quite large this can be
+  // maps it from disk. Since these files can get quite large this can be
   // useful.
   std::function<absl::StatusOr<CharStream>()> make_cs;
   absl::optional<std::string> text;
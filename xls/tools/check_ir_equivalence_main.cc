@@ -18,6 +18,7 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -27,12 +28,15 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value_helpers.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/map_inlining_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/passes.h"
 #include "xls/passes/unroll_pass.h"
+#include "xls/solvers/aig_ir_translator.h"
+#include "xls/solvers/z3_ir_equivalence.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_utils.h"
 #include "../z3/src/api/z3.h"
@@ -49,6 +53,16 @@ Example invocation:
 If there are multiple functions in the specified files, then it's _strongly_
 recommended that you specify --function to ensure that the right functions are
 compared. If the tool picks the wrong one, a crash may result.
+
+By default the functions are compared by SAT sweeping: internal nodes which
+behave identically in simulation are proven equivalent bottom-up, and proven
+pairs are replaced by shared variables in later queries. This is typically much
+faster than a single query over the return values when the functions share
+structure, as optimized and unoptimized versions of the same code do.
+
+With --backend=aig, both functions are instead bit-blasted into a single
+structurally hashed and-inverter graph, and the comparison of their return
+values is handed to the built-in SAT solver.
 )";
 
 // LINT.IfChange
@@ -58,6 +72,15 @@ ABSL_FLAG(std::string, top, "",
           "Functions are supported.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(bool, sat_sweeping, true,
+          "Prove equivalence by SAT sweeping rather than by a single query "
+          "over the return values.");
+ABSL_FLAG(absl::Duration, candidate_timeout, absl::Seconds(1),
+          "With --sat_sweeping, how long to spend trying to prove each pair "
+          "of internal nodes equivalent.");
+ABSL_FLAG(std::string, backend, "z3",
+          "Solver to use; choices: z3, aig (bit-blasting to an and-inverter "
+          "graph solved by the built-in SAT solver).");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
@@ -79,8 +102,61 @@ absl::StatusOr<Z3_ast> CreateComparisonFunction(
   return Z3_mk_eq(ctx, result1, result2);
 }
 
+absl::Status CheckBySatSweeping(const std::vector<Function*>& functions,
+                                absl::Duration timeout,
+                                absl::Duration candidate_timeout) {
+  solvers::z3::EquivalenceOptions options;
+  options.timeout = timeout;
+  options.candidate_timeout = candidate_timeout;
+  XLS_ASSIGN_OR_RETURN(
+      solvers::z3::EquivalenceReport report,
+      solvers::z3::TryProveEquivalence(functions[0], functions[1], options));
+  std::cout << absl::StreamFormat(
+                   "Proved %d of %d candidate pairs of internal nodes "
+                   "equivalent.\n",
+                   report.proven_pairs, report.candidate_pairs)
+            << "Result: "
+            << solvers::z3::EquivalenceResultToString(report.result)
+            << std::endl;
+  if (report.counterexample.has_value()) {
+    std::cout << "Results differ for arguments: "
+              << absl::StrJoin(*report.counterexample, ", ",
+                               ValueFormatter)
+              << std::endl;
+  }
+  if (!report.solver_output.empty()) {
+    std::cout << report.solver_output << std::endl;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CheckWithAig(const std::vector<Function*>& functions,
+                          absl::Duration timeout) {
+  XLS_ASSIGN_OR_RETURN(
+      solvers::aig::ProofReport report,
+      solvers::aig::ProveEquivalence(functions[0], functions[1], timeout));
+  std::cout << "AIG proof: " << report.ToString() << std::endl;
+  switch (report.result) {
+    case solvers::aig::ProofResult::kProven:
+      std::cout << "Result: equivalent" << std::endl;
+      break;
+    case solvers::aig::ProofResult::kDisproven:
+      std::cout << "Result: not equivalent" << std::endl
+                << "Results differ for arguments: "
+                << absl::StrJoin(*report.counterexample, ", ", ValueFormatter)
+                << std::endl;
+      break;
+    case solvers::aig::ProofResult::kUnknown:
+      std::cout << "Result: unknown" << std::endl;
+      break;
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(const std::vector<absl::string_view>& ir_paths,
-                      const std::string& entry, absl::Duration timeout) {
+                      const std::string& entry, absl::Duration timeout,
+                      bool sat_sweeping, absl::Duration candidate_timeout,
+                      absl::string_view backend) {
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -119,6 +195,17 @@ absl::Status RealMain(const std::vector<absl::string_view>& ir_paths,
     functions.push_back(func);
   }
 
+  if (backend == "aig") {
+    return CheckWithAig(functions, timeout);
+  }
+  if (backend != "z3") {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid backend: \"%s\"", backend));
+  }
+  if (sat_sweeping) {
+    return CheckBySatSweeping(functions, timeout, candidate_timeout);
+  }
+
   std::vector<std::unique_ptr<IrTranslator>> translators;
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(functions[0]));
@@ -168,5 +255,8 @@ int main(int argc, char** argv) {
       xls::InitXls(kUsage, argc, argv);
   XLS_QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
   XLS_QCHECK_OK(xls::RealMain(positional_args, absl::GetFlag(FLAGS_top),
-                              absl::GetFlag(FLAGS_timeout)));
+                              absl::GetFlag(FLAGS_timeout),
+                              absl::GetFlag(FLAGS_sat_sweeping),
+                              absl::GetFlag(FLAGS_candidate_timeout),
+                              absl::GetFlag(FLAGS_backend)));
 }
@@ -14,8 +14,10 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "google/protobuf/util/json_util.h"
 #include "xls/codegen/combinational_generator.h"
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/codegen/pipeline_generator.h"
@@ -30,6 +32,7 @@
 #include "xls/ir/verifier.h"
 #include "xls/passes/standard_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/schedule_report.h"
 
 const char kUsage[] = R"(
 Generates Verilog RTL from a given IR file. Writes a Verilog file and a module
@@ -50,6 +53,12 @@ Emit a feed-forward pipelined module:
 ABSL_FLAG(int64_t, clock_period_ps, 0, "Target clock period, in picoseconds.");
 ABSL_FLAG(int64_t, pipeline_stages, 0,
           "The number of stages in the generated pipeline.");
+ABSL_FLAG(int64_t, initiation_interval, 1,
+          "The number of cycles between successive inputs of the generated "
+          "pipeline. If greater than one, multipliers and dividers in "
+          "pipeline stages which are active in different cycles share "
+          "functional units; this requires --reset. Only supported for "
+          "functions.");
 ABSL_FLAG(std::string, delay_model, "",
           "Delay model name to use from registry.");
 ABSL_FLAG(
@@ -59,6 +68,15 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, output_schedule_path, "",
           "Specific output path for the generated pipeline schedule. "
           "If not specified, then no schedule is output.");
+ABSL_FLAG(std::string, output_schedule_report_path, "",
+          "Specific output path for a report of the critical path delay, "
+          "slack and pipeline register bits of each stage of the pipeline "
+          "schedule. The report is written as JSON if the path ends in "
+          "'.json', otherwise as a text proto. If not specified, then no "
+          "report is output.");
+ABSL_FLAG(int64_t, schedule_report_top_k, 5,
+          "The number of nodes listed for the critical path and pipeline "
+          "registers of each stage in the schedule report.");
 ABSL_FLAG(std::string, output_block_ir_path, "",
           "Path to write the block-level IR.");
 ABSL_FLAG(
@@ -104,6 +122,17 @@ ABSL_FLAG(bool, add_idle_output, false,
           "flops is added to the block. This output signal is not registered, "
           "regardless of the setting of flop_outputs. "
           "use in generated pipelines. Only used with pipeline generator.");
+ABSL_FLAG(bool, data_load_enable, true,
+          "If true, the pipeline data registers of a function with valid "
+          "control are loaded only when the valid signal of their stage is "
+          "asserted. This reduces switching in the data path when the "
+          "pipeline is idle. Only used with pipeline generator.");
+ABSL_FLAG(bool, retime_pipeline, false,
+          "If true, the pipeline registers of the generated block are moved "
+          "across combinational logic to minimize the critical path as "
+          "measured by the delay model. Pipelines with registers which have a "
+          "reset or load enable are not retimed. Only used with pipeline "
+          "generator.");
 ABSL_FLAG(std::string, module_name, "",
           "Explicit name to use for the generated module; if not provided the "
           "mangled IR function name is used");
@@ -175,6 +204,10 @@ absl::StatusOr<SchedulingOptions> SetupSchedulingOptions() {
   if (absl::GetFlag(FLAGS_clock_period_ps) != 0) {
     scheduling_options.clock_period_ps(absl::GetFlag(FLAGS_clock_period_ps));
   }
+  if (absl::GetFlag(FLAGS_initiation_interval) != 1) {
+    scheduling_options.initiation_interval(
+        absl::GetFlag(FLAGS_initiation_interval));
+  }
   if (absl::GetFlag(FLAGS_clock_margin_percent) != 0) {
     scheduling_options.clock_margin_percent(
         absl::GetFlag(FLAGS_clock_margin_percent));
@@ -245,6 +278,8 @@ absl::StatusOr<verilog::CodegenOptions> GetCodegenOptions() {
     options.flop_single_value_channels(
         absl::GetFlag(FLAGS_flop_single_value_channels));
     options.add_idle_output(absl::GetFlag(FLAGS_add_idle_output));
+    options.data_load_enable(absl::GetFlag(FLAGS_data_load_enable));
+    options.retime_pipeline(absl::GetFlag(FLAGS_retime_pipeline));
 
     if (!absl::GetFlag(FLAGS_reset).empty()) {
       options.reset(absl::GetFlag(FLAGS_reset),
@@ -303,9 +338,36 @@ absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
   return schedule_status;
 }
 
+absl::Status WriteScheduleReport(absl::string_view path,
+                                 const PipelineSchedule& schedule,
+                                 const DelayEstimator& delay_estimator) {
+  absl::optional<int64_t> clock_period_ps;
+  if (absl::GetFlag(FLAGS_clock_period_ps) > 0) {
+    clock_period_ps = absl::GetFlag(FLAGS_clock_period_ps);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      ScheduleReportProto report,
+      GenerateScheduleReport(schedule, delay_estimator, clock_period_ps,
+                             absl::GetFlag(FLAGS_schedule_report_top_k)));
+  if (!absl::EndsWith(path, ".json")) {
+    return SetTextProtoFile(path, report);
+  }
+  std::string json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto status =
+      google::protobuf::util::MessageToJsonString(report, &json, print_options);
+  if (!status.ok()) {
+    return absl::InternalError(std::string{status.message()});
+  }
+  return SetFileContents(path, json);
+}
+
 absl::Status RealMain(absl::string_view ir_path, absl::string_view verilog_path,
                       absl::string_view signature_path,
                       absl::string_view schedule_path,
+                      absl::string_view schedule_report_path,
                       absl::string_view output_block_ir_path) {
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
@@ -335,8 +397,14 @@ absl::Status RealMain(absl::string_view ir_path, absl::string_view verilog_path,
         PipelineSchedule schedule,
         RunSchedulingPipeline(main, scheduling_options, delay_estimator));
 
+    if (!schedule_report_path.empty()) {
+      XLS_RETURN_IF_ERROR(WriteScheduleReport(schedule_report_path, schedule,
+                                              *delay_estimator));
+    }
+
     XLS_ASSIGN_OR_RETURN(
-        result, verilog::ToPipelineModuleText(schedule, main, codegen_options));
+        result, verilog::ToPipelineModuleText(schedule, main, codegen_options,
+                                              delay_estimator));
 
     if (!schedule_path.empty()) {
       XLS_RETURN_IF_ERROR(SetTextProtoFile(schedule_path, schedule.ToProto()));
@@ -385,6 +453,7 @@ int main(int argc, char** argv) {
   XLS_QCHECK_OK(xls::RealMain(ir_path, absl::GetFlag(FLAGS_output_verilog_path),
                               absl::GetFlag(FLAGS_output_signature_path),
                               absl::GetFlag(FLAGS_output_schedule_path),
+                              absl::GetFlag(FLAGS_output_schedule_report_path),
                               absl::GetFlag(FLAGS_output_block_ir_path)));
 
   return EXIT_SUCCESS;
@@ -18,12 +18,14 @@
 
 import subprocess
 
+from google.protobuf import json_format
 from google.protobuf import text_format
 from absl.testing import absltest
 from absl.testing import parameterized
 from xls.codegen import module_signature_pb2
 from xls.common import runfiles
 from xls.common import test_base
+from xls.scheduling import schedule_report_pb2
 
 CODEGEN_MAIN_PATH = runfiles.get_path('xls/tools/codegen_main')
 SHA256_IR_PATH = runfiles.get_path('xls/examples/sha256.opt.ir')
@@ -133,6 +135,34 @@ class CodeGenMainTest(parameterized.TestCase):
         '--output_verilog_path=' + verilog_path, SHA256_IR_PATH
     ])
 
+  @parameterized.parameters(['textproto', 'json'])
+  def test_schedule_report(self, extension):
+    report_path = test_base.create_named_output_text_file(
+        f'sha256.schedule_report.{extension}')
+    subprocess.check_call([
+        CODEGEN_MAIN_PATH, '--generator=pipeline', '--delay_model=unit',
+        '--pipeline_stages=5', '--clock_period_ps=5000',
+        '--schedule_report_top_k=3', '--alsologtostderr',
+        '--output_verilog_path=/dev/null',
+        '--output_schedule_report_path=' + report_path, SHA256_IR_PATH
+    ])
+
+    with open(report_path, 'r') as f:
+      report = schedule_report_pb2.ScheduleReportProto()
+      if extension == 'json':
+        json_format.Parse(f.read(), report)
+      else:
+        text_format.Parse(f.read(), report)
+    self.assertEqual(report.clock_period_ps, 5000)
+    self.assertLen(report.stages, 5)
+    for stage in report.stages:
+      self.assertEqual(stage.slack_ps, 5000 - stage.critical_path_delay_ps)
+      self.assertLessEqual(len(stage.critical_path_nodes), 3)
+      self.assertLessEqual(len(stage.pipeline_register_nodes), 3)
+    self.assertEqual(
+        report.interior_pipeline_register_bits,
+        sum(stage.pipeline_register_bits for stage in report.stages[:-1]))
+
   def test_custom_module_name(self):
     ir_file = self.create_tempfile(content=NOT_ADD_IR)
     verilog = subprocess.check_output([
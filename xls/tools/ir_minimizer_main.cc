@@ -12,8 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
 #include <random>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/random/distributions.h"
 #include "absl/status/status.h"
@@ -23,6 +26,7 @@
 #include "xls/common/file/temp_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/parallel_for.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
@@ -74,6 +78,12 @@ from the interpreter results. Example invocation:
   ir_minimizer_main --test_llvm_jit --use_optimization_pipeline \
     --input='bits[32]:42; bits[1]:0' IR_FILE
 
+Either mode can evaluate several candidate simplifications at once, which
+speeds up the reduction of large samples considerably when the test is slow:
+
+  ir_minimizer_main --test_executable=/foo/test.sh --num_threads=0 \
+    --bulk_removal IR_FILE
+
 )";
 
 ABSL_FLAG(bool, can_remove_params, false,
@@ -119,6 +129,17 @@ ABSL_FLAG(
     "in more minimization than --use_optimization_pipeline which "
     "which might optimize away the problematic bit of IR entirely.");
 ABSL_FLAG(std::string, entry, "", "Entry function to use during minimization.");
+ABSL_FLAG(int64_t, num_threads, 1,
+          "Number of candidate simplifications to generate and test "
+          "concurrently in each round; zero means one per hardware thread. "
+          "The first candidate (in generation order) which still fails is "
+          "accepted. With a value of one candidates are tried one at a time.");
+ABSL_FLAG(bool, bulk_removal, false,
+          "If true, before making random single-node simplifications, try to "
+          "replace whole sets of nodes with zero literals at once, "
+          "delta-debugging style: the nodes are split into chunks which are "
+          "tested (concurrently, see --num_threads) and the chunk count is "
+          "doubled whenever no chunk can be removed.");
 
 namespace xls {
 namespace {
@@ -512,50 +533,14 @@ absl::Status CleanUp(Function* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
-absl::Status RealMain(absl::string_view path,
-                      const int64_t failed_attempt_limit,
-                      const int64_t total_attempt_limit) {
-  XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
-  // Cache of test results to avoid duplicate invocations of the
-  // test_executable.
-  absl::flat_hash_map<std::string, bool> test_cache;
-
-  // Parse inputs, if specified.
-  absl::optional<std::vector<xls::Value>> inputs;
-  if (!absl::GetFlag(FLAGS_input).empty()) {
-    inputs = std::vector<xls::Value>();
-    XLS_QCHECK(absl::GetFlag(FLAGS_test_llvm_jit))
-        << "Can only specify --input with --test_llvm_jit";
-    for (const absl::string_view& value_string :
-         absl::StrSplit(absl::GetFlag(FLAGS_input), ';')) {
-      XLS_ASSIGN_OR_RETURN(Value input, Parser::ParseTypedValue(value_string));
-      inputs->push_back(input);
-    }
-  }
-
-  // Check what the user gave us actually fails.
-  XLS_RETURN_IF_ERROR(VerifyStillFails(
-      knownf_ir_text, inputs,
-      "Originally-provided main function provided does not fail", &test_cache));
-
-  const bool can_remove_params = absl::GetFlag(FLAGS_can_remove_params);
-
-  // Clean up any initial garbage and see if it still fails.
-  {
-    XLS_LOG(INFO) << "=== Cleaning up initial garbage";
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         ParsePackage(knownf_ir_text));
-    XLS_ASSIGN_OR_RETURN(Function * main, package->GetTopAsFunction());
-    XLS_RETURN_IF_ERROR(CleanUp(main, can_remove_params));
-    XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
-    knownf_ir_text = package->DumpIr();
-    XLS_RETURN_IF_ERROR(VerifyStillFails(
-        knownf_ir_text, inputs,
-        "Original main function does not fail after cleanup", &test_cache));
-    XLS_LOG(INFO) << "=== Done cleaning up initial garbage";
-  }
-
-  // If so, we start simplifying via this seeded RNG.
+// Repeatedly applies a random simplification to the known-failing IR and
+// keeps it if the result still fails. Returns the smallest failing IR found.
+absl::StatusOr<std::string> MinimizeSerially(
+    std::string knownf_ir_text,
+    const absl::optional<std::vector<Value>>& inputs, bool can_remove_params,
+    int64_t failed_attempt_limit, int64_t total_attempt_limit,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  // We simplify via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
   // Smallest version of the function that's known to be failing.
@@ -613,7 +598,7 @@ absl::Status RealMain(absl::string_view path,
 
     std::string candidate_ir_text = package->DumpIr();
     XLS_ASSIGN_OR_RETURN(bool still_fails,
-                         StillFails(candidate_ir_text, inputs, &test_cache));
+                         StillFails(candidate_ir_text, inputs, test_cache));
     if (!still_fails) {
       failed_simplification_attempts++;
       XLS_LOG(INFO) << "Sample no longer fails.";
@@ -632,7 +617,7 @@ absl::Status RealMain(absl::string_view path,
 
     XLS_RETURN_IF_ERROR(VerifyStillFails(
         knownf_ir_text, inputs, "Known failure does not fail after cleanup!",
-        &test_cache));
+        test_cache));
 
     knownf_ir_text = candidate_ir_text;
 
@@ -643,6 +628,297 @@ absl::Status RealMain(absl::string_view path,
     failed_simplification_attempts = 0;
   }
 
+  return knownf_ir_text;
+}
+
+// A simplified version of the known-failing IR which is yet to be tested.
+struct Candidate {
+  std::string ir_text;
+  std::string which_transform;
+  int64_t node_count;
+};
+
+// Tests the candidates concurrently (using up to `num_threads` threads) and
+// returns the index of the first candidate, in the given order, which still
+// fails. Candidates after one which is known to fail are not tested. Test
+// results are looked up in and recorded into the (not thread-safe) test cache
+// on the calling thread.
+absl::StatusOr<absl::optional<int64_t>> FindFirstStillFailing(
+    absl::Span<const Candidate> candidates,
+    const absl::optional<std::vector<Value>>& inputs, int64_t num_threads,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  const int64_t count = candidates.size();
+  std::vector<absl::optional<absl::StatusOr<bool>>> results(count);
+  std::atomic<int64_t> first_failing = count;
+  for (int64_t i = 0; i < count; ++i) {
+    auto it = test_cache->find(candidates[i].ir_text);
+    if (it != test_cache->end()) {
+      results[i] = absl::StatusOr<bool>(it->second);
+      if (it->second) {
+        first_failing = std::min(first_failing.load(), i);
+      }
+    }
+  }
+
+  ParallelFor(count, num_threads, [&](int64_t i) {
+    if (results[i].has_value() || i > first_failing.load()) {
+      return;
+    }
+    XLS_VLOG(1) << "=== Verifying candidate " << i << " still fails";
+    XLS_VLOG_LINES(2, candidates[i].ir_text);
+    absl::StatusOr<bool> still_fails =
+        StillFailsHelper(candidates[i].ir_text, inputs);
+    if (still_fails.ok() && *still_fails) {
+      int64_t current = first_failing.load();
+      while (i < current && !first_failing.compare_exchange_weak(current, i)) {
+      }
+    }
+    results[i] = std::move(still_fails);
+  });
+
+  for (int64_t i = 0; i < count; ++i) {
+    if (!results[i].has_value()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(bool still_fails, *results[i]);
+    (*test_cache)[candidates[i].ir_text] = still_fails;
+  }
+  if (first_failing.load() == count) {
+    return absl::nullopt;
+  }
+  return first_failing.load();
+}
+
+// Delta-debugging style bulk simplification: splits the (non-literal) nodes of
+// the known-failing function into chunks and tries replacing every node of a
+// chunk with a zero literal at once. If some chunk can be replaced the chunk
+// count is decreased again; otherwise it is doubled, until chunks consist of
+// single nodes. Returns the smallest failing IR found.
+absl::StatusOr<std::string> BulkRemove(
+    std::string knownf_ir_text,
+    const absl::optional<std::vector<Value>>& inputs, bool can_remove_params,
+    int64_t num_threads, absl::flat_hash_map<std::string, bool>* test_cache) {
+  XLS_LOG(INFO) << "=== Bulk removal";
+  int64_t chunk_count = 2;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParsePackage(knownf_ir_text));
+    XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+    std::vector<std::string> names;
+    for (Node* n : f->nodes()) {
+      if (n->Is<Literal>() || n->GetType()->IsToken() ||
+          (n->Is<Param>() && n->IsDead())) {
+        continue;
+      }
+      names.push_back(n->GetName());
+    }
+    if (names.empty()) {
+      break;
+    }
+    chunk_count = std::min<int64_t>(chunk_count, names.size());
+
+    std::vector<Candidate> candidates;
+    for (int64_t chunk = 0; chunk < chunk_count; ++chunk) {
+      int64_t begin = chunk * names.size() / chunk_count;
+      int64_t end = (chunk + 1) * names.size() / chunk_count;
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> candidate_package,
+                           ParsePackage(knownf_ir_text));
+      XLS_ASSIGN_OR_RETURN(Function * candidate,
+                           candidate_package->GetTopAsFunction());
+      for (int64_t i = begin; i < end; ++i) {
+        XLS_ASSIGN_OR_RETURN(Node * n, candidate->GetNode(names[i]));
+        XLS_RETURN_IF_ERROR(
+            n->ReplaceUsesWithNew<Literal>(ZeroOfType(n->GetType())).status());
+      }
+      XLS_RETURN_IF_ERROR(CleanUp(candidate, can_remove_params));
+      std::string candidate_ir_text = candidate_package->DumpIr();
+      if (candidate_ir_text == knownf_ir_text) {
+        continue;
+      }
+      candidates.push_back(Candidate{
+          .ir_text = std::move(candidate_ir_text),
+          .which_transform = absl::StrFormat(
+              "bulk replace %d of %d nodes with zero", end - begin,
+              names.size()),
+          .node_count = candidate->node_count()});
+    }
+
+    XLS_ASSIGN_OR_RETURN(
+        absl::optional<int64_t> winner,
+        FindFirstStillFailing(candidates, inputs, num_threads, test_cache));
+    if (winner.has_value()) {
+      const Candidate& accepted = candidates[*winner];
+      knownf_ir_text = accepted.ir_text;
+      std::cerr << "---\ntransform: " << accepted.which_transform << "\n"
+                << knownf_ir_text << "(" << accepted.node_count
+                << " nodes)" << std::endl;
+      chunk_count = std::max<int64_t>(chunk_count - 1, 2);
+      continue;
+    }
+    if (chunk_count >= names.size()) {
+      break;
+    }
+    chunk_count = std::min<int64_t>(2 * chunk_count, names.size());
+  }
+  XLS_LOG(INFO) << "=== Done with bulk removal";
+  return knownf_ir_text;
+}
+
+// As MinimizeSerially, but in each round generates up to `num_threads`
+// candidate simplifications of the known-failing IR, tests them concurrently
+// and accepts the first (in generation order) that still fails. Candidate
+// generation uses the same deterministic RNG so results are reproducible for
+// a given thread count.
+absl::StatusOr<std::string> MinimizeInParallel(
+    std::string knownf_ir_text,
+    const absl::optional<std::vector<Value>>& inputs, bool can_remove_params,
+    int64_t failed_attempt_limit, int64_t total_attempt_limit,
+    int64_t num_threads, absl::flat_hash_map<std::string, bool>* test_cache) {
+  const int64_t batch_size =
+      num_threads == 0 ? DefaultThreadCount() : num_threads;
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
+
+  int64_t failed_simplification_attempts = 0;
+  int64_t total_attempts = 0;
+  bool cannot_change = false;
+  while (!cannot_change) {
+    if (failed_simplification_attempts >= failed_attempt_limit) {
+      XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                    << failed_simplification_attempts;
+      break;
+    }
+    if (total_attempts >= total_attempt_limit) {
+      XLS_LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+      break;
+    }
+
+    std::vector<Candidate> candidates;
+    absl::flat_hash_set<std::string> candidate_texts;
+    while (candidates.size() < batch_size &&
+           total_attempts < total_attempt_limit &&
+           failed_simplification_attempts < failed_attempt_limit) {
+      total_attempts++;
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      XLS_ASSIGN_OR_RETURN(Function * candidate, package->GetTopAsFunction());
+      std::string which_transform;
+      XLS_ASSIGN_OR_RETURN(
+          SimplificationResult simplification,
+          Simplify(candidate, inputs, &rng, &which_transform));
+      if (simplification == SimplificationResult::kCannotChange) {
+        XLS_LOG(INFO) << "Cannot simplify any further, done!";
+        cannot_change = true;
+        break;
+      }
+      if (simplification == SimplificationResult::kDidNotChange) {
+        XLS_VLOG(1) << "Did not change the sample.";
+        failed_simplification_attempts++;
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(CleanUp(candidate, can_remove_params));
+      std::string candidate_ir_text = package->DumpIr();
+      if (!candidate_texts.insert(candidate_ir_text).second) {
+        // Duplicate of a candidate already in this round.
+        failed_simplification_attempts++;
+        continue;
+      }
+      candidates.push_back(
+          Candidate{.ir_text = std::move(candidate_ir_text),
+                    .which_transform = std::move(which_transform),
+                    .node_count = candidate->node_count()});
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+
+    XLS_LOG(INFO) << "Trying " << candidates.size()
+                  << " candidate simplifications";
+    XLS_ASSIGN_OR_RETURN(
+        absl::optional<int64_t> winner,
+        FindFirstStillFailing(candidates, inputs, num_threads, test_cache));
+    if (!winner.has_value()) {
+      failed_simplification_attempts += candidates.size();
+      XLS_LOG(INFO) << "No candidate still fails; failed simplification "
+                       "attempts now: "
+                    << failed_simplification_attempts;
+      continue;
+    }
+
+    const Candidate& accepted = candidates[*winner];
+    knownf_ir_text = accepted.ir_text;
+    std::cerr << "---\ntransform: " << accepted.which_transform << "\n"
+              << knownf_ir_text << "(" << accepted.node_count << " nodes)"
+              << std::endl;
+    failed_simplification_attempts = 0;
+  }
+  return knownf_ir_text;
+}
+
+absl::Status RealMain(absl::string_view path,
+                      const int64_t failed_attempt_limit,
+                      const int64_t total_attempt_limit,
+                      const int64_t num_threads) {
+  XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
+  // Cache of test results to avoid duplicate invocations of the
+  // test_executable.
+  absl::flat_hash_map<std::string, bool> test_cache;
+
+  // Parse inputs, if specified.
+  absl::optional<std::vector<xls::Value>> inputs;
+  if (!absl::GetFlag(FLAGS_input).empty()) {
+    inputs = std::vector<xls::Value>();
+    XLS_QCHECK(absl::GetFlag(FLAGS_test_llvm_jit))
+        << "Can only specify --input with --test_llvm_jit";
+    for (const absl::string_view& value_string :
+         absl::StrSplit(absl::GetFlag(FLAGS_input), ';')) {
+      XLS_ASSIGN_OR_RETURN(Value input, Parser::ParseTypedValue(value_string));
+      inputs->push_back(input);
+    }
+  }
+
+  // Check what the user gave us actually fails.
+  XLS_RETURN_IF_ERROR(VerifyStillFails(
+      knownf_ir_text, inputs,
+      "Originally-provided main function provided does not fail", &test_cache));
+
+  const bool can_remove_params = absl::GetFlag(FLAGS_can_remove_params);
+
+  // Clean up any initial garbage and see if it still fails.
+  {
+    XLS_LOG(INFO) << "=== Cleaning up initial garbage";
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParsePackage(knownf_ir_text));
+    XLS_ASSIGN_OR_RETURN(Function * main, package->GetTopAsFunction());
+    XLS_RETURN_IF_ERROR(CleanUp(main, can_remove_params));
+    XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+    knownf_ir_text = package->DumpIr();
+    XLS_RETURN_IF_ERROR(VerifyStillFails(
+        knownf_ir_text, inputs,
+        "Original main function does not fail after cleanup", &test_cache));
+    XLS_LOG(INFO) << "=== Done cleaning up initial garbage";
+  }
+
+  if (absl::GetFlag(FLAGS_bulk_removal)) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        BulkRemove(knownf_ir_text, inputs, can_remove_params, num_threads,
+                   &test_cache));
+  }
+
+  if (num_threads == 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeSerially(knownf_ir_text, inputs, can_remove_params,
+                         failed_attempt_limit, total_attempt_limit,
+                         &test_cache));
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeInParallel(knownf_ir_text, inputs, can_remove_params,
+                           failed_attempt_limit, total_attempt_limit,
+                           num_threads, &test_cache));
+  }
+
   // Run the last test verification without the cache.
   XLS_RETURN_IF_ERROR(VerifyStillFails(knownf_ir_text, inputs,
                                        "Minimized function does not fail!",
@@ -671,7 +947,8 @@ int main(int argc, char** argv) {
 
   XLS_QCHECK_OK(xls::RealMain(positional_arguments[0],
                               absl::GetFlag(FLAGS_failed_attempt_limit),
-                              absl::GetFlag(FLAGS_total_attempt_limit)));
+                              absl::GetFlag(FLAGS_total_attempt_limit),
+                              absl::GetFlag(FLAGS_num_threads)));
 
   return EXIT_SUCCESS;
 }
@@ -16,15 +16,24 @@
 
 #include <signal.h>
 
+#include <set>
+
 #include "absl/base/internal/sysinfo.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/parallel_for.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
@@ -48,6 +57,10 @@ ABSL_FLAG(std::string, cell_proto_path, "",
           "This is a whole bunch faster than specifiying an unprocessed "
           "cell library and should be favored.\n"
           "Either this or --cell_lib_path should be set.");
+ABSL_FLAG(std::string, cell_lib_cache_path, "",
+          "Optional path at which to cache the cell library extracted from "
+          "--cell_lib_path, as a binary CellLibraryProto. The cache is reused "
+          "while it is at least as new as the library.");
 ABSL_FLAG(std::string, constraints_file, "",
           "Optional path to a DSLX file containing a input parameter "
           "constraint function. This function must have the same signature as "
@@ -85,6 +98,19 @@ ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
           "will be evaluated.");
+ABSL_FLAG(bool, all_stages, false,
+          "If true, every pipeline stage is checked independently and "
+          "concurrently, each in its own Z3 context, and the solve time of "
+          "each stage is reported. Requires --schedule_path.");
+ABSL_FLAG(int32_t, num_threads, 0,
+          "Number of stages to check concurrently with --all_stages. If zero, "
+          "the number of hardware threads is used.");
+ABSL_FLAG(std::string, cache_path, "",
+          "Optional file of previously-proven stage fingerprints for use with "
+          "--all_stages. A fingerprint covers the IR nodes of a stage and the "
+          "netlist cone between its registers, so stages whose fingerprint is "
+          "present are not re-proven. Fingerprints of newly-proven stages are "
+          "added to the file.");
 
 namespace xls {
 namespace {
@@ -93,10 +119,11 @@ using solvers::z3::IrTranslator;
 
 constexpr const char kIrConverterPath[] = "xls/dslx/ir_converter_main";
 
-// Loads a cell library, either from a raw Liberty file or a preprocessed
-// CellLibraryProto proto.
+// Loads a cell library, either from a raw Liberty file (possibly via a cache)
+// or a preprocessed CellLibraryProto proto.
 absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
-    absl::string_view cell_lib_path, absl::string_view cell_proto_path) {
+    absl::string_view cell_lib_path, absl::string_view cell_proto_path,
+    absl::string_view cell_lib_cache_path) {
   if (!cell_proto_path.empty()) {
     XLS_ASSIGN_OR_RETURN(std::string cell_proto_text,
                          GetFileContents(cell_proto_path));
@@ -104,21 +131,27 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
     return netlist::CellLibrary::FromProto(cell_proto);
   } else {
-    XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
-    XLS_ASSIGN_OR_RETURN(auto stream,
-                         netlist::cell_lib::CharStream::FromText(lib_text));
     XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
-                         netlist::function::ExtractFunctions(&stream));
+                         netlist::function::ExtractFunctionsCached(
+                             std::string(cell_lib_path),
+                             std::string(cell_lib_cache_path)));
     return netlist::CellLibrary::FromProto(proto);
   }
 }
 
-// Loads and parses a netlist from a file.
+// Loads and parses a netlist from a file, parsing its modules in parallel.
 absl::StatusOr<std::unique_ptr<netlist::rtl::Netlist>> GetNetlist(
     absl::string_view netlist_path, netlist::CellLibrary* cell_library) {
   XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  return netlist::rtl::Parser::ParseNetlist(cell_library, &scanner);
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<netlist::rtl::Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlistParallel(cell_library, netlist_text));
+  absl::Duration elapsed = absl::Now() - start;
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Parsed netlist in %s (%.1f MB/s)", absl::FormatDuration(elapsed),
+      netlist_text.size() / 1e6 / absl::ToDoubleSeconds(elapsed));
+  return netlist;
 }
 
 // Returns true if the given function contains a large ( > 8 bit) multiply op.
@@ -219,14 +252,135 @@ absl::Status AutoStage(const solvers::z3::LecParams& lec_params,
   return absl::OkStatus();
 }
 
+// The outcome of checking a single stage with --all_stages.
+struct StageResult {
+  std::string fingerprint;
+  // True if the stage was found in the cache and so not re-proven.
+  bool cached = false;
+  bool equal = false;
+  bool timed_out = false;
+  absl::Duration solve_time;
+  // Retained only for stages found to differ, to report the counterexample.
+  std::unique_ptr<solvers::z3::Lec> lec;
+};
+
+// Reads the set of proven fingerprints from the cache file, one per line. A
+// missing file is treated as an empty cache.
+absl::StatusOr<std::set<std::string>> ReadProofCache(
+    absl::string_view cache_path) {
+  std::set<std::string> cache;
+  if (cache_path.empty() || !FileExists(cache_path).ok()) {
+    return cache;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(cache_path));
+  for (absl::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+    cache.insert(std::string(absl::StripAsciiWhitespace(line)));
+  }
+  return cache;
+}
+
+absl::StatusOr<StageResult> CheckStage(
+    const solvers::z3::LecParams& lec_params, const PipelineSchedule& schedule,
+    int stage, int timeout_sec, const std::set<std::string>& cache) {
+  StageResult result;
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::Lec> lec,
+                       solvers::z3::Lec::CreateForStage(lec_params, schedule,
+                                                        stage));
+  XLS_ASSIGN_OR_RETURN(result.fingerprint, lec->Fingerprint());
+  if (cache.count(result.fingerprint) != 0) {
+    result.cached = true;
+    result.equal = true;
+    return result;
+  }
+
+  // SIGALRM-based timeouts can only interrupt a single context, so rely on the
+  // solver's own timeout here.
+  if (timeout_sec != -1) {
+    lec->SetTimeout(absl::Seconds(timeout_sec));
+  }
+  absl::Time start = absl::Now();
+  result.equal = lec->Run();
+  result.solve_time = absl::Now() - start;
+  result.timed_out = lec->Undetermined();
+  if (!result.equal && !result.timed_out) {
+    result.lec = std::move(lec);
+  }
+  return result;
+}
+
+// Checks every stage of the schedule concurrently, skipping those whose
+// fingerprints are in the cache, and reports the result and solve time of
+// each.
+absl::Status AllStages(const solvers::z3::LecParams& lec_params,
+                       const PipelineSchedule& schedule, int timeout_sec,
+                       int num_threads, absl::string_view cache_path) {
+  XLS_ASSIGN_OR_RETURN(std::set<std::string> cache,
+                       ReadProofCache(cache_path));
+
+  // Stages are already checked in parallel, so give each solver a single
+  // thread rather than oversubscribing the machine.
+  solvers::z3::LecParams stage_params = lec_params;
+  stage_params.solver_threads = 1;
+
+  std::vector<absl::StatusOr<StageResult>> results(schedule.length());
+  absl::Time start = absl::Now();
+  ParallelFor(schedule.length(), num_threads, [&](int64_t stage) {
+    results[stage] =
+        CheckStage(stage_params, schedule, stage, timeout_sec, cache);
+  });
+  absl::Duration wall_time = absl::Now() - start;
+
+  int64_t passed = 0;
+  int64_t cached = 0;
+  absl::Duration total_solve_time;
+  for (int stage = 0; stage < schedule.length(); ++stage) {
+    XLS_RETURN_IF_ERROR(results[stage].status());
+    StageResult& result = results[stage].value();
+    std::cout << "Stage " << stage << " [" << result.fingerprint << "]: ";
+    total_solve_time += result.solve_time;
+    if (result.cached) {
+      std::cout << "PASSED (cached)\n";
+      ++passed;
+      ++cached;
+      continue;
+    }
+    std::string solve_time = absl::FormatDuration(result.solve_time);
+    if (result.timed_out) {
+      std::cout << "TIMED OUT after " << solve_time << "\n";
+    } else if (result.equal) {
+      std::cout << "PASSED in " << solve_time << "\n";
+      ++passed;
+      cache.insert(result.fingerprint);
+    } else {
+      std::cout << "FAILED in " << solve_time << "\n";
+      std::cout << result.lec->ResultToString() << std::endl;
+      std::cout << std::endl << "IR/netlist value dump:" << std::endl;
+      result.lec->DumpIrTree();
+    }
+  }
+  std::cout << passed << "/" << schedule.length() << " stages passed ("
+            << cached << " cached); total solve time "
+            << absl::FormatDuration(total_solve_time) << ", wall time "
+            << absl::FormatDuration(wall_time) << ".\n";
+
+  if (!cache_path.empty()) {
+    std::string contents = absl::StrCat(absl::StrJoin(cache, "\n"), "\n");
+    XLS_RETURN_IF_ERROR(SetFileContents(cache_path, contents));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::Status RealMain(
     absl::string_view ir_path, absl::string_view entry_function_name,
     absl::string_view netlist_module_name, absl::string_view cell_lib_path,
-    absl::string_view cell_proto_path, absl::string_view netlist_path,
-    absl::string_view constraints_file, absl::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    absl::string_view cell_proto_path, absl::string_view cell_lib_cache_path,
+    absl::string_view netlist_path, absl::string_view constraints_file,
+    absl::string_view schedule_path, int stage, bool auto_stage,
+    bool all_stages, int num_threads, absl::string_view cache_path,
+    int timeout_sec) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -240,7 +394,8 @@ absl::Status RealMain(
         lec_params.ir_package->GetFunction(entry_function_name));
   }
   XLS_ASSIGN_OR_RETURN(auto cell_library,
-                       GetCellLibrary(cell_lib_path, cell_proto_path));
+                       GetCellLibrary(cell_lib_path, cell_proto_path,
+                                      cell_lib_cache_path));
   XLS_ASSIGN_OR_RETURN(auto netlist, GetNetlist(netlist_path, &cell_library));
   lec_params.netlist = netlist.get();
   lec_params.netlist_module_name = netlist_module_name;
@@ -256,6 +411,12 @@ absl::Status RealMain(
     if (auto_stage) {
       return AutoStage(lec_params, schedule, timeout_sec);
     }
+    if (all_stages) {
+      XLS_RET_CHECK(constraints_file.empty())
+          << "Constraints cannot be specified with --all_stages.";
+      return AllStages(lec_params, schedule, timeout_sec, num_threads,
+                       cache_path);
+    }
     XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::CreateForStage(
                                   std::move(lec_params), schedule, stage));
   } else {
@@ -316,6 +477,9 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(cell_lib_path.empty() ^ cell_proto_path.empty())
       << "One (and only one) of --cell_lib_path and --cell_proto_path "
          "should be set.";
+  std::string cell_lib_cache_path = absl::GetFlag(FLAGS_cell_lib_cache_path);
+  XLS_QCHECK(cell_lib_cache_path.empty() || !cell_lib_path.empty())
+      << "--cell_lib_cache_path requires --cell_lib_path.";
 
   std::string schedule_path = absl::GetFlag(FLAGS_schedule_path);
   int stage = absl::GetFlag(FLAGS_stage);
@@ -329,10 +493,21 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
 
+  bool all_stages = absl::GetFlag(FLAGS_all_stages);
+  XLS_QCHECK(!(all_stages && (auto_stage || stage != -1)))
+      << "--all_stages may not be combined with --stage or --auto_stage.";
+  XLS_QCHECK(!(all_stages && schedule_path.empty()))
+      << "--schedule_path must be specified with --all_stages.";
+  std::string cache_path = absl::GetFlag(FLAGS_cache_path);
+  XLS_QCHECK(all_stages || cache_path.empty())
+      << "--cache_path requires --all_stages.";
+
   XLS_QCHECK_OK(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
-      netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      cell_lib_cache_path, netlist_path, absl::GetFlag(FLAGS_constraints_file),
+      schedule_path, stage, auto_stage, all_stages,
+      absl::GetFlag(FLAGS_num_threads), cache_path,
+      absl::GetFlag(FLAGS_timeout_sec)));
   return 0;
 }
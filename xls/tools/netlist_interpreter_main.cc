@@ -18,16 +18,21 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xls/codegen/flattening.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_simulator.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
 #include "xls/netlist/lib_parser.h"
@@ -38,6 +43,10 @@ ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
+ABSL_FLAG(std::string, cell_library_cache, "",
+          "Optional path at which to cache the cell library extracted from "
+          "--cell_library, as a binary CellLibraryProto. The cache is reused "
+          "while it is at least as new as the library.");
 // TODO(rspringer): Eliminate the need for this flag.
 // This one is a hidden temporary flag until we can properly handle cells
 // with state_function attributes (e.g., some latches).
@@ -48,6 +57,16 @@ ABSL_FLAG(std::string, input, "",
           "The input to the function as a semicolon-separated list of typed "
           "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\". "
           "Values must be listed in the same order as the module inputs.");
+ABSL_FLAG(std::string, input_file, "",
+          "Path to a file of input vectors, one per line, each in the format "
+          "of --input. The output for each vector is printed on its own "
+          "line. Either this or --input must be set.");
+ABSL_FLAG(bool, compiled, false,
+          "If true, evaluate the netlist with the bit-parallel compiled "
+          "simulator rather than the interpreter. The compiled simulator "
+          "evaluates many input vectors per pass, so is much faster for "
+          "large --input_file batches, but does not support cells described "
+          "by state tables or --dump_cells.");
 ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
@@ -58,7 +77,8 @@ namespace xls {
 
 absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     const std::string& cell_library_path,
-    const std::string& cell_library_proto_path) {
+    const std::string& cell_library_proto_path,
+    const std::string& cell_library_cache_path) {
   if (!cell_library_proto_path.empty()) {
     XLS_ASSIGN_OR_RETURN(std::string proto_text,
                          GetFileContents(cell_library_proto_path));
@@ -66,34 +86,17 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
     return netlist::CellLibrary::FromProto(lib_proto);
   } else {
-    XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                         GetFileContents(cell_library_path));
-    XLS_ASSIGN_OR_RETURN(
-        auto char_stream,
-        netlist::cell_lib::CharStream::FromText(cell_library_text));
     XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                         netlist::function::ExtractFunctions(&char_stream));
+                         netlist::function::ExtractFunctionsCached(
+                             cell_library_path, cell_library_cache_path));
     return netlist::CellLibrary::FromProto(lib_proto);
   }
 }
 
-absl::Status RealMain(const std::string& netlist_path,
-                      const std::string& cell_library_path,
-                      const std::string& cell_library_proto_path,
-                      const std::string& module_name,
-                      absl::Span<const std::string> inputs,
-                      const std::string& output_type_string,
-                      absl::Span<const std::string> dump_cells) {
-  XLS_ASSIGN_OR_RETURN(
-      netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
-
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
-                                         &cell_library, &scanner));
-  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
-
+// Converts one input vector - a list of values in module declaration order -
+// into Bits whose bit i is the value of module->inputs()[i].
+absl::StatusOr<Bits> InputVectorToBits(const netlist::rtl::Module* module,
+                                       absl::Span<const std::string> inputs) {
   // Input values are listed in the same order as inputs are declared by
   // the netlist module declaration, which may be different from the order of
   // Module::inputs().  For example:
@@ -115,38 +118,94 @@ absl::Status RealMain(const std::string& netlist_path,
   }
   input_bits = bits_ops::Reverse(input_bits);
 
-  netlist::NetRef2Value input_nets;
   const std::vector<netlist::rtl::NetRef>& module_inputs = module->inputs();
   XLS_RET_CHECK(module_inputs.size() == input_bits.bit_count());
 
-  for (int i = 0; i < module->inputs().size(); i++) {
-    const netlist::rtl::NetRef in = module_inputs[i];
-    input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
+  BitsRope rope(module_inputs.size());
+  for (const netlist::rtl::NetRef in : module_inputs) {
+    rope.push_back(input_bits.Get(module->GetInputPortOffset(in->name())));
+  }
+  return rope.Build();
+}
+
+absl::Status RealMain(const std::string& netlist_path,
+                      const std::string& cell_library_path,
+                      const std::string& cell_library_proto_path,
+                      const std::string& cell_library_cache_path,
+                      const std::string& module_name,
+                      absl::Span<const std::vector<std::string>> input_vectors,
+                      const std::string& output_type_string,
+                      absl::Span<const std::string> dump_cells,
+                      bool compiled) {
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibrary cell_library,
+      GetCellLibrary(cell_library_path, cell_library_proto_path,
+                     cell_library_cache_path));
+
+  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
+  absl::Time parse_start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlistParallel(
+                                         &cell_library, netlist_text));
+  absl::Duration parse_time = absl::Now() - parse_start;
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Parsed netlist in %s (%.1f MB/s)", absl::FormatDuration(parse_time),
+      netlist_text.size() / 1e6 / absl::ToDoubleSeconds(parse_time));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  std::vector<Bits> inputs;
+  for (const std::vector<std::string>& input_vector : input_vectors) {
+    XLS_ASSIGN_OR_RETURN(Bits input, InputVectorToBits(module, input_vector));
+    inputs.push_back(std::move(input));
   }
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
+  // Bit i of each result is the value of module->outputs()[i].
+  std::vector<Bits> results;
+  absl::Time start = absl::Now();
+  if (compiled) {
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CompiledSimulator simulator,
+        netlist::CompiledSimulator::Create(netlist.get(), module));
+    XLS_VLOG(1) << "Compiled module to " << simulator.op_count()
+                << " ops per pass.";
+    XLS_ASSIGN_OR_RETURN(results, simulator.Run(inputs));
+  } else {
+    netlist::Interpreter interpreter(netlist.get());
+    for (const Bits& input : inputs) {
+      netlist::NetRef2Value input_nets;
+      for (int i = 0; i < module->inputs().size(); i++) {
+        input_nets[module->inputs()[i]] = input.Get(i);
+      }
+      XLS_ASSIGN_OR_RETURN(
+          auto output_nets,
+          interpreter.InterpretModule(module, input_nets, dump_cells));
 
-  BitsRope rope(output_nets.size());
-  for (const netlist::rtl::NetRef ref : module->outputs()) {
-    rope.push_back(output_nets[ref]);
+      BitsRope rope(output_nets.size());
+      for (const netlist::rtl::NetRef ref : module->outputs()) {
+        rope.push_back(output_nets[ref]);
+      }
+      results.push_back(rope.Build());
+    }
   }
-  Bits output_bits = rope.Build();
+  XLS_VLOG(1) << "Evaluated " << inputs.size() << " input vectors in "
+              << absl::FormatDuration(absl::Now() - start);
 
-  Value output;
+  // This is a disposable package - it only exists to hold the type below.
+  Package package("foo");
+  Type* output_type = nullptr;
   if (!output_type_string.empty()) {
-    // This is a disposable package - it only exists to hold the type below.
-    Package package("foo");
-    XLS_ASSIGN_OR_RETURN(Type * output_type,
+    XLS_ASSIGN_OR_RETURN(output_type,
                          Parser::ParseType(output_type_string, &package));
-    XLS_ASSIGN_OR_RETURN(output,
-                         UnflattenBitsToValue(output_bits, output_type));
-  } else {
-    output = Value(output_bits);
   }
-
-  std::cout << output.ToString(FormatPreference::kHex) << std::endl;
+  for (const Bits& output_bits : results) {
+    Value output;
+    if (output_type != nullptr) {
+      XLS_ASSIGN_OR_RETURN(output,
+                           UnflattenBitsToValue(output_bits, output_type));
+    } else {
+      output = Value(output_bits);
+    }
+    std::cout << output.ToString(FormatPreference::kHex) << std::endl;
+  }
   return absl::OkStatus();
 }
 
@@ -160,6 +219,9 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!cell_library_path.empty() ^ !cell_library_proto_path.empty())
       << "One (and only one) of --cell_library or --cell_library_proto "
          "must be specified.";
+  std::string cell_library_cache_path = absl::GetFlag(FLAGS_cell_library_cache);
+  XLS_QCHECK(cell_library_cache_path.empty() || !cell_library_path.empty())
+      << "--cell_library_cache requires --cell_library.";
 
   std::string netlist_path = absl::GetFlag(FLAGS_netlist);
   XLS_QCHECK(!netlist_path.empty()) << "--netlist must be specified.";
@@ -168,17 +230,33 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!module_name.empty()) << "--module_name must be specified.";
 
   std::string input = absl::GetFlag(FLAGS_input);
-  XLS_QCHECK(!input.empty()) << "--input must be specified.";
-  std::vector<std::string> inputs = absl::StrSplit(input, ';');
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  XLS_QCHECK(input.empty() ^ input_file.empty())
+      << "One (and only one) of --input or --input_file must be specified.";
+  std::vector<std::string> input_lines;
+  if (!input.empty()) {
+    input_lines.push_back(input);
+  } else {
+    absl::StatusOr<std::string> input_text = xls::GetFileContents(input_file);
+    XLS_QCHECK_OK(input_text.status());
+    input_lines = absl::StrSplit(*input_text, '\n', absl::SkipWhitespace());
+  }
+  std::vector<std::vector<std::string>> input_vectors;
+  for (const std::string& line : input_lines) {
+    input_vectors.push_back(absl::StrSplit(line, ';'));
+  }
 
   std::string dump_cells_str = absl::GetFlag(FLAGS_dump_cells);
   std::vector<std::string> dump_cells = absl::StrSplit(dump_cells_str, ',');
+  XLS_QCHECK(dump_cells_str.empty() || !absl::GetFlag(FLAGS_compiled))
+      << "--dump_cells is not supported with --compiled.";
 
   std::string output_type = absl::GetFlag(FLAGS_output_type);
 
-  XLS_QCHECK_OK(xls::RealMain(netlist_path, cell_library_path,
-                              cell_library_proto_path, module_name, inputs,
-                              output_type, dump_cells));
+  XLS_QCHECK_OK(xls::RealMain(
+      netlist_path, cell_library_path, cell_library_proto_path,
+      cell_library_cache_path, module_name, input_vectors, output_type,
+      dump_cells, absl::GetFlag(FLAGS_compiled)));
 
   return 0;
 }
@@ -26,26 +26,54 @@ NETLIST_INTERPRETER_MAIN = runfiles.get_path(XLS_TOOLS +
 CELL_LIBRARY = runfiles.get_path(XLS_TOOLS + 'testdata/simple_cell.lib')
 
 
-def run_netlist_interpreter(netlist, module, input_data, output_type):
+def run_netlist_interpreter(netlist,
+                            module,
+                            input_data,
+                            output_type,
+                            extra_args=()):
   result = subprocess.check_output([
       NETLIST_INTERPRETER_MAIN,
       '--netlist=' + runfiles.get_path(XLS_TOOLS + netlist),
-      '--module_name=' + module, '--input=' + input_data,
-      '--output_type=' + output_type, '--cell_library=' + CELL_LIBRARY
-  ])
+      '--module_name=' + module, input_data, '--output_type=' + output_type,
+      '--cell_library=' + CELL_LIBRARY
+  ] + list(extra_args))
   return result.decode('utf-8').strip()
 
 
 class NetlistTranspilerMainTest(test_base.TestCase):
 
   def test_sqrt(self):
-    res = run_netlist_interpreter('testdata/sqrt.v', 'isqrt', 'bits[16]:100',
-                                  'bits[8]')
+    res = run_netlist_interpreter('testdata/sqrt.v', 'isqrt',
+                                  '--input=bits[16]:100', 'bits[8]')
+    self.assertEqual(res, 'bits[8]:0xa')
+
+  def test_sqrt_compiled(self):
+    res = run_netlist_interpreter(
+        'testdata/sqrt.v',
+        'isqrt',
+        '--input=bits[16]:100',
+        'bits[8]',
+        extra_args=['--compiled'])
     self.assertEqual(res, 'bits[8]:0xa')
 
+  def test_sqrt_input_file(self):
+    inputs = [0, 1, 99, 100, 144, 65535]
+    input_file = self.create_tempfile(
+        content='\n'.join('bits[16]:{}'.format(x) for x in inputs))
+    expected = '\n'.join(
+        'bits[8]:{:#x}'.format(int(x**0.5)) for x in inputs)
+    for extra_args in ([], ['--compiled']):
+      res = run_netlist_interpreter(
+          'testdata/sqrt.v',
+          'isqrt',
+          '--input_file=' + input_file.full_path,
+          'bits[8]',
+          extra_args=extra_args)
+      self.assertEqual(res, expected)
+
   def test_ifte(self):
     res = run_netlist_interpreter('testdata/ifte.v', 'ifte',
-                                  'bits[1]:1;bits[8]:0xaa;bits[8]:0xbb',
+                                  '--input=bits[1]:1;bits[8]:0xaa;bits[8]:0xbb',
                                   'bits[8]')
     self.assertEqual(res, 'bits[8]:0xaa')
 
@@ -50,6 +50,8 @@ absl::StatusOr<std::string> OptimizeIrForEntry(absl::string_view ir,
       .skip_passes = options.skip_passes,
       .inline_procs = options.inline_procs,
       .convert_array_index_to_select = options.convert_array_index_to_select,
+      .resource_sharing_max_delay_increase_ps =
+          options.resource_sharing_max_delay_increase_ps,
   };
   PassResults results;
   XLS_RETURN_IF_ERROR(
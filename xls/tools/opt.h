@@ -39,6 +39,7 @@ struct OptOptions {
   absl::optional<std::vector<std::string>> run_only_passes = absl::nullopt;
   std::vector<std::string> skip_passes;
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
+  std::optional<int64_t> resource_sharing_max_delay_increase_ps = std::nullopt;
   bool inline_procs;
 };
 
@@ -59,6 +59,11 @@ ABSL_FLAG(int64_t, convert_array_index_to_select, -1,
           "equal to the given number of possible indices (by range analysis) "
           "into chains of selects. Otherwise, this optimization is skipped, "
           "since it can sometimes reduce output quality.");
+ABSL_FLAG(int64_t, resource_sharing_max_delay_increase_ps, -1,
+          "If specified, share expensive operations feeding mutually "
+          "exclusive select arms as long as the critical-path delay grows by "
+          "no more than the given number of picoseconds. Otherwise, resource "
+          "sharing is skipped.");
 ABSL_FLAG(int64_t, opt_level, xls::kMaxOptLevel,
           absl::StrFormat("Optimization level. Ranges from 1 to %d.",
                           xls::kMaxOptLevel));
@@ -80,6 +85,8 @@ absl::Status RealMain(absl::string_view input_path) {
       absl::GetFlag(FLAGS_run_only_passes);
   int64_t convert_array_index_to_select =
       absl::GetFlag(FLAGS_convert_array_index_to_select);
+  int64_t resource_sharing_max_delay_increase_ps =
+      absl::GetFlag(FLAGS_resource_sharing_max_delay_increase_ps);
   const OptOptions options = {
       .opt_level = absl::GetFlag(FLAGS_opt_level),
       .entry = entry,
@@ -92,6 +99,10 @@ absl::Status RealMain(absl::string_view input_path) {
           (convert_array_index_to_select < 0)
               ? std::nullopt
               : std::make_optional(convert_array_index_to_select),
+      .resource_sharing_max_delay_increase_ps =
+          (resource_sharing_max_delay_increase_ps < 0)
+              ? std::nullopt
+              : std::make_optional(resource_sharing_max_delay_increase_ps),
       .inline_procs = absl::GetFlag(FLAGS_inline_procs),
   };
   XLS_ASSIGN_OR_RETURN(std::string opt_ir,
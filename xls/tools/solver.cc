@@ -22,6 +22,8 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/solvers/aig_ir_translator.h"
+#include "xls/solvers/simulation_prefilter.h"
 #include "xls/solvers/z3_ir_translator.h"
 
 ABSL_FLAG(std::string, subject, "",
@@ -32,6 +34,13 @@ ABSL_FLAG(std::string, other, "",
           "Node for comparison; e.g. when kind is eq_node");
 ABSL_FLAG(int64_t, timeout_ms, 60000,
           "Timeout for proof attempt, in milliseconds");
+ABSL_FLAG(std::string, backend, "z3",
+          "Solver to use; choices: z3, aig (bit-blasting to an and-inverter "
+          "graph solved by the built-in SAT solver)");
+ABSL_FLAG(int64_t, prefilter_samples, 2048,
+          "Number of random and corner-case arguments to simulate (with the "
+          "JIT) in search of a counterexample before invoking the solver; 0 "
+          "disables simulation");
 
 const char kUsage[] = R"(
 Attempts to prove a property of a node in an XLS IR entry function within a
@@ -56,7 +65,8 @@ using solvers::z3::Predicate;
 absl::Status RealMain(absl::string_view ir_path,
                       absl::string_view subject_node_name,
                       absl::string_view predicate_kind,
-                      absl::string_view other_node_name, int64_t timeout_ms) {
+                      absl::string_view other_node_name, int64_t timeout_ms,
+                      absl::string_view backend, int64_t prefilter_samples) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(contents, ir_path));
@@ -74,12 +84,39 @@ absl::Status RealMain(absl::string_view ir_path,
         absl::StrFormat("Invalid predicate kind: \"%s\"", predicate_kind));
   }
 
+  solvers::ProverFn prover;
+  if (backend == "z3") {
+    prover = solvers::z3::TryProve;
+  } else if (backend == "aig") {
+    prover = [](Function* f, Node* subject, Predicate p,
+                absl::Duration timeout) -> absl::StatusOr<bool> {
+      XLS_ASSIGN_OR_RETURN(solvers::aig::ProofReport report,
+                           solvers::aig::Prove(f, subject, p, timeout));
+      XLS_VLOG(1) << "AIG proof: " << report.ToString();
+      return report.result == solvers::aig::ProofResult::kProven;
+    };
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid backend: \"%s\"", backend));
+  }
+
+  solvers::PrefilterOptions options;
+  options.samples = prefilter_samples;
+  solvers::SimulationPrefilter prefilter(options, std::move(prover));
   XLS_ASSIGN_OR_RETURN(
-      bool proved,
-      solvers::z3::TryProve(f, subject, predicate.value(), timeout));
+      solvers::PrefilterResult result,
+      prefilter.TryProve(f, subject, predicate.value(), timeout));
+  XLS_VLOG(1) << "Simulation prefilter: " << prefilter.stats().ToString();
+  if (result.counterexample.has_value()) {
+    std::cout << "Counterexample found by simulation:" << std::endl;
+    for (int64_t i = 0; i < f->params().size(); ++i) {
+      std::cout << "  " << f->param(i)->GetName() << " = "
+                << result.counterexample->at(i).ToString() << std::endl;
+    }
+  }
   std::cout << "Proved " << subject_node_name << " " << predicate->ToString()
             << " holds for all input?"
-            << ": " << (proved ? "true" : "false") << std::endl;
+            << ": " << (result.proven ? "true" : "false") << std::endl;
   return absl::OkStatus();
 }
 
@@ -99,6 +136,8 @@ int main(int argc, char** argv) {
   XLS_QCHECK_OK(
       xls::RealMain(positional_arguments[0], absl::GetFlag(FLAGS_subject),
                     absl::GetFlag(FLAGS_kind), absl::GetFlag(FLAGS_other),
-                    absl::GetFlag(FLAGS_timeout_ms)));
+                    absl::GetFlag(FLAGS_timeout_ms),
+                    absl::GetFlag(FLAGS_backend),
+                    absl::GetFlag(FLAGS_prefilter_samples)));
   return EXIT_SUCCESS;
 }